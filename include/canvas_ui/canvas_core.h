@@ -205,7 +205,8 @@ enum class EventType {
     TRACKPAD_ZOOM,
     TRACKPAD_ROTATE,
     SMART_MOUSE_GESTURE,
-    MODIFIER_CHANGE  // Special event for when modifier keys change
+    MODIFIER_CHANGE, // Special event for when modifier keys change
+    TEXT_INPUT       // A character was typed; codepoint holds it
 };
 
 enum class MouseButton {
@@ -228,6 +229,7 @@ struct InputEvent {
     Point2D mouse_delta;
     MouseButton mouse_button;
     int key_code;
+    uint32_t codepoint = 0; // TEXT_INPUT: Unicode codepoint after keyboard layout and IME
     uint32_t modifiers; // Bitfield of KeyModifier values
     float wheel_delta;
     double timestamp;
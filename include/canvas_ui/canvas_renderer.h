@@ -13,8 +13,12 @@
 
 #include "canvas_core.h"
 #include "scaled_theme.h"
+#include "path_tessellator.h"
+#include "vertex_packing.h"
+#include "texture_residency.h"
 #include "glad/gl.h"
 #include <memory>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -23,7 +27,8 @@
 // Forward declare to avoid circular dependency
 namespace voxel_canvas { 
     class FontSystem;
-    class PolylineShader;
+    class FontFace;
+    struct ShapedRun;
 }
 
 namespace voxel_canvas {
@@ -35,15 +40,19 @@ class TextRenderer;
 struct RenderBatch;
 
 // UIVertex definition - moved here from bottom of file for CurrentBatch
+// Packed to 16 bytes: float position (text needs subpixel placement across
+// the full framebuffer), unorm16 texture coordinates, RGBA8 color
 struct UIVertex {
     float x, y;
-    float u, v;
-    float r, g, b, a;
+    uint16_t u, v;
+    uint8_t r, g, b, a;
     
     UIVertex(float x = 0, float y = 0, float u = 0, float v = 0, 
              float r = 1, float g = 1, float b = 1, float a = 1)
-        : x(x), y(y), u(u), v(v), r(r), g(g), b(b), a(a) {}
+        : x(x), y(y), u(pack_unorm16(u)), v(pack_unorm16(v)),
+          r(pack_unorm8(r)), g(pack_unorm8(g)), b(pack_unorm8(b)), a(pack_unorm8(a)) {}
 };
+static_assert(sizeof(UIVertex) == 16, "UIVertex must stay tightly packed");
 
 // Widget instance data for GPU instancing with professional architecture
 struct WidgetInstance {
@@ -111,6 +120,11 @@ public:
     // UI line drawing using batched rectangles
     void draw_line_batched(const Point2D& start, const Point2D& end, const ColorRGBA& color, float width = 1.0f);
     
+    // Anti-aliased instanced segments for dense line work (curves, graphs, overlays)
+    void draw_line_aa(const Point2D& start, const Point2D& end, const ColorRGBA& color,
+                      float width = 1.0f, bool round_caps = true);
+    void draw_polyline(const std::vector<Point2D>& points, const ColorRGBA& color, float width = 1.0f);
+    
     // Viewport immediate rendering (for 3D overlays like navigation widget)
     // These use immediate mode OpenGL and should only be called by viewport components
     void draw_viewport_line(const Point2D& start, const Point2D& end, const ColorRGBA& color, float width = 1.0f);
@@ -180,6 +194,17 @@ public:
                                  const ColorRGBA& color, float size = 14.0f,
                                  TextAlign align = TextAlign::LEFT);
     
+    // Shaped run of the default font at draw_text's pixel size, for caret
+    // placement and hit-testing; valid until the run is evicted
+    const ShapedRun* get_text_run(const std::string& text, float size = 14.0f);
+    
+    // Glyphs [glyph_begin, glyph_end) of a run built with quads, e.g. one line
+    // of a TextLayout; position is the top-left of the line box
+    void draw_text_run(const ShapedRun& run, const Point2D& position, float ascender,
+                       const ColorRGBA& color, size_t glyph_begin, size_t glyph_end) {
+        batch_text_run(run, position, ascender, color, glyph_begin, glyph_end);
+    }
+    
     void draw_text_with_shadow(const std::string& text, const Point2D& position,
                                const ColorRGBA& color, const ColorRGBA& shadow_color,
                                float size = 14.0f, float shadow_offset_x = 1.0f,
@@ -197,14 +222,20 @@ public:
     void draw_image(GLuint texture_id, const Rect2D& bounds, ObjectFit fit = ObjectFit::Fill,
                    const ColorRGBA& tint = ColorRGBA(1, 1, 1, 1));
     
-    // Path rendering (simplified)
+    // Image file loaded in the background by ImageLoader; a placeholder is
+    // drawn until its texture is ready, and nothing if the file failed
+    void draw_image(const std::string& path, const Rect2D& bounds, ObjectFit fit = ObjectFit::Fill,
+                   const ColorRGBA& tint = ColorRGBA(1, 1, 1, 1));
+    
+    // Path rendering - tessellated once per path and scale, drawn as batched meshes
     void begin_path();
     void move_to(float x, float y);
     void line_to(float x, float y);
     void curve_to(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y);
     void close_path();
-    void stroke_path(const ColorRGBA& color, float width = 1.0f);
-    void fill_path(const ColorRGBA& color);
+    void stroke_path(const ColorRGBA& color, float width = 1.0f,
+                     LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt);
+    void fill_path(const ColorRGBA& color);  // Even-odd, supports concave paths and holes
     
     // Filter effects
     void push_blur(float radius);
@@ -233,6 +264,12 @@ public:
     void set_viewport(int x, int y, int width, int height);
     Point2D get_viewport_size() const;
     
+    // Draw in units of viewport / scale, stretched by scale onto the
+    // framebuffer. Keeps a layout built at the previous content scale at its
+    // on-screen size while caches for the new scale are pre-warmed.
+    void set_presentation_scale(float scale);
+    float get_presentation_scale() const { return presentation_scale_; }
+    
     // Theme
     void set_theme(const CanvasTheme& theme);
     const CanvasTheme& get_theme() const { return theme_; }
@@ -240,6 +277,9 @@ public:
     // Clipping stack
     void push_clip(const Rect2D& rect);
     void pop_clip();
+    // Innermost clip, or the whole viewport, in drawing units; unbounded
+    // under a transform, where the clip no longer maps to drawing units
+    Rect2D get_visible_rect() const;
     void enable_scissor(const Rect2D& rect);
     void disable_scissor();
     
@@ -268,6 +308,10 @@ public:
     // Texture binding and rendering
     void bind_texture(GLuint texture_id, int unit = 0);
     void draw_texture(GLuint texture_id, const Rect2D& rect, const ColorRGBA& tint = ColorRGBA(1, 1, 1, 1));
+    // Draw a sub-rectangle of a texture (normalized uv), e.g. an atlas slot.
+    // distance_field samples it as a glyph-style distance field filled with tint.
+    void draw_texture_region(GLuint texture_id, const Rect2D& rect, const Rect2D& uv,
+                             const ColorRGBA& tint = ColorRGBA(1, 1, 1, 1), bool distance_field = false);
     
     // SDF shader support (used internally by UI shader)
     GLuint get_sdf_shader() const { return sdf_shader_program_; }
@@ -276,8 +320,12 @@ public:
     // Statistics
     int get_draw_calls_this_frame() const { return draw_calls_this_frame_; }
     int get_vertices_this_frame() const { return vertices_this_frame_; }
+    int get_opaque_instances_this_frame() const { return opaque_instances_this_frame_; }
     int get_frame_id() const { return frame_id_; }  // Get current frame ID for duplicate detection
     
+    // Toggle the depth-tested opaque instance pass (for fill-rate comparisons)
+    void set_depth_sorted_instances(bool enabled) { use_depth_sorted_instances_ = enabled; }
+    
     // Dirty rectangle management
     void mark_dirty(const Rect2D& rect) { dirty_tracker_.mark_dirty(rect); }
     void mark_full_redraw() { dirty_tracker_.mark_full_redraw(); }
@@ -294,23 +342,30 @@ public:
         bool force_render = false;         // Always render (debug, etc)
     };
     
-    bool should_cull_widget(const Rect2D& bounds, const OcclusionFlags& flags) {
-        return occlusion_tracker_.should_cull(bounds, flags);
+    bool should_cull_widget(const Rect2D& bounds, const OcclusionFlags& flags,
+                            uint32_t first_order = 0, uint32_t last_order = 0) {
+        return occlusion_tracker_.should_cull(bounds, flags, first_order, last_order);
     }
-    void add_occluder(const Rect2D& bounds, const OcclusionFlags& flags) {
-        occlusion_tracker_.add_occluder(bounds, flags);
+    void add_occluder(const Rect2D& bounds, const OcclusionFlags& flags, uint32_t order = 0) {
+        occlusion_tracker_.add_occluder(bounds, flags, order);
     }
-    void begin_occlusion_frame() { occlusion_tracker_.begin_frame(); }
+    uint32_t next_paint_order() { return occlusion_tracker_.next_paint_order(); }
+    uint32_t get_paint_order() const { return occlusion_tracker_.get_paint_order(); }
+    bool begin_occlusion_scope() { return occlusion_tracker_.begin_scope(); }
+    void end_occlusion_scope() { occlusion_tracker_.end_scope(); }
+    void begin_occlusion_frame() { occlusion_tracker_.begin_frame(viewport_width_, viewport_height_); }
     void end_occlusion_frame() { occlusion_tracker_.end_frame(); }
     void set_occlusion_debug(bool enabled) { occlusion_tracker_.set_debug_mode(enabled); }
     bool is_occlusion_debug() const { return occlusion_tracker_.is_debug_mode(); }
     int get_culled_widget_count() const { return occlusion_tracker_.get_culled_count(); }
     int get_tested_widget_count() const { return occlusion_tracker_.get_tested_count(); }
+    int get_skipped_widget_count() const { return occlusion_tracker_.get_skipped_count(); }
     
     // Matrix access for text rendering
     void get_projection_matrix(float* matrix) const;
     
-    // Window properties access
+    // Window properties access. The content scale is the layout's: the
+    // window's, less any presentation scale stretching it.
     float get_content_scale() const;
     CanvasWindow* get_window() const { return window_; }
     
@@ -328,7 +383,6 @@ private:
     void create_text_shader();
     void create_sdf_shader();
     void create_blur_shader();
-    void create_gradient_shader();
     
     // Batch management
     void sort_batches_by_layer();
@@ -339,6 +393,11 @@ private:
     // Text batching
     void batch_text(const std::string& text, const Point2D& position, 
                     const std::string& font_name, int size, const ColorRGBA& color);
+    // Emit a shaped run's quads for glyphs [glyph_begin, glyph_end); the first
+    // emitted glyph's pen position lands on position.x
+    void batch_text_run(const ShapedRun& run, const Point2D& position, float ascender,
+                        const ColorRGBA& color, size_t glyph_begin = 0,
+                        size_t glyph_end = SIZE_MAX);
     
 private:
     CanvasWindow* window_;
@@ -349,7 +408,7 @@ private:
     std::unique_ptr<ShaderProgram> instance_shader_;  // New instanced rendering shader
     std::unique_ptr<ShaderProgram> text_shader_;
     std::unique_ptr<FontSystem> font_system_;
-    std::unique_ptr<PolylineShader> polyline_shader_;
+    FontFace* default_font_ = nullptr;  // "Inter", resolved once at startup
     
     GLuint ui_vao_ = 0;
     GLuint ui_vbo_ = 0; 
@@ -361,28 +420,48 @@ private:
     GLuint widget_ebo_ = 0;
     
     // Instance rendering system - Single-pass widget rendering
-    struct WidgetInstanceData {
-        float transform[4];      // x, y, width, height
-        float color[4];          // RGBA (background/fill color)
-        float uv_rect[4];        // texture atlas coords (u0, v0, u1, v1)
-        float params[4];         // corner_radius (tl, tr, br, bl)
-        float border[4];         // border_width, border_color RGB
-        float extra[4];          // outline_width, outline_offset, outline_color RG
-        // Note: extra[2] = outline_color B, extra[3] = outline_alpha
-    };
+    // WidgetInstanceData and its packing live in vertex_packing.h
+    
+    enum GradientKind { GRADIENT_LINEAR = 1, GRADIENT_RADIAL = 2, GRADIENT_CONIC = 3 };
     
     GLuint instance_vbo_ = 0;  // Instance data buffer
     std::vector<WidgetInstanceData> instance_data_;
+    std::vector<WidgetInstanceData> sorted_instances_;  // Upload order: opaque front-to-back, then translucent
     size_t max_instances_ = 10000;  // Maximum instances per batch
+    int opaque_instances_this_frame_ = 0;
+    
+    OcclusionFlags classify_instance(const WidgetInstanceData& instance) const;
+    void bind_instance_attributes(size_t first_instance);
     
     // Performance optimization flags (cross-platform)
     bool use_buffer_orphaning_ = true;   // Use buffer orphaning for updates
+    bool use_depth_sorted_instances_ = true;  // Opaque instances front-to-back with depth writes
     bool use_mapped_buffers_ = false;    // Use mapped buffers (requires GL 4.4+)
     
     // Advanced features (only used if available)
     void* instance_buffer_ptr_ = nullptr;  // For persistent mapping (GL 4.4+)
     GLsync fence_sync_ = 0;                // For sync operations (GL 4.4+)
     
+    // Instanced AA line segments - corners generated in the vertex shader
+    struct SegmentInstanceData {
+        float endpoints[4];      // start.xy, end.xy
+        float color[4];          // RGBA
+        float params[4];         // half width, round caps (0/1), joins previous (0/1), unused
+        float previous[2];       // Start of the previous polyline segment
+    };
+    
+    std::unique_ptr<ShaderProgram> segment_shader_;
+    GLuint segment_vao_ = 0;
+    GLuint segment_vbo_ = 0;
+    std::vector<SegmentInstanceData> segment_instances_;
+    size_t max_segment_instances_ = 65536;
+    
+    void create_segment_shader();
+    void add_segment_instance(const Point2D& start, const Point2D& end, const ColorRGBA& color,
+                              float width, bool round_caps, const Point2D* previous = nullptr);
+    void flush_segments();
+    void flush_pending_segments();  // Instances, then segments, if any segments wait
+    
     // SDF shader
     GLuint sdf_shader_program_ = 0;
     GLint sdf_u_projection_ = -1;
@@ -405,8 +484,27 @@ private:
     int backdrop_texture_height_ = 0;
     Rect2D backdrop_region_;
     
-    // Gradient shader
-    std::unique_ptr<ShaderProgram> gradient_shader_;
+    // Gradient stop lookup table - one row per unique stop list, sampled by
+    // gradient instances. When every row is taken the least recently used
+    // one that no queued instance samples is rebaked.
+    struct GradientLutRow {
+        std::vector<std::pair<ColorRGBA, float>> stops;  // Compared on hash hits
+        uint64_t hash = 0;
+        uint64_t last_used = 0;      // gradient_lut_clock_ at the last lookup
+        uint64_t instance_flush = 0; // instance_flush_count_ at the last lookup
+    };
+    GLuint gradient_lut_texture_ = 0;
+    std::vector<GradientLutRow> gradient_lut_rows_;               // By row
+    std::unordered_multimap<uint64_t, int> gradient_lut_index_;   // Stop list hash -> rows
+    uint64_t gradient_lut_clock_ = 0;
+    uint64_t instance_flush_count_ = 0;  // Bumped whenever queued instances are drawn
+    static constexpr int GRADIENT_LUT_WIDTH = 256;
+    static constexpr int GRADIENT_LUT_ROWS = 128;
+    
+    void setup_gradient_lut();
+    int get_gradient_lut_row(const std::vector<std::pair<ColorRGBA, float>>& stops);
+    int allocate_gradient_lut_row();
+    void add_gradient_instance(const Rect2D& rect, GradientKind kind, const float geometry[4], int lut_row);
     
     // Textures
     GLuint white_texture_ = 0;
@@ -421,6 +519,8 @@ private:
     int viewport_y_ = 0;
     int viewport_width_ = 0;
     int viewport_height_ = 0;
+    float presentation_scale_ = 1.0f;
+    Point2D get_projection_extent() const;  // Viewport in drawing units
     
     // Scissor testing
     bool scissor_enabled_ = false;
@@ -514,13 +614,13 @@ private:
     std::vector<float> opacity_stack_;
     
     // Path rendering state
-    struct PathPoint {
-        float x, y;
-        enum Type { MoveTo, LineTo, CurveTo } type;
-        float cp1x, cp1y, cp2x, cp2y;  // Control points for curves
-    };
-    std::vector<PathPoint> current_path_;
+    std::vector<PathCommand> current_path_;
     bool path_started_ = false;
+    PathTessellationCache path_cache_;
+    float get_transform_scale() const;
+    void batch_path_mesh(const PathMesh& mesh, const ColorRGBA& color);
+    void draw_image_fitted(GLuint texture_id, int tex_width, int tex_height, const Rect2D& bounds,
+                           ObjectFit fit, const ColorRGBA& tint);
     
     // Filter effect stack
     struct FilterState {
@@ -560,18 +660,25 @@ private:
             
             auto it = cache_.find(key);
             if (it != cache_.end()) {
+                TextureResidency::get_instance().touch(it->second.texture_id);
                 return &it->second;
             }
             
-            // Create new shadow texture
+            // Create new shadow texture; over the texture budget an unused
+            // one is dropped and rebuilt when next drawn
             NinePatchTexture& texture = cache_[key];
             create_shadow_texture(texture, blur_radius, spread, color);
+            TextureResidency::get_instance().track(
+                texture.texture_id,
+                TextureResidency::get_texture_bytes(texture.texture_width, texture.texture_height),
+                TextureOwner::ShadowCache, [this, key]() { evict(key); });
             return &texture;
         }
         
         void clear() {
             for (auto& [key, texture] : cache_) {
                 if (texture.texture_id) {
+                    TextureResidency::get_instance().release(texture.texture_id);
                     glDeleteTextures(1, &texture.texture_id);
                 }
             }
@@ -589,6 +696,7 @@ private:
         }
         
         void create_shadow_texture(NinePatchTexture& texture, float blur_radius, float spread, const ColorRGBA& color);
+        void evict(const ShadowKey& key);
     };
     ShadowCache shadow_cache_;
     
@@ -676,63 +784,36 @@ private:
     DirtyRectTracker dirty_tracker_;
     
     // Occlusion culling system for reducing overdraw
+    // Occluders are kept exactly (never merged) and indexed by a uniform grid
+    // over the viewport. Each cell records the latest paint order of any
+    // occluder covering it completely, plus the occluders that only touch it,
+    // so a query visits the cells under the tested rect rather than every occluder.
     class OcclusionTracker {
     public:
         using OcclusionFlags = CanvasRenderer::OcclusionFlags;
         
-        void begin_frame() {
-            occluded_regions_.clear();
-            culled_count_ = 0;
-            tested_count_ = 0;
-            debug_mode_ = false;
-        }
+        void begin_frame(int viewport_width, int viewport_height);
         
         void end_frame() {
             // Stats available for debugging
         }
         
-        // Test if a widget should be culled
-        bool should_cull(const Rect2D& bounds, const OcclusionFlags& flags) {
-            tested_count_++;
-            
-            // Never cull if not allowed or has special requirements
-            if (!flags.allows_occlusion || flags.force_render || 
-                flags.is_3d_element || flags.has_transparency || flags.has_shadow) {
-                return false;
-            }
-            
-            // Check if completely covered by opaque regions
-            for (const auto& occluder : occluded_regions_) {
-                if (is_completely_covered(bounds, occluder)) {
-                    culled_count_++;
-                    return true;
-                }
-            }
-            
-            return false;
-        }
+        // Test if a widget (or a whole subtree) should be culled. Only occluders
+        // painted after last_order can hide it; the defaults test against all.
+        // first_order..last_order is the subtree's paint order range, for stats.
+        bool should_cull(const Rect2D& bounds, const OcclusionFlags& flags,
+                         uint32_t first_order = 0, uint32_t last_order = 0);
         
-        // Mark region as occluding (for opaque widgets)
-        void add_occluder(const Rect2D& bounds, const OcclusionFlags& flags) {
-            // Only add if widget is opaque and can occlude others
-            if (!flags.is_opaque || flags.has_transparency) {
-                return;
-            }
-            
-            // Try to merge with existing occluders
-            bool merged = false;
-            for (auto& existing : occluded_regions_) {
-                if (should_merge_occluders(existing, bounds)) {
-                    existing = merge_rects(existing, bounds);
-                    merged = true;
-                    break;
-                }
-            }
-            
-            if (!merged) {
-                occluded_regions_.push_back(bounds);
-            }
-        }
+        // Mark region as occluding (for opaque widgets). Order 0 takes the next paint order.
+        void add_occluder(const Rect2D& bounds, const OcclusionFlags& flags, uint32_t order = 0);
+        
+        // Paint order is assigned by a pre-pass before the widgets render
+        uint32_t next_paint_order() { return ++paint_order_; }
+        uint32_t get_paint_order() const { return paint_order_; }
+        
+        // Outermost render call of a widget tree; nested calls return false
+        bool begin_scope() { return scope_depth_++ == 0; }
+        void end_scope() { if (scope_depth_ > 0) scope_depth_--; }
         
         // Debug visualization
         void set_debug_mode(bool enabled) { debug_mode_ = enabled; }
@@ -744,33 +825,37 @@ private:
         
         int get_culled_count() const { return culled_count_; }
         int get_tested_count() const { return tested_count_; }
+        int get_skipped_count() const { return skipped_count_; }  // Widgets inside culled subtrees
         
     private:
+        struct Cell {
+            uint32_t full_cover_order = 0;     // Latest occluder covering the whole cell
+            std::vector<uint32_t> partial;     // Indices of occluders overlapping part of it
+        };
+        
+        bool is_region_covered(const Rect2D& rect, uint32_t after_order);
+        
         std::vector<Rect2D> occluded_regions_;
+        std::vector<uint32_t> occluder_orders_;
+        std::vector<Cell> cells_;
+        int columns_ = 0;
+        int rows_ = 0;
+        float grid_width_ = 0;
+        float grid_height_ = 0;
+        
+        // Scratch space for coverage queries
+        std::vector<uint32_t> candidates_;
+        std::vector<float> slab_edges_;
+        std::vector<std::pair<float, float>> spans_;
+        
+        uint32_t paint_order_ = 0;
+        int scope_depth_ = 0;
         int culled_count_ = 0;
         int tested_count_ = 0;
+        int skipped_count_ = 0;
         bool debug_mode_ = false;
         
-        bool is_completely_covered(const Rect2D& rect, const Rect2D& occluder) const {
-            return rect.x >= occluder.x && 
-                   rect.y >= occluder.y &&
-                   rect.x + rect.width <= occluder.x + occluder.width &&
-                   rect.y + rect.height <= occluder.y + occluder.height;
-        }
-        
-        bool should_merge_occluders(const Rect2D& a, const Rect2D& b) const {
-            // Merge if overlapping or adjacent
-            return !(a.x > b.x + b.width || b.x > a.x + a.width ||
-                    a.y > b.y + b.height || b.y > a.y + a.height);
-        }
-        
-        Rect2D merge_rects(const Rect2D& a, const Rect2D& b) const {
-            float min_x = std::min(a.x, b.x);
-            float min_y = std::min(a.y, b.y);
-            float max_x = std::max(a.x + a.width, b.x + b.width);
-            float max_y = std::max(a.y + a.height, b.y + b.height);
-            return Rect2D(min_x, min_y, max_x - min_x, max_y - min_y);
-        }
+        static constexpr float CELL_SIZE = 64.0f;
     };
     OcclusionTracker occlusion_tracker_;
     
@@ -818,12 +903,14 @@ public:
     ShaderProgram();
     ~ShaderProgram();
     
-    bool load_from_strings(const std::string& vertex_source, const std::string& fragment_source);
+    // Programs are built through ShaderCache; deferred programs finish linking on first use
+    bool load_from_strings(const std::string& vertex_source, const std::string& fragment_source,
+                           const std::string& cache_name = "program", bool deferred = false);
     void use() const;
     void unuse() const;
     
-    bool is_valid() const { return program_id_ != 0; }
-    GLuint get_id() const { return program_id_; }
+    bool is_valid() const;
+    GLuint get_id() const { ensure_linked(); return program_id_; }
     
     void set_uniform(const std::string& name, float value);
     void set_uniform(const std::string& name, int value);
@@ -832,13 +919,11 @@ public:
     void set_uniform(const std::string& name, const float* matrix, int count = 1);
     
 private:
-    GLuint compile_shader(const std::string& source, GLenum type);
-    bool link_program();
+    void ensure_linked() const;
     GLint get_uniform_location(const std::string& name) const;
     
-    GLuint program_id_ = 0;
-    GLuint vertex_shader_ = 0;
-    GLuint fragment_shader_ = 0;
+    mutable GLuint program_id_ = 0;
+    mutable bool pending_ = false;
     mutable std::unordered_map<std::string, GLint> uniform_cache_;
 };
 
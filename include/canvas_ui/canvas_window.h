@@ -97,6 +97,7 @@ public:
     void on_mouse_move(double x, double y);
     void on_mouse_scroll(double x_offset, double y_offset);
     void on_key_event(int key, int scancode, int action, int mods);
+    void on_char_event(unsigned int codepoint);
     
 private:
     void setup_opengl_context();
@@ -130,7 +131,7 @@ private:
     std::unique_ptr<WorkspaceManager> workspace_manager_;
     
     // Input state
-    Point2D last_mouse_pos_;
+    Point2D last_cursor_pos_;  // Window coordinates, as GLFW reports them
     bool mouse_buttons_[3] = {false, false, false}; // left, right, middle
     uint32_t keyboard_modifiers_ = 0;
     bool natural_scroll_direction_ = false; // Smart mouse/trackpad scroll direction
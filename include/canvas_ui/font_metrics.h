@@ -7,6 +7,7 @@
 #pragma once
 
 #include "canvas_core.h"
+#include <array>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -92,9 +93,16 @@ public:
     float get_cap_height(float font_size_px) const;
     float get_x_height(float font_size_px) const;
     
-    // Shape text (handles ligatures, kerning, etc.)
+    // Shape UTF-8 text (handles ligatures, kerning, etc.)
     std::vector<ShapedGlyph> shape_text(const std::string& text, float font_size_px) const;
     
+    // Shape decoded codepoints, appending to out; kerning applies within the span
+    void shape_codepoints(const uint32_t* codepoints, size_t count, float font_size_px,
+                          std::vector<ShapedGlyph>& out) const;
+    
+    // Whether the font maps the codepoint to a real glyph (not .notdef)
+    bool has_glyph(uint32_t codepoint) const { return codepoint_to_glyph(codepoint) != 0; }
+    
     // Get metrics data
     const FontMetricsData& get_metrics() const { return metrics_; }
     
@@ -102,8 +110,18 @@ private:
     FT_Face face_ = nullptr;
     FontMetricsData metrics_;
     
-    // Glyph advance widths (in font units)
-    std::unordered_map<uint32_t, float> glyph_advances_;
+    // Glyph ids and advance widths (font units) for codepoints 0-255 by direct
+    // index; a negative advance means the font has no glyph
+    static constexpr uint32_t LATIN_CODEPOINTS = 256;
+    std::array<uint32_t, LATIN_CODEPOINTS> latin_glyph_ids_{};
+    std::array<float, LATIN_CODEPOINTS> latin_advances_{};
+    
+    // Glyph advance widths beyond Latin-1 (in font units), loaded on first
+    // use; negative when the font has no glyph
+    mutable std::unordered_map<uint32_t, float> glyph_advances_;
+    
+    // Advance in font units; false when unknown
+    bool find_advance(uint32_t codepoint, float& advance) const;
     
     // Kerning table (key is (left << 32) | right)
     std::unordered_map<uint64_t, float> kerning_table_;
@@ -121,48 +139,4 @@ private:
     void load_glyph_metrics();
 };
 
-/**
- * Text measurement cache for performance
- */
-class TextMeasurementCache {
-public:
-    struct CacheKey {
-        std::string text;
-        std::string font_name;
-        float font_size;
-        
-        bool operator==(const CacheKey& other) const {
-            return text == other.text && 
-                   font_name == other.font_name && 
-                   font_size == other.font_size;
-        }
-    };
-    
-    struct CacheKeyHash {
-        size_t operator()(const CacheKey& key) const {
-            size_t h1 = std::hash<std::string>{}(key.text);
-            size_t h2 = std::hash<std::string>{}(key.font_name);
-            size_t h3 = std::hash<float>{}(key.font_size);
-            return h1 ^ (h2 << 1) ^ (h3 << 2);
-        }
-    };
-    
-    // Get or compute measurement
-    TextMeasurement measure(const CacheKey& key, 
-                           const std::function<TextMeasurement()>& compute);
-    
-    // Clear cache
-    void clear();
-    
-    // Set max cache size
-    void set_max_size(size_t max_size) { max_cache_size_ = max_size; }
-    
-private:
-    std::unordered_map<CacheKey, TextMeasurement, CacheKeyHash> cache_;
-    size_t max_cache_size_ = 1000;
-    
-    // LRU eviction
-    void evict_oldest();
-};
-
 } // namespace voxel_canvas
\ No newline at end of file
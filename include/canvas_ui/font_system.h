@@ -11,12 +11,21 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
 #include <vector>
 #include "canvas_ui/canvas_core.h"
 #include "canvas_ui/font_metrics.h"
+#include "canvas_ui/glyph_rasterizer.h"
+#include "canvas_ui/interned_id.h"
+#include "canvas_ui/paged_atlas.h"
 
 // Forward declarations
 typedef struct FT_LibraryRec_* FT_Library;
@@ -26,33 +35,61 @@ namespace voxel_canvas {
 
 // Forward declarations
 class CanvasRenderer;
+class MappedFile;
 
-// Glyph metrics and rendering data
+// Glyph metrics and rendering data. Glyphs are multi-channel distance fields
+// generated once at FontFace::REFERENCE_SIZE; metrics are in reference pixels
+// and scale linearly to any size via FontFace::get_glyph_scale().
 struct GlyphInfo {
-    unsigned int texture_id = 0;  // OpenGL texture ID for this glyph
-    Point2D size;                  // Size of glyph in pixels
-    Point2D bearing;               // Offset from baseline to left/top of glyph
-    float advance;                 // Horizontal advance to next glyph
-    Rect2D uv_rect;               // UV coordinates in atlas (if using atlas)
-    bool in_atlas = false;        // Whether this glyph is in the texture atlas
+    unsigned int texture_id = 0;  // Atlas page texture holding the field (RGB distance field)
+    Point2D size;                  // Size of the field quad in reference pixels
+    Point2D bearing;               // Offset from baseline to left/top of the quad
+    float advance = 0.0f;          // Unhinted horizontal advance to next glyph
+    Rect2D uv_rect;               // UV coordinates in the atlas page
+    bool in_atlas = false;        // Whether the field is resident in the atlas
+    int atlas_page = -1;          // Atlas page index, for LRU tracking
+    bool pending = false;         // Being rasterized on a worker; drawn as a placeholder
 };
 
-// Font face with multiple sizes
+// Font face; one glyph cache serves every size. Faces of the same file share
+// one memory mapping, and a weight selects a variable-font instance.
 class FontFace {
 public:
-    FontFace(const std::string& path, int size = 14);
+    // Pixel size distance-field glyphs are generated at
+    static constexpr int REFERENCE_SIZE = 32;
+    // Distance in reference pixels spanned by the field's 0..1 value range
+    static constexpr float DISTANCE_RANGE = 4.0f;
+    
+    // weight is the variable font's wght axis value; 0 keeps the font default
+    FontFace(const std::string& path, int size = 14, float weight = 0.0f);
     ~FontFace();
     
     bool load();
     void unload();
     
-    // Get or create glyph for character
-    GlyphInfo* get_glyph(unsigned int codepoint, int size);
+    // Get or create glyph for character (reference-size metrics). Codepoints
+    // below LATIN_GLYPHS are an array index once loaded.
+    GlyphInfo* get_glyph(unsigned int codepoint) {
+        if (codepoint < LATIN_GLYPHS && latin_loaded_[codepoint]) {
+            return &latin_glyphs_[codepoint];
+        }
+        return get_glyph_slow(codepoint);
+    }
+    
+    // Loaded or pending glyph without requesting one
+    GlyphInfo* find_glyph(unsigned int codepoint);
+    
+    // The atlas repacked the glyph's page; the next lookup regenerates it
+    void evict_glyph(unsigned int codepoint);
+    
+    // Factor from reference-size glyph metrics to a pixel size
+    static float get_glyph_scale(float size) { return size / static_cast<float>(REFERENCE_SIZE); }
     
-    // Font metrics
-    float get_line_height(int size) const;
-    float get_ascender(int size) const;
-    float get_descender(int size) const;
+    // Font metrics: one multiply by per-pixel factors taken from the design
+    // units at load, so no size state is touched
+    float get_line_height(int size) const { return static_cast<float>(size) * line_height_per_px_; }
+    float get_ascender(int size) const { return static_cast<float>(size) * ascender_per_px_; }
+    float get_descender(int size) const { return static_cast<float>(size) * descender_per_px_; }
     
     // Accurate text measurement with kerning
     TextMeasurement measure_text(const std::string& text, float font_size_px) const;
@@ -60,9 +97,18 @@ public:
     // Get font metrics object
     const FontMetrics* get_metrics() const { return metrics_.get(); }
     
+    // Whether the face has a real glyph for the codepoint (not .notdef)
+    bool has_glyph(uint32_t codepoint) const { return metrics_ && metrics_->has_glyph(codepoint); }
+    
     // Font properties
     const std::string& get_path() const { return font_path_; }
     const std::string& get_name() const { return font_name_; }
+    float get_weight() const { return weight_; }
+    const std::shared_ptr<MappedFile>& get_file() const { return file_; }
+    
+    // Face over a mapped font file at the reference size and the given weight
+    // (0 keeps the default); glyph workers open their own faces this way
+    static FT_Face create_face(FT_Library library, const MappedFile& file, float weight);
     bool is_loaded() const { return face_ != nullptr; }
     
 private:
@@ -70,22 +116,132 @@ private:
     std::string font_name_;
     FT_Face face_ = nullptr;
     int default_size_;
+    float weight_;
+    
+    // Font file bytes; FreeType reads tables straight from the mapping
+    std::shared_ptr<MappedFile> file_;
+    
+    // Select the weight instance of a variable font
+    static void apply_weight(FT_Library library, FT_Face face, float weight, const std::string& path);
     
     // Font metrics for accurate measurement
     std::unique_ptr<FontMetrics> metrics_;
     
-    // Cache of loaded glyphs per size
-    struct SizeCache {
-        int pixel_size;
-        std::unordered_map<unsigned int, GlyphInfo> glyphs;
-        float line_height;
-        float ascender;
-        float descender;
+    // Distance-field glyphs, independent of the sizes in use: Latin-1 in a
+    // flat array, everything else hashed
+    static constexpr unsigned int LATIN_GLYPHS = 256;
+    std::array<GlyphInfo, LATIN_GLYPHS> latin_glyphs_;
+    std::array<bool, LATIN_GLYPHS> latin_loaded_{};
+    std::unordered_map<unsigned int, GlyphInfo> glyphs_;
+    
+    // Metrics per pixel of font size (fallbacks until a face is loaded)
+    float ascender_per_px_ = 0.8f;
+    float descender_per_px_ = 0.2f;
+    float line_height_per_px_ = 1.2f;
+    
+    GlyphInfo* get_glyph_slow(unsigned int codepoint);
+    
+    // Generate the distance field for a glyph at the reference size
+    bool load_glyph(unsigned int codepoint, GlyphInfo& glyph);
+    void release_glyph(GlyphInfo& glyph);
+    void reset_metrics();
+};
+
+// Drawable glyph of a shaped run, relative to the pen origin on the baseline
+struct GlyphQuad {
+    float x0 = 0, y0 = 0, x1 = 0, y1 = 0;  // Pixels; y grows downward
+    Rect2D uv_rect;
+    unsigned int texture_id = 0;
+    uint32_t glyph_index = 0;              // Index into the run's prefix table
+};
+
+// Text shaped at one font and size: measurement, caret stops and glyph quads
+struct ShapedRun {
+    TextMeasurement measurement;
+    
+    // Pen x before each glyph; the last entry is the run width (glyphs + 1 entries)
+    std::vector<float> prefix_advances;
+    // Source byte offset of each prefix entry, i.e. the caret stops
+    std::vector<uint32_t> byte_offsets;
+    // Face each glyph resolved to through the fallback chain; empty when
+    // every glyph comes from the run's own font
+    std::vector<FontFace*> glyph_fonts;
+    
+    std::vector<GlyphQuad> quads;
+    bool has_quads = false;  // Built on first draw, so measuring alone generates no glyphs
+    bool has_placeholders = false;  // Some glyphs were still rasterizing
+    uint64_t quads_generation = 0;  // FontSystem glyph generation the quads were built at
+    uint32_t atlas_pages = 0;       // Bit per glyph atlas page the quads sample
+    
+    size_t glyph_count() const { return prefix_advances.empty() ? 0 : prefix_advances.size() - 1; }
+    
+    // Binary searches over prefix_advances
+    size_t fit_glyphs(float max_width) const;   // Leading glyphs that fit in max_width
+    size_t hit_test(float x) const;              // Caret stop nearest to x
+    float caret_x(size_t byte_offset) const;     // Pen x at the stop for a byte offset
+};
+
+/**
+ * LRU cache of shaped runs keyed by (text, font, size). A lookup hashes the
+ * key once and probes once; hits move to the front in O(1) and the least
+ * recently used run is evicted when full. Returned references stay valid
+ * until that run is evicted.
+ */
+class ShapedRunCache {
+public:
+    static uint64_t hash_key(const FontFace* font, std::string_view text, float size);
+    
+    // Cached run (now most recently used), or nullptr
+    ShapedRun* find(uint64_t hash, const FontFace* font, std::string_view text, float size);
+    
+    // Empty run for a key that find() missed, evicting the oldest if full
+    ShapedRun& insert(uint64_t hash, const FontFace* font, std::string_view text, float size);
+    
+    void clear();
+    void set_max_size(size_t max_size);
+    size_t get_max_size() const { return max_size_; }
+    size_t size() const { return entries_.size(); }
+    
+    // Visit every cached key, most recently used first:
+    // visit(font, text, size, has_quads)
+    template <typename Visitor>
+    void for_each_key(Visitor&& visit) const {
+        for (const Entry& entry : entries_) {
+            visit(entry.font, std::string_view(entry.text), entry.size, entry.run.has_quads);
+        }
+    }
+    
+private:
+    struct Entry {
+        std::string text;
+        const FontFace* font = nullptr;
+        float size = 0.0f;
+        uint64_t hash = 0;
+        ShapedRun run;
+    };
+    
+    // Index key; text views the string owned by the list node
+    struct KeyView {
+        uint64_t hash;
+        const FontFace* font;
+        float size;
+        std::string_view text;
+        
+        bool operator==(const KeyView& other) const {
+            return hash == other.hash && font == other.font &&
+                   size == other.size && text == other.text;
+        }
+    };
+    
+    struct KeyViewHash {
+        size_t operator()(const KeyView& key) const { return static_cast<size_t>(key.hash); }
     };
-    std::unordered_map<int, SizeCache> size_caches_;
     
-    // Load glyph for specific size
-    GlyphInfo* load_glyph(unsigned int codepoint, int size);
+    void evict_oldest();
+    
+    std::list<Entry> entries_;  // Most recently used first
+    std::unordered_map<KeyView, std::list<Entry>::iterator, KeyViewHash> index_;
+    size_t max_size_ = 1000;
 };
 
 // Main font system manager
@@ -99,14 +255,40 @@ public:
     void shutdown();
     
     // Font management
-    bool load_font(const std::string& name, const std::string& path, int default_size = 14);
+    bool load_font(const std::string& name, const std::string& path, int default_size = 14,
+                   float weight = 0.0f);
     FontFace* get_font(const std::string& name);
     
+    // Face for an interned name ("default" included): an array lookup once
+    // the name has been resolved, for draw and layout paths
+    FontFace* get_font(FontId id);
+    
     // Text rendering
     Point2D measure_text(const std::string& text, const std::string& font_name, int size);
     
-    // Accurate text measurement with kerning
-    TextMeasurement measure_text_accurate(const std::string& text, const std::string& font_name, float font_size_px);
+    // Accurate text measurement with kerning; cached, valid until the run is evicted
+    const TextMeasurement& measure_text_accurate(const std::string& text, const std::string& font_name, float font_size_px);
+    const TextMeasurement& measure_text_accurate(const std::string& text, FontId font, float font_size_px);
+    
+    // Shaped run for a font handle: one hash probe when cached. with_quads
+    // builds the drawable glyph quads on first use.
+    const ShapedRun& get_shaped_run(FontFace* font, std::string_view text, float font_size_px,
+                                    bool with_quads = false);
+    
+    // Runs the caller owns (TextLayout paragraphs) skip the shared cache, so
+    // bulk text cannot evict the UI's runs. prepare_run_quads() builds or
+    // refreshes the quads of any run before it is drawn.
+    void shape_owned_run(FontFace* font, std::string_view text, float font_size_px, ShapedRun& run);
+    void prepare_run_quads(FontFace* font, float font_size_px, ShapedRun& run);
+    
+    // Content scale change: queue every cached run again at the size it has
+    // at to_scale, for prewarm_runs() to shape a slice per frame. The cache
+    // holds twice as many runs until end_scale_retention(), so the runs at
+    // the old scale survive a move back.
+    void begin_scale_prewarm(float from_scale, float to_scale);
+    bool prewarm_runs(std::chrono::steady_clock::time_point deadline);  // True once none are queued
+    void cancel_scale_prewarm() { prewarm_queue_.clear(); }
+    void end_scale_retention();
     
     // Viewport immediate mode text rendering - for 3D overlays like navigation widget
     // For UI text, use CanvasRenderer::draw_text() which uses batched rendering
@@ -117,37 +299,98 @@ public:
     // Default fonts
     bool load_default_fonts();
     
+    // Fallback chain: loaded fonts tried in order for codepoints the requested
+    // font has no glyph for (CJK, symbols, ...)
+    bool add_fallback_font(const std::string& name);
+    void clear_fallback_fonts();
+    
+    // Face that draws a codepoint for a requested font; cached per codepoint.
+    // The requested font itself (its .notdef) when no face in the chain has it.
+    FontFace* resolve_font(FontFace* font, uint32_t codepoint);
+    
     // Access to FreeType library (for FontFace)
     FT_Library get_ft_library() const { return ft_library_; }
     
-    // Texture atlas management
-    bool try_add_to_atlas(GlyphInfo& glyph, const unsigned char* bitmap_data, 
-                         int width, int height);
+    // Font file mapping shared by every face loaded from the path
+    std::shared_ptr<MappedFile> map_font_file(const std::string& path);
+    
+    // Glyph atlas: RGB8 distance fields packed into shared pages. Every
+    // glyph lives in a page; repacked pages drop their glyphs for regeneration.
+    static constexpr int GLYPH_ATLAS_PAGE_SIZE = 1024;
+    static constexpr int GLYPH_ATLAS_MAX_PAGES = 8;
+    bool add_to_atlas(FontFace* font, unsigned int codepoint, GlyphInfo& glyph, const MsdfBitmap& field);
+    void release_atlas_glyphs(const FontFace* font);
+    const PagedAtlas& get_glyph_atlas() const { return glyph_atlas_; }
+    
+    // Queue a glyph for the worker pool; false when it isn't running and the
+    // caller should rasterize synchronously
+    bool request_glyph(FontFace* font, unsigned int codepoint);
+    
+    // Once per frame on the render thread: advance the atlas LRU clock, then
+    // pack the glyphs workers finished and upload them in one pixel-buffer
+    // transfer
+    void begin_frame();
     
 private:
     FT_Library ft_library_ = nullptr;
     std::unordered_map<std::string, std::unique_ptr<FontFace>> fonts_;
+    std::vector<FontFace*> fonts_by_id_;  // By FontId index; refilled after fonts load
+    std::unordered_map<std::string, std::weak_ptr<MappedFile>> font_files_;  // Unmapped with their last face
     bool initialized_ = false;
     
-    // Text measurement cache
-    TextMeasurementCache measurement_cache_;
-    
-    // Texture atlas for small glyphs (optional optimization)
-    struct TextureAtlas {
-        unsigned int texture_id = 0;
-        int width = 2048;
-        int height = 2048;
-        int current_x = 0;
-        int current_y = 0;
-        int row_height = 0;
+    // Shaped text runs (measurement and glyph quads)
+    ShapedRunCache run_cache_;
+    
+    // Runs to shape ahead of a content scale change
+    struct PrewarmRun {
+        FontFace* font;
+        std::string text;
+        float size;
+        bool with_quads;  // Drawn at the old scale, not only measured
     };
-    std::unique_ptr<TextureAtlas> atlas_;
+    std::deque<PrewarmRun> prewarm_queue_;
+    size_t retained_run_capacity_ = 0;  // Capacity to restore after a scale change; 0 when none
+    
+    // Fallback faces and the codepoints resolved through them
+    struct FallbackKey {
+        const FontFace* font;
+        uint32_t codepoint;
+        
+        bool operator==(const FallbackKey& other) const {
+            return font == other.font && codepoint == other.codepoint;
+        }
+    };
+    struct FallbackKeyHash {
+        size_t operator()(const FallbackKey& key) const {
+            return std::hash<const void*>()(key.font) ^ (static_cast<size_t>(key.codepoint) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+    std::vector<FontFace*> fallback_fonts_;
+    std::unordered_map<FallbackKey, FontFace*, FallbackKeyHash> fallback_cache_;
+    
+    // Scratch for shaping: decoded codepoints, their byte offsets and faces
+    std::vector<uint32_t> shape_codepoints_;
+    std::vector<uint32_t> shape_offsets_;
+    std::vector<FontFace*> shape_fonts_;
+    
+    // Shared distance-field pages; their size does not depend on the font sizes in use
+    PagedAtlas glyph_atlas_;
+    Rect2D placeholder_uv_;  // Uniform half-coverage texels for glyphs in flight (page 0)
+    uint64_t atlas_evicted_generation_ = 0;  // Quads built before this sample repacked pages
+    
+    // Asynchronous glyph generation
+    GlyphRasterizer glyph_rasterizer_;
+    std::vector<RasterizedGlyph> completed_glyphs_;
+    unsigned int upload_pbo_ = 0;
+    uint64_t glyph_generation_ = 0;  // Bumped whenever pending glyphs land
     
     // Shader for text rendering
     unsigned int text_shader_program_ = 0;
     unsigned int projection_uniform_ = 0;
     unsigned int text_color_uniform_ = 0;
     unsigned int texture_uniform_ = 0;
+    unsigned int distance_range_uniform_ = 0;
+    bool text_shader_ready_ = false;  // Linked and uniforms resolved
     
     // VAO/VBO for batch rendering
     unsigned int text_vao_ = 0;
@@ -164,13 +407,18 @@ private:
     std::vector<GlyphVertex> vertex_batch_;
     static constexpr size_t MAX_BATCH_SIZE = 1000; // Max glyphs per batch
     
+    void shape_run(FontFace* font, std::string_view text, float font_size_px, ShapedRun& run);
+    void build_run_quads(FontFace* font, float font_size_px, ShapedRun& run);
     void create_text_shader();
+    bool ensure_text_shader_ready();
     void setup_render_buffers();
-    void create_texture_atlas();
+    void create_glyph_atlas();
+    void process_glyph_uploads();
+    static void set_atlas_slot(GlyphInfo& glyph, const AtlasSlot& slot);
     void render_glyph(CanvasRenderer* renderer, const GlyphInfo& glyph, 
-                     const Point2D& position, const ColorRGBA& color);
+                     const Point2D& position, float scale, const ColorRGBA& color);
     void flush_batch(CanvasRenderer* renderer, unsigned int texture_id, const ColorRGBA& color);
-    void add_glyph_to_batch(const GlyphInfo& glyph, const Point2D& position);
+    void add_glyph_to_batch(const GlyphInfo& glyph, const Point2D& position, float scale);
 };
 
 // Global font system instance
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Glyph Rasterizer - distance-field glyph generation on worker threads
+ */
+
+#pragma once
+
+#include "canvas_ui/msdf_generator.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace voxel_canvas {
+
+// Forward declarations
+class FontFace;
+class MappedFile;
+
+// Finished glyph, ready to be packed and uploaded on the render thread
+struct RasterizedGlyph {
+    FontFace* font = nullptr;
+    unsigned int codepoint = 0;
+    float advance = 0.0f;    // Reference pixels
+    MsdfBitmap field;        // Empty for glyphs without an outline
+    bool loaded = false;     // False when the font has no such glyph
+};
+
+/**
+ * Worker pool that turns glyph requests into distance fields off the render
+ * thread. Each worker owns an FT_Library and opens its own FT_Face per font
+ * from the font's shared file mapping, so no FreeType object is touched by
+ * two threads. Results are drained once per frame with take_completed().
+ */
+class GlyphRasterizer {
+public:
+    GlyphRasterizer() = default;
+    ~GlyphRasterizer();
+
+    GlyphRasterizer(const GlyphRasterizer&) = delete;
+    GlyphRasterizer& operator=(const GlyphRasterizer&) = delete;
+
+    // 0 picks one worker per spare hardware thread (at most 4)
+    bool start(unsigned int worker_count = 0);
+    void stop();
+    bool is_running() const { return !workers_.empty(); }
+
+    void request(FontFace* font, std::shared_ptr<MappedFile> file, float weight, unsigned int codepoint);
+
+    // Moves finished glyphs into out (appending); never blocks on workers
+    void take_completed(std::vector<RasterizedGlyph>& out);
+
+    size_t get_pending_count() const;
+
+private:
+    struct Job {
+        FontFace* font;
+        std::shared_ptr<MappedFile> file;
+        float weight;
+        unsigned int codepoint;
+    };
+
+    void worker_main();
+
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<Job> jobs_;
+    std::vector<RasterizedGlyph> completed_;
+    size_t in_flight_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace voxel_canvas
@@ -57,8 +57,6 @@ private:
     
     // OpenGL resources
     GLuint shader_program_ = 0;
-    GLuint vertex_shader_ = 0;
-    GLuint fragment_shader_ = 0;
     
     // Separate VAOs for each plane
     GLuint vao_xz_ = 0;  // Horizontal plane VAO
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Icon Pack - prebuilt icon file with pre-rasterized sizes
+ */
+
+#pragma once
+
+#include "canvas_ui/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace voxel_canvas {
+
+/**
+ * On-disk layout written by voxelux_pack_icons at build time. All fields are
+ * little-endian uint32 and offsets are from the start of the file:
+ *
+ *   Header
+ *   IconRecord[icon_count]
+ *   ImageRecord[image_count]    (each icon owns a contiguous run)
+ *   names, SVG sources, RGBA pixels (4-byte aligned)
+ *
+ * Images are square, straight-alpha RGBA with currentColor already white,
+ * exactly what IconAsset would rasterize at that size.
+ */
+namespace icon_pack {
+
+constexpr uint32_t MAGIC = 0x50495856;  // "VXIP"
+constexpr uint32_t VERSION = 1;
+
+// ScaledTheme icon sizes (tiny through xlarge) at 1x, 1.5x and 2x
+constexpr int BASE_SIZES[] = {12, 16, 24, 32, 48};
+constexpr float SCALES[] = {1.0f, 1.5f, 2.0f};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t icon_count;
+    uint32_t image_count;
+};
+
+struct IconRecord {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t svg_offset;
+    uint32_t svg_length;
+    uint32_t first_image;
+    uint32_t image_count;
+};
+
+struct ImageRecord {
+    uint32_t size;          // Width and height in pixels
+    uint32_t pixel_offset;  // size * size * 4 bytes
+};
+
+} // namespace icon_pack
+
+/**
+ * Read-only view of a mapped icon pack. Nothing is copied or decoded when
+ * the pack opens; names, SVG text and pixels are read from the mapping.
+ */
+class IconPack {
+public:
+    bool open(const std::string& path);
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& get_path() const { return file_.get_path(); }
+
+    size_t get_icon_count() const { return header_ ? header_->icon_count : 0; }
+    std::string_view get_name(size_t icon) const;
+    std::string_view get_svg(size_t icon) const;
+
+    // Pre-rasterized pixels of an icon at exactly size, or nullptr
+    const uint8_t* find_image(size_t icon, int size) const;
+
+    // Packed size closest to size (larger on ties), or 0 if there are none
+    int find_nearest_size(size_t icon, int size) const;
+
+private:
+    MappedFile file_;
+    const icon_pack::Header* header_ = nullptr;
+    const icon_pack::IconRecord* icons_ = nullptr;
+    const icon_pack::ImageRecord* images_ = nullptr;
+
+    bool in_bounds(uint64_t offset, uint64_t length) const {
+        return offset <= file_.size() && length <= file_.size() - offset;
+    }
+};
+
+} // namespace voxel_canvas
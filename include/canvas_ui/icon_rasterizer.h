@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Icon Rasterizer - background SVG rasterization for icons
+ */
+
+#pragma once
+
+#include "canvas_ui/interned_id.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Forward declarations for NanoSVG
+struct NSVGimage;
+struct NSVGrasterizer;
+
+namespace voxel_canvas {
+
+// Rasterize a parsed SVG into a size x size straight-alpha RGBA square
+// (the scale fits the larger SVG dimension). Shared by the workers and the
+// synchronous fallback so both produce identical pixels.
+bool rasterize_svg_icon(NSVGrasterizer* rasterizer, NSVGimage* image, int size, std::vector<uint8_t>& pixels);
+
+// Distance-field icons: a monochrome SVG is rasterized once into a signed
+// distance field that draws at any size through the renderer's glyph path
+constexpr int ICON_FIELD_SIZE = 64;        // Field texels per side
+constexpr int ICON_FIELD_SUPERSAMPLE = 8;  // Coverage samples per texel along each axis
+constexpr float ICON_FIELD_RANGE = 4.0f;   // Texels spanned by 0..1, as FontFace::DISTANCE_RANGE
+
+// Whether every visible shape paints the same opaque colour, so a tinted
+// coverage mask reproduces the icon exactly
+bool is_monochrome_svg(const NSVGimage* image);
+
+// Rasterize a parsed SVG into an ICON_FIELD_SIZE square RGBA field: rgb hold
+// 0.5 + distance / ICON_FIELD_RANGE (positive inside), alpha is opaque
+bool rasterize_svg_icon_field(NSVGrasterizer* rasterizer, NSVGimage* image, std::vector<uint8_t>& pixels);
+
+// Finished icon, ready to be placed in the atlas on the render thread
+struct RasterizedIcon {
+    IconId icon;
+    uint64_t serial = 0;          // IconAsset that asked, in case the name was reloaded
+    int size = 0;
+    bool distance_field = false;  // ICON_FIELD_SIZE field rather than a raster of size
+    std::vector<uint8_t> pixels;  // Empty if rasterization failed
+};
+
+/**
+ * Worker pool that rasterizes icon SVGs off the render thread. Parsed
+ * images are shared read-only with the workers; each worker owns its
+ * NSVGrasterizer. Results are drained once per frame with take_completed().
+ */
+class IconRasterizer {
+public:
+    IconRasterizer() = default;
+    ~IconRasterizer();
+
+    IconRasterizer(const IconRasterizer&) = delete;
+    IconRasterizer& operator=(const IconRasterizer&) = delete;
+
+    // 0 picks one worker per spare hardware thread (at most 2)
+    bool start(unsigned int worker_count = 0);
+    void stop();
+    bool is_running() const { return !workers_.empty(); }
+
+    void request(IconId icon, uint64_t serial, std::shared_ptr<NSVGimage> image, int size);
+    void request_field(IconId icon, uint64_t serial, std::shared_ptr<NSVGimage> image);
+
+    // Moves finished icons into out (appending) until at least max_bytes of
+    // pixels were taken; the rest wait for the next call. Returns the bytes
+    // taken and never blocks on workers.
+    size_t take_completed(std::vector<RasterizedIcon>& out, size_t max_bytes);
+
+    // Queued, rasterizing, or finished but not taken yet
+    size_t get_pending_count() const;
+
+private:
+    struct Job {
+        IconId icon;
+        uint64_t serial;
+        std::shared_ptr<NSVGimage> image;
+        int size;
+        bool distance_field;
+    };
+
+    void worker_main();
+
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<Job> jobs_;
+    std::deque<RasterizedIcon> completed_;
+    size_t in_flight_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace voxel_canvas
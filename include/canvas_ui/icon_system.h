@@ -8,29 +8,108 @@
 #pragma once
 
 #include "canvas_core.h"
+#include "icon_rasterizer.h"
+#include "paged_atlas.h"
+#include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
-#include <chrono>
-
-// Forward declarations for NanoSVG
-struct NSVGimage;
-struct NSVGrasterizer;
-
-// OpenGL types
-typedef unsigned int GLuint;
 
 namespace voxel_canvas {
 
 // Forward declarations
 class CanvasRenderer;
+class IconPack;
 
 // Icon sizes are now handled by ScaledTheme
 // Use theme.icon_size_small(), theme.icon_size_medium(), etc.
 
 /**
- * Represents a single icon asset that can be rendered at different sizes
+ * Texture atlas for efficient icon rendering. Icons are packed into RGBA
+ * pages of a PagedAtlas, so every icon on a page draws in the same batch;
+ * when the pages are full the least recently drawn page is repacked and
+ * only the icons on it are dropped.
+ */
+class IconAtlas {
+public:
+    struct AtlasEntry {
+        Rect2D texture_coords;      // UV coordinates in the page
+        float width;                // Width in pixels
+        float height;               // Height in pixels
+        unsigned int texture_id;    // Page texture
+        int page;
+        uint32_t id;                // Allocation id within the pages
+    };
+    
+    // Entries are keyed by icon and variant (raster size, 0 for a bitmap's
+    // native size, or FIELD_VARIANT), so lookups never build strings
+    using Key = uint64_t;
+    static constexpr uint32_t FIELD_VARIANT = UINT32_MAX;
+    static Key make_key(IconId icon, uint32_t variant) {
+        return (Key{icon.get_index()} << 32) | variant;
+    }
+    
+    struct IconUpload {
+        Key key;
+        const uint8_t* pixels;      // width * height RGBA
+        int width;
+        int height;
+    };
+    
+    static constexpr int PAGE_SIZE = 1024;
+    static constexpr int MAX_PAGES = 4;
+    
+    IconAtlas(int page_size = PAGE_SIZE, int max_pages = MAX_PAGES);
+    ~IconAtlas();
+    
+    // Add icon to atlas (pages are created on first use)
+    bool add_icon(Key key, const uint8_t* pixels, int width, int height);
+    
+    // Add several icons, copying their texels through one staging buffer
+    void add_icons(const std::vector<IconUpload>& uploads);
+    
+    // Get UV coordinates for icon
+    const AtlasEntry* get_entry(Key key) const;
+    
+    // Get entry and mark its page as drawn this frame
+    const AtlasEntry* use_entry(Key key);
+    
+    // Forget every entry of an icon; the texels are reclaimed when their
+    // page is repacked
+    void remove_icon(IconId icon);
+    
+    // Advance the page LRU clock, once per frame
+    void begin_frame();
+    
+    // Clear atlas
+    void clear();
+    
+    int get_page_count() const { return pages_.get_page_count(); }
+    uint64_t get_eviction_count() const { return pages_.get_eviction_count(); }
+    
+private:
+    int page_size_;
+    int max_pages_;
+    PagedAtlas pages_;
+    std::unordered_map<Key, AtlasEntry> entries_;
+    std::unordered_map<uint32_t, Key> keys_;  // For eviction callbacks
+    uint32_t next_id_ = 1;
+    unsigned int upload_pbo_ = 0;
+    
+    bool ensure_pages();
+    bool place_icon(Key key, int width, int height, AtlasSlot& slot);
+    void evict(uint32_t id);
+};
+
+/**
+ * Represents a single icon asset that can be rendered at different sizes.
+ * Pixels live in the shared IconAtlas; SVGs get one entry per raster size.
+ * A size that is not in the atlas is rasterized on the IconSystem workers
+ * and, until it lands, the nearest size that is draws scaled in its place.
+ * With distance-field icons on, a monochrome SVG instead has a single
+ * field entry that every size draws from.
  */
 class IconAsset {
 public:
@@ -45,111 +124,94 @@ public:
     // Load icon from memory
     bool load_from_memory(const uint8_t* data, size_t size, bool is_svg = false);
     
+    // Reference an icon of a mapped pack; its SVG is only parsed for sizes
+    // the pack does not carry
+    bool load_from_pack(std::shared_ptr<const IconPack> pack, size_t index);
+    
     // Render the icon - size must be pre-scaled from ScaledTheme
     void render(CanvasRenderer* renderer, const Point2D& position, float scaled_size, const ColorRGBA& tint = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
     
     // Pre-render at specific size for faster display
     void prerender_at_size(CanvasRenderer* renderer, float size);
     
-    // Clear all cached sizes (useful when DPI changes)
-    void clear_cache();
+    // Atlas key of this icon at a raster size
+    IconAtlas::Key get_atlas_key(int size) const;
+    
+    // Atlas key of this icon's distance field, shared by every size
+    IconAtlas::Key get_field_key() const { return IconAtlas::make_key(id_, IconAtlas::FIELD_VARIANT); }
+    
+    // Whether this icon draws from one distance field (the system option is
+    // on and the SVG is monochrome); parses a packed SVG on first call
+    bool uses_distance_field();
+    
+    // A background rasterization finished (placed in the atlas or not)
+    void finish_rasterization(const RasterizedIcon& result, bool placed);
+    
+    // Raster sizes currently in the atlas
+    const std::vector<int>& get_atlas_sizes() const { return atlas_sizes_; }
+    
+    // Put a raster size in the atlas ahead of its first draw: uploaded from
+    // the pack or queued for the workers, alongside any pending size. False
+    // when this frame's budget is spent and the caller should retry.
+    bool prewarm_size(int size);
     
     // Get icon properties
     const std::string& get_name() const { return name_; }
-    bool is_loaded() const { return texture_id_ != 0; }
+    IconId get_id() const { return id_; }
+    uint64_t get_serial() const { return serial_; }
+    bool is_loaded() const { return is_svg_ ? (svg_image_ != nullptr || pack_) : !pixels_.empty(); }
     Point2D get_size() const { return Point2D(width_, height_); }
     
 private:
     std::string name_;
-    unsigned int texture_id_ = 0;  // Current active texture
+    IconId id_;        // name_ interned; shared by reloads of the same name
+    uint64_t serial_;  // Distinguishes reloads of the same name
     float width_ = 0;
     float height_ = 0;
     bool is_svg_ = false;
     
-    // Multi-size texture cache for optimal rendering
-    struct SizeCache {
-        GLuint texture_id = 0;
-        int size = 0;
-        std::chrono::steady_clock::time_point last_used;
-    };
-    std::unordered_map<int, SizeCache> size_cache_;  // Key: pixel size
-    static constexpr size_t MAX_CACHED_SIZES = 8;  // Limit cache size
+    // Decoded RGBA of bitmap icons, kept to refill the atlas after eviction
+    std::vector<uint8_t> pixels_;
     
     // SVG data for re-rasterization at different sizes
     std::vector<uint8_t> svg_data_;
-    NSVGimage* svg_image_ = nullptr;
-    NSVGrasterizer* svg_rasterizer_ = nullptr;
+    std::shared_ptr<NSVGimage> svg_image_;   // Shared read-only with the workers
+    NSVGrasterizer* svg_rasterizer_ = nullptr;  // Only without workers
     
     // Original SVG dimensions
     float original_width_ = 0;
     float original_height_ = 0;
     
-    // Last rendered size for cache invalidation
-    int last_rendered_size_ = 0;
-    
-    // Rasterize SVG at specific size
-    bool rasterize_svg(int target_size);
-    
-    // Create OpenGL texture from pixel data
-    bool create_texture(const uint8_t* pixels, int width, int height, int channels);
-    
-    // Get or create texture for specific size
-    GLuint get_texture_for_size(int size);
-    
-    // Clean up old cached sizes
-    void cleanup_old_caches();
-};
-
-/**
- * Texture atlas for efficient icon rendering
- */
-class IconAtlas {
-public:
-    struct AtlasEntry {
-        Rect2D texture_coords;  // UV coordinates in atlas
-        float width;            // Width in pixels
-        float height;           // Height in pixels
-        uint32_t last_used;     // Frame number for LRU
-    };
-    
-    IconAtlas(int width = 2048, int height = 2048);
-    ~IconAtlas();
-    
-    // Add icon to atlas, returns UV coordinates
-    bool add_icon(const std::string& key, const uint8_t* pixels, int width, int height);
-    
-    // Get UV coordinates for icon
-    const AtlasEntry* get_entry(const std::string& key) const;
-    
-    // Get OpenGL texture ID
-    unsigned int get_texture_id() const { return texture_id_; }
-    
-    // Clear atlas
-    void clear();
-    
-    // Evict least recently used entries if needed
-    void evict_lru(size_t target_count);
-    
-private:
-    unsigned int texture_id_ = 0;
-    int atlas_width_;
-    int atlas_height_;
-    std::unordered_map<std::string, AtlasEntry> entries_;
-    
-    // Rectangle packing for atlas
-    int next_x_ = 0;
-    int next_y_ = 0;
-    int row_height_ = 0;
-};
-
-/**
- * Icon cache entry for size-specific rasterizations
- */
-struct CachedIcon {
-    unsigned int texture_id = 0;
-    int width = 0;
-    int height = 0;
-    std::chrono::steady_clock::time_point last_used;
+    // Pack holding pre-rasterized sizes, kept mapped while referenced
+    std::shared_ptr<const IconPack> pack_;
+    size_t pack_index_ = 0;
+    
+    // Raster sizes placed in the atlas (pruned once evicted) and the one
+    // being rasterized in the background (0 for none)
+    std::vector<int> atlas_sizes_;
+    int pending_size_ = 0;
+    
+    // Distance field, generated once and kept to refill the atlas after
+    // eviction; monochrome_ is only valid once monochrome_checked_
+    std::vector<uint8_t> field_pixels_;
+    bool field_pending_ = false;
+    bool monochrome_checked_ = false;
+    bool monochrome_ = false;
+    
+    // Parse the SVG from the pack on the first size it lacks
+    bool parse_packed_svg();
+    
+    // Atlas entry for a raster size, or the nearest stand-in while it is
+    // rasterized
+    const IconAtlas::AtlasEntry* get_atlas_entry(int size);
+    const IconAtlas::AtlasEntry* find_nearest_entry(int size);
+    bool add_packed_size(int size);
+    void request_size(int size);
+    void remember_size(int size);
+    
+    // Field entry, or nullptr while it is generated
+    const IconAtlas::AtlasEntry* get_field_entry();
+    void request_field();
 };
 
 /**
@@ -168,10 +230,18 @@ public:
     bool load_icon(const std::string& name, const std::string& filepath);
     bool load_icon_set(const std::string& set_name, const std::string& directory);
     
+    // Register every icon of a prebuilt pack (see voxelux_pack_icons)
+    bool load_icon_pack(const std::string& path);
+    
     // Get icon by name
     IconAsset* get_icon(const std::string& name);
     const IconAsset* get_icon(const std::string& name) const;
     
+    // Get icon by interned name: an array lookup, for draw paths
+    IconAsset* get_icon(IconId id) {
+        return id.get_index() < icons_by_id_.size() ? icons_by_id_[id.get_index()] : nullptr;
+    }
+    
     // Check if icon exists
     bool has_icon(const std::string& name) const;
     
@@ -183,6 +253,11 @@ public:
                      const Point2D& position, float scaled_size, 
                      const ColorRGBA& tint = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
     
+    // Same, for widgets that interned their icon name when they were built
+    void render_icon(CanvasRenderer* renderer, IconId icon, 
+                     const Point2D& position, float scaled_size, 
+                     const ColorRGBA& tint = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+    
     // Get singleton instance
     static IconSystem& get_instance();
     
@@ -192,17 +267,56 @@ public:
     // Clear all icon caches (useful when DPI changes)
     void clear_all_caches();
     
+    // Shared atlas every icon draws from
+    IconAtlas& get_atlas() { return atlas_; }
+    
+    // Once per frame, before any icon is drawn: ages the atlas and places
+    // icons the workers finished
+    void begin_frame();
+    
+    // Charge icon work (uploads, rasterization) to this frame; false once
+    // the budget is spent, except that every frame admits one icon
+    bool spend_frame_budget(size_t bytes);
+    
+    IconRasterizer& get_rasterizer() { return rasterizer_; }
+    
+    // Content scale change: queue every raster size in the atlas at the size
+    // it has at to_scale, for prewarm_icons() to request within the frame
+    // budget. The old sizes stay in the atlas until its LRU drops them.
+    void begin_scale_prewarm(float from_scale, float to_scale);
+    bool prewarm_icons();  // True once every queued size is in the atlas or failed
+    void cancel_scale_prewarm() { prewarm_queue_.clear(); }
+    
+    // Draw monochrome SVG icons from one distance field each, tinted and
+    // scaled to any size, instead of a raster per size. Off by default:
+    // per-size rasters keep small icons pixel-exact.
+    void set_distance_field_icons(bool enabled);
+    bool uses_distance_field_icons() const { return distance_field_icons_; }
+    
 private:
     std::unordered_map<std::string, std::unique_ptr<IconAsset>> icons_;
+    std::vector<IconAsset*> icons_by_id_;  // By IconId index; null until loaded
     std::string icon_directory_;
     bool initialized_ = false;
     
-    // Cache for different icon sizes
-    // Key: icon_name + "_" + size
-    std::unordered_map<std::string, CachedIcon> size_cache_;
+    IconAtlas atlas_;
+    
+    // Background rasterization; results are placed within the frame budget
+    static constexpr size_t ICON_FRAME_BUDGET_BYTES = 256 * 1024;
+    IconRasterizer rasterizer_;
+    std::vector<RasterizedIcon> completed_icons_;
+    size_t frame_budget_ = ICON_FRAME_BUDGET_BYTES;
     
-    // Maximum cache size in MB
-    static constexpr size_t MAX_CACHE_SIZE_MB = 32;
+    // Raster sizes to request ahead of a content scale change
+    std::deque<std::pair<IconId, int>> prewarm_queue_;
+    
+    bool distance_field_icons_ = false;
+    
+    void process_rasterized_icons();
+    
+    // Register an icon, replacing (and dropping the atlas entries of) any
+    // icon loaded under the same name
+    void add_icon(std::unique_ptr<IconAsset> icon);
     
     // Load built-in icons from embedded data
     void load_builtin_icons();
@@ -210,10 +324,6 @@ private:
     // Helper to determine file type
     bool is_svg_file(const std::string& filepath) const;
     bool is_png_file(const std::string& filepath) const;
-    
-    // Cache management
-    void evict_old_cache_entries();
-    std::string make_cache_key(const std::string& icon_name, int size) const;
 };
 
 /**
@@ -233,7 +343,10 @@ public:
     void set_tooltip(const std::string& tooltip) { tooltip_ = tooltip; }
     
     // Appearance
-    void set_icon(const std::string& icon_name) { icon_name_ = icon_name; }
+    void set_icon(const std::string& icon_name) {
+        icon_name_ = icon_name;
+        icon_id_ = IconId::intern(icon_name);
+    }
     void set_icon_size(float scaled_size) { scaled_icon_size_ = scaled_size; }
     void set_tint(const ColorRGBA& tint) { icon_tint_ = tint; }
     
@@ -247,6 +360,7 @@ public:
     
 private:
     std::string icon_name_;
+    IconId icon_id_;
     Rect2D bounds_;
     float scaled_icon_size_;
     ColorRGBA icon_tint_;
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Image Loader - background decoding and budgeted texture uploads
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace voxel_canvas {
+
+/**
+ * Loads image files (background images, material textures) without
+ * stalling the render thread. Files are decoded to RGBA by a worker pool;
+ * begin_frame() then streams at most the upload budget of rows per frame
+ * through a pixel buffer and builds the mip chain on the GPU once the last
+ * row landed. Large images therefore take several frames to appear, and
+ * get_texture() returns 0 until they have (callers draw a placeholder). It
+ * also returns 0 for files that failed to decode or upload; those stay
+ * failed, and the state tells callers not to draw anything for them.
+ *
+ * Textures are registered with TextureResidency; when one is evicted the
+ * next get_texture() loads the file again.
+ *
+ * get_texture() and begin_frame() are render thread only.
+ */
+class ImageLoader {
+public:
+    static constexpr size_t DEFAULT_UPLOAD_BUDGET = size_t{8} * 1024 * 1024;  // Bytes per frame
+
+    enum class State {
+        Decoding,
+        Uploading,
+        Ready,
+        Failed  // Unreadable file or no texture; not retried
+    };
+
+    static ImageLoader& get_instance();
+
+    ~ImageLoader();
+
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    // Stops the workers and deletes every texture; needs the GL context
+    void shutdown();
+
+    // Uploaded texture for path, or 0 while it loads (the first call queues
+    // the file) or once it failed. Width and height are filled once known,
+    // state always. Counts as a use.
+    unsigned int get_texture(const std::string& path, int* width = nullptr, int* height = nullptr,
+                             State* state = nullptr);
+
+    // Land decoded images and upload up to the byte budget
+    void begin_frame();
+
+    void set_upload_budget(size_t bytes) { upload_budget_ = bytes; }
+    size_t get_upload_budget() const { return upload_budget_; }
+
+    // Images queued, decoding or partially uploaded
+    size_t get_pending_count() const;
+
+private:
+    struct Image {
+        State state = State::Decoding;
+        unsigned int texture_id = 0;
+        int width = 0;
+        int height = 0;
+        int uploaded_rows = 0;
+        std::vector<uint8_t> pixels;  // Decoded RGBA until the upload finishes
+    };
+
+    struct Decoded {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;  // Empty if decoding failed
+    };
+
+    ImageLoader() = default;
+
+    void start_workers();
+    void stop_workers();
+    void worker_main();
+    void queue_decode(const std::string& path);
+    void upload_pending();
+    bool create_texture(const std::string& path, Image& image);
+    void unload(const std::string& path);
+
+    // Render thread state
+    std::unordered_map<std::string, Image> images_;
+    std::deque<std::string> upload_queue_;  // Oldest first
+    unsigned int upload_pbo_ = 0;
+    size_t upload_budget_ = DEFAULT_UPLOAD_BUDGET;
+
+    // Shared with the workers
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<std::string> jobs_;
+    std::deque<Decoded> completed_;
+    size_t in_flight_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace voxel_canvas
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Interned IDs - small integer handles for icon, font and theme token names
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace voxel_canvas {
+
+/**
+ * Handle for a name interned once, typically when a widget is built or its
+ * style computed. Indices are dense and never reused, so draw paths look
+ * resources up by indexing an array instead of hashing the name.
+ *
+ * Each Tag has its own table. Interning is not synchronized; names are
+ * interned on the UI thread.
+ */
+template <typename Tag>
+class InternedId {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    constexpr InternedId() = default;
+
+    // Existing handle for the name, or a new one
+    static InternedId intern(std::string_view name) {
+        Table& table = get_table();
+        auto it = table.indices.find(name);
+        if (it != table.indices.end()) {
+            return InternedId(it->second);
+        }
+        uint32_t index = static_cast<uint32_t>(table.names.size());
+        const std::string& stored = table.names.emplace_back(name);
+        table.indices.emplace(stored, index);
+        return InternedId(index);
+    }
+
+    // Handle of an already interned name, or an invalid one
+    static InternedId find(std::string_view name) {
+        const Table& table = get_table();
+        auto it = table.indices.find(name);
+        return it != table.indices.end() ? InternedId(it->second) : InternedId();
+    }
+
+    // Number of names interned so far; every valid index is below it
+    static size_t get_count() { return get_table().names.size(); }
+
+    bool is_valid() const { return index_ != INVALID; }
+    uint32_t get_index() const { return index_; }
+    const std::string& get_name() const {
+        static const std::string empty;
+        return is_valid() ? get_table().names[index_] : empty;
+    }
+
+    bool operator==(const InternedId& other) const { return index_ == other.index_; }
+    bool operator!=(const InternedId& other) const { return index_ != other.index_; }
+
+private:
+    struct Table {
+        std::deque<std::string> names;  // Stable storage for the index keys
+        std::unordered_map<std::string_view, uint32_t> indices;
+    };
+
+    static Table& get_table() {
+        static Table table;
+        return table;
+    }
+
+    constexpr explicit InternedId(uint32_t index) : index_(index) {}
+
+    uint32_t index_ = INVALID;
+};
+
+using IconId = InternedId<struct IconIdTag>;
+using FontId = InternedId<struct FontIdTag>;
+using ThemeTokenId = InternedId<struct ThemeTokenIdTag>;
+
+} // namespace voxel_canvas
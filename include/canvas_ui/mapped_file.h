@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Mapped File - read-only memory-mapped asset files
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace voxel_canvas {
+
+/**
+ * Read-only memory mapping of a whole file. Pages are loaded on first touch
+ * and shared through the OS page cache, so several consumers of one asset
+ * (e.g. font faces of one variable font) cost a single copy.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& get_path() const { return path_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::string path_;
+    void* mapping_handle_ = nullptr;  // File mapping object (Windows only)
+};
+
+} // namespace voxel_canvas
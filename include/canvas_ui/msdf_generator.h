@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * MSDF Generator - multi-channel signed distance fields from glyph outlines
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Forward declarations
+typedef struct FT_Outline_ FT_Outline;
+
+namespace voxel_canvas {
+
+/**
+ * Distance field bitmap for one glyph. Column 0 / row 0 sit at (left, top)
+ * relative to the pen position on the baseline, matching FreeType's
+ * bitmap_left / bitmap_top, and the field extends pixel_range past the outline.
+ */
+struct MsdfBitmap {
+    int width = 0;
+    int height = 0;
+    int left = 0;
+    int top = 0;
+    std::vector<uint8_t> pixels;  // RGB8, top row first
+
+    void clear() { width = height = left = top = 0; pixels.clear(); }
+};
+
+/**
+ * Multi-channel signed distance field generation (edge colouring, per-channel
+ * pseudo-distance, scanline sign fix-up and clash correction). The median of
+ * the three channels reconstructs the outline with sharp corners at any scale.
+ *
+ * The outline is taken in 26.6 pixels at the size it was loaded at; a texel
+ * value of 128 lies on the outline and pixel_range is the distance in texels
+ * that maps to the full 0..255 span.
+ */
+class MsdfGenerator {
+public:
+    // Returns false for outlines without contours (e.g. space); bitmap is cleared
+    static bool generate(const FT_Outline& outline, float pixel_range, MsdfBitmap& bitmap);
+};
+
+} // namespace voxel_canvas
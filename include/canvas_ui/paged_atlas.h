@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Paged Atlas - rectangle-packed texture pages with LRU page eviction
+ */
+
+#pragma once
+
+#include "canvas_ui/canvas_core.h"
+#include "canvas_ui/texture_residency.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace voxel_canvas {
+
+enum class AtlasFormat {
+    RGB8,   // Distance fields
+    RGBA8   // Color images
+};
+
+// Where an allocation landed; uv covers exactly the requested texels
+struct AtlasSlot {
+    int page = -1;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    unsigned int texture_id = 0;
+    Rect2D uv;
+};
+
+/**
+ * Fixed-size texture pages packed with rectpack2D. When every page is full
+ * the least recently used page is cleared and repacked from scratch; the
+ * eviction callback reports each (owner, id) that lived on it so the owner
+ * can drop its slot and regenerate on demand. Pages used during the current
+ * frame are never evicted: if all of them are, an overflow page is added and
+ * released again once it goes idle. Allocations never fall back to separate
+ * textures.
+ *
+ * Pages are registered with TextureResidency under the atlas owner; when the
+ * global budget is exceeded an idle page is released the same way.
+ */
+class PagedAtlas {
+public:
+    static constexpr int MAX_PAGE_SLOTS = 32;  // Page masks are 32-bit
+
+    using EvictionCallback = std::function<void(void* owner, uint32_t id)>;
+
+    PagedAtlas();
+    ~PagedAtlas();
+
+    PagedAtlas(const PagedAtlas&) = delete;
+    PagedAtlas& operator=(const PagedAtlas&) = delete;
+
+    // max_pages is the steady-state budget; padding is left right and below each rect
+    bool initialize(int page_size, int max_pages, AtlasFormat format, TextureOwner owner, int padding = 2);
+    void shutdown();
+    bool is_initialized() const { return page_size_ > 0; }
+
+    void set_eviction_callback(EvictionCallback callback) { on_evict_ = std::move(callback); }
+
+    // Advance the LRU clock; releases overflow pages idle since last frame
+    void begin_frame();
+
+    // Reserve width x height texels for (owner, id). Must not be called with
+    // a pixel unpack buffer bound, since eviction clears the page from client
+    // memory. False only when the rect is larger than a page.
+    bool allocate(void* owner, uint32_t id, int width, int height, AtlasSlot& slot);
+
+    // Copy texels into an allocated slot (tightly packed rows)
+    void upload(const AtlasSlot& slot, const void* pixels) const;
+
+    // Drop every allocation of an owner that is going away; the space is
+    // reclaimed when its page is next repacked
+    void release_owner(const void* owner);
+
+    // Mark pages as drawn this frame
+    void touch(int page) {
+        if (page >= 0 && page < static_cast<int>(pages_.size())) {
+            pages_[static_cast<size_t>(page)].last_used_frame = frame_;
+        }
+    }
+    void touch_pages(uint32_t page_mask);
+
+    // Never evict this page (e.g. it holds a shared placeholder)
+    void pin_page(int page);
+
+    unsigned int get_texture(int page) const;
+    int get_page_size() const { return page_size_; }
+    int get_page_count() const;
+    uint64_t get_eviction_count() const { return eviction_count_; }
+
+private:
+    struct PagePacker;  // rectpack2D state, kept out of this header
+
+    struct Entry {
+        void* owner;
+        uint32_t id;
+    };
+
+    struct Page {
+        unsigned int texture_id = 0;  // 0 while the slot is unused
+        std::unique_ptr<PagePacker> packer;
+        std::vector<Entry> entries;
+        uint64_t last_used_frame = 0;
+        bool pinned = false;
+    };
+
+    int add_page();
+    void clear_page(Page& page);
+    void evict_page(Page& page);
+    void release_page(Page& page);
+    bool try_insert(Page& page, int width, int height, AtlasSlot& slot);
+
+    std::vector<Page> pages_;
+    int page_size_ = 0;
+    int max_pages_ = 0;
+    int padding_ = 0;
+    AtlasFormat format_ = AtlasFormat::RGB8;
+    TextureOwner owner_ = TextureOwner::GlyphAtlas;
+    uint64_t frame_ = 1;
+    uint64_t eviction_count_ = 0;
+    EvictionCallback on_evict_;
+};
+
+} // namespace voxel_canvas
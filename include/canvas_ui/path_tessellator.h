@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Path Tessellator - flattening, fill triangulation and stroke expansion
+ */
+
+#pragma once
+
+#include "canvas_core.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace voxel_canvas {
+
+/**
+ * One recorded path command (begin_path / move_to / line_to / curve_to / close_path)
+ */
+struct PathCommand {
+    enum Type { MoveTo, LineTo, CurveTo, Close };
+    Type type = MoveTo;
+    float x = 0, y = 0;
+    float cp1x = 0, cp1y = 0, cp2x = 0, cp2y = 0;  // Control points for curves
+};
+
+enum class LineJoin { Miter, Round, Bevel };
+enum class LineCap { Butt, Round, Square };
+
+struct StrokeStyle {
+    float width = 1.0f;
+    LineJoin join = LineJoin::Miter;
+    LineCap cap = LineCap::Butt;
+    float miter_limit = 4.0f;  // Ratio of miter length to stroke width (SVG semantics)
+};
+
+/**
+ * Flattened polyline of one subpath
+ */
+struct PathContour {
+    std::vector<Point2D> points;
+    bool closed = false;
+};
+
+/**
+ * Indexed triangle list in path space
+ */
+struct PathMesh {
+    std::vector<Point2D> vertices;
+    std::vector<uint32_t> indices;
+
+    void clear() { vertices.clear(); indices.clear(); }
+    bool empty() const { return indices.empty(); }
+};
+
+/**
+ * Stateless tessellation routines. Tolerance is the maximum distance in path
+ * units between a curve and its flattened polyline.
+ */
+class PathTessellator {
+public:
+    // Adaptive flattening: cubic segment count from Wang's formula
+    static void flatten(const std::vector<PathCommand>& commands, float tolerance,
+                        std::vector<PathContour>& contours);
+
+    // Even-odd fill; nested contours become holes bridged into their outer
+    // contour, then the polygon is ear-clipped (handles concave shapes)
+    static void fill(const std::vector<PathContour>& contours, PathMesh& mesh);
+
+    // Stroke expansion with joins on interior vertices and caps on open ends
+    static void stroke(const std::vector<PathContour>& contours, const StrokeStyle& style,
+                       float tolerance, PathMesh& mesh);
+
+    static uint64_t hash_commands(const std::vector<PathCommand>& commands);
+};
+
+/**
+ * Caches tessellated meshes keyed by path, operation and transform scale.
+ * Scale is bucketed in quarter octaves so small zoom changes reuse a mesh.
+ */
+class PathTessellationCache {
+public:
+    // Returned references stay valid until the next begin_frame()
+    const PathMesh& get_fill(const std::vector<PathCommand>& commands, float scale);
+    const PathMesh& get_stroke(const std::vector<PathCommand>& commands, const StrokeStyle& style, float scale);
+
+    // Advance the frame counter and drop meshes that have not been used recently
+    void begin_frame();
+    void clear() { entries_.clear(); }
+
+    size_t size() const { return entries_.size(); }
+    uint32_t get_hits() const { return hits_; }
+    uint32_t get_misses() const { return misses_; }
+
+private:
+    // The inputs are kept and compared on hash hits, so a collision is a miss
+    // rather than another path's mesh
+    struct Entry {
+        std::vector<PathCommand> commands;
+        float bucket = 1.0f;
+        bool is_stroke = false;
+        StrokeStyle style;  // Strokes only
+        PathMesh mesh;
+        uint64_t last_used_frame = 0;
+    };
+
+    Entry* find(uint64_t key, const std::vector<PathCommand>& commands, float bucket, const StrokeStyle* style);
+    Entry& insert(uint64_t key, const std::vector<PathCommand>& commands, float bucket, const StrokeStyle* style);
+    static float bucket_scale(float scale);
+
+    std::unordered_multimap<uint64_t, Entry> entries_;  // Path hash -> meshes
+    uint64_t frame_ = 0;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+
+    static constexpr float BASE_TOLERANCE = 0.25f;      // Device pixels
+    static constexpr size_t MAX_ENTRIES = 512;
+    static constexpr uint64_t MAX_IDLE_FRAMES = 300;
+};
+
+} // namespace voxel_canvas
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Scale Transition - content scale changes with pre-warmed caches
+ */
+
+#pragma once
+
+namespace voxel_canvas {
+
+class CanvasRenderer;
+
+/**
+ * Switches the UI to a new content scale (the window moved to another
+ * display) without the frames a direct switch spends re-shaping every text
+ * run and re-rasterizing every icon size on first draw.
+ *
+ * begin() queues the cached runs and icon sizes at the new scale; update()
+ * works through them a time slice per frame while the layout stays at the
+ * old scale, drawn stretched to the new one through the renderer's
+ * presentation scale. Once they are warm (or after MAX_PREWARM_FRAMES)
+ * update() reports the switch and the caller applies get_scale() to its
+ * layout in that one frame. Runs at the previous scale stay cached for
+ * RETAIN_FRAMES afterwards, so moving back is a swap, not a rebuild.
+ *
+ * Render thread only.
+ */
+class ScaleTransition {
+public:
+    static constexpr int MAX_PREWARM_FRAMES = 30;     // Switch anyway after this many
+    static constexpr int RETAIN_FRAMES = 600;         // About ten seconds at 60 fps
+    static constexpr double PREWARM_SLICE_MS = 2.0;   // Shaping per frame
+
+    explicit ScaleTransition(float scale) : scale_(scale), target_scale_(scale) {}
+
+    // The content scale changed to new_scale
+    void begin(CanvasRenderer* renderer, float new_scale);
+
+    // Once per frame before the layout is refreshed; true on the frame the
+    // caller should lay out at get_scale()
+    bool update(CanvasRenderer* renderer);
+
+    bool is_prewarming() const { return prewarming_; }
+
+    // Scale the layout should use, and the one it is moving to
+    float get_scale() const { return scale_; }
+    float get_target_scale() const { return target_scale_; }
+
+private:
+    void finish(CanvasRenderer* renderer);
+    void cancel_prewarm();
+
+    float scale_;
+    float target_scale_;
+    bool prewarming_ = false;
+    int prewarm_frames_ = 0;
+    int retain_frames_ = 0;  // Frames left before the previous scale's runs may go
+};
+
+} // namespace voxel_canvas
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Shader Program Cache - linked program binaries persisted across runs
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// OpenGL types
+typedef unsigned int GLuint;
+
+namespace voxel_canvas {
+
+/**
+ * Builds GLSL programs from embedded sources and keeps their linked binaries
+ * in the user cache directory, so warm starts skip the driver compiler.
+ * Binaries are keyed by GL vendor, renderer, version and a hash of the sources.
+ *
+ * Programs that are not needed for the first frame can be requested as
+ * deferred: they are compiled and linked without waiting on the driver
+ * (in parallel where KHR_parallel_shader_compile is available) and finished
+ * from poll() or on first use via finish_program().
+ */
+class ShaderCache {
+public:
+    struct Stats {
+        int cache_hits = 0;        // Programs restored from a stored binary
+        int cache_misses = 0;      // Programs compiled from source
+        int deferred = 0;          // Programs linked off the critical path
+        int failures = 0;
+        double total_ms = 0.0;     // Time spent on the calling thread
+    };
+
+    static ShaderCache& get_instance();
+
+    // Requires a current GL context; called implicitly by load_program
+    void initialize();
+
+    // Returns a program id, or 0 on failure. geometry_source may be null.
+    GLuint load_program(const std::string& name,
+                        const char* vertex_source,
+                        const char* fragment_source,
+                        const char* geometry_source = nullptr,
+                        bool deferred = false);
+
+    // Block until a deferred program has linked. Returns false (and deletes
+    // the program) if linking failed, including when poll() already found
+    // the failure. No-op for programs that are ready.
+    bool finish_program(GLuint program);
+    bool is_pending(GLuint program) const { return pending_.count(program) != 0; }
+
+    // Finish deferred programs the driver has completed; call once per frame
+    void poll();
+
+    // Forget a program before the owner deletes it
+    void release_program(GLuint program);
+
+    const Stats& get_stats() const { return stats_; }
+    void log_startup_summary(const char* stage) const;
+
+    bool is_binary_cache_enabled() const { return binary_supported_ && !cache_directory_.empty(); }
+    bool has_parallel_compile() const { return parallel_compile_; }
+
+private:
+    ShaderCache() = default;
+
+    struct PendingProgram {
+        std::string name;
+        std::string cache_path;
+        std::vector<GLuint> shaders;
+    };
+
+    GLuint load_binary(const std::string& path) const;
+    void store_binary(GLuint program, const std::string& path) const;
+    bool complete_link(GLuint program, PendingProgram& pending);
+    std::string make_cache_path(const std::string& name, uint64_t hash) const;
+
+    static GLuint compile_stage(const char* source, unsigned int type);
+    static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size);
+    static std::string resolve_cache_directory();
+
+    std::unordered_map<GLuint, PendingProgram> pending_;
+    std::unordered_set<GLuint> failed_;  // Deferred links that failed, until the id is reused
+    std::string driver_key_;
+    std::string cache_directory_;
+    bool binary_supported_ = false;
+    bool parallel_compile_ = false;
+    bool initialized_ = false;
+    Stats stats_;
+};
+
+} // namespace voxel_canvas
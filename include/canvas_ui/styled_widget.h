@@ -175,6 +175,13 @@ protected:
     void render_gradient(CanvasRenderer* renderer, const Rect2D& bounds, const WidgetStyle::Gradient& gradient);
     virtual void render_outline(CanvasRenderer* renderer);  // Shadows, etc.
     
+    // Occlusion pre-pass: assigns paint order, measures the painted extent of
+    // the subtree and registers opaque backgrounds as occluders. The theme is
+    // resolved once by the root and shared by the whole walk.
+    void collect_occluders(CanvasRenderer* renderer, const ScaledTheme& theme, const Rect2D& clip,
+                           bool transformed, float opacity);
+    bool has_style_transform() const;
+    
     // Layout algorithms
     virtual void layout_children();  // Apply layout based on display type
     void layout_flex();              // Flexbox layout
@@ -210,6 +217,13 @@ protected:
     bool needs_layout_ = true;
     bool visible_ = true;
     
+    // Occlusion culling (filled by collect_occluders each frame)
+    uint32_t paint_order_ = 0;
+    uint32_t subtree_last_order_ = 0;   // Last paint order inside this subtree
+    Rect2D paint_extent_;               // Bounds plus shadow/outline of the whole subtree
+    int occlusion_frame_ = -1;
+    bool occlusion_cullable_ = false;
+    
     // Hierarchy
     StyledWidget* parent_ = nullptr;
     std::vector<std::shared_ptr<StyledWidget>> children_;
@@ -12,6 +12,8 @@
 #include "icon_system.h"
 #include "font_system.h"
 #include "layout_builder.h"
+#include "text_layout.h"
+#include <limits>
 #include <string>
 #include <functional>
 #include <iostream>
@@ -30,6 +32,7 @@ public:
     
     void set_text(const std::string& text) { 
         text_ = text; 
+        layout_text_dirty_ = true;
         invalidate_layout();
     }
     const std::string& get_text() const { return text_; }
@@ -57,11 +60,17 @@ public:
             return Point2D(0, 0);
         }
         
+        // Preserved newlines: one line per paragraph before any wrapping
+        float unbounded = std::numeric_limits<float>::infinity();
+        if (configure_layout(unbounded)) {
+            layout_all(unbounded);
+            return Point2D(layout_natural_width_, layout_.get_height());
+        }
+        
         // Use accurate text measurement with kerning
         if (g_font_system && computed_style_.font_size_pixels > 0) {
-            TextMeasurement measurement = g_font_system->measure_text_accurate(
-                text_, computed_style_.font_family.empty() ? "default" : computed_style_.font_family,
-                computed_style_.font_size_pixels);
+            const TextMeasurement& measurement = g_font_system->measure_text_accurate(
+                text_, computed_style_.font_id, computed_style_.font_size_pixels);
             return Point2D(measurement.width, measurement.height);
         }
         
@@ -76,6 +85,11 @@ protected:
         if (text_.empty()) return;
         
         Rect2D content_bounds = get_content_bounds();
+        if (configure_layout(content_bounds.width)) {
+            render_layout(renderer, content_bounds);
+            return;
+        }
+        
         Point2D text_pos;
         
         // Calculate text position based on alignment
@@ -124,7 +138,101 @@ protected:
     }
     
 private:
+    // Multi-line text (preserved newlines, or wrapping past max_width) goes
+    // through the layout; a single line keeps the draw_text path
+    bool configure_layout(float max_width) const {
+        if (!g_font_system || computed_style_.font_size_pixels <= 0) {
+            return false;
+        }
+        
+        WidgetStyle::WhiteSpace white_space = computed_style_.white_space;
+        if (white_space == WidgetStyle::WhiteSpace::NoWrap) {
+            return false;
+        }
+        
+        // draw_text renders with the default font at whole pixel sizes
+        static const FontId default_font = FontId::intern("default");
+        FontFace* font = g_font_system->get_font(default_font);
+        if (!font) {
+            return false;
+        }
+        float font_size = static_cast<float>(static_cast<int>(computed_style_.font_size_pixels));
+        
+        // Called every frame; the newline scan, re-split and natural width
+        // pass only repeat when the text or a style input has changed
+        if (layout_text_dirty_ || font != layout_font_ || font_size != layout_font_size_ ||
+            white_space != layout_white_space_ || computed_style_.word_break != layout_word_break_) {
+            layout_text_dirty_ = false;
+            layout_font_ = font;
+            layout_font_size_ = font_size;
+            layout_white_space_ = white_space;
+            layout_word_break_ = computed_style_.word_break;
+            layout_exact_width_ = -1.0f;
+            
+            layout_has_newline_ = white_space != WidgetStyle::WhiteSpace::Normal &&
+                                  text_.find('\n') != std::string::npos;
+            layout_active_ = layout_has_newline_ || white_space != WidgetStyle::WhiteSpace::Pre;
+            if (layout_active_) {
+                layout_.set_font(font, font_size);
+                layout_.set_white_space(white_space);
+                layout_.set_word_break(layout_word_break_);
+                layout_.set_text(text_);
+                layout_natural_width_ = layout_.get_natural_width();
+            }
+        }
+        if (!layout_active_) {
+            return false;
+        }
+        
+        layout_.set_width(max_width);
+        return layout_has_newline_ || layout_natural_width_ > max_width;
+    }
+    
+    // Exact line counts for the height; each paragraph re-flows at most once per width
+    void layout_all(float width) const {
+        if (layout_exact_width_ != width) {
+            layout_.layout_all();
+            layout_exact_width_ = width;
+        }
+    }
+    
+    void render_layout(CanvasRenderer* renderer, const Rect2D& content_bounds) {
+        voxel_canvas::TextAlign align = voxel_canvas::TextAlign::LEFT;
+        if (computed_style_.text_align == WidgetStyle::TextAlign::Center) {
+            align = voxel_canvas::TextAlign::CENTER;
+        } else if (computed_style_.text_align == WidgetStyle::TextAlign::Right) {
+            align = voxel_canvas::TextAlign::RIGHT;
+        }
+        
+        // Only middle and bottom alignment need the full height; top-aligned
+        // text re-flows just the lines it draws
+        float top = content_bounds.y;
+        if (computed_style_.vertical_align == WidgetStyle::VerticalAlign::Middle) {
+            layout_all(content_bounds.width);
+            top += std::round((content_bounds.height - layout_.get_height()) / 2);
+        } else if (computed_style_.vertical_align == WidgetStyle::VerticalAlign::Bottom) {
+            layout_all(content_bounds.width);
+            top += content_bounds.height - layout_.get_height();
+        }
+        
+        Rect2D visible = renderer->get_visible_rect();
+        layout_.draw(renderer, Point2D(content_bounds.x, top), computed_style_.text_color_rgba,
+                     align, content_bounds.width, visible.y - top, visible.y + visible.height - top);
+    }
+    
     std::string text_;
+    mutable TextLayout layout_;  // Line breaks cached across layout and paint
+    
+    // Inputs layout_ was last configured with
+    mutable bool layout_text_dirty_ = true;
+    mutable bool layout_active_ = false;
+    mutable bool layout_has_newline_ = false;
+    mutable FontFace* layout_font_ = nullptr;
+    mutable float layout_font_size_ = 0.0f;
+    mutable WidgetStyle::WhiteSpace layout_white_space_ = WidgetStyle::WhiteSpace::Normal;
+    mutable WidgetStyle::WordBreak layout_word_break_ = WidgetStyle::WordBreak::Normal;
+    mutable float layout_natural_width_ = 0.0f;
+    mutable float layout_exact_width_ = -1.0f;  // Width layout_all() last ran at
 };
 
 /**
@@ -133,7 +241,7 @@ private:
 class Icon : public StyledWidget {
 public:
     explicit Icon(const std::string& icon_name = "", float size = 16.0f) 
-        : StyledWidget("icon"), icon_name_(icon_name) {
+        : StyledWidget("icon"), icon_name_(icon_name), icon_id_(IconId::intern(icon_name)) {
         base_style_.width = SizeValue(size);
         base_style_.height = SizeValue(size);
         base_style_.display = WidgetStyle::Display::InlineBlock;
@@ -141,6 +249,7 @@ public:
     
     void set_icon(const std::string& name) { 
         icon_name_ = name; 
+        icon_id_ = IconId::intern(name);
         invalidate_layout();
     }
     const std::string& get_icon() const { return icon_name_; }
@@ -163,7 +272,7 @@ protected:
         IconSystem& icon_system = IconSystem::get_instance();
         
         // Get the icon asset from the system
-        IconAsset* icon_asset = icon_system.get_icon(icon_name_);
+        IconAsset* icon_asset = icon_system.get_icon(icon_id_);
         if (!icon_asset) {
             // Icon not found - render a placeholder rectangle for debugging
             ColorRGBA debug_color(1.0f, 0.0f, 0.0f, 0.5f); // Semi-transparent red
@@ -186,6 +295,7 @@ protected:
     
 private:
     std::string icon_name_;
+    IconId icon_id_;  // Interned when the icon is set; looked up every paint
     ColorRGBA icon_color_ = ColorRGBA(0, 0, 0, 0);  // Transparent = use text color
 };
 
@@ -209,6 +319,7 @@ public:
     
     void set_icon(const std::string& icon_name) {
         icon_name_ = icon_name;
+        icon_id_ = IconId::intern(icon_name);
         invalidate_layout();
     }
     
@@ -288,9 +399,8 @@ public:
         if (!text_.empty()) {
             // Use accurate text measurement with kerning
             if (g_font_system && computed_style_.font_size_pixels > 0) {
-                TextMeasurement measurement = g_font_system->measure_text_accurate(
-                    text_, computed_style_.font_family.empty() ? "default" : computed_style_.font_family, 
-                    computed_style_.font_size_pixels);
+                const TextMeasurement& measurement = g_font_system->measure_text_accurate(
+                    text_, computed_style_.font_id, computed_style_.font_size_pixels);
                 width += measurement.width;
                 height = measurement.height;
             } else {
@@ -337,7 +447,7 @@ protected:
             // Render icon
             IconSystem& icon_system = IconSystem::get_instance();
             Point2D icon_pos(x + icon_size / 2, center_y);
-            icon_system.render_icon(renderer, icon_name_, icon_pos, icon_size, 
+            icon_system.render_icon(renderer, icon_id_, icon_pos, icon_size, 
                                   computed_style_.text_color_rgba);
             
             // Render text after icon
@@ -352,7 +462,7 @@ protected:
             float icon_size = computed_style_.font_size_pixels * 1.2f;
             IconSystem& icon_system = IconSystem::get_instance();
             Point2D icon_pos(center_x, center_y);
-            icon_system.render_icon(renderer, icon_name_, icon_pos, icon_size, 
+            icon_system.render_icon(renderer, icon_id_, icon_pos, icon_size, 
                                   computed_style_.text_color_rgba);
         }
         // Just text - use CENTER alignment
@@ -367,6 +477,7 @@ protected:
 private:
     std::string text_;
     std::string icon_name_;
+    IconId icon_id_;
     bool is_toggled_ = false;
 };
 
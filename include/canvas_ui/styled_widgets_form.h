@@ -9,7 +9,12 @@
 #include "styled_widget.h"
 #include "styled_widgets_core.h"
 #include "layout_builder.h"
+#include "text_buffer.h"
+#include "utf8.h"
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 
@@ -38,55 +43,147 @@ public:
     }
     
     void set_value(const std::string& value) {
-        value_ = value;
+        buffer_.set_text(value);
+        caret_ = buffer_.size();
         invalidate_layout();
     }
     
-    const std::string& get_value() const { return value_; }
+    // Materialized from the buffer on demand; edits never copy the whole text
+    const std::string& get_value() const {
+        if (value_version_ != buffer_.get_version()) {
+            value_ = buffer_.to_string();
+            value_version_ = buffer_.get_version();
+        }
+        return value_;
+    }
+    
+    const TextBuffer& get_buffer() const { return buffer_; }
     
     void set_placeholder(const std::string& placeholder) {
         placeholder_ = placeholder;
     }
     
-    void set_on_change(std::function<void(const std::string&)> callback) {
+    // One edit: `erased` bytes removed at `offset`, then `inserted` placed
+    // there. The view is only valid during the callback.
+    struct Edit {
+        size_t offset = 0;
+        size_t erased = 0;
+        std::string_view inserted;
+    };
+    
+    // Called per edit with the range it touched. A listener that needs the
+    // whole text asks get_value(), so typing copies nothing by default.
+    void set_on_change(std::function<void(const Edit&)> callback) {
         on_change_ = callback;
     }
     
+    // Editing at the caret; O(log n) in the buffer's piece count
+    void insert_text(std::string_view text) {
+        if (text.empty()) return;
+        size_t offset = caret_;
+        buffer_.insert(caret_, text);
+        caret_ += text.size();
+        notify_change({offset, 0, text});
+    }
+    
+    // Whole UTF-8 sequences, never a lone byte of one
+    void erase_backward() {
+        size_t length = previous_codepoint_length();
+        if (length == 0) return;
+        caret_ -= length;
+        buffer_.erase(caret_, length);
+        notify_change({caret_, length, {}});
+    }
+    
+    void erase_forward() {
+        size_t length = next_codepoint_length();
+        if (length == 0) return;
+        buffer_.erase(caret_, length);
+        notify_change({caret_, length, {}});
+    }
+    
+    void set_caret(size_t offset) { caret_ = std::min(offset, buffer_.size()); }
+    size_t get_caret() const { return caret_; }
+    
     std::string get_widget_type() const override { return "input"; }
     
 protected:
     void render_content(CanvasRenderer* renderer) override {
         Rect2D content_bounds = get_content_bounds();
+        float font_size = computed_style_.font_size_pixels;
         
-        std::string display_text = value_.empty() ? placeholder_ : value_;
-        ColorRGBA text_color = value_.empty() ? 
-            ColorRGBA(0.5f, 0.5f, 0.5f, 1.0f) : computed_style_.text_color_rgba;
+        if (buffer_.empty()) {
+            renderer->draw_text(placeholder_, 
+                              Point2D(content_bounds.x, content_bounds.y + content_bounds.height / 2),
+                              ColorRGBA(0.5f, 0.5f, 0.5f, 1.0f), font_size,
+                              voxel_canvas::TextAlign::LEFT, 
+                              voxel_canvas::TextBaseline::MIDDLE);
+        }
         
-        // Draw text
-        renderer->draw_text(display_text, 
-                          Point2D(content_bounds.x, content_bounds.y + content_bounds.height / 2),
-                          text_color, computed_style_.font_size_pixels,
-                          voxel_canvas::TextAlign::LEFT, 
-                          voxel_canvas::TextBaseline::MIDDLE);
+        // Only lines edited since the last paint are re-read from the buffer;
+        // unchanged line strings keep hitting their cached shaped runs
+        bool single_line = buffer_.get_line_count() == 1;
+        float line_height = get_line_height();
+        size_t visible_lines = single_line ? 1 : std::min(buffer_.get_line_count(),
+            static_cast<size_t>(std::ceil(content_bounds.height / line_height)));
+        refresh_line_cache(visible_lines);
+        
+        for (size_t i = 0; i < visible_lines && !buffer_.empty(); ++i) {
+            if (single_line) {
+                renderer->draw_text(line_cache_[i].text, 
+                                  Point2D(content_bounds.x, content_bounds.y + content_bounds.height / 2),
+                                  computed_style_.text_color_rgba, font_size,
+                                  voxel_canvas::TextAlign::LEFT, 
+                                  voxel_canvas::TextBaseline::MIDDLE);
+            } else {
+                renderer->draw_text(line_cache_[i].text,
+                                  Point2D(content_bounds.x, content_bounds.y + static_cast<float>(i) * line_height),
+                                  computed_style_.text_color_rgba, font_size,
+                                  voxel_canvas::TextAlign::LEFT,
+                                  voxel_canvas::TextBaseline::TOP);
+            }
+        }
         
         // Draw cursor if focused
         if (is_focused()) {
-            float cursor_x = content_bounds.x + (value_.length() * 7.0f);  // Approximate
+            size_t line = buffer_.line_of_offset(caret_);
+            if (line >= visible_lines) {
+                return;
+            }
+            size_t column = caret_ - buffer_.line_start(line);
+            const std::string& text = line_cache_[line].text;
+            const ShapedRun* run = text.empty() ? nullptr : renderer->get_text_run(text, font_size);
+            float cursor_x = content_bounds.x + (run ? run->caret_x(column) : 0.0f);
+            float top = single_line ? content_bounds.y + 2 : content_bounds.y + static_cast<float>(line) * line_height;
+            float bottom = single_line ? content_bounds.y + content_bounds.height - 2 : top + line_height;
             renderer->draw_line_batched(
-                Point2D(cursor_x, content_bounds.y + 2),
-                Point2D(cursor_x, content_bounds.y + content_bounds.height - 2),
+                Point2D(cursor_x, top),
+                Point2D(cursor_x, bottom),
                 computed_style_.text_color_rgba, 1.0f
             );
         }
     }
     
     bool handle_event(const InputEvent& event) override {
+        // Keys go to the focused field wherever the pointer is
+        if (is_focused() && handle_key(event)) {
+            return true;
+        }
+        
         if (StyledWidget::handle_event(event)) {
-            // Handle text input when focused
-            if (is_focused() && event.type == EventType::KEY_PRESS) {
-                // TODO: Handle keyboard input
-                if (on_change_) {
-                    on_change_(value_);
+            // Click-to-index: nearest caret stop on the clicked line
+            if (event.type == EventType::MOUSE_PRESS && g_font_system && !buffer_.empty()) {
+                if (FontFace* font = g_font_system->get_font(get_font_id())) {
+                    Rect2D content_bounds = get_content_bounds();
+                    size_t line = 0;
+                    if (buffer_.get_line_count() > 1) {
+                        float row = std::floor((event.mouse_pos.y - content_bounds.y) / get_line_height());
+                        line = std::min(static_cast<size_t>(std::max(row, 0.0f)), buffer_.get_line_count() - 1);
+                    }
+                    float pixel_size = static_cast<float>(static_cast<int>(computed_style_.font_size_pixels));
+                    const ShapedRun& run = g_font_system->get_shaped_run(font, buffer_.get_line(line), pixel_size);
+                    size_t stop = run.hit_test(event.mouse_pos.x - content_bounds.x);
+                    caret_ = buffer_.line_start(line) + (run.byte_offsets.empty() ? 0 : run.byte_offsets[stop]);
                 }
             }
             return true;
@@ -95,9 +192,118 @@ protected:
     }
     
 private:
-    std::string value_;
+    // GLFW key codes, as CanvasWindow forwards them
+    enum : int {
+        KEY_BACKSPACE = 259,
+        KEY_DELETE = 261,
+        KEY_RIGHT = 262,
+        KEY_LEFT = 263,
+        KEY_HOME = 268,
+        KEY_END = 269
+    };
+    
+    // Typed text arrives as TEXT_INPUT; KEY_PRESS only edits and moves
+    bool handle_key(const InputEvent& event) {
+        if (event.type == EventType::TEXT_INPUT) {
+            char utf8[4];
+            insert_text(std::string_view(utf8, encode_utf8(event.codepoint, utf8)));
+            return true;
+        }
+        if (event.type != EventType::KEY_PRESS) {
+            return false;
+        }
+        
+        switch (event.key_code) {
+            case KEY_BACKSPACE:
+                erase_backward();
+                return true;
+            case KEY_DELETE:
+                erase_forward();
+                return true;
+            case KEY_LEFT:
+                caret_ -= previous_codepoint_length();
+                return true;
+            case KEY_RIGHT:
+                caret_ += next_codepoint_length();
+                return true;
+            case KEY_HOME:
+                caret_ = buffer_.line_start(buffer_.line_of_offset(caret_));
+                return true;
+            case KEY_END:
+                caret_ = buffer_.line_end(buffer_.line_of_offset(caret_));
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    // Bytes of the codepoints either side of the caret (0 at the ends)
+    size_t previous_codepoint_length() const {
+        if (caret_ == 0) return 0;
+        std::string tail;
+        size_t window = std::min<size_t>(caret_, 4);
+        buffer_.get_text(caret_ - window, window, tail);
+        return window - utf8_previous(tail, window);
+    }
+    
+    size_t next_codepoint_length() const {
+        if (caret_ >= buffer_.size()) return 0;
+        std::string head;
+        buffer_.get_text(caret_, 4, head);
+        size_t length = 0;
+        decode_utf8(head, length);
+        return length;
+    }
+    
+    struct CachedLine {
+        std::string text;
+        bool valid = false;
+    };
+    
+    // The field draws in Inter; interned once for every lookup
+    static FontId get_font_id() {
+        static const FontId font = FontId::intern("Inter");
+        return font;
+    }
+    
+    float get_line_height() const {
+        FontFace* font = g_font_system ? g_font_system->get_font(get_font_id()) : nullptr;
+        float height = font ? font->get_line_height(static_cast<int>(computed_style_.font_size_pixels)) : 0.0f;
+        return height > 0.0f ? std::round(height) : computed_style_.font_size_pixels * 1.2f;
+    }
+    
+    void refresh_line_cache(size_t visible_lines) {
+        size_t first;
+        size_t last;
+        if (buffer_.take_dirty_lines(first, last)) {
+            size_t end = last == TextBuffer::npos ? line_cache_.size() : std::min(last + 1, line_cache_.size());
+            for (size_t i = first; i < end; ++i) {
+                line_cache_[i].valid = false;
+            }
+        }
+        line_cache_.resize(visible_lines);
+        for (size_t i = 0; i < visible_lines; ++i) {
+            if (!line_cache_[i].valid) {
+                line_cache_[i].text = buffer_.get_line(i);
+                line_cache_[i].valid = true;
+            }
+        }
+    }
+    
+    void notify_change(const Edit& edit) {
+        invalidate_layout();
+        if (on_change_) {
+            on_change_(edit);
+        }
+    }
+    
+    TextBuffer buffer_;
+    std::vector<CachedLine> line_cache_;      // Visible lines, refreshed by dirty range
+    mutable std::string value_;
+    mutable uint64_t value_version_ = 0;
     std::string placeholder_;
-    std::function<void(const std::string&)> on_change_;
+    size_t caret_ = 0;  // Byte offset into the buffer
+    std::function<void(const Edit&)> on_change_;
 };
 
 /**
@@ -143,8 +349,9 @@ protected:
         
         // Draw checkmark if checked
         if (checked_) {
+            static const IconId check_icon = IconId::intern("check");
             IconSystem& icon_system = IconSystem::get_instance();
-            icon_system.render_icon(renderer, "check", 
+            icon_system.render_icon(renderer, check_icon, 
                                    Point2D(box_rect.x + 8, box_rect.y + 8), 
                                    12, ColorRGBA(0, 1, 0, 1));
         }
@@ -317,8 +524,9 @@ protected:
                           voxel_canvas::TextBaseline::MIDDLE);
         
         // Draw dropdown arrow
+        static const IconId chevron_icon = IconId::intern("chevron_down");
         IconSystem& icon_system = IconSystem::get_instance();
-        icon_system.render_icon(renderer, "chevron_down",
+        icon_system.render_icon(renderer, chevron_icon,
                                Point2D(content_bounds.right() - 12, 
                                      content_bounds.y + content_bounds.height / 2),
                                12, computed_style_.text_color_rgba);
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Text Buffer - piece table for editable text
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace voxel_canvas {
+
+/**
+ * Piece table over an immutable original buffer and an append-only add
+ * buffer. Pieces live in a treap ordered by position; every node carries its
+ * subtree's byte and newline counts, so insert, erase, offset <-> line lookups
+ * and line extraction are O(log n) in the number of pieces (plus the bytes
+ * copied out). Newline positions of both buffers are indexed once, so
+ * splitting a large piece never rescans it.
+ *
+ * Edits accumulate a dirty line range for per-line caches (shaped runs,
+ * batches) to refresh only what changed.
+ */
+class TextBuffer {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    TextBuffer();
+    explicit TextBuffer(std::string_view text);
+
+    void set_text(std::string_view text);
+    void insert(size_t offset, std::string_view text);
+    void erase(size_t offset, size_t length);
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t get_line_count() const;
+
+    // Byte offset of a line's first character (size() past the last line)
+    size_t line_start(size_t line) const;
+    // Byte offset one past a line's last character, excluding its newline
+    size_t line_end(size_t line) const;
+    // Line containing a byte offset
+    size_t line_of_offset(size_t offset) const;
+
+    void get_text(size_t offset, size_t length, std::string& out) const;
+    std::string get_line(size_t line) const;
+    std::string to_string() const;
+
+    size_t get_piece_count() const { return piece_count_; }
+    uint64_t get_version() const { return version_; }
+
+    // Lines [first, last] edited since the last call (last is npos when line
+    // indices after first shifted); returns false when nothing changed
+    bool take_dirty_lines(size_t& first, size_t& last);
+
+private:
+    struct Piece {
+        bool added = false;    // Which buffer the bytes come from
+        size_t start = 0;
+        size_t length = 0;
+        size_t newlines = 0;
+    };
+
+    struct Node {
+        uint32_t left = 0;
+        uint32_t right = 0;
+        uint32_t priority = 0;
+        Piece piece;
+        size_t length = 0;      // Subtree totals
+        size_t newlines = 0;
+    };
+
+    const std::string& buffer_of(const Piece& piece) const { return piece.added ? added_ : original_; }
+    const std::vector<size_t>& newlines_of(const Piece& piece) const {
+        return piece.added ? added_newlines_ : original_newlines_;
+    }
+    size_t count_newlines(bool added, size_t start, size_t end) const;
+
+    uint32_t new_node(const Piece& piece);
+    void free_subtree(uint32_t node);
+    void update(uint32_t node);
+    void split(uint32_t node, size_t offset, uint32_t& left, uint32_t& right);
+    uint32_t merge(uint32_t left, uint32_t right);
+    void collect(uint32_t node, size_t offset, size_t length, std::string& out) const;
+    uint32_t next_priority();
+    void mark_dirty(size_t first_line, bool shifted);
+
+    std::string original_;
+    std::string added_;
+    std::vector<size_t> original_newlines_;  // Ascending byte positions of '\n'
+    std::vector<size_t> added_newlines_;
+
+    std::vector<Node> nodes_;                // Index 0 is the null node
+    std::vector<uint32_t> free_nodes_;
+    uint32_t root_ = 0;
+    size_t piece_count_ = 0;
+
+    uint32_t random_state_ = 0x9E3779B9u;
+    uint64_t version_ = 0;
+    size_t dirty_first_ = npos;
+    size_t dirty_last_ = 0;
+};
+
+} // namespace voxel_canvas
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Text Layout - incremental paragraph line breaking over shaped runs
+ */
+
+#pragma once
+
+#include "canvas_core.h"
+#include "canvas_renderer.h"
+#include "font_system.h"
+#include "widget_style.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace voxel_canvas {
+
+/**
+ * One laid-out line: a glyph range of its paragraph's shaped run
+ */
+struct TextLine {
+    uint32_t glyph_begin = 0;
+    uint32_t glyph_end = 0;    // Exclusive; includes spaces hanging past the content
+    float width = 0.0f;        // Content width, hanging spaces excluded
+};
+
+/**
+ * Multi-line text layout following the WhiteSpace / WordBreak styles.
+ *
+ * Text is split into paragraphs at preserved newlines. Each paragraph keeps
+ * its advance prefix sums, its break opportunities and the range of widths
+ * its current lines stay valid for, so:
+ *  - set_width() is O(1); a paragraph re-flows lazily, from its first line
+ *    that no longer holds, when it is next measured or drawn,
+ *  - set_text() / append_text() re-shape only the paragraphs that changed,
+ *  - a Fenwick tree over per-paragraph line counts maps a line index to its
+ *    paragraph in O(log n), so large documents (log panels) are laid out and
+ *    drawn by visible range only.
+ *
+ * Each paragraph owns its shaped run rather than borrowing one from the
+ * FontSystem cache: a large log would otherwise cycle the shared LRU and
+ * evict the runs of every label in the UI.
+ *
+ * Line counts of paragraphs not yet re-flowed at the current width are the
+ * previous counts until they are visited; layout_all() makes them exact.
+ */
+class TextLayout {
+public:
+    void set_font(FontFace* font, float font_size_px);
+    void set_white_space(WidgetStyle::WhiteSpace white_space);
+    void set_word_break(WidgetStyle::WordBreak word_break);
+    void set_width(float max_width);
+
+    void set_text(std::string_view text);
+    void append_text(std::string_view text);
+    void clear();
+
+    const std::string& get_text() const { return source_; }
+    size_t get_paragraph_count() const { return paragraphs_.size(); }
+    size_t get_line_count() const;
+    float get_line_height() const { return line_height_; }
+    float get_height() const { return static_cast<float>(get_line_count()) * line_height_; }
+    bool wraps() const;
+
+    // Widest paragraph without wrapping (shapes every paragraph)
+    float get_natural_width();
+
+    // Re-flow every stale paragraph so line counts are exact
+    void layout_all();
+
+    // Line by index, re-flowing its paragraph if needed
+    bool get_line(size_t line_index, size_t& paragraph_index, TextLine& line);
+
+    // Batch the lines that intersect [clip_top, clip_bottom), in layout space
+    // where y = 0 is the top of the first line
+    void draw(CanvasRenderer* renderer, const Point2D& origin, const ColorRGBA& color,
+              TextAlign align, float box_width, float clip_top, float clip_bottom);
+
+private:
+    // A line may start at glyph `start`; the content before it ends at content_end
+    struct Break {
+        uint32_t start;
+        uint32_t content_end;
+    };
+
+    // Widths [min, max) for which a line breaks the same way
+    struct ValidRange {
+        float min;
+        float max;
+    };
+
+    struct Paragraph {
+        std::string text;                  // After white-space processing
+        ShapedRun run;                     // prefix_advances: pen x before each glyph, plus the width
+        std::vector<Break> breaks;         // Ascending; the last is the paragraph end
+        std::vector<TextLine> lines;
+        std::vector<ValidRange> line_ranges;
+        float natural_width = 0.0f;
+        ValidRange valid{0.0f, -1.0f};     // Intersection of line_ranges; empty = stale
+        bool shaped = false;
+    };
+
+    void split_paragraphs(std::string_view text, std::vector<std::string>& out) const;
+    void process_paragraph(std::string_view raw, std::string& out) const;
+    void invalidate_shaping();
+
+    void ensure_shaped(Paragraph& paragraph);
+    void ensure_layout(size_t index);
+    void break_line(const Paragraph& paragraph, uint32_t start, TextLine& line, ValidRange& range) const;
+    float span_width(const Paragraph& paragraph, uint32_t start, uint32_t end) const;
+
+    // Fenwick tree over line counts (1-based internally)
+    void rebuild_line_tree();
+    void push_line_count(uint32_t count);
+    void add_line_count(size_t index, int delta);
+    size_t lines_before(size_t paragraph_index) const;
+    size_t find_paragraph(size_t line_index) const;
+
+    std::string source_;
+    std::vector<Paragraph> paragraphs_;
+    std::vector<uint32_t> line_counts_;
+    std::vector<uint32_t> line_tree_;
+
+    FontFace* font_ = nullptr;
+    float font_size_ = 0.0f;
+    float line_height_ = 0.0f;
+    float ascender_ = 0.0f;
+    float max_width_ = 0.0f;
+    WidgetStyle::WhiteSpace white_space_ = WidgetStyle::WhiteSpace::Normal;
+    WidgetStyle::WordBreak word_break_ = WidgetStyle::WordBreak::Normal;
+
+    static constexpr int TAB_WIDTH = 4;  // Spaces per tab in preserved white space
+};
+
+} // namespace voxel_canvas
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Texture Residency - GPU texture accounting, budget and LRU eviction
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace voxel_canvas {
+
+// Who allocated a texture, for per-owner usage counters
+enum class TextureOwner : uint8_t {
+    Renderer,      // White, checker and gradient LUT textures
+    GlyphAtlas,    // FontSystem atlas pages
+    IconAtlas,     // IconSystem atlas pages
+    ShadowCache,   // Nine-patch shadow textures
+    RenderTarget,  // Blur and backdrop targets, including per-draw temporaries
+    Image,         // Textures loaded from image files
+    Count
+};
+
+const char* get_texture_owner_name(TextureOwner owner);
+
+/**
+ * Registry of every GL texture the canvas UI allocates. Owners report each
+ * texture with its size when it is created and again when they delete it,
+ * so get_usage() is the total the UI holds on the GPU.
+ *
+ * Textures registered with an eviction callback may be dropped when usage
+ * exceeds the budget: begin_frame() calls back the least recently touched
+ * ones that were not drawn during the previous frame until usage fits. The
+ * callback deletes the texture (and calls release()) and its owner
+ * recreates it on demand. Textures without a callback are counted but never
+ * evicted, so usage can stay above the budget.
+ *
+ * Render thread only, like the GL calls it accounts for.
+ */
+class TextureResidency {
+public:
+    using EvictCallback = std::function<void()>;
+
+    static constexpr size_t DEFAULT_BUDGET_BYTES = size_t{128} * 1024 * 1024;
+
+    static TextureResidency& get_instance();
+
+    // Driver-side size of a texture; RGB8 storage is padded to four bytes
+    static size_t get_texture_bytes(int width, int height, int bytes_per_texel = 4, bool mipmapped = false);
+
+    // Account for a texture the caller just created (or resized in place)
+    void track(unsigned int texture, size_t bytes, TextureOwner owner, EvictCallback evict = nullptr);
+
+    // The owner deleted the texture; unknown names are ignored
+    void release(unsigned int texture);
+
+    // Drawn this frame; only evictable textures need touching
+    void touch(unsigned int texture);
+
+    // Keep an evictable texture resident from now on
+    void pin(unsigned int texture);
+
+    // Evict down to the budget, then advance the LRU clock
+    void begin_frame();
+
+    void set_budget(size_t bytes) { budget_bytes_ = bytes; }
+    size_t get_budget() const { return budget_bytes_; }
+
+    size_t get_usage() const { return total_bytes_; }
+    size_t get_usage(TextureOwner owner) const { return owners_[static_cast<size_t>(owner)].bytes; }
+    size_t get_texture_count() const { return textures_.size(); }
+    size_t get_texture_count(TextureOwner owner) const { return owners_[static_cast<size_t>(owner)].count; }
+    size_t get_peak_usage() const { return peak_bytes_; }
+    uint64_t get_eviction_count() const { return eviction_count_; }
+
+    // One line per owner with a nonzero count
+    void print_usage() const;
+
+private:
+    struct Entry {
+        size_t bytes;
+        TextureOwner owner;
+        uint64_t last_used_frame;
+        EvictCallback evict;  // Empty when the texture must stay resident
+    };
+
+    struct OwnerUsage {
+        size_t bytes = 0;
+        size_t count = 0;
+    };
+
+    TextureResidency() = default;
+
+    void evict_to_budget();
+
+    std::unordered_map<unsigned int, Entry> textures_;
+    std::array<OwnerUsage, static_cast<size_t>(TextureOwner::Count)> owners_{};
+    size_t total_bytes_ = 0;
+    size_t peak_bytes_ = 0;
+    size_t budget_bytes_ = DEFAULT_BUDGET_BYTES;
+    uint64_t frame_ = 1;
+    uint64_t eviction_count_ = 0;
+};
+
+} // namespace voxel_canvas
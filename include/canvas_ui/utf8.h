@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * UTF-8 - codepoint decoding for the text pipeline
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace voxel_canvas {
+
+// Substituted for malformed or truncated sequences
+constexpr uint32_t UTF8_REPLACEMENT = 0xFFFD;
+
+inline bool is_utf8_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Decode the codepoint at index and advance past it. A malformed sequence
+// decodes as U+FFFD and advances one byte, so every byte is consumed.
+inline uint32_t decode_utf8(std::string_view text, size_t& index) {
+    unsigned char c = static_cast<unsigned char>(text[index]);
+    if (c < 0x80) {
+        index += 1;
+        return c;
+    }
+
+    size_t length;
+    uint32_t codepoint;
+    uint32_t min_value;
+    if ((c & 0xE0) == 0xC0) {
+        length = 2;
+        codepoint = c & 0x1Fu;
+        min_value = 0x80;
+    } else if ((c & 0xF0) == 0xE0) {
+        length = 3;
+        codepoint = c & 0x0Fu;
+        min_value = 0x800;
+    } else if ((c & 0xF8) == 0xF0) {
+        length = 4;
+        codepoint = c & 0x07u;
+        min_value = 0x10000;
+    } else {
+        index += 1;
+        return UTF8_REPLACEMENT;
+    }
+
+    if (index + length > text.size()) {
+        index += 1;
+        return UTF8_REPLACEMENT;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        char next = text[index + i];
+        if (!is_utf8_continuation(next)) {
+            index += 1;
+            return UTF8_REPLACEMENT;
+        }
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(next) & 0x3Fu);
+    }
+
+    // Overlong forms, surrogates and values past U+10FFFF
+    if (codepoint < min_value || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+        index += 1;
+        return UTF8_REPLACEMENT;
+    }
+    index += length;
+    return codepoint;
+}
+
+// Encode a codepoint into out, returning its length (1-4). Surrogates and
+// values past U+10FFFF encode as U+FFFD.
+inline size_t encode_utf8(uint32_t codepoint, char out[4]) {
+    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+        codepoint = UTF8_REPLACEMENT;
+    }
+    if (codepoint < 0x80) {
+        out[0] = static_cast<char>(codepoint);
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (codepoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (codepoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (codepoint >> 18));
+    out[1] = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+// Start of the codepoint before offset (0 at the start of the text)
+inline size_t utf8_previous(std::string_view text, size_t offset) {
+    if (offset == 0) {
+        return 0;
+    }
+    size_t start = offset - 1;
+    while (start > 0 && offset - start < 4 && is_utf8_continuation(text[start])) {
+        start--;
+    }
+    return start;
+}
+
+} // namespace voxel_canvas
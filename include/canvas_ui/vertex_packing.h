@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Vertex Packing - conversions for compact GPU vertex and instance formats
+ */
+
+#pragma once
+
+#include "canvas_core.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace voxel_canvas {
+
+// [0,1] -> normalized unsigned byte (GL_UNSIGNED_BYTE, normalized)
+inline uint8_t pack_unorm8(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+inline float unpack_unorm8(uint8_t value) {
+    return static_cast<float>(value) / 255.0f;
+}
+
+// [0,1] -> normalized unsigned short (GL_UNSIGNED_SHORT, normalized)
+inline uint16_t pack_unorm16(float value) {
+    return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+inline float unpack_unorm16(uint16_t value) {
+    return static_cast<float>(value) / 65535.0f;
+}
+
+// IEEE 754 binary16 (GL_HALF_FLOAT), round to nearest even.
+// Out-of-range values saturate to infinity; NaN stays NaN.
+inline uint16_t float_to_half(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFFu) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int half_exponent = static_cast<int>(exponent) - 127 + 15;
+    if (half_exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    if (half_exponent <= 0) {
+        // Subnormal half (or zero)
+        if (half_exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - half_exponent);
+        uint32_t half_mantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1u))) {
+            half_mantissa++;
+        }
+        return static_cast<uint16_t>(sign | half_mantissa);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;  // May carry into the exponent, which is still correct rounding
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline float half_to_float(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Normalize the subnormal
+            int shift = 0;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                shift++;
+            }
+            mantissa &= 0x3FFu;
+            bits = sign | (static_cast<uint32_t>(127 - 15 + 1 - shift) << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Widget instance, packed to 56 bytes: float rect, half-float geometry,
+// RGBA8 colors
+struct WidgetInstanceData {
+    float transform[4];         // x, y, width, height
+    uint16_t uv_rect[4];        // Half floats: texture coords (u0, v0, u1, v1), or
+                                // gradient geometry relative to the rect
+    uint8_t color[4];           // Fill RGBA8
+    uint8_t border_color[4];    // Border RGBA8
+    uint8_t outline_color[4];   // Outline RGBA8
+    uint16_t radii[4];          // Half floats: corner radius (tl, tr, br, bl)
+    uint16_t widths[4];         // Half floats: border width, outline width, outline offset, unused
+    uint16_t flags;             // Bits 0-3: gradient kind (0 = none), bits 4-15: gradient LUT row
+    uint16_t depth;             // Unorm16, assigned at flush from submission order (later = nearer)
+};
+static_assert(sizeof(WidgetInstanceData) == 56, "WidgetInstanceData must stay tightly packed");
+
+inline void pack_rgba8(uint8_t out[4], const ColorRGBA& color) {
+    out[0] = pack_unorm8(color.r);
+    out[1] = pack_unorm8(color.g);
+    out[2] = pack_unorm8(color.b);
+    out[3] = pack_unorm8(color.a);
+}
+
+inline ColorRGBA unpack_rgba8(const uint8_t in[4]) {
+    return ColorRGBA(unpack_unorm8(in[0]), unpack_unorm8(in[1]), unpack_unorm8(in[2]), unpack_unorm8(in[3]));
+}
+
+// Gradient kind in the low 4 bits, LUT row in the upper 12
+inline uint16_t pack_instance_flags(unsigned gradient_kind, unsigned lut_row) {
+    return static_cast<uint16_t>((gradient_kind & 0xFu) | ((lut_row & 0xFFFu) << 4));
+}
+
+inline unsigned instance_gradient_kind(uint16_t flags) { return flags & 0xFu; }
+inline unsigned instance_lut_row(uint16_t flags) { return static_cast<unsigned>(flags >> 4); }
+
+// A plain rounded rect with border and outline; uv_rect spans the texture
+inline WidgetInstanceData pack_widget_instance(const Rect2D& rect, const ColorRGBA& color,
+                                               float corner_radius, float border_width,
+                                               const ColorRGBA& border_color,
+                                               float outline_width, float outline_offset,
+                                               const ColorRGBA& outline_color) {
+    WidgetInstanceData instance = {};
+    instance.transform[0] = rect.x;
+    instance.transform[1] = rect.y;
+    instance.transform[2] = rect.width;
+    instance.transform[3] = rect.height;
+
+    pack_rgba8(instance.color, color);
+    pack_rgba8(instance.border_color, border_color);
+    pack_rgba8(instance.outline_color, outline_color);
+
+    instance.uv_rect[0] = float_to_half(0.0f);
+    instance.uv_rect[1] = float_to_half(0.0f);
+    instance.uv_rect[2] = float_to_half(1.0f);
+    instance.uv_rect[3] = float_to_half(1.0f);
+
+    // Same radius for all corners for now
+    uint16_t radius = float_to_half(std::max(corner_radius, 0.0f));
+    for (uint16_t& corner : instance.radii) {
+        corner = radius;
+    }
+
+    instance.widths[0] = float_to_half(std::max(border_width, 0.0f));
+    instance.widths[1] = float_to_half(std::max(outline_width, 0.0f));
+    instance.widths[2] = float_to_half(outline_offset);
+    return instance;
+}
+
+} // namespace voxel_canvas
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "canvas_core.h"
+#include "interned_id.h"
 #include "glad/gl.h"
 #include <optional>
 #include <string>
@@ -210,22 +211,26 @@ struct ColorValue {
     
     Type type = ThemeColor;
     ColorRGBA color;
-    std::string theme_ref = "gray_3";  // Default theme color
+    ThemeTokenId theme_token = default_theme_token();  // Interned once, when the style is built
     
     ColorValue() = default;
     ColorValue(const ColorRGBA& c) : type(Direct), color(c) {}
-    ColorValue(const std::string& theme_name) : type(ThemeColor), theme_ref(theme_name) {}
+    ColorValue(const std::string& theme_name) : type(ThemeColor), theme_token(ThemeTokenId::intern(theme_name)) {}
+    ColorValue(ThemeTokenId token) : type(ThemeColor), theme_token(token) {}
     
     static ColorValue inherit() { return ColorValue(); }
     
-    // Resolve to actual color
+    // "gray_3"
+    static ThemeTokenId default_theme_token();
+    
+    // Resolve to actual color; theme tokens index a table, no name compares
     ColorRGBA resolve(const ScaledTheme& theme) const;
     
     // Comparison operators
     bool operator==(const ColorValue& other) const {
         if (type != other.type) return false;
         if (type == Direct) return color == other.color;
-        if (type == ThemeColor) return theme_ref == other.theme_ref;
+        if (type == ThemeColor) return theme_token == other.theme_token;
         return true;  // Both are Inherit
     }
     bool operator!=(const ColorValue& other) const {
@@ -812,6 +817,7 @@ public:
         float line_height;
         int font_weight;
         std::string font_family;
+        FontId font_id;  // font_family interned, "default" when unset
         float opacity;
         Overflow overflow_x, overflow_y;
         
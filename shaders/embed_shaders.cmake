@@ -0,0 +1,36 @@
+# Copyright (C) 2024 Voxelux
+#
+# This software and its source code are proprietary and confidential.
+# All rights reserved. No part of this software may be reproduced,
+# distributed, or transmitted in any form or by any means without
+# prior written permission from Voxelux.
+#
+# Embeds GLSL files into a C++ header so shaders ship inside the binary.
+#
+# Usage: cmake -DOUTPUT=<header> -DSHADERS="NAME=path;NAME=path" -P embed_shaders.cmake
+
+if(NOT OUTPUT OR NOT SHADERS)
+    message(FATAL_ERROR "embed_shaders.cmake requires OUTPUT and SHADERS")
+endif()
+
+set(content "// Generated by shaders/embed_shaders.cmake - do not edit\n#pragma once\n\nnamespace voxel_canvas::embedded_shaders {\n")
+
+foreach(entry IN LISTS SHADERS)
+    string(FIND "${entry}" "=" split)
+    string(SUBSTRING "${entry}" 0 ${split} name)
+    math(EXPR path_start "${split} + 1")
+    string(SUBSTRING "${entry}" ${path_start} -1 path)
+    file(READ "${path}" source)
+    string(APPEND content "\ninline constexpr const char* ${name} = R\"glsl(${source})glsl\";\n")
+endforeach()
+
+string(APPEND content "\n} // namespace voxel_canvas::embedded_shaders\n")
+
+# Only touch the header when the sources changed to avoid needless rebuilds
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" existing)
+    if(existing STREQUAL content)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${content}")
@@ -79,7 +79,8 @@ bool InputEvent::is_mouse_event() const {
 
 bool InputEvent::is_keyboard_event() const {
     return type == EventType::KEY_PRESS ||
-           type == EventType::KEY_RELEASE;
+           type == EventType::KEY_RELEASE ||
+           type == EventType::TEXT_INPUT;
 }
 
 bool InputEvent::is_trackpad_event() const {
@@ -13,7 +13,9 @@
 #include "canvas_ui/canvas_renderer.h"
 #include "canvas_ui/canvas_window.h"
 #include "canvas_ui/font_system.h"
-#include "canvas_ui/polyline_shader.h"
+#include "canvas_ui/icon_system.h"
+#include "canvas_ui/image_loader.h"
+#include "canvas_ui/shader_cache.h"
 #include "canvas_ui/scaled_theme.h"
 #include <iostream>
 #include <fstream>
@@ -21,6 +23,8 @@
 #include <cmath>
 #include <algorithm>
 #include <cstddef>  // For offsetof
+#include <cstring>
+#include <limits>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -169,7 +173,7 @@ bool CanvasRenderer::initialize() {
     GLboolean blend_enabled;
     glGetBooleanv(GL_BLEND, &blend_enabled);
 
-    // Setup shaders
+    // Setup shaders (restored from the program binary cache when possible)
     setup_shaders();
     
     // Setup buffers
@@ -177,6 +181,7 @@ bool CanvasRenderer::initialize() {
     
     // Setup default textures
     setup_default_textures();
+    setup_gradient_lut();
 
     // Initialize font system
     font_system_ = std::make_unique<FontSystem>();
@@ -185,17 +190,13 @@ bool CanvasRenderer::initialize() {
         return false;
     }
     
-    // Initialize polyline shader for thick line rendering
-    polyline_shader_ = std::make_unique<PolylineShader>();
-    if (!polyline_shader_->initialize()) {
-        std::cerr << "Failed to initialize polyline shader" << std::endl;
-        // Non-fatal, fall back to regular line rendering
-    }
-    
     // Load default fonts (Inter)
     if (!font_system_->load_default_fonts()) {
         std::cerr << "Warning: Failed to load default fonts" << std::endl;
     }
+    default_font_ = font_system_->get_font("Inter");
+    
+    ShaderCache::get_instance().log_startup_summary("canvas renderer");
 
     // Set initial viewport
     Point2D fb_size = window_->get_framebuffer_size();
@@ -210,17 +211,52 @@ void CanvasRenderer::shutdown() {
         return;
     }
 
+    default_font_ = nullptr;
     font_system_.reset();
+    ImageLoader::get_instance().shutdown();
 
+    TextureResidency& residency = TextureResidency::get_instance();
     if (white_texture_) {
+        residency.release(white_texture_);
         glDeleteTextures(1, &white_texture_);
         white_texture_ = 0;
     }
     
     if (checker_texture_) {
+        residency.release(checker_texture_);
         glDeleteTextures(1, &checker_texture_);
         checker_texture_ = 0;
     }
+    
+    if (gradient_lut_texture_) {
+        residency.release(gradient_lut_texture_);
+        glDeleteTextures(1, &gradient_lut_texture_);
+        gradient_lut_texture_ = 0;
+    }
+    gradient_lut_rows_.clear();
+    gradient_lut_index_.clear();
+
+    shadow_cache_.clear();
+
+    if (blur_fbo_) {
+        glDeleteFramebuffers(1, &blur_fbo_);
+        blur_fbo_ = 0;
+        residency.release(blur_texture_);
+        glDeleteTextures(1, &blur_texture_);
+        blur_texture_ = 0;
+        blur_texture_width_ = 0;
+        blur_texture_height_ = 0;
+    }
+
+    if (backdrop_fbo_) {
+        glDeleteFramebuffers(1, &backdrop_fbo_);
+        backdrop_fbo_ = 0;
+        residency.release(backdrop_texture_);
+        glDeleteTextures(1, &backdrop_texture_);
+        backdrop_texture_ = 0;
+        backdrop_texture_width_ = 0;
+        backdrop_texture_height_ = 0;
+    }
 
     ui_shader_.reset();
     text_shader_.reset();
@@ -239,6 +275,18 @@ void CanvasRenderer::shutdown() {
         glDeleteBuffers(1, &ui_ebo_);
         ui_ebo_ = 0;
     }
+    
+    segment_shader_.reset();
+    
+    if (segment_vao_) {
+        glDeleteVertexArrays(1, &segment_vao_);
+        segment_vao_ = 0;
+    }
+    
+    if (segment_vbo_) {
+        glDeleteBuffers(1, &segment_vbo_);
+        segment_vbo_ = 0;
+    }
 
     initialized_ = false;
 }
@@ -249,6 +297,7 @@ void CanvasRenderer::begin_frame() {
     
     draw_calls_this_frame_ = 0;
     vertices_this_frame_ = 0;
+    opaque_instances_this_frame_ = 0;
     
     // Clear render batches
     render_batches_.clear();
@@ -259,7 +308,25 @@ void CanvasRenderer::begin_frame() {
     current_batch_.indices.clear();
     
     // Start occlusion tracking for this frame
-    occlusion_tracker_.begin_frame();
+    occlusion_tracker_.begin_frame(viewport_width_, viewport_height_);
+    
+    // Age out path tessellations that are no longer drawn
+    path_cache_.begin_frame();
+    
+    // Age the glyph atlas pages and land glyphs the rasterizer workers
+    // finished since the last frame
+    if (font_system_) {
+        font_system_->begin_frame();
+    }
+    
+    // Same for the icon atlas pages
+    IconSystem::get_instance().begin_frame();
+    
+    // Stream decoded images into their textures within the upload budget
+    ImageLoader::get_instance().begin_frame();
+    
+    // Drop idle evictable textures if the UI is over its texture budget
+    TextureResidency::get_instance().begin_frame();
     
     // Force flush any pending OpenGL commands first
     glFlush();
@@ -285,6 +352,9 @@ void CanvasRenderer::end_frame() {
     // Flush any pending instance data FIRST (most efficient)
     flush_instances();
     
+    // Anti-aliased line segments draw over widget backgrounds
+    flush_segments();
+    
     // Flush any pending batched draw calls (for text/icons)
     flush_current_batch();
     
@@ -299,6 +369,9 @@ void CanvasRenderer::end_frame() {
     // End occlusion tracking for this frame
     occlusion_tracker_.end_frame();
     
+    // Finish any background shader links the driver has completed
+    ShaderCache::get_instance().poll();
+    
     // CRITICAL: Reset OpenGL state after UI rendering
     glDisable(GL_SCISSOR_TEST);
     check_gl_error("disable scissor test");
@@ -329,10 +402,11 @@ void CanvasRenderer::set_viewport(int x, int y, int width, int height) {
     check_gl_error("glViewport");
     
     // Standard orthographic projection for UI rendering
-    // Maps screen coordinates: (0,0) = top-left, (width,height) = bottom-right
+    // Maps screen coordinates: (0,0) = top-left, extent = bottom-right
+    Point2D extent = get_projection_extent();
     float projection[16] = {
-        2.0f / width,  0,             0, 0,
-        0,            -2.0f / height, 0, 0,  // Negative Y to flip coordinates (top-left origin)
+        2.0f / extent.x,  0,             0, 0,
+        0,            -2.0f / extent.y, 0, 0,  // Negative Y to flip coordinates (top-left origin)
         0,             0,            -1, 0,
         -1,            1,             0, 1   // Translate to NDC space
     };
@@ -353,17 +427,28 @@ Point2D CanvasRenderer::get_viewport_size() const {
     return Point2D(static_cast<float>(viewport_width_), static_cast<float>(viewport_height_));
 }
 
+void CanvasRenderer::set_presentation_scale(float scale) {
+    scale = scale > 0.0f ? scale : 1.0f;
+    if (scale == presentation_scale_) {
+        return;
+    }
+    presentation_scale_ = scale;
+    set_viewport(viewport_x_, viewport_y_, viewport_width_, viewport_height_);
+}
+
+Point2D CanvasRenderer::get_projection_extent() const {
+    return Point2D(std::max(1.0f, static_cast<float>(viewport_width_) / presentation_scale_),
+                   std::max(1.0f, static_cast<float>(viewport_height_) / presentation_scale_));
+}
+
 void CanvasRenderer::get_projection_matrix(float* matrix) const {
     if (!matrix) return;
     
     // Create orthographic projection matrix for 2D rendering
     // Maps screen coordinates to NDC (-1 to 1)
-    float width = static_cast<float>(viewport_width_);
-    float height = static_cast<float>(viewport_height_);
-    
-    // Prevent division by zero
-    if (width <= 0) width = 1.0f;
-    if (height <= 0) height = 1.0f;
+    Point2D extent = get_projection_extent();
+    float width = extent.x;
+    float height = extent.y;
     
     // Column-major order for OpenGL
     matrix[0] = 2.0f / width;   matrix[4] = 0.0f;           matrix[8] = 0.0f;  matrix[12] = -1.0f;
@@ -373,8 +458,11 @@ void CanvasRenderer::get_projection_matrix(float* matrix) const {
 }
 
 float CanvasRenderer::get_content_scale() const {
+    // Per drawing unit: while a scale change is pre-warmed the layout stays
+    // at the previous scale and is stretched by the presentation scale, so
+    // this is the layout's scale, not the window's new one
     if (window_) {
-        return window_->get_content_scale();
+        return window_->get_content_scale() / presentation_scale_;
     }
     return 1.0f;
 }
@@ -447,36 +535,113 @@ void CanvasRenderer::draw_line_batched(const Point2D& start, const Point2D& end,
     vertices_this_frame_ += 4;
 }
 
+// Anti-aliased lines - one instance per segment, expanded in the vertex shader
+void CanvasRenderer::draw_line_aa(const Point2D& start, const Point2D& end, const ColorRGBA& color,
+                                  float width, bool round_caps) {
+    add_segment_instance(start, end, color, width, round_caps);
+}
+
+void CanvasRenderer::draw_polyline(const std::vector<Point2D>& points, const ColorRGBA& color, float width) {
+    // Round caps on every segment cover the joins by overlap, no join
+    // geometry needed; each segment leaves out what the previous one drew
+    // so translucent lines do not blend twice at the joints
+    for (size_t i = 1; i < points.size(); ++i) {
+        add_segment_instance(points[i - 1], points[i], color, width, true, i > 1 ? &points[i - 2] : nullptr);
+    }
+}
+
+void CanvasRenderer::add_segment_instance(const Point2D& start, const Point2D& end, const ColorRGBA& color,
+                                          float width, bool round_caps, const Point2D* previous) {
+    if (segment_instances_.size() >= max_segment_instances_) {
+        flush_segments();
+    }
+    
+    SegmentInstanceData segment;
+    segment.endpoints[0] = start.x;
+    segment.endpoints[1] = start.y;
+    segment.endpoints[2] = end.x;
+    segment.endpoints[3] = end.y;
+    segment.color[0] = color.r;
+    segment.color[1] = color.g;
+    segment.color[2] = color.b;
+    segment.color[3] = color.a;
+    segment.params[0] = width * 0.5f;
+    segment.params[1] = round_caps ? 1.0f : 0.0f;
+    segment.params[2] = previous ? 1.0f : 0.0f;
+    segment.params[3] = 0.0f;
+    segment.previous[0] = previous ? previous->x : start.x;
+    segment.previous[1] = previous ? previous->y : start.y;
+    segment_instances_.push_back(segment);
+}
+
+void CanvasRenderer::flush_pending_segments() {
+    // Segments draw under the scissor they were queued in and over the
+    // widgets queued before them, so they go out before either changes
+    if (!segment_instances_.empty()) {
+        flush_instances();
+        flush_segments();
+    }
+}
+
+void CanvasRenderer::flush_segments() {
+    if (segment_instances_.empty()) {
+        return;
+    }
+    
+    if (!segment_shader_ || !segment_shader_->is_valid()) {
+        segment_instances_.clear();
+        return;
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, segment_vbo_);
+    size_t data_size = segment_instances_.size() * sizeof(SegmentInstanceData);
+    
+    // Orphan, then upload only the live range
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(max_segment_instances_ * sizeof(SegmentInstanceData)),
+                 nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(data_size), segment_instances_.data());
+    
+    segment_shader_->use();
+    
+    Point2D extent = get_projection_extent();
+    float vp_width = extent.x;
+    float vp_height = extent.y;
+    float projection[16] = {
+        2.0f / vp_width,  0,                  0, 0,
+        0,               -2.0f / vp_height,    0, 0,
+        0,                0,                  -1, 0,
+        -1,               1,                   0, 1
+    };
+    segment_shader_->set_uniform("u_projection", projection, 16);
+    
+    glBindVertexArray(segment_vao_);
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    // Four strip vertices per segment, generated from gl_VertexID
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(segment_instances_.size()));
+    
+    draw_calls_this_frame_++;
+    vertices_this_frame_ += static_cast<int>(4 * segment_instances_.size());
+    
+    segment_instances_.clear();
+    
+    glBindVertexArray(0);
+    segment_shader_->unuse();
+}
+
 // Viewport immediate rendering - for 3D overlays like navigation widget
 void CanvasRenderer::draw_viewport_line(const Point2D& start, const Point2D& end, const ColorRGBA& color, float width) {
-    // Use polyline shader if available and line is thick
-    if (polyline_shader_ && polyline_shader_->is_valid() && width > 1.0f) {
-        polyline_shader_->use();
-        
-        // Set uniforms
-        float projection[16];
-        get_projection_matrix(projection);
-        polyline_shader_->set_projection(projection);
-        polyline_shader_->set_viewport_size(viewport_width_, viewport_height_);
-        polyline_shader_->set_line_width(width);
-        polyline_shader_->set_line_smooth(true);  // Enable anti-aliasing
-        
-        // Enable blending for smooth edges
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        // Draw the line
-        polyline_shader_->draw_line(start.x, start.y, end.x, end.y, 
-                                   color.r, color.g, color.b, color.a);
-        
-        polyline_shader_->unuse();
-        
-        draw_calls_this_frame_++;
-        vertices_this_frame_ += 2;
+    // Thick viewport lines use the instanced AA segment renderer, drawn immediately
+    if (segment_shader_ && segment_shader_->is_valid() && width > 1.0f) {
+        flush_segments();
+        add_segment_instance(start, end, color, width, true);
+        flush_segments();
         return;
     }
     
-    // Fallback to quad-based approach if polyline shader not available
+    // Fallback to quad-based approach if the segment shader is not available
     if (!ui_shader_ || !ui_shader_->is_valid()) {
         return;
     }
@@ -505,8 +670,9 @@ void CanvasRenderer::draw_viewport_line(const Point2D& start, const Point2D& end
     ui_shader_->use();
     
     // Set projection matrix
-    float vp_width = std::max(1.0f, static_cast<float>(viewport_width_));
-    float vp_height = std::max(1.0f, static_cast<float>(viewport_height_));
+    Point2D extent = get_projection_extent();
+    float vp_width = extent.x;
+    float vp_height = extent.y;
     float projection[16] = {
         2.0f / vp_width,  0,                  0, 0,
         0,               -2.0f / vp_height,    0, 0,
@@ -527,9 +693,12 @@ void CanvasRenderer::draw_viewport_line(const Point2D& start, const Point2D& end
     if (white_texture_ == 0 || !glIsTexture(white_texture_)) {
         // Recreate texture if invalid
         GLubyte white_pixel[4] = {255, 255, 255, 255};
+        TextureResidency::get_instance().release(white_texture_);
         glGenTextures(1, &white_texture_);
         glBindTexture(GL_TEXTURE_2D, white_texture_);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white_pixel);
+        TextureResidency::get_instance().track(white_texture_, TextureResidency::get_texture_bytes(1, 1),
+                                               TextureOwner::Renderer);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     } else {
@@ -730,8 +899,9 @@ void CanvasRenderer::draw_viewport_circle_ring(const Point2D& center, float radi
     ui_shader_->use();
     
     // Set projection matrix
-    float vp_width = std::max(1.0f, static_cast<float>(viewport_width_));
-    float vp_height = std::max(1.0f, static_cast<float>(viewport_height_));
+    Point2D extent = get_projection_extent();
+    float vp_width = extent.x;
+    float vp_height = extent.y;
     float projection[16] = {
         2.0f / vp_width,  0,                  0, 0,
         0,               -2.0f / vp_height,    0, 0,
@@ -780,21 +950,19 @@ void CanvasRenderer::draw_text(const std::string& text, const Point2D& position,
     if (font_system_) {
         Point2D adjusted_pos = position;
         
-        // Get actual font metrics from the font system
-        FontFace* font = font_system_->get_font("Inter");
+        // Default font handle is resolved once at startup
+        FontFace* font = default_font_;
         if (!font) {
             // Font not found - can't render
             return;
         }
         
-        // Get real font metrics
-        float ascender = font->get_ascender(static_cast<int>(size));
-        float descender = font->get_descender(static_cast<int>(size));
+        // One cache probe gives metrics, width and glyph quads
+        const ShapedRun& run = font_system_->get_shaped_run(font, text, static_cast<float>(static_cast<int>(size)), true);
+        float ascender = run.measurement.ascender;
+        float descender = run.measurement.descender;
         float text_height = ascender - descender; // descender is negative
-        
-        // Measure text width for horizontal alignment
-        Point2D text_size = font_system_->measure_text(text, "Inter", static_cast<int>(size));
-        float text_width = text_size.x;
+        float text_width = run.measurement.width;
         
         // Adjust X position based on horizontal alignment
         switch (align) {
@@ -831,9 +999,8 @@ void CanvasRenderer::draw_text(const std::string& text, const Point2D& position,
                 break;
         }
         
-        // NEW: Batch text rendering
-        // Get glyphs and add them as textured quads to the current batch
-        batch_text(text, adjusted_pos, "Inter", static_cast<int>(size), color);
+        // Add the run's glyph quads to the current batch
+        batch_text_run(run, adjusted_pos, ascender, color);
     }
 }
 
@@ -848,80 +1015,68 @@ void CanvasRenderer::batch_text(const std::string& text, const Point2D& position
         return;
     }
     
-    float x = position.x;
-    float y = position.y;
-    float baseline_y = y + font->get_ascender(size);
+    const ShapedRun& run = font_system_->get_shaped_run(font, text, static_cast<float>(size), true);
+    batch_text_run(run, position, run.measurement.ascender, color);
+}
+
+void CanvasRenderer::batch_text_run(const ShapedRun& run, const Point2D& position, float ascender,
+                                    const ColorRGBA& color, size_t glyph_begin, size_t glyph_end) {
+    if (run.prefix_advances.empty()) {
+        return;
+    }
     
-    // Process each character
-    for (size_t i = 0; i < text.length(); ) {
-        unsigned int codepoint = 0;
-        // Simple ASCII extraction for now
-        if (i < text.length()) {
-            codepoint = static_cast<unsigned char>(text[i]);
-            i++;
+    // Keep the baseline on the pixel grid; glyph quads scale the shared field
+    glyph_begin = std::min(glyph_begin, run.glyph_count());
+    float origin_x = position.x - run.prefix_advances[glyph_begin];
+    float baseline_y = std::round(position.y + ascender);
+    
+    // Quads are in glyph order; skip to the range, stop past its end
+    auto first = std::lower_bound(run.quads.begin(), run.quads.end(), glyph_begin,
+                                  [](const GlyphQuad& quad, size_t index) {
+                                      return quad.glyph_index < index;
+                                  });
+    for (auto it = first; it != run.quads.end(); ++it) {
+        const GlyphQuad& quad = *it;
+        if (quad.glyph_index >= glyph_end) {
+            break;
         }
         
-        GlyphInfo* glyph = font->get_glyph(codepoint, size);
-        if (glyph && glyph->texture_id) {
-            // Calculate glyph position
-            float glyph_x = x + glyph->bearing.x;
-            float glyph_y = baseline_y - glyph->bearing.y;
-            float glyph_w = glyph->size.x;
-            float glyph_h = glyph->size.y;
-            
-            // Check if we need to switch textures
-            if (!current_batch_.can_batch_with(glyph->texture_id, GL_SRC_ALPHA, ui_shader_->get_id())) {
-                flush_current_batch();
-                current_batch_.texture_id = glyph->texture_id;
-                current_batch_.blend_mode = GL_SRC_ALPHA;
-                current_batch_.shader_id = ui_shader_->get_id();
-            }
-            
-            // Always mark as text batch when rendering glyphs
-            current_batch_.is_text = true;
-            
-            // Add glyph quad to batch
-            uint32_t base_index = static_cast<uint32_t>(current_batch_.vertices.size());
-            
-            // Calculate UVs
-            float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
-            if (glyph->in_atlas) {
-                u0 = glyph->uv_rect.x;
-                v0 = glyph->uv_rect.y;
-                u1 = glyph->uv_rect.x + glyph->uv_rect.width;
-                v1 = glyph->uv_rect.y + glyph->uv_rect.height;
-            }
-            
-            // Add vertices (with texture coords)
-            current_batch_.vertices.push_back(UIVertex(
-                glyph_x, glyph_y, u0, v0,
-                color.r, color.g, color.b, color.a
-            ));
-            current_batch_.vertices.push_back(UIVertex(
-                glyph_x + glyph_w, glyph_y, u1, v0,
-                color.r, color.g, color.b, color.a
-            ));
-            current_batch_.vertices.push_back(UIVertex(
-                glyph_x + glyph_w, glyph_y + glyph_h, u1, v1,
-                color.r, color.g, color.b, color.a
-            ));
-            current_batch_.vertices.push_back(UIVertex(
-                glyph_x, glyph_y + glyph_h, u0, v1,
-                color.r, color.g, color.b, color.a
-            ));
-            
-            // Add indices
-            current_batch_.indices.push_back(base_index + 0);
-            current_batch_.indices.push_back(base_index + 1);
-            current_batch_.indices.push_back(base_index + 2);
-            current_batch_.indices.push_back(base_index + 2);
-            current_batch_.indices.push_back(base_index + 3);
-            current_batch_.indices.push_back(base_index + 0);
+        // Check if we need to switch textures
+        if (!current_batch_.can_batch_with(quad.texture_id, GL_SRC_ALPHA, ui_shader_->get_id())) {
+            flush_current_batch();
+            current_batch_.texture_id = quad.texture_id;
+            current_batch_.blend_mode = GL_SRC_ALPHA;
+            current_batch_.shader_id = ui_shader_->get_id();
         }
         
-        if (glyph) {
-            x += glyph->advance;
-        }
+        // Always mark as text batch when rendering glyphs
+        current_batch_.is_text = true;
+        
+        // Add glyph quad to batch
+        uint32_t base_index = static_cast<uint32_t>(current_batch_.vertices.size());
+        
+        float x0 = origin_x + quad.x0;
+        float y0 = baseline_y + quad.y0;
+        float x1 = origin_x + quad.x1;
+        float y1 = baseline_y + quad.y1;
+        float u0 = quad.uv_rect.x;
+        float v0 = quad.uv_rect.y;
+        float u1 = quad.uv_rect.x + quad.uv_rect.width;
+        float v1 = quad.uv_rect.y + quad.uv_rect.height;
+        
+        // Add vertices (with texture coords)
+        current_batch_.vertices.push_back(UIVertex(x0, y0, u0, v0, color.r, color.g, color.b, color.a));
+        current_batch_.vertices.push_back(UIVertex(x1, y0, u1, v0, color.r, color.g, color.b, color.a));
+        current_batch_.vertices.push_back(UIVertex(x1, y1, u1, v1, color.r, color.g, color.b, color.a));
+        current_batch_.vertices.push_back(UIVertex(x0, y1, u0, v1, color.r, color.g, color.b, color.a));
+        
+        // Add indices
+        current_batch_.indices.push_back(base_index + 0);
+        current_batch_.indices.push_back(base_index + 1);
+        current_batch_.indices.push_back(base_index + 2);
+        current_batch_.indices.push_back(base_index + 2);
+        current_batch_.indices.push_back(base_index + 3);
+        current_batch_.indices.push_back(base_index + 0);
     }
 }
 
@@ -1186,6 +1341,18 @@ void CanvasRenderer::push_clip(const Rect2D& rect) {
     enable_scissor(clip_stack_.back());
 }
 
+Rect2D CanvasRenderer::get_visible_rect() const {
+    if (!transform_stack_.empty()) {
+        float huge = std::numeric_limits<float>::max() / 4;
+        return Rect2D(-huge, -huge, 2 * huge, 2 * huge);
+    }
+    if (!clip_stack_.empty()) {
+        return clip_stack_.back();
+    }
+    Point2D extent = get_projection_extent();
+    return Rect2D(0, 0, extent.x, extent.y);
+}
+
 void CanvasRenderer::pop_clip() {
     if (!clip_stack_.empty()) {
         // State change - flush pending batch
@@ -1219,69 +1386,39 @@ void CanvasRenderer::pop_opacity() {
 }
 
 // Advanced rendering methods
+// Gradients are widget instances that sample a shared stop lookup table, so they
+// batch with ordinary rects and cost no per-frame CPU work beyond the instance itself
 void CanvasRenderer::draw_linear_gradient(const Rect2D& rect, float angle_degrees,
                                          const std::vector<std::pair<ColorRGBA, float>>& stops) {
     if (stops.size() < 2) return;
     
-    // Convert angle to radians and calculate direction
+    // CSS convention: 0deg points up, angles increase clockwise
     float radians = angle_degrees * static_cast<float>(M_PI / 180.0);
     float dx = std::sin(radians);
     float dy = -std::cos(radians);
     
-    // For simplicity, we'll approximate with multiple rectangles
-    // In a real implementation, this would use a shader
-    const int segments = 20;
+    // Gradient line passes through the center and just reaches the far corners
+    float half_length = (std::abs(rect.width * dx) + std::abs(rect.height * dy)) * 0.5f;
+    float cx = rect.x + rect.width * 0.5f;
+    float cy = rect.y + rect.height * 0.5f;
     
-    for (int i = 0; i < segments; i++) {
-        float t = static_cast<float>(i) / segments;
-        float next_t = static_cast<float>(i + 1) / segments;
-        
-        // Interpolate color based on stops
-        ColorRGBA color = interpolate_gradient_color(stops, t);
-        ColorRGBA next_color = interpolate_gradient_color(stops, next_t);
-        
-        // Calculate segment bounds
-        Rect2D segment_rect;
-        if (std::abs(dx) > std::abs(dy)) {
-            // More horizontal
-            segment_rect.x = rect.x + rect.width * t;
-            segment_rect.y = rect.y;
-            segment_rect.width = rect.width / segments;
-            segment_rect.height = rect.height;
-        } else {
-            // More vertical
-            segment_rect.x = rect.x;
-            segment_rect.y = rect.y + rect.height * t;
-            segment_rect.width = rect.width;
-            segment_rect.height = rect.height / segments;
-        }
-        
-        // Draw gradient segment
-        draw_gradient_rect(segment_rect, color, next_color, std::abs(dx) > std::abs(dy));
-    }
+    float geometry[4] = {
+        cx - dx * half_length, cy - dy * half_length,  // start
+        cx + dx * half_length, cy + dy * half_length   // end
+    };
+    add_gradient_instance(rect, GRADIENT_LINEAR, geometry, get_gradient_lut_row(stops));
 }
 
-void CanvasRenderer::draw_radial_gradient([[maybe_unused]] const Rect2D& rect, const Point2D& center,
+void CanvasRenderer::draw_radial_gradient(const Rect2D& rect, const Point2D& center,
                                          float radius_x, float radius_y,
                                          const std::vector<std::pair<ColorRGBA, float>>& stops) {
     if (stops.size() < 2) return;
     
-    // Approximate with concentric ellipses
-    const int rings = 20;
-    
-    for (int i = rings - 1; i >= 0; i--) {
-        float t = static_cast<float>(i) / rings;
-        ColorRGBA color = interpolate_gradient_color(stops, t);
-        
-        float current_rx = radius_x * t;
-        float current_ry = radius_y * t;
-        
-        // Draw filled ellipse (approximated with circle for now)
-        float avg_radius = (current_rx + current_ry) / 2;
-        // TODO: Implement batched circle drawing for gradients
-        // For now, approximate with a rectangle
-        draw_rect(Rect2D(center.x - avg_radius, center.y - avg_radius, avg_radius * 2, avg_radius * 2), color);
-    }
+    float geometry[4] = {
+        center.x, center.y,
+        std::max(radius_x, 0.001f), std::max(radius_y, 0.001f)
+    };
+    add_gradient_instance(rect, GRADIENT_RADIAL, geometry, get_gradient_lut_row(stops));
 }
 
 void CanvasRenderer::draw_conic_gradient(const Rect2D& rect, const Point2D& center,
@@ -1289,32 +1426,11 @@ void CanvasRenderer::draw_conic_gradient(const Rect2D& rect, const Point2D& cent
                                         const std::vector<std::pair<ColorRGBA, float>>& stops) {
     if (stops.size() < 2) return;
     
-    // Approximate with triangular segments
-    const int segments = 36;  // 10-degree segments
-    
-    for (int i = 0; i < segments; i++) {
-        float t = static_cast<float>(i) / segments;
-        float angle = start_angle + t * 360.0f;
-        float next_angle = start_angle + (t + 1.0f / segments) * 360.0f;
-        
-        ColorRGBA color = interpolate_gradient_color(stops, t);
-        
-        // Draw triangular segment from center
-        float rad1 = angle * static_cast<float>(M_PI / 180.0);
-        float rad2 = next_angle * static_cast<float>(M_PI / 180.0);
-        
-        float radius = std::max(rect.width, rect.height);
-        Point2D p1 = center;
-        Point2D p2(center.x + radius * std::cos(rad1), center.y + radius * std::sin(rad1));
-        Point2D p3(center.x + radius * std::cos(rad2), center.y + radius * std::sin(rad2));
-        
-        // Draw triangle (simplified - would need proper triangle rendering)
-        // TODO: Implement proper triangle rendering for conic gradients
-        // For now, use batched lines
-        draw_line_batched(p1, p2, color, 1);
-        draw_line_batched(p2, p3, color, 1);
-        draw_line_batched(p3, p1, color, 1);
-    }
+    float geometry[4] = {
+        center.x, center.y,
+        start_angle * static_cast<float>(M_PI / 180.0), 0.0f
+    };
+    add_gradient_instance(rect, GRADIENT_CONIC, geometry, get_gradient_lut_row(stops));
 }
 
 // Helper function to interpolate gradient colors
@@ -1324,6 +1440,10 @@ ColorRGBA CanvasRenderer::interpolate_gradient_color(
     if (stops.empty()) return ColorRGBA(0, 0, 0, 0);
     if (stops.size() == 1) return stops[0].first;
     
+    // Outside the stop range the end colors extend
+    if (position <= stops.front().second) return stops.front().first;
+    if (position >= stops.back().second) return stops.back().first;
+    
     // Find the two stops to interpolate between
     size_t lower_idx = 0;
     size_t upper_idx = stops.size() - 1;
@@ -1353,43 +1473,148 @@ ColorRGBA CanvasRenderer::interpolate_gradient_color(
 
 void CanvasRenderer::draw_gradient_rect(const Rect2D& rect, const ColorRGBA& top_color, 
                                        const ColorRGBA& bottom_color, bool horizontal) {
-    RenderBatch batch;
-    batch.layer = RenderLayer::UI_CONTENT;
-    batch.texture_id = white_texture_;
-    
-    uint32_t base_index = 0;
-    
-    if (horizontal) {
-        // Horizontal gradient (left to right)
-        batch.vertices.emplace_back(rect.x, rect.y, 0, 0, 
-                                   top_color.r, top_color.g, top_color.b, top_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x + rect.width, rect.y, 1, 0,
-                                   bottom_color.r, bottom_color.g, bottom_color.b, bottom_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x + rect.width, rect.y + rect.height, 1, 1,
-                                   bottom_color.r, bottom_color.g, bottom_color.b, bottom_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x, rect.y + rect.height, 0, 1,
-                                   top_color.r, top_color.g, top_color.b, top_color.a * global_opacity_);
-    } else {
-        // Vertical gradient (top to bottom)
-        batch.vertices.emplace_back(rect.x, rect.y, 0, 0,
-                                   top_color.r, top_color.g, top_color.b, top_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x + rect.width, rect.y, 1, 0,
-                                   top_color.r, top_color.g, top_color.b, top_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x + rect.width, rect.y + rect.height, 1, 1,
-                                   bottom_color.r, bottom_color.g, bottom_color.b, bottom_color.a * global_opacity_);
-        batch.vertices.emplace_back(rect.x, rect.y + rect.height, 0, 1,
-                                   bottom_color.r, bottom_color.g, bottom_color.b, bottom_color.a * global_opacity_);
+    // Two-stop linear gradient: left to right, or top to bottom
+    std::vector<std::pair<ColorRGBA, float>> stops = {
+        {top_color, 0.0f},
+        {bottom_color, 1.0f}
+    };
+    draw_linear_gradient(rect, horizontal ? 90.0f : 180.0f, stops);
+}
+
+int CanvasRenderer::get_gradient_lut_row(const std::vector<std::pair<ColorRGBA, float>>& stops) {
+    // FNV-1a over the raw stop data
+    size_t stop_bytes = stops.size() * sizeof(stops[0]);
+    uint64_t hash = 14695981039346656037ull;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(stops.data());
+    for (size_t i = 0; i < stop_bytes; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
     }
     
-    // Add indices for the quad
-    batch.indices.push_back(base_index + 0);
-    batch.indices.push_back(base_index + 1);
-    batch.indices.push_back(base_index + 2);
-    batch.indices.push_back(base_index + 0);
-    batch.indices.push_back(base_index + 2);
-    batch.indices.push_back(base_index + 3);
+    // Rows sharing the hash are only a hit if their stops match
+    gradient_lut_clock_++;
+    auto range = gradient_lut_index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        GradientLutRow& entry = gradient_lut_rows_[static_cast<size_t>(it->second)];
+        if (entry.stops.size() == stops.size() &&
+            std::memcmp(entry.stops.data(), stops.data(), stop_bytes) == 0) {
+            entry.last_used = gradient_lut_clock_;
+            entry.instance_flush = instance_flush_count_;
+            return it->second;
+        }
+    }
+    
+    int row = allocate_gradient_lut_row();
+    GradientLutRow& entry = gradient_lut_rows_[static_cast<size_t>(row)];
+    entry.stops = stops;
+    entry.hash = hash;
+    entry.last_used = gradient_lut_clock_;
+    entry.instance_flush = instance_flush_count_;
+    gradient_lut_index_.emplace(hash, row);
+    
+    // Bake the stops once; the shader only ever samples this row
+    GLubyte texels[GRADIENT_LUT_WIDTH * 4];
+    for (int i = 0; i < GRADIENT_LUT_WIDTH; ++i) {
+        float t = static_cast<float>(i) / (GRADIENT_LUT_WIDTH - 1);
+        ColorRGBA color = interpolate_gradient_color(stops, t);
+        texels[i * 4 + 0] = static_cast<GLubyte>(std::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 1] = static_cast<GLubyte>(std::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 2] = static_cast<GLubyte>(std::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 3] = static_cast<GLubyte>(std::clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, gradient_lut_texture_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, GRADIENT_LUT_WIDTH, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    return row;
+}
+
+int CanvasRenderer::allocate_gradient_lut_row() {
+    if (gradient_lut_rows_.size() < static_cast<size_t>(GRADIENT_LUT_ROWS)) {
+        gradient_lut_rows_.emplace_back();
+        return static_cast<int>(gradient_lut_rows_.size() - 1);
+    }
+    
+    // Least recently used row that no queued instance samples; if queued
+    // instances sample every row, draw them first
+    auto find_victim = [this]() {
+        int victim = -1;
+        for (size_t i = 0; i < gradient_lut_rows_.size(); ++i) {
+            const GradientLutRow& entry = gradient_lut_rows_[i];
+            if (entry.instance_flush != instance_flush_count_ &&
+                (victim < 0 || entry.last_used < gradient_lut_rows_[static_cast<size_t>(victim)].last_used)) {
+                victim = static_cast<int>(i);
+            }
+        }
+        return victim;
+    };
+    int row = find_victim();
+    if (row < 0) {
+        flush_instances();
+        row = find_victim();
+    }
+    if (row < 0) {
+        row = 0;  // Instances could not be drawn; reuse a row rather than fail
+    }
     
-    submit_batch(batch);
+    GradientLutRow& entry = gradient_lut_rows_[static_cast<size_t>(row)];
+    auto range = gradient_lut_index_.equal_range(entry.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == row) {
+            gradient_lut_index_.erase(it);
+            break;
+        }
+    }
+    return row;
+}
+
+void CanvasRenderer::add_gradient_instance(const Rect2D& rect, GradientKind kind,
+                                          const float geometry[4], int lut_row) {
+    if (rect.width <= 0 || rect.height <= 0) {
+        return;
+    }
+    
+    flush_pending_segments();
+    if (instance_data_.size() >= max_instances_) {
+        flush_instances();
+    }
+    
+    WidgetInstanceData instance = {};
+    
+    instance.transform[0] = rect.x;
+    instance.transform[1] = rect.y;
+    instance.transform[2] = rect.width;
+    instance.transform[3] = rect.height;
+    
+    // LUT color is modulated by the instance color
+    instance.color[0] = 255;
+    instance.color[1] = 255;
+    instance.color[2] = 255;
+    instance.color[3] = pack_unorm8(global_opacity_);
+    
+    // Geometry is stored relative to the rect so it survives half precision;
+    // the vertex shader maps it back to pixels
+    float relative[4] = {
+        (geometry[0] - rect.x) / rect.width,
+        (geometry[1] - rect.y) / rect.height,
+        geometry[2],
+        geometry[3]
+    };
+    if (kind == GRADIENT_LINEAR) {
+        relative[2] = (geometry[2] - rect.x) / rect.width;
+        relative[3] = (geometry[3] - rect.y) / rect.height;
+    } else if (kind == GRADIENT_RADIAL) {
+        relative[2] = geometry[2] / rect.width;
+        relative[3] = geometry[3] / rect.height;
+    }
+    for (int i = 0; i < 4; ++i) {
+        instance.uv_rect[i] = float_to_half(relative[i]);
+    }
+    
+    instance.flags = pack_instance_flags(static_cast<unsigned>(kind), static_cast<unsigned>(lut_row));
+    
+    instance_data_.push_back(instance);
 }
 
 // Shadow cache implementation
@@ -1461,6 +1686,18 @@ void CanvasRenderer::ShadowCache::create_shadow_texture(NinePatchTexture& textur
     texture.bottom_v = 1.0f;
 }
 
+void CanvasRenderer::ShadowCache::evict(const ShadowKey& key) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+        return;
+    }
+    if (it->second.texture_id) {
+        TextureResidency::get_instance().release(it->second.texture_id);
+        glDeleteTextures(1, &it->second.texture_id);
+    }
+    cache_.erase(it);
+}
+
 void CanvasRenderer::draw_shadow_cached(const Rect2D& rect, float blur_radius, float spread,
                                        float offset_x, float offset_y, const ColorRGBA& color) {
     // Get or create cached shadow texture
@@ -1616,6 +1853,7 @@ void CanvasRenderer::begin_blur_region(const Rect2D& region, [[maybe_unused]] fl
         // Recreate blur framebuffer and texture
         if (blur_fbo_) {
             glDeleteFramebuffers(1, &blur_fbo_);
+            TextureResidency::get_instance().release(blur_texture_);
             glDeleteTextures(1, &blur_texture_);
         }
         
@@ -1624,6 +1862,8 @@ void CanvasRenderer::begin_blur_region(const Rect2D& region, [[maybe_unused]] fl
         
         glBindTexture(GL_TEXTURE_2D, blur_texture_);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        TextureResidency::get_instance().track(blur_texture_, TextureResidency::get_texture_bytes(width, height),
+                                               TextureOwner::RenderTarget);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -1664,6 +1904,10 @@ void CanvasRenderer::apply_gaussian_blur(GLuint texture, const Rect2D& src_rect,
                 static_cast<GLsizei>(src_rect.width), 
                 static_cast<GLsizei>(src_rect.height), 
                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    TextureResidency::get_instance().track(
+        temp_texture,
+        TextureResidency::get_texture_bytes(static_cast<int>(src_rect.width), static_cast<int>(src_rect.height)),
+        TextureOwner::RenderTarget);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -1728,6 +1972,7 @@ void CanvasRenderer::apply_gaussian_blur(GLuint texture, const Rect2D& src_rect,
     // Cleanup
     glDeleteBuffers(1, &quad_vbo);
     glDeleteFramebuffers(1, &blur_fbo);
+    TextureResidency::get_instance().release(temp_texture);
     glDeleteTextures(1, &temp_texture);
 }
 
@@ -1735,14 +1980,18 @@ void CanvasRenderer::begin_backdrop_filter(const Rect2D& region) {
     // Store the region for later use
     backdrop_region_ = region;
     
+    // The region is in drawing units; the copy is in framebuffer pixels
+    float scale = presentation_scale_;
+    int width = static_cast<int>(region.width * scale);
+    int height = static_cast<int>(region.height * scale);
+    
     // Ensure backdrop texture is large enough
-    int width = static_cast<int>(region.width);
-    int height = static_cast<int>(region.height);
     
     if (backdrop_texture_width_ < width || backdrop_texture_height_ < height) {
         // Recreate backdrop framebuffer and texture
         if (backdrop_fbo_) {
             glDeleteFramebuffers(1, &backdrop_fbo_);
+            TextureResidency::get_instance().release(backdrop_texture_);
             glDeleteTextures(1, &backdrop_texture_);
         }
         
@@ -1751,6 +2000,8 @@ void CanvasRenderer::begin_backdrop_filter(const Rect2D& region) {
         
         glBindTexture(GL_TEXTURE_2D, backdrop_texture_);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        TextureResidency::get_instance().track(backdrop_texture_, TextureResidency::get_texture_bytes(width, height),
+                                               TextureOwner::RenderTarget);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -1763,8 +2014,8 @@ void CanvasRenderer::begin_backdrop_filter(const Rect2D& region) {
     // Copy current framebuffer content to backdrop texture
     glBindTexture(GL_TEXTURE_2D, backdrop_texture_);
     glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-                        static_cast<GLint>(region.x), 
-                        static_cast<GLint>(viewport_height_ - region.y - region.height),
+                        static_cast<GLint>(region.x * scale), 
+                        static_cast<GLint>(static_cast<float>(viewport_height_) - (region.y + region.height) * scale),
                         width, height);
 }
 
@@ -1775,17 +2026,22 @@ void CanvasRenderer::end_backdrop_filter() {
 void CanvasRenderer::apply_backdrop_blur(const Rect2D& region, float blur_radius, float opacity) {
     if (!backdrop_texture_) return;
     
-    // Apply blur to the backdrop texture
-    Rect2D src_rect(0, 0, region.width, region.height);
+    // Apply blur to the backdrop texture, which begin_backdrop_filter()
+    // filled in framebuffer pixels
+    Rect2D src_rect(0, 0, region.width * presentation_scale_, region.height * presentation_scale_);
     
     // Create a temporary blurred texture
     GLuint blurred_texture;
     glGenTextures(1, &blurred_texture);
     glBindTexture(GL_TEXTURE_2D, blurred_texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 
-                static_cast<GLsizei>(region.width),
-                static_cast<GLsizei>(region.height),
+                static_cast<GLsizei>(src_rect.width),
+                static_cast<GLsizei>(src_rect.height),
                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    TextureResidency::get_instance().track(
+        blurred_texture,
+        TextureResidency::get_texture_bytes(static_cast<int>(src_rect.width), static_cast<int>(src_rect.height)),
+        TextureOwner::RenderTarget);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
@@ -1807,6 +2063,7 @@ void CanvasRenderer::apply_backdrop_blur(const Rect2D& region, float blur_radius
     draw_texture(blurred_texture, region, tint);
     
     // Cleanup
+    TextureResidency::get_instance().release(blurred_texture);
     glDeleteTextures(1, &blurred_texture);
 }
 
@@ -1844,7 +2101,8 @@ void CanvasRenderer::draw_occlusion_debug() {
     if (font_system_) {
         std::string stats = "Occlusion Culling: " + 
                           std::to_string(occlusion_tracker_.get_culled_count()) + " culled / " +
-                          std::to_string(occlusion_tracker_.get_tested_count()) + " tested";
+                          std::to_string(occlusion_tracker_.get_tested_count()) + " tested, " +
+                          std::to_string(occlusion_tracker_.get_skipped_count()) + " widgets skipped";
         
         Point2D text_pos(10, viewport_height_ - 30);
         ColorRGBA text_color(1.0f, 1.0f, 0.0f, 1.0f);  // Yellow
@@ -1852,6 +2110,180 @@ void CanvasRenderer::draw_occlusion_debug() {
     }
 }
 
+void CanvasRenderer::OcclusionTracker::begin_frame(int viewport_width, int viewport_height) {
+    occluded_regions_.clear();
+    occluder_orders_.clear();
+    paint_order_ = 0;
+    scope_depth_ = 0;
+    culled_count_ = 0;
+    tested_count_ = 0;
+    skipped_count_ = 0;
+    debug_mode_ = false;
+    
+    grid_width_ = static_cast<float>(std::max(viewport_width, 0));
+    grid_height_ = static_cast<float>(std::max(viewport_height, 0));
+    columns_ = static_cast<int>(std::ceil(grid_width_ / CELL_SIZE));
+    rows_ = static_cast<int>(std::ceil(grid_height_ / CELL_SIZE));
+    
+    // Cells keep their vector capacity from frame to frame
+    cells_.resize(static_cast<size_t>(columns_ * rows_));
+    for (auto& cell : cells_) {
+        cell.full_cover_order = 0;
+        cell.partial.clear();
+    }
+}
+
+bool CanvasRenderer::OcclusionTracker::should_cull(const Rect2D& bounds, const OcclusionFlags& flags,
+                                                   uint32_t first_order, uint32_t last_order) {
+    tested_count_++;
+    
+    // Never cull if not allowed or has special requirements
+    if (!flags.allows_occlusion || flags.force_render || 
+        flags.is_3d_element || flags.has_transparency || flags.has_shadow) {
+        return false;
+    }
+    
+    if (occluded_regions_.empty() || bounds.width <= 0 || bounds.height <= 0) {
+        return false;
+    }
+    
+    // Only the on-screen part has to be hidden
+    Rect2D visible = bounds.intersection(Rect2D(0, 0, grid_width_, grid_height_));
+    if (visible.width <= 0 || visible.height <= 0) {
+        return false;
+    }
+    
+    if (!is_region_covered(visible, last_order)) {
+        return false;
+    }
+    
+    culled_count_++;
+    skipped_count_ += (first_order > 0 && last_order >= first_order) ? static_cast<int>(last_order - first_order + 1) : 1;
+    return true;
+}
+
+void CanvasRenderer::OcclusionTracker::add_occluder(const Rect2D& bounds, const OcclusionFlags& flags, uint32_t order) {
+    // Only add if widget is opaque and can occlude others
+    if (!flags.is_opaque || flags.has_transparency) {
+        return;
+    }
+    
+    Rect2D clipped = bounds.intersection(Rect2D(0, 0, grid_width_, grid_height_));
+    if (clipped.width <= 0 || clipped.height <= 0) {
+        return;
+    }
+    
+    if (order == 0) {
+        order = next_paint_order();
+    }
+    
+    uint32_t index = static_cast<uint32_t>(occluded_regions_.size());
+    occluded_regions_.push_back(clipped);
+    occluder_orders_.push_back(order);
+    
+    int col0 = static_cast<int>(clipped.x / CELL_SIZE);
+    int row0 = static_cast<int>(clipped.y / CELL_SIZE);
+    int col1 = std::min(columns_ - 1, static_cast<int>((clipped.right() - 0.001f) / CELL_SIZE));
+    int row1 = std::min(rows_ - 1, static_cast<int>((clipped.bottom() - 0.001f) / CELL_SIZE));
+    
+    for (int row = row0; row <= row1; ++row) {
+        for (int col = col0; col <= col1; ++col) {
+            Cell& cell = cells_[static_cast<size_t>(row * columns_ + col)];
+            
+            float cell_x = static_cast<float>(col) * CELL_SIZE;
+            float cell_y = static_cast<float>(row) * CELL_SIZE;
+            float cell_right = std::min(cell_x + CELL_SIZE, grid_width_);
+            float cell_bottom = std::min(cell_y + CELL_SIZE, grid_height_);
+            
+            if (clipped.x <= cell_x && clipped.y <= cell_y &&
+                clipped.right() >= cell_right && clipped.bottom() >= cell_bottom) {
+                cell.full_cover_order = std::max(cell.full_cover_order, order);
+            } else {
+                cell.partial.push_back(index);
+            }
+        }
+    }
+}
+
+bool CanvasRenderer::OcclusionTracker::is_region_covered(const Rect2D& rect, uint32_t after_order) {
+    constexpr float EPSILON = 0.01f;
+    
+    int col0 = static_cast<int>(rect.x / CELL_SIZE);
+    int row0 = static_cast<int>(rect.y / CELL_SIZE);
+    int col1 = std::min(columns_ - 1, static_cast<int>((rect.right() - 0.001f) / CELL_SIZE));
+    int row1 = std::min(rows_ - 1, static_cast<int>((rect.bottom() - 0.001f) / CELL_SIZE));
+    
+    for (int row = row0; row <= row1; ++row) {
+        for (int col = col0; col <= col1; ++col) {
+            const Cell& cell = cells_[static_cast<size_t>(row * columns_ + col)];
+            if (cell.full_cover_order > after_order) {
+                continue;
+            }
+            
+            // Part of the rect inside this cell must be covered by the union
+            // of partial occluders painted after the tested widget
+            float cell_x = static_cast<float>(col) * CELL_SIZE;
+            float cell_y = static_cast<float>(row) * CELL_SIZE;
+            Rect2D piece = rect.intersection(Rect2D(cell_x, cell_y, CELL_SIZE, CELL_SIZE));
+            if (piece.width <= EPSILON || piece.height <= EPSILON) {
+                continue;
+            }
+            
+            candidates_.clear();
+            for (uint32_t index : cell.partial) {
+                if (occluder_orders_[index] > after_order && occluded_regions_[index].intersects(piece)) {
+                    candidates_.push_back(index);
+                }
+            }
+            if (candidates_.empty()) {
+                return false;
+            }
+            
+            // Sweep vertical slabs between occluder edges; within each slab the
+            // occluders spanning it must cover the full height of the piece
+            slab_edges_.clear();
+            slab_edges_.push_back(piece.x);
+            slab_edges_.push_back(piece.right());
+            for (uint32_t index : candidates_) {
+                const Rect2D& occluder = occluded_regions_[index];
+                if (occluder.x > piece.x && occluder.x < piece.right()) slab_edges_.push_back(occluder.x);
+                if (occluder.right() > piece.x && occluder.right() < piece.right()) slab_edges_.push_back(occluder.right());
+            }
+            std::sort(slab_edges_.begin(), slab_edges_.end());
+            
+            for (size_t i = 0; i + 1 < slab_edges_.size(); ++i) {
+                float slab_left = slab_edges_[i];
+                float slab_right = slab_edges_[i + 1];
+                if (slab_right - slab_left <= EPSILON) {
+                    continue;
+                }
+                
+                spans_.clear();
+                for (uint32_t index : candidates_) {
+                    const Rect2D& occluder = occluded_regions_[index];
+                    if (occluder.x <= slab_left + EPSILON && occluder.right() >= slab_right - EPSILON) {
+                        spans_.emplace_back(occluder.y, occluder.bottom());
+                    }
+                }
+                std::sort(spans_.begin(), spans_.end());
+                
+                float covered_to = piece.y;
+                for (const auto& [top, bottom] : spans_) {
+                    if (top > covered_to + EPSILON) {
+                        break;
+                    }
+                    covered_to = std::max(covered_to, bottom);
+                }
+                if (covered_to < piece.bottom() - EPSILON) {
+                    return false;
+                }
+            }
+        }
+    }
+    
+    return true;
+}
+
 void CanvasRenderer::draw_dashed_line(const Point2D& start, const Point2D& end, 
                                      const ColorRGBA& color, float width,
                                      float dash_length, float gap_length) {
@@ -1904,58 +2336,45 @@ void CanvasRenderer::draw_dotted_line(const Point2D& start, const Point2D& end,
 void CanvasRenderer::draw_text_with_ellipsis(const std::string& text, const Rect2D& bounds,
                                             const ColorRGBA& color, float size,
                                             TextAlign align) {
-    if (!font_system_) return;
-    
-    // Measure text width
-    float text_width = font_system_->measure_text(text, "default", static_cast<int>(size)).x;
-    
-    if (text_width <= bounds.width) {
-        // Text fits, draw normally
-        Point2D pos(bounds.x, bounds.y);
-        if (align == TextAlign::CENTER) {
-            pos.x = bounds.x + (bounds.width - text_width) / 2;
-        } else if (align == TextAlign::RIGHT) {
-            pos.x = bounds.x + bounds.width - text_width;
-        }
-        draw_text(text, pos, color, size, align, TextBaseline::TOP);
-        return;
-    }
-    
-    // Text doesn't fit, add ellipsis
-    std::string ellipsis = "...";
-    float ellipsis_width = font_system_->measure_text(ellipsis, "default", static_cast<int>(size)).x;
-    float available_width = bounds.width - ellipsis_width;
-    
-    // Binary search for the longest substring that fits
-    size_t left = 0, right = text.length();
-    size_t best_fit = 0;
-    
-    while (left <= right) {
-        size_t mid = (left + right) / 2;
-        std::string substr = text.substr(0, mid);
-        float substr_width = font_system_->measure_text(substr, "default", static_cast<int>(size)).x;
-        
-        if (substr_width <= available_width) {
-            best_fit = mid;
-            left = mid + 1;
-        } else {
-            if (mid == 0) break;
-            right = mid - 1;
-        }
+    if (!font_system_ || !default_font_) return;
+    
+    // Same font and pixel size draw_text uses; cached runs allocate nothing on a hit
+    float pixel_size = static_cast<float>(static_cast<int>(size));
+    const ShapedRun& run = font_system_->get_shaped_run(default_font_, text, pixel_size, true);
+    float ascender = run.measurement.ascender;
+    
+    size_t glyph_limit = run.glyph_count();
+    const ShapedRun* ellipsis_run = nullptr;
+    float text_width = run.measurement.width;
+    
+    if (text_width > bounds.width) {
+        // Longest prefix that leaves room for the ellipsis, by binary search over the prefix sums
+        static constexpr std::string_view ELLIPSIS = "...";
+        ellipsis_run = &font_system_->get_shaped_run(default_font_, ELLIPSIS, pixel_size, true);
+        float available_width = std::max(0.0f, bounds.width - ellipsis_run->measurement.width);
+        glyph_limit = run.fit_glyphs(available_width);
+        text_width = run.prefix_advances[glyph_limit] + ellipsis_run->measurement.width;
     }
     
-    std::string truncated = text.substr(0, best_fit) + ellipsis;
     Point2D pos(bounds.x, bounds.y);
-    
     if (align == TextAlign::CENTER) {
-        float truncated_width = font_system_->measure_text(truncated, "default", static_cast<int>(size)).x;
-        pos.x = bounds.x + (bounds.width - truncated_width) / 2;
+        pos.x = bounds.x + (bounds.width - text_width) / 2;
     } else if (align == TextAlign::RIGHT) {
-        float truncated_width = font_system_->measure_text(truncated, "default", static_cast<int>(size)).x;
-        pos.x = bounds.x + bounds.width - truncated_width;
+        pos.x = bounds.x + bounds.width - text_width;
     }
     
-    draw_text(truncated, pos, color, size, align, TextBaseline::TOP);
+    batch_text_run(run, pos, ascender, color, 0, glyph_limit);
+    if (ellipsis_run) {
+        batch_text_run(*ellipsis_run, Point2D(pos.x + run.prefix_advances[glyph_limit], pos.y),
+                       ascender, color);
+    }
+}
+
+const ShapedRun* CanvasRenderer::get_text_run(const std::string& text, float size) {
+    if (!font_system_ || !default_font_) {
+        return nullptr;
+    }
+    return &font_system_->get_shaped_run(default_font_, text, static_cast<float>(static_cast<int>(size)));
 }
 
 void CanvasRenderer::draw_text_with_shadow(const std::string& text, const Point2D& position,
@@ -1995,6 +2414,27 @@ void CanvasRenderer::draw_image(GLuint texture_id, const Rect2D& bounds, ObjectF
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &tex_width);
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &tex_height);
     
+    draw_image_fitted(texture_id, tex_width, tex_height, bounds, fit, tint);
+}
+
+void CanvasRenderer::draw_image(const std::string& path, const Rect2D& bounds, ObjectFit fit,
+                               const ColorRGBA& tint) {
+    int tex_width = 0;
+    int tex_height = 0;
+    ImageLoader::State state = ImageLoader::State::Decoding;
+    GLuint texture_id = ImageLoader::get_instance().get_texture(path, &tex_width, &tex_height, &state);
+    if (!texture_id) {
+        // Placeholder while the image is on its way; a failed one draws nothing
+        if (state != ImageLoader::State::Failed) {
+            draw_rect(bounds, theme_.widget_disabled);
+        }
+        return;
+    }
+    draw_image_fitted(texture_id, tex_width, tex_height, bounds, fit, tint);
+}
+
+void CanvasRenderer::draw_image_fitted(GLuint texture_id, int tex_width, int tex_height, const Rect2D& bounds,
+                                       ObjectFit fit, const ColorRGBA& tint) {
     Rect2D draw_rect = bounds;
     
     switch (fit) {
@@ -2148,51 +2588,13 @@ void CanvasRenderer::add_widget_instance(const Rect2D& rect, const ColorRGBA& co
                                         const ColorRGBA& border_color,
                                         float outline_width, float outline_offset,
                                         const ColorRGBA& outline_color) {
+    flush_pending_segments();
     if (instance_data_.size() >= max_instances_) {
         flush_instances();  // Flush if we hit the limit
     }
     
-    WidgetInstanceData instance;
-    
-    // Transform
-    instance.transform[0] = rect.x;
-    instance.transform[1] = rect.y;
-    instance.transform[2] = rect.width;
-    instance.transform[3] = rect.height;
-    
-    // Color
-    instance.color[0] = color.r;
-    instance.color[1] = color.g;
-    instance.color[2] = color.b;
-    instance.color[3] = color.a;
-    
-    // UV rect (full texture for now - will use atlas later)
-    instance.uv_rect[0] = 0.0f;
-    instance.uv_rect[1] = 0.0f;
-    instance.uv_rect[2] = 1.0f;
-    instance.uv_rect[3] = 1.0f;
-    
-    // Corner radii (same for all corners for now)
-    instance.params[0] = corner_radius;  // top-left
-    instance.params[1] = corner_radius;  // top-right
-    instance.params[2] = corner_radius;  // bottom-right
-    instance.params[3] = corner_radius;  // bottom-left
-    
-    // Border
-    instance.border[0] = border_width;
-    instance.border[1] = border_color.r;
-    instance.border[2] = border_color.g;
-    instance.border[3] = border_color.b;
-    
-    // Extra params for outline
-    instance.extra[0] = outline_width;     // outline width
-    instance.extra[1] = outline_offset;    // outline offset from border
-    instance.extra[2] = outline_color.r;   // outline color R
-    instance.extra[3] = outline_color.g;   // outline color G
-    // Note: outline B and A packed into shader constants or derived
-    
-    
-    instance_data_.push_back(instance);
+    instance_data_.push_back(pack_widget_instance(rect, color, corner_radius, border_width, border_color,
+                                                  outline_width, outline_offset, outline_color));
 }
 
 void CanvasRenderer::flush_instances() {
@@ -2205,13 +2607,41 @@ void CanvasRenderer::flush_instances() {
         return;
     }
     
+    // Depth follows submission order so the painter's result is preserved.
+    // Opaque instances go first, front-to-back, so pixels they cover are
+    // rejected by the depth test before shading; translucent ones follow
+    // back-to-front, tested against the opaque depth but not writing it.
+    size_t count = instance_data_.size();
+    auto instance_depth = [count](size_t index) {
+        // Unorm16 steps stay distinct because max_instances_ < 65535
+        return static_cast<uint16_t>(65535 - (index + 1) * 65535 / (count + 1));
+    };
+    sorted_instances_.clear();
+    
+    if (use_depth_sorted_instances_) {
+        for (size_t i = count; i-- > 0;) {
+            if (classify_instance(instance_data_[i]).is_opaque) {
+                sorted_instances_.push_back(instance_data_[i]);
+                sorted_instances_.back().depth = instance_depth(i);
+            }
+        }
+    }
+    size_t opaque_count = sorted_instances_.size();
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (!use_depth_sorted_instances_ || !classify_instance(instance_data_[i]).is_opaque) {
+            sorted_instances_.push_back(instance_data_[i]);
+            sorted_instances_.back().depth = instance_depth(i);
+        }
+    }
+    
     // Upload instance data to GPU with cross-platform optimizations
     glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
-    size_t data_size = instance_data_.size() * sizeof(WidgetInstanceData);
+    size_t data_size = sorted_instances_.size() * sizeof(WidgetInstanceData);
     
     // Buffer orphaning technique for better performance on all platforms
     // This avoids GPU stalls by letting the driver manage buffer swapping
-    if (use_buffer_orphaning_ && instance_data_.size() > max_instances_ / 4) {
+    if (use_buffer_orphaning_ && count > max_instances_ / 4) {
         // Orphan the buffer for large updates (>25% of buffer)
         // This tells the driver we're replacing all data
         glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(max_instances_ * sizeof(WidgetInstanceData)), 
@@ -2219,14 +2649,15 @@ void CanvasRenderer::flush_instances() {
     }
     
     // Upload the instance data
-    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(data_size), instance_data_.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(data_size), sorted_instances_.data());
     
     // Set up rendering state
     instance_shader_->use();
     
     // Set projection matrix
-    float vp_width = std::max(1.0f, static_cast<float>(viewport_width_));
-    float vp_height = std::max(1.0f, static_cast<float>(viewport_height_));
+    Point2D extent = get_projection_extent();
+    float vp_width = extent.x;
+    float vp_height = extent.y;
     float projection[16] = {
         2.0f / vp_width,  0,                  0, 0,
         0,               -2.0f / vp_height,    0, 0,
@@ -2241,27 +2672,72 @@ void CanvasRenderer::flush_instances() {
     instance_shader_->set_uniform("u_texture_atlas", 0);
     instance_shader_->set_uniform("u_enable_sdf", 1);  // Enable SDF for proper border rendering
     
+    // Gradient stop rows for gradient instances
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gradient_lut_texture_);
+    instance_shader_->set_uniform("u_gradient_lut", 1);
+    instance_shader_->set_uniform("u_gradient_lut_rows", static_cast<float>(GRADIENT_LUT_ROWS));
+    glActiveTexture(GL_TEXTURE0);
+    
     // Bind the widget VAO (has static quad + instance attributes)
     glBindVertexArray(widget_vao_);
     
-    // Enable blending for proper UI rendering
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Depth is private to this flush; anything drawn earlier (3D viewports) is already resolved
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    
+    if (opaque_count > 0) {
+        glDisable(GL_BLEND);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(opaque_count));
+        draw_calls_this_frame_++;
+    }
     
-    // Draw all instances in ONE call!
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(instance_data_.size()));
+    size_t translucent_count = sorted_instances_.size() - opaque_count;
+    if (translucent_count > 0) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+        bind_instance_attributes(opaque_count);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(translucent_count));
+        bind_instance_attributes(0);
+        draw_calls_this_frame_++;
+    }
+    
+    // Batched geometry drawn afterwards is not depth sorted
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
     
     // Update statistics
-    draw_calls_this_frame_++;
-    vertices_this_frame_ += 4 * instance_data_.size();
+    vertices_this_frame_ += static_cast<int>(4 * count);
+    opaque_instances_this_frame_ += static_cast<int>(opaque_count);
     
     // Clear for next batch
     instance_data_.clear();
+    instance_flush_count_++;
     
     glBindVertexArray(0);
     instance_shader_->unuse();
 }
 
+CanvasRenderer::OcclusionFlags CanvasRenderer::classify_instance(const WidgetInstanceData& instance) const {
+    // Only plain fills cover every pixel of their rect: rounded corners,
+    // borders and outlines go through the anti-aliased SDF path, and
+    // gradients may carry transparent stops. Widths and radii are clamped
+    // non-negative when packed, so a zero bit pattern means "none".
+    OcclusionFlags flags;
+    bool plain_fill = instance.radii[0] == 0 && instance.radii[1] == 0 &&
+                      instance.radii[2] == 0 && instance.radii[3] == 0 &&
+                      instance.widths[0] == 0 && instance.widths[1] == 0 &&
+                      instance.flags == 0;
+    flags.has_transparency = instance.color[3] < 255;
+    flags.is_opaque = plain_fill && !flags.has_transparency;
+    flags.allows_occlusion = true;
+    return flags;
+}
+
 void CanvasRenderer::render_sorted_batches() {
     if (completed_batches_.empty()) {
         return;
@@ -2273,6 +2749,25 @@ void CanvasRenderer::render_sorted_batches() {
                   return a.sort_key < b.sort_key;
               });
     
+    // Batches that sort together share every piece of state, so fold them
+    // into one draw (e.g. all icons on one atlas page between button quads)
+    size_t merged = 0;
+    for (size_t i = 1; i < completed_batches_.size(); ++i) {
+        CompletedBatch& target = completed_batches_[merged];
+        CompletedBatch& batch = completed_batches_[i];
+        if (batch.sort_key == target.sort_key && batch.is_text == target.is_text) {
+            uint32_t base_index = static_cast<uint32_t>(target.vertices.size());
+            target.vertices.insert(target.vertices.end(), batch.vertices.begin(), batch.vertices.end());
+            for (uint32_t index : batch.indices) {
+                target.indices.push_back(base_index + index);
+            }
+        } else if (++merged != i) {
+            completed_batches_[merged] = std::move(batch);
+        }
+    }
+    completed_batches_.erase(completed_batches_.begin() + static_cast<std::ptrdiff_t>(merged + 1),
+                             completed_batches_.end());
+    
     // Track current state to avoid redundant state changes
     GLuint current_texture = 0;
     GLuint current_shader = 0;
@@ -2296,8 +2791,9 @@ void CanvasRenderer::render_sorted_batches() {
             ui_shader_->use();
             
             // Set projection matrix for new shader
-            float vp_width = std::max(1.0f, static_cast<float>(viewport_width_));
-            float vp_height = std::max(1.0f, static_cast<float>(viewport_height_));
+            Point2D extent = get_projection_extent();
+            float vp_width = extent.x;
+            float vp_height = extent.y;
             
             float projection[16] = {
                 2.0f / vp_width,  0,                  0, 0,
@@ -2310,6 +2806,7 @@ void CanvasRenderer::render_sorted_batches() {
             // Set default uniforms
             ui_shader_->set_uniform("u_texture", 0);  // Use texture unit 0
             ui_shader_->set_uniform("u_is_text", 0);  // Default to non-text
+            ui_shader_->set_uniform("u_text_distance_range", FontFace::DISTANCE_RANGE);
             ui_shader_->set_uniform("u_use_vertex_color", 1);  // Batched geometry uses vertex colors
             
             // We ALWAYS have a texture bound (even if it's just white_texture_)
@@ -2435,17 +2932,21 @@ void CanvasRenderer::set_theme(const CanvasTheme& theme) {
 }
 
 void CanvasRenderer::enable_scissor(const Rect2D& rect) {
+    flush_pending_segments();
     scissor_enabled_ = true;
     scissor_rect_ = rect;
     
+    // Scissor boxes are in framebuffer pixels
+    float scale = presentation_scale_;
     glEnable(GL_SCISSOR_TEST);
-    glScissor(static_cast<GLint>(rect.x), 
-              static_cast<GLint>(viewport_height_ - rect.y - rect.height),
-              static_cast<GLsizei>(rect.width), 
-              static_cast<GLsizei>(rect.height));
+    glScissor(static_cast<GLint>(rect.x * scale), 
+              static_cast<GLint>(static_cast<float>(viewport_height_) - (rect.y + rect.height) * scale),
+              static_cast<GLsizei>(rect.width * scale), 
+              static_cast<GLsizei>(rect.height * scale));
 }
 
 void CanvasRenderer::disable_scissor() {
+    flush_pending_segments();
     scissor_enabled_ = false;
     glDisable(GL_SCISSOR_TEST);
 }
@@ -2456,36 +2957,55 @@ void CanvasRenderer::bind_texture(GLuint texture_id, int unit) {
 }
 
 void CanvasRenderer::draw_texture(GLuint texture_id, const Rect2D& rect, const ColorRGBA& tint) {
-    // Professional batched rendering - add to batch instead of immediate mode
-    
     if (!glIsTexture(texture_id)) {
         std::cerr << "ERROR: Invalid texture ID " << texture_id << std::endl;
         return;
     }
     
+    // Full texture (0,0 to 1,1)
+    draw_texture_region(texture_id, rect, Rect2D(0.0f, 0.0f, 1.0f, 1.0f), tint);
+}
+
+// Icon fields are drawn with the glyph range the UI shader is set up with
+static_assert(static_cast<int>(ICON_FIELD_RANGE) == static_cast<int>(FontFace::DISTANCE_RANGE),
+              "icon distance fields must match the glyph field range");
+
+void CanvasRenderer::draw_texture_region(GLuint texture_id, const Rect2D& rect, const Rect2D& uv, const ColorRGBA& tint,
+                                         bool distance_field) {
+    // Professional batched rendering - add to batch instead of immediate mode
+    if (texture_id == 0) {
+        return;
+    }
+    
     // Check if we need to flush (different texture or shader state)
     GLuint shader_id = ui_shader_->get_id();
     GLenum blend_mode = GL_SRC_ALPHA;
     
-    if (!current_batch_.can_batch_with(texture_id, blend_mode, shader_id)) {
+    // Raster and field icons share atlas pages but not the shader path
+    if (!current_batch_.can_batch_with(texture_id, blend_mode, shader_id) ||
+        current_batch_.is_text != distance_field) {
         // Flush current batch before starting new one with different texture
         flush_current_batch();
         current_batch_.texture_id = texture_id;
         current_batch_.blend_mode = blend_mode;
         current_batch_.shader_id = shader_id;
     }
+    current_batch_.is_text = distance_field;
     
     // Add vertices to batch - same as draw_rect but with proper texture coords
     uint32_t base_index = static_cast<uint32_t>(current_batch_.vertices.size());
     
-    // Add vertices with proper texture coordinates (0,0 to 1,1 for full texture)
-    current_batch_.vertices.push_back(UIVertex(rect.x, rect.y, 0.0f, 0.0f, 
+    float u0 = uv.x;
+    float v0 = uv.y;
+    float u1 = uv.x + uv.width;
+    float v1 = uv.y + uv.height;
+    current_batch_.vertices.push_back(UIVertex(rect.x, rect.y, u0, v0,
                                                tint.r, tint.g, tint.b, tint.a));
-    current_batch_.vertices.push_back(UIVertex(rect.x + rect.width, rect.y, 1.0f, 0.0f,
+    current_batch_.vertices.push_back(UIVertex(rect.x + rect.width, rect.y, u1, v0,
                                                tint.r, tint.g, tint.b, tint.a));
-    current_batch_.vertices.push_back(UIVertex(rect.x + rect.width, rect.y + rect.height, 1.0f, 1.0f,
+    current_batch_.vertices.push_back(UIVertex(rect.x + rect.width, rect.y + rect.height, u1, v1,
                                                tint.r, tint.g, tint.b, tint.a));
-    current_batch_.vertices.push_back(UIVertex(rect.x, rect.y + rect.height, 0.0f, 1.0f,
+    current_batch_.vertices.push_back(UIVertex(rect.x, rect.y + rect.height, u0, v1,
                                                tint.r, tint.g, tint.b, tint.a));
     
     // Add indices for the quad
@@ -2505,10 +3025,10 @@ void CanvasRenderer::draw_texture(GLuint texture_id, const Rect2D& rect, const C
 void CanvasRenderer::setup_shaders() {
     create_ui_shader();
     create_instance_shader();
+    create_segment_shader();
     create_text_shader();
     create_sdf_shader();
     create_blur_shader();
-    create_gradient_shader();
 }
 
 void CanvasRenderer::setup_buffers() {
@@ -2532,17 +3052,17 @@ void CanvasRenderer::setup_buffers() {
     
     // Position (location 0)
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(UIVertex), reinterpret_cast<void*>(0));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(UIVertex), reinterpret_cast<void*>(offsetof(UIVertex, x)));
     check_gl_error("setup position attribute");
     
     // Texture coordinates (location 1)
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(UIVertex), reinterpret_cast<void*>(2 * sizeof(float)));
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(UIVertex), reinterpret_cast<void*>(offsetof(UIVertex, u)));
     check_gl_error("setup texture coordinate attribute");
     
     // Color (location 2)
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(UIVertex), reinterpret_cast<void*>(4 * sizeof(float)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(UIVertex), reinterpret_cast<void*>(offsetof(UIVertex, r)));
     check_gl_error("setup color attribute");
     
     
@@ -2610,40 +3130,68 @@ void CanvasRenderer::setup_buffers() {
     // Pre-allocate instance data vector for performance
     instance_data_.reserve(max_instances_);
     
-    // Setup instance attributes (using locations 3-8)
-    size_t stride = sizeof(WidgetInstanceData);
+    // Setup instance attributes (using locations 3-11)
+    bind_instance_attributes(0);
+    
+    glBindVertexArray(0);
+    
+    // Segment instances: the quad corners come from gl_VertexID, so the VAO
+    // only carries per-instance attributes
+    glGenVertexArrays(1, &segment_vao_);
+    glBindVertexArray(segment_vao_);
+    
+    glGenBuffers(1, &segment_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, segment_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(max_segment_instances_ * sizeof(SegmentInstanceData)),
+                 nullptr, GL_STREAM_DRAW);
+    segment_instances_.reserve(max_segment_instances_);
     
-    // Transform (location 3)
+    GLsizei segment_stride = static_cast<GLsizei>(sizeof(SegmentInstanceData));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, segment_stride, reinterpret_cast<void*>(offsetof(SegmentInstanceData, endpoints)));
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, segment_stride, reinterpret_cast<void*>(offsetof(SegmentInstanceData, color)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, segment_stride, reinterpret_cast<void*>(offsetof(SegmentInstanceData, params)));
+    glVertexAttribDivisor(2, 1);
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, transform)));
-    glVertexAttribDivisor(3, 1);  // One per instance
-    
-    // Color (location 4)
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, color)));
-    glVertexAttribDivisor(4, 1);
-    
-    // UV rect (location 5)
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, uv_rect)));
-    glVertexAttribDivisor(5, 1);
-    
-    // Params/corner radius (location 6)
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, params)));
-    glVertexAttribDivisor(6, 1);
-    
-    // Border (location 7)
-    glEnableVertexAttribArray(7);
-    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, border)));
-    glVertexAttribDivisor(7, 1);
-    
-    // Extra params (location 8)
-    glEnableVertexAttribArray(8);
-    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), reinterpret_cast<void*>(offsetof(WidgetInstanceData, extra)));
-    glVertexAttribDivisor(8, 1);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, segment_stride, reinterpret_cast<void*>(offsetof(SegmentInstanceData, previous)));
+    glVertexAttribDivisor(3, 1);
     
     glBindVertexArray(0);
+    check_gl_error("setup segment buffers");
+}
+
+void CanvasRenderer::bind_instance_attributes(size_t first_instance) {
+    // Expects widget_vao_ and instance_vbo_ to be bound. A non-zero first
+    // instance stands in for base-instance draws, which need GL 4.2
+    size_t stride = sizeof(WidgetInstanceData);
+    size_t base = first_instance * stride;
+    
+    auto instance_attribute = [&](GLuint location, GLint components, GLenum type,
+                                  GLboolean normalized, size_t offset) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, components, type, normalized, static_cast<GLsizei>(stride),
+                              reinterpret_cast<void*>(base + offset));
+        glVertexAttribDivisor(location, 1);  // One per instance
+    };
+    
+    instance_attribute(3, 4, GL_FLOAT, GL_FALSE, offsetof(WidgetInstanceData, transform));
+    instance_attribute(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(WidgetInstanceData, color));
+    instance_attribute(5, 4, GL_HALF_FLOAT, GL_FALSE, offsetof(WidgetInstanceData, uv_rect));
+    instance_attribute(6, 4, GL_HALF_FLOAT, GL_FALSE, offsetof(WidgetInstanceData, radii));
+    instance_attribute(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(WidgetInstanceData, border_color));
+    instance_attribute(8, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(WidgetInstanceData, outline_color));
+    instance_attribute(9, 1, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(WidgetInstanceData, depth));
+    instance_attribute(10, 4, GL_HALF_FLOAT, GL_FALSE, offsetof(WidgetInstanceData, widths));
+    
+    // Flags are read as an integer, not converted to float
+    glEnableVertexAttribArray(11);
+    glVertexAttribIPointer(11, 1, GL_UNSIGNED_SHORT, static_cast<GLsizei>(stride),
+                           reinterpret_cast<void*>(base + offsetof(WidgetInstanceData, flags)));
+    glVertexAttribDivisor(11, 1);
 }
 
 void CanvasRenderer::setup_default_textures() {
@@ -2655,6 +3203,8 @@ void CanvasRenderer::setup_default_textures() {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white_pixel);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    TextureResidency::get_instance().track(white_texture_, TextureResidency::get_texture_bytes(1, 1),
+                                           TextureOwner::Renderer);
     
     // Create checker texture for debugging
     GLubyte checker_data[64]; // 4x4 RGBA
@@ -2671,10 +3221,31 @@ void CanvasRenderer::setup_default_textures() {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker_data);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    TextureResidency::get_instance().track(checker_texture_, TextureResidency::get_texture_bytes(4, 4),
+                                           TextureOwner::Renderer);
     
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void CanvasRenderer::setup_gradient_lut() {
+    // Rows are filled on demand by get_gradient_lut_row()
+    glGenTextures(1, &gradient_lut_texture_);
+    glBindTexture(GL_TEXTURE_2D, gradient_lut_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GRADIENT_LUT_WIDTH, GRADIENT_LUT_ROWS, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    TextureResidency::get_instance().track(
+        gradient_lut_texture_, TextureResidency::get_texture_bytes(GRADIENT_LUT_WIDTH, GRADIENT_LUT_ROWS),
+        TextureOwner::Renderer);
+    // Linear along a row interpolates between baked stops; rows are sampled at texel centers
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    gradient_lut_rows_.clear();
+    gradient_lut_index_.clear();
+}
+
 void CanvasRenderer::create_ui_shader() {
     // This shader supports both dynamic batched geometry (with vertex colors)
     // and static widget geometry (with uniform colors)
@@ -2711,6 +3282,7 @@ in vec2 v_position;
 uniform sampler2D u_texture;
 uniform int u_has_texture;
 uniform int u_is_text;  // 1 for text glyphs, 0 for regular textures
+uniform float u_text_distance_range;  // Glyph field range in texels
 uniform vec4 u_widget_rect;
 uniform vec4 u_corner_radius;
 uniform float u_border_width;
@@ -2731,15 +3303,17 @@ void main() {
     vec4 base_color;
     
     if (u_is_text == 1) {
-        // Text rendering - use texture's red channel as alpha
-        // Font textures are stored as GL_RED format
-        vec4 tex_sample = texture(u_texture, v_texcoord);
-        float glyph_alpha = tex_sample.r;
-        
-        // Debug: Check what GL_RED texture returns
-        // If green/blue are also set to red value, we have a driver issue
-        // In that case, the text would appear red/yellow/white instead of using vertex color
-        // Fix: explicitly use only the red channel for alpha
+        // Text rendering - glyphs are multi-channel distance fields shared by
+        // all sizes; the median channel is the signed distance to the outline
+        vec3 msd = texture(u_texture, v_texcoord).rgb;
+        float sd = max(min(msd.r, msd.g), min(max(msd.r, msd.g), msd.b)) - 0.5;
+        
+        // Field range in screen pixels at the scale this glyph is drawn at
+        vec2 unit_range = vec2(u_text_distance_range) / vec2(textureSize(u_texture, 0));
+        vec2 screen_tex_size = vec2(1.0) / fwidth(v_texcoord);
+        float screen_px_range = max(0.5 * dot(unit_range, screen_tex_size), 1.0);
+        float glyph_alpha = clamp(screen_px_range * sd + 0.5, 0.0, 1.0);
+        
         base_color = vec4(v_color.rgb, v_color.a * glyph_alpha);
     } else if (u_has_texture == 1) {
         // Regular texture - modulate with vertex color
@@ -2791,7 +3365,7 @@ void main() {
 )";
 
     ui_shader_ = std::make_unique<ShaderProgram>();
-    if (!ui_shader_->load_from_strings(vertex_source, fragment_source)) {
+    if (!ui_shader_->load_from_strings(vertex_source, fragment_source, "canvas_ui")) {
         std::cerr << "CRITICAL ERROR: Failed to create UI shader!" << std::endl;
     } else {
         }
@@ -2806,28 +3380,37 @@ layout(location = 0) in vec2 a_position;  // Unit quad position
 layout(location = 1) in vec2 a_texcoord;  // Unit quad UV
 
 // Per-instance attributes
-layout(location = 3) in vec4 a_transform;     // x, y, width, height
-layout(location = 4) in vec4 a_color;         // RGBA
-layout(location = 5) in vec4 a_uv_rect;       // u0, v0, u1, v1 for texture atlas
-layout(location = 6) in vec4 a_params;        // corner radii (tl, tr, br, bl)
-layout(location = 7) in vec4 a_border;        // width, r, g, b
-layout(location = 8) in vec4 a_extra;         // type, alpha, unused, unused
+layout(location = 3) in vec4 a_transform;       // x, y, width, height
+layout(location = 4) in vec4 a_color;           // RGBA8, normalized
+layout(location = 5) in vec4 a_uv_rect;         // u0, v0, u1, v1, or gradient geometry
+layout(location = 6) in vec4 a_radii;           // corner radii (tl, tr, br, bl)
+layout(location = 7) in vec4 a_border_color;    // RGBA8, normalized
+layout(location = 8) in vec4 a_outline_color;   // RGBA8, normalized
+layout(location = 9) in float a_depth;          // Submission order, nearer = later
+layout(location = 10) in vec4 a_widths;         // border width, outline width, outline offset
+layout(location = 11) in uint a_flags;          // gradient kind (bits 0-3), LUT row (bits 4-15)
 
 uniform mat4 u_projection;
+uniform float u_gradient_lut_rows;
 
 out vec2 v_position;      // World position for SDF
 out vec2 v_texcoord;      // Texture coordinates
 out vec4 v_color;         // Instance color
-out vec4 v_params;        // Pass params to fragment
-out vec4 v_border;        // Pass border to fragment
-out vec4 v_outline;       // Pass outline to fragment
+out vec4 v_params;        // Corner radii
+out vec4 v_border;        // Border color
+out vec4 v_outline;       // Outline color
+out vec3 v_widths;        // Border width, outline width, outline offset
 out vec2 v_widget_size;   // Widget dimensions for SDF
 out vec2 v_widget_pos;    // Widget position for SDF
+flat out vec4 v_gradient; // Gradient geometry in pixels (gradient instances only)
+flat out int v_gradient_kind;
+flat out float v_gradient_row;
 
 void main() {
     // Transform unit quad to world space
     vec2 world_pos = a_position * a_transform.zw + a_transform.xy;
     gl_Position = u_projection * vec4(world_pos, 0.0, 1.0);
+    gl_Position.z = a_depth * 2.0 - 1.0;
     
     // Interpolate texture coordinates for atlas
     v_texcoord = mix(a_uv_rect.xy, a_uv_rect.zw, a_texcoord);
@@ -2835,11 +3418,24 @@ void main() {
     // Pass through instance data
     v_position = world_pos;
     v_color = a_color;
-    v_params = a_params;
-    v_border = a_border;
-    v_outline = a_extra;  // Outline data is in extra
+    v_params = a_radii;
+    v_border = a_border_color;
+    v_outline = a_outline_color;
+    v_widths = a_widths.xyz;
     v_widget_size = a_transform.zw;
     v_widget_pos = a_transform.xy;
+    
+    // Gradient geometry is stored relative to the rect; map it to pixels
+    v_gradient_kind = int(a_flags & 15u);
+    v_gradient_row = (float(a_flags >> 4u) + 0.5) / u_gradient_lut_rows;
+    vec2 origin = a_transform.xy + a_uv_rect.xy * a_transform.zw;
+    if (v_gradient_kind == 1) {         // Linear: start, end
+        v_gradient = vec4(origin, a_transform.xy + a_uv_rect.zw * a_transform.zw);
+    } else if (v_gradient_kind == 2) {  // Radial: center, radii
+        v_gradient = vec4(origin, a_uv_rect.zw * a_transform.zw);
+    } else {                            // Conic: center, start angle
+        v_gradient = vec4(origin, a_uv_rect.z, 0.0);
+    }
 }
 )";
 
@@ -2850,16 +3446,37 @@ in vec2 v_position;
 in vec2 v_texcoord;
 in vec4 v_color;
 in vec4 v_params;      // corner radii
-in vec4 v_border;      // width, r, g, b
-in vec4 v_outline;     // width, offset, r, g (outline data)
+in vec4 v_border;      // border color
+in vec4 v_outline;     // outline color
+in vec3 v_widths;      // border width, outline width, outline offset
 in vec2 v_widget_size;
 in vec2 v_widget_pos;
+flat in vec4 v_gradient;
+flat in int v_gradient_kind;
+flat in float v_gradient_row;
 
 uniform sampler2D u_texture_atlas;
+uniform sampler2D u_gradient_lut;  // One row of baked stops per gradient
 uniform int u_enable_sdf;
 
 out vec4 fragColor;
 
+vec4 sample_gradient(int kind, float row) {
+    float t = 0.0;
+    if (kind == 1) {  // Linear: start.xy, end.xy
+        vec2 axis = v_gradient.zw - v_gradient.xy;
+        t = dot(v_position - v_gradient.xy, axis) / max(dot(axis, axis), 1e-6);
+    } else if (kind == 2) {  // Radial: center.xy, radius.xy
+        t = length((v_position - v_gradient.xy) / v_gradient.zw);
+    } else {  // Conic: center.xy, start angle
+        vec2 d = v_position - v_gradient.xy;
+        t = fract((atan(d.y, d.x) - v_gradient.z) / 6.28318530718);
+    }
+    // Map [0,1] onto texel centers so the end stops are exact
+    float u = (clamp(t, 0.0, 1.0) * 255.0 + 0.5) / 256.0;
+    return texture(u_gradient_lut, vec2(u, row));
+}
+
 float sdf_rounded_rect(vec2 p, vec2 b, vec4 r) {
     r.xy = (p.x > 0.0) ? r.xy : r.zw;
     r.x  = (p.y > 0.0) ? r.x  : r.y;
@@ -2868,18 +3485,20 @@ float sdf_rounded_rect(vec2 p, vec2 b, vec4 r) {
 }
 
 void main() {
-    // Sample texture atlas
-    vec4 tex_color = texture(u_texture_atlas, v_texcoord);
+    // Sample texture atlas, or the gradient LUT for gradient instances
+    vec4 tex_color = v_gradient_kind != 0 ?
+        sample_gradient(v_gradient_kind, v_gradient_row) :
+        texture(u_texture_atlas, v_texcoord);
     vec4 base_color = tex_color * v_color;
     
     // Only apply SDF if we actually have rounded corners or borders
     // Check if any corner radius is non-zero
     bool has_rounded_corners = (v_params.x > 0.001 || v_params.y > 0.001 || 
                                 v_params.z > 0.001 || v_params.w > 0.001);
-    bool has_border = v_border.x > 0.001;
+    bool has_border = v_widths.x > 0.001;
     
     // Check for outline
-    bool has_outline = v_outline.x > 0.001;
+    bool has_outline = v_widths.y > 0.001;
     
     if (u_enable_sdf == 1 && (has_rounded_corners || has_border || has_outline)) {
         vec2 center = v_widget_pos + v_widget_size * 0.5;
@@ -2892,9 +3511,9 @@ void main() {
         float aa = 0.5;
         
         // Calculate all three masks
-        float outline_width = v_outline.x;
-        float outline_offset = v_outline.y;  // Pre-calculated position based on alignment
-        float border_width = v_border.x;
+        float outline_width = v_widths.y;
+        float outline_offset = v_widths.z;  // Pre-calculated position based on alignment
+        float border_width = v_widths.x;
         
         // SDF increases inward (positive = inside shape)
         // Border is at the widget boundary (sdf = 0)
@@ -2928,13 +3547,11 @@ void main() {
         
         // Each layer adds its contribution without overlap
         if (has_outline) {
-            vec3 outline_color = vec3(v_outline.z, v_outline.w, 0.5); // RG from outline, B hardcoded for now
-            result += vec4(outline_color, 1.0) * outline_mask;
+            result += v_outline * outline_mask;
         }
         
         if (has_border) {
-            vec3 border_color = v_border.yzw;
-            result += vec4(border_color, 1.0) * border_mask;
+            result += v_border * border_mask;
         }
         
         // Fill layer
@@ -2950,109 +3567,124 @@ void main() {
 )";
 
     instance_shader_ = std::make_unique<ShaderProgram>();
-    if (!instance_shader_->load_from_strings(vertex_source, fragment_source)) {
+    if (!instance_shader_->load_from_strings(vertex_source, fragment_source, "canvas_instance")) {
         std::cerr << "Failed to create instance shader!" << std::endl;
     }
 }
 
-void CanvasRenderer::create_text_shader() {
-    // Text shader similar to UI shader for now
-    text_shader_ = std::make_unique<ShaderProgram>();
-    // TODO: Implement proper text rendering shader
-}
-
-void CanvasRenderer::create_gradient_shader() {
+void CanvasRenderer::create_segment_shader() {
     const char* vertex_source = R"(
-        #version 330 core
-        
-        layout(location = 0) in vec2 a_position;
-        layout(location = 1) in vec2 a_texcoord;
-        
-        uniform mat4 u_projection;
-        
-        out vec2 v_position;
-        out vec2 v_texcoord;
-        
-        void main() {
-            gl_Position = u_projection * vec4(a_position, 0.0, 1.0);
-            v_position = a_position;
-            v_texcoord = a_texcoord;
-        }
-    )";
+#version 330 core
+
+layout(location = 0) in vec4 a_endpoints;  // start.xy, end.xy
+layout(location = 1) in vec4 a_color;
+layout(location = 2) in vec4 a_params;     // half width, round caps, joins previous
+layout(location = 3) in vec2 a_previous;   // Start of the previous polyline segment
+
+uniform mat4 u_projection;
+
+out vec4 v_color;
+out vec2 v_local;          // Position along / across the segment in pixels
+flat out float v_length;
+flat out float v_half_width;
+flat out float v_round;
+flat out float v_coverage;
+flat out float v_joined;
+flat out vec2 v_previous;  // a_previous in the same local frame
+
+void main() {
+    vec2 p0 = a_endpoints.xy;
+    vec2 p1 = a_endpoints.zw;
+    vec2 delta = p1 - p0;
+    float len = length(delta);
+    vec2 dir = len > 1e-4 ? delta / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+    
+    // Hairlines keep a one pixel footprint and fade by coverage instead
+    float half_width = max(a_params.x, 0.5);
+    float extent = half_width + 1.0;  // One pixel fringe for the AA ramp
+    float cap_extent = (a_params.y > 0.5 ? half_width : 0.0) + 1.0;
+    
+    // Triangle strip corners: 0 = start/-, 1 = start/+, 2 = end/-, 3 = end/+
+    float along = gl_VertexID < 2 ? -cap_extent : len + cap_extent;
+    float across = (gl_VertexID & 1) == 0 ? -extent : extent;
+    
+    vec2 position = p0 + dir * along + normal * across;
+    gl_Position = u_projection * vec4(position, 0.0, 1.0);
     
+    v_color = a_color;
+    v_local = vec2(along, across);
+    v_length = len;
+    v_half_width = half_width;
+    v_round = a_params.y;
+    v_coverage = min(a_params.x * 2.0, 1.0);
+    v_joined = a_params.z;
+    vec2 previous = a_previous - p0;
+    v_previous = vec2(dot(previous, dir), dot(previous, normal));
+}
+)";
+
     const char* fragment_source = R"(
-        #version 330 core
-        
-        in vec2 v_position;
-        in vec2 v_texcoord;
-        
-        out vec4 fragColor;
-        
-        // Gradient uniforms
-        uniform int u_gradient_type;  // 0 = linear, 1 = radial, 2 = conic
-        uniform vec2 u_gradient_start;
-        uniform vec2 u_gradient_end;
-        uniform vec2 u_gradient_center;
-        uniform vec2 u_gradient_radius;
-        uniform float u_gradient_angle;
-        
-        // Color stops (up to 8)
-        uniform int u_stop_count;
-        uniform vec4 u_stop_colors[8];
-        uniform float u_stop_positions[8];
-        
-        vec4 interpolate_gradient(float t) {
-            if (t <= u_stop_positions[0]) return u_stop_colors[0];
-            if (t >= u_stop_positions[u_stop_count - 1]) return u_stop_colors[u_stop_count - 1];
-            
-            for (int i = 0; i < u_stop_count - 1; i++) {
-                if (t >= u_stop_positions[i] && t <= u_stop_positions[i + 1]) {
-                    float local_t = (t - u_stop_positions[i]) / 
-                                  (u_stop_positions[i + 1] - u_stop_positions[i]);
-                    return mix(u_stop_colors[i], u_stop_colors[i + 1], local_t);
-                }
-            }
-            
-            return u_stop_colors[u_stop_count - 1];
-        }
-        
-        void main() {
-            float t = 0.0;
-            
-            if (u_gradient_type == 0) {  // Linear gradient
-                vec2 grad_vec = u_gradient_end - u_gradient_start;
-                float grad_len = length(grad_vec);
-                if (grad_len > 0.0) {
-                    vec2 grad_dir = grad_vec / grad_len;
-                    vec2 pos_vec = v_position - u_gradient_start;
-                    t = dot(pos_vec, grad_dir) / grad_len;
-                    t = clamp(t, 0.0, 1.0);
-                }
-            }
-            else if (u_gradient_type == 1) {  // Radial gradient
-                vec2 pos_vec = v_position - u_gradient_center;
-                float dist = length(pos_vec / u_gradient_radius);
-                t = clamp(dist, 0.0, 1.0);
-            }
-            else if (u_gradient_type == 2) {  // Conic gradient
-                vec2 pos_vec = v_position - u_gradient_center;
-                float angle = atan(pos_vec.y, pos_vec.x);
-                angle = angle - u_gradient_angle;
-                if (angle < 0.0) angle += 6.28318530718;  // 2*PI
-                t = angle / 6.28318530718;
-            }
-            
-            fragColor = interpolate_gradient(t);
-        }
-    )";
+#version 330 core
+
+in vec4 v_color;
+in vec2 v_local;
+flat in float v_length;
+flat in float v_half_width;
+flat in float v_round;
+flat in float v_coverage;
+flat in float v_joined;
+flat in vec2 v_previous;
+
+out vec4 fragColor;
+
+// Coverage of the capsule from a to the local origin
+float capsule_coverage(vec2 p, vec2 a, float half_width) {
+    vec2 ab = -a;
+    float t = clamp(dot(p - a, ab) / max(dot(ab, ab), 1e-8), 0.0, 1.0);
+    return clamp(0.5 - (length(p - a - ab * t) - half_width), 0.0, 1.0);
+}
+
+void main() {
+    float distance;
+    if (v_round > 0.5) {
+        // Capsule: distance to the centre line segment
+        vec2 nearest = vec2(clamp(v_local.x, 0.0, v_length), 0.0);
+        distance = length(v_local - nearest) - v_half_width;
+    } else {
+        // Butt caps: box around the segment
+        vec2 d = vec2(max(-v_local.x, v_local.x - v_length), abs(v_local.y) - v_half_width);
+        distance = max(d.x, d.y);
+    }
     
-    gradient_shader_ = std::make_unique<ShaderProgram>();
-    if (!gradient_shader_->load_from_strings(vertex_source, fragment_source)) {
-        std::cerr << "Failed to create gradient shader" << std::endl;
-        gradient_shader_.reset();
+    float alpha = clamp(0.5 - distance, 0.0, 1.0);
+    
+    // The previous segment already covered the joint: add only what it
+    // left uncovered, so the two blend like one shape
+    if (v_joined > 0.5) {
+        alpha *= 1.0 - capsule_coverage(v_local, v_previous, v_half_width);
+    }
+    alpha *= v_coverage;
+    if (alpha <= 0.0) {
+        discard;
+    }
+    fragColor = vec4(v_color.rgb, v_color.a * alpha);
+}
+)";
+
+    segment_shader_ = std::make_unique<ShaderProgram>();
+    if (!segment_shader_->load_from_strings(vertex_source, fragment_source, "canvas_segment")) {
+        std::cerr << "Failed to create segment shader" << std::endl;
+        segment_shader_.reset();
     }
 }
 
+void CanvasRenderer::create_text_shader() {
+    // Text shader similar to UI shader for now
+    text_shader_ = std::make_unique<ShaderProgram>();
+    // TODO: Implement proper text rendering shader
+}
+
 void CanvasRenderer::create_blur_shader() {
     const char* vertex_source = R"(
         #version 330 core
@@ -3104,7 +3736,8 @@ void CanvasRenderer::create_blur_shader() {
     )";
     
     blur_shader_ = std::make_unique<ShaderProgram>();
-    if (!blur_shader_->load_from_strings(vertex_source, fragment_source)) {
+    // Not needed for the first frame - link in the background
+    if (!blur_shader_->load_from_strings(vertex_source, fragment_source, "canvas_blur", true)) {
         std::cerr << "Failed to create blur shader" << std::endl;
         blur_shader_.reset();
     }
@@ -3165,61 +3798,12 @@ void CanvasRenderer::create_sdf_shader() {
         }
     )";
     
-    // Compile vertex shader
-    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_source, nullptr);
-    glCompileShader(vertex_shader);
-    
-    // Check vertex shader compilation
-    GLint success;
-    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(vertex_shader, 512, nullptr, info_log);
-        std::cerr << "SDF vertex shader compilation failed: " << info_log << std::endl;
-        glDeleteShader(vertex_shader);
+    sdf_shader_program_ = ShaderCache::get_instance().load_program("canvas_sdf", vertex_source, fragment_source);
+    if (!sdf_shader_program_) {
+        std::cerr << "Failed to create SDF shader" << std::endl;
         return;
     }
     
-    // Compile fragment shader
-    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_source, nullptr);
-    glCompileShader(fragment_shader);
-    
-    // Check fragment shader compilation
-    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(fragment_shader, 512, nullptr, info_log);
-        std::cerr << "SDF fragment shader compilation failed: " << info_log << std::endl;
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        return;
-    }
-    
-    // Create and link program
-    sdf_shader_program_ = glCreateProgram();
-    glAttachShader(sdf_shader_program_, vertex_shader);
-    glAttachShader(sdf_shader_program_, fragment_shader);
-    glLinkProgram(sdf_shader_program_);
-    
-    // Check linking
-    glGetProgramiv(sdf_shader_program_, GL_LINK_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetProgramInfoLog(sdf_shader_program_, 512, nullptr, info_log);
-        std::cerr << "SDF shader linking failed: " << info_log << std::endl;
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        glDeleteProgram(sdf_shader_program_);
-        sdf_shader_program_ = 0;
-        return;
-    }
-    
-    // Clean up shaders
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
-    
     // Get uniform locations
     sdf_u_projection_ = glGetUniformLocation(sdf_shader_program_, "u_projection");
     sdf_u_texture_ = glGetUniformLocation(sdf_shader_program_, "u_texture");
@@ -3227,7 +3811,6 @@ void CanvasRenderer::create_sdf_shader() {
     sdf_u_threshold_ = glGetUniformLocation(sdf_shader_program_, "u_threshold");
     sdf_u_smoothness_ = glGetUniformLocation(sdf_shader_program_, "u_smoothness");
     
-    std::cout << "SDF shader created successfully" << std::endl;
 }
 
 void CanvasRenderer::sort_batches_by_layer() {
@@ -3250,31 +3833,35 @@ ShaderProgram::ShaderProgram() = default;
 
 ShaderProgram::~ShaderProgram() {
     if (program_id_) {
+        ShaderCache::get_instance().release_program(program_id_);
         glDeleteProgram(program_id_);
     }
-    if (vertex_shader_) {
-        glDeleteShader(vertex_shader_);
-    }
-    if (fragment_shader_) {
-        glDeleteShader(fragment_shader_);
-    }
 }
 
-bool ShaderProgram::load_from_strings(const std::string& vertex_source, const std::string& fragment_source) {
-    vertex_shader_ = compile_shader(vertex_source, GL_VERTEX_SHADER);
-    if (!vertex_shader_) {
-        return false;
-    }
-    
-    fragment_shader_ = compile_shader(fragment_source, GL_FRAGMENT_SHADER);
-    if (!fragment_shader_) {
-        return false;
+bool ShaderProgram::load_from_strings(const std::string& vertex_source, const std::string& fragment_source,
+                                      const std::string& cache_name, bool deferred) {
+    program_id_ = ShaderCache::get_instance().load_program(cache_name, vertex_source.c_str(),
+                                                           fragment_source.c_str(), nullptr, deferred);
+    pending_ = deferred && program_id_ != 0;
+    return program_id_ != 0;
+}
+
+bool ShaderProgram::is_valid() const {
+    ensure_linked();
+    return program_id_ != 0;
+}
+
+void ShaderProgram::ensure_linked() const {
+    if (pending_) {
+        pending_ = false;
+        if (!ShaderCache::get_instance().finish_program(program_id_)) {
+            program_id_ = 0;
+        }
     }
-    
-    return link_program();
 }
 
 void ShaderProgram::use() const {
+    ensure_linked();
     if (program_id_) {
         glUseProgram(program_id_);
     }
@@ -3320,6 +3907,7 @@ void ShaderProgram::set_uniform(const std::string& name, const float* matrix, in
 }
 
 GLint ShaderProgram::get_uniform_location(const std::string& name) const {
+    ensure_linked();
     auto it = uniform_cache_.find(name);
     if (it != uniform_cache_.end()) {
         return it->second;
@@ -3330,46 +3918,6 @@ GLint ShaderProgram::get_uniform_location(const std::string& name) const {
     return location;
 }
 
-GLuint ShaderProgram::compile_shader(const std::string& source, GLenum type) {
-    GLuint shader = glCreateShader(type);
-    const char* source_ptr = source.c_str();
-    glShaderSource(shader, 1, &source_ptr, nullptr);
-    glCompileShader(shader);
-    
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        GLchar info_log[512];
-        glGetShaderInfoLog(shader, 512, nullptr, info_log);
-        std::cerr << "Shader compilation failed: " << info_log << std::endl;
-        glDeleteShader(shader);
-        return 0;
-    }
-    
-    return shader;
-}
-
-bool ShaderProgram::link_program() {
-    program_id_ = glCreateProgram();
-    glAttachShader(program_id_, vertex_shader_);
-    glAttachShader(program_id_, fragment_shader_);
-    glLinkProgram(program_id_);
-    
-    GLint success;
-    glGetProgramiv(program_id_, GL_LINK_STATUS, &success);
-    if (!success) {
-        GLchar info_log[512];
-        glGetProgramInfoLog(program_id_, 512, nullptr, info_log);
-        std::cerr << "Shader linking failed: " << info_log << std::endl;
-        glDeleteProgram(program_id_);
-        program_id_ = 0;
-        return false;
-    }
-    
-    
-    return true;
-}
-
 // TextRenderer implementation
 
 TextRenderer::TextRenderer(CanvasRenderer* renderer)
@@ -3438,103 +3986,56 @@ void CanvasRenderer::begin_path() {
 void CanvasRenderer::move_to(float x, float y) {
     if (!path_started_) return;
     
-    PathPoint point;
-    point.type = PathPoint::MoveTo;
-    point.x = x;
-    point.y = y;
-    current_path_.push_back(point);
+    PathCommand command;
+    command.type = PathCommand::MoveTo;
+    command.x = x;
+    command.y = y;
+    current_path_.push_back(command);
 }
 
 void CanvasRenderer::line_to(float x, float y) {
     if (!path_started_ || current_path_.empty()) return;
     
-    PathPoint point;
-    point.type = PathPoint::LineTo;
-    point.x = x;
-    point.y = y;
-    current_path_.push_back(point);
+    PathCommand command;
+    command.type = PathCommand::LineTo;
+    command.x = x;
+    command.y = y;
+    current_path_.push_back(command);
 }
 
 void CanvasRenderer::curve_to(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y) {
     if (!path_started_ || current_path_.empty()) return;
     
-    PathPoint point;
-    point.type = PathPoint::CurveTo;
-    point.x = x;
-    point.y = y;
-    point.cp1x = cp1x;
-    point.cp1y = cp1y;
-    point.cp2x = cp2x;
-    point.cp2y = cp2y;
-    current_path_.push_back(point);
+    PathCommand command;
+    command.type = PathCommand::CurveTo;
+    command.x = x;
+    command.y = y;
+    command.cp1x = cp1x;
+    command.cp1y = cp1y;
+    command.cp2x = cp2x;
+    command.cp2y = cp2y;
+    current_path_.push_back(command);
 }
 
 void CanvasRenderer::close_path() {
-    if (!path_started_ || current_path_.size() < 2) return;
+    if (!path_started_ || current_path_.empty()) return;
     
-    // Find the last MoveTo
-    for (auto it = current_path_.rbegin(); it != current_path_.rend(); ++it) {
-        if (it->type == PathPoint::MoveTo) {
-            line_to(it->x, it->y);
-            break;
-        }
-    }
+    PathCommand command;
+    command.type = PathCommand::Close;
+    current_path_.push_back(command);
 }
 
-void CanvasRenderer::stroke_path(const ColorRGBA& color, float width) {
+void CanvasRenderer::stroke_path(const ColorRGBA& color, float width, LineJoin join, LineCap cap) {
     if (!path_started_ || current_path_.size() < 2) return;
     
-    // Convert path to line segments and render
-    Point2D current_pos;
-    bool has_current = false;
+    StrokeStyle style;
+    style.width = width;
+    style.join = join;
+    style.cap = cap;
     
-    for (const auto& point : current_path_) {
-        switch (point.type) {
-            case PathPoint::MoveTo:
-                current_pos = Point2D(point.x, point.y);
-                has_current = true;
-                break;
-                
-            case PathPoint::LineTo:
-                if (has_current) {
-                    draw_line_batched(current_pos, Point2D(point.x, point.y), color, width);
-                    current_pos = Point2D(point.x, point.y);
-                }
-                break;
-                
-            case PathPoint::CurveTo:
-                if (has_current) {
-                    // Approximate cubic bezier with line segments
-                    const int segments = 20;
-                    Point2D prev = current_pos;
-                    
-                    for (int i = 1; i <= segments; i++) {
-                        float t = static_cast<float>(i) / segments;
-                        float t2 = t * t;
-                        float t3 = t2 * t;
-                        float mt = 1 - t;
-                        float mt2 = mt * mt;
-                        float mt3 = mt2 * mt;
-                        
-                        float x = mt3 * current_pos.x + 
-                                 3 * mt2 * t * point.cp1x + 
-                                 3 * mt * t2 * point.cp2x + 
-                                 t3 * point.x;
-                        float y = mt3 * current_pos.y + 
-                                 3 * mt2 * t * point.cp1y + 
-                                 3 * mt * t2 * point.cp2y + 
-                                 t3 * point.y;
-                        
-                        Point2D next(x, y);
-                        draw_line_batched(prev, next, color, width);
-                        prev = next;
-                    }
-                    
-                    current_pos = Point2D(point.x, point.y);
-                }
-                break;
-        }
-    }
+    // Tessellation is cached per path and scale bucket, so static vector UI costs one lookup
+    const PathMesh& mesh = path_cache_.get_stroke(current_path_, style, get_transform_scale());
+    batch_path_mesh(mesh, color);
     
     path_started_ = false;
 }
@@ -3542,71 +4043,50 @@ void CanvasRenderer::stroke_path(const ColorRGBA& color, float width) {
 void CanvasRenderer::fill_path(const ColorRGBA& color) {
     if (!path_started_ || current_path_.size() < 3) return;
     
-    // Simplified fill using triangulation
-    // For complex paths, a proper triangulation algorithm would be needed
-    // This is a simplified version that works for convex paths
+    const PathMesh& mesh = path_cache_.get_fill(current_path_, get_transform_scale());
+    batch_path_mesh(mesh, color);
     
-    std::vector<Point2D> vertices;
-    Point2D current_pos;
-    bool has_current = false;
+    path_started_ = false;
+}
+
+float CanvasRenderer::get_transform_scale() const {
+    // Largest axis scale of the 2D part of the current transform
+    const float* m = current_transform_.matrix;
+    float sx = std::sqrt(m[0] * m[0] + m[1] * m[1]);
+    float sy = std::sqrt(m[4] * m[4] + m[5] * m[5]);
+    return std::max(sx, sy);
+}
+
+void CanvasRenderer::batch_path_mesh(const PathMesh& mesh, const ColorRGBA& color) {
+    if (mesh.empty() || !ui_shader_ || !ui_shader_->is_valid()) {
+        return;
+    }
     
-    for (const auto& point : current_path_) {
-        switch (point.type) {
-            case PathPoint::MoveTo:
-                current_pos = Point2D(point.x, point.y);
-                vertices.push_back(current_pos);
-                has_current = true;
-                break;
-                
-            case PathPoint::LineTo:
-                if (has_current) {
-                    vertices.push_back(Point2D(point.x, point.y));
-                    current_pos = Point2D(point.x, point.y);
-                }
-                break;
-                
-            case PathPoint::CurveTo:
-                // Tessellate curve into line segments
-                if (has_current) {
-                    const int segments = 10;
-                    for (int i = 1; i <= segments; i++) {
-                        float t = static_cast<float>(i) / segments;
-                        float t2 = t * t;
-                        float t3 = t2 * t;
-                        float mt = 1 - t;
-                        float mt2 = mt * mt;
-                        float mt3 = mt2 * mt;
-                        
-                        float x = mt3 * current_pos.x + 
-                                 3 * mt2 * t * point.cp1x + 
-                                 3 * mt * t2 * point.cp2x + 
-                                 t3 * point.x;
-                        float y = mt3 * current_pos.y + 
-                                 3 * mt2 * t * point.cp1y + 
-                                 3 * mt * t2 * point.cp2y + 
-                                 t3 * point.y;
-                        
-                        vertices.push_back(Point2D(x, y));
-                    }
-                    current_pos = Point2D(point.x, point.y);
-                }
-                break;
-        }
+    GLuint shader_id = ui_shader_->get_id();
+    GLenum blend_mode = GL_SRC_ALPHA;
+    
+    if (!current_batch_.can_batch_with(white_texture_, blend_mode, shader_id)) {
+        flush_current_batch();
+        current_batch_.texture_id = white_texture_;
+        current_batch_.blend_mode = blend_mode;
+        current_batch_.shader_id = shader_id;
     }
     
-    // Simple fan triangulation for convex shapes
-    if (vertices.size() >= 3) {
-        for (size_t i = 2; i < vertices.size(); i++) {
-            // Draw triangle from first vertex to i-1 and i
-            // This would be better done with actual triangle rendering
-            // For now, approximate with very thin rectangles
-            draw_line_batched(vertices[0], vertices[i-1], color, 1);
-            draw_line_batched(vertices[i-1], vertices[i], color, 1);
-            draw_line_batched(vertices[i], vertices[0], color, 1);
-        }
+    // Meshes are cached in path space; apply the current transform while copying
+    const float* m = current_transform_.matrix;
+    uint32_t base_index = static_cast<uint32_t>(current_batch_.vertices.size());
+    current_batch_.vertices.reserve(current_batch_.vertices.size() + mesh.vertices.size());
+    for (const auto& v : mesh.vertices) {
+        float x = m[0] * v.x + m[4] * v.y + m[12];
+        float y = m[1] * v.x + m[5] * v.y + m[13];
+        current_batch_.vertices.push_back(UIVertex(x, y, 0.5f, 0.5f, color.r, color.g, color.b, color.a));
+    }
+    current_batch_.indices.reserve(current_batch_.indices.size() + mesh.indices.size());
+    for (uint32_t index : mesh.indices) {
+        current_batch_.indices.push_back(base_index + index);
     }
     
-    path_started_ = false;
+    vertices_this_frame_ += static_cast<int>(mesh.vertices.size());
 }
 
 // Filter effects (stubs - require shader support)
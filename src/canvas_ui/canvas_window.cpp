@@ -85,6 +85,13 @@ static void glfw_key_callback(GLFWwindow* window, int key, int scancode, int act
     }
 }
 
+static void glfw_char_callback(GLFWwindow* window, unsigned int codepoint) {
+    CanvasWindow* canvas_window = static_cast<CanvasWindow*>(glfwGetWindowUserPointer(window));
+    if (canvas_window) {
+        canvas_window->on_char_event(codepoint);
+    }
+}
+
 static void glfw_window_content_scale_callback(GLFWwindow* window, float xscale, float yscale) {
     CanvasWindow* canvas_window = static_cast<CanvasWindow*>(glfwGetWindowUserPointer(window));
     if (canvas_window) {
@@ -107,7 +114,7 @@ CanvasWindow::CanvasWindow(int width, int height, const std::string& title)
     , ui_scale_(1.0f)
     , pixelsize_(1.0f)
     , ui_line_width_(0)
-    , last_mouse_pos_(0, 0)
+    , last_cursor_pos_(0, 0)
     , keyboard_modifiers_(0) {
 }
 
@@ -460,6 +467,7 @@ void CanvasWindow::setup_callbacks() {
     glfwSetCursorPosCallback(window_, glfw_cursor_pos_callback);
     glfwSetScrollCallback(window_, glfw_scroll_callback);
     glfwSetKeyCallback(window_, glfw_key_callback);
+    glfwSetCharCallback(window_, glfw_char_callback);
     glfwSetWindowContentScaleCallback(window_, glfw_window_content_scale_callback);
 }
 
@@ -467,7 +475,15 @@ InputEvent CanvasWindow::create_input_event(EventType type) const {
     InputEvent event;
     event.type = type;
     event.timestamp = glfwGetTime();
-    event.mouse_pos = last_mouse_pos_;  // Already in framebuffer space
+    
+    // Window coordinates to drawing units: framebuffer pixels, less the
+    // stretch applied while a new scale is pre-warmed. Converted per event,
+    // so a scale swap applies without the pointer moving.
+    float scale = get_content_scale();
+    if (renderer_) {
+        scale /= renderer_->get_presentation_scale();
+    }
+    event.mouse_pos = Point2D(last_cursor_pos_.x * scale, last_cursor_pos_.y * scale);
     event.mouse_delta = Point2D(0, 0);
     event.mouse_button = MouseButton::LEFT;
     event.key_code = 0;
@@ -524,14 +540,11 @@ void CanvasWindow::calculate_dpi_and_scaling() {
               << ", dpi=" << dpi_
               << ", pixelsize=" << pixelsize_ << std::endl;
     
-    // If DPI changed significantly, clear icon cache
+    // Icon rasters are keyed by pixel size, so the atlas stays valid: the
+    // application pre-warms the new scale's sizes and the old ones serve a
+    // move back until the atlas LRU drops them
     if (initialized_ && std::abs(pixelsize_ - previous_pixelsize) > 0.01f) {
-        std::cout << "DPI changed from " << previous_pixelsize << " to " << pixelsize_ 
-                  << ", clearing icon cache" << std::endl;
-        
-        // Clear all cached icon sizes to force re-rendering at new DPI
-        IconSystem& icon_system = IconSystem::get_instance();
-        icon_system.clear_all_caches();
+        std::cout << "DPI changed from " << previous_pixelsize << " to " << pixelsize_ << std::endl;
     }
 }
 
@@ -583,9 +596,8 @@ void CanvasWindow::on_mouse_button(int button, int action, int mods) {
 }
 
 void CanvasWindow::on_mouse_move(double x, double y) {
-    // Convert mouse coordinates from window space to framebuffer space
-    float scale = get_content_scale();
-    last_mouse_pos_ = Point2D(static_cast<float>(x) * scale, static_cast<float>(y) * scale);
+    // Window coordinates; create_input_event() converts to drawing units
+    last_cursor_pos_ = Point2D(static_cast<float>(x), static_cast<float>(y));
     
     
     InputEvent event = create_input_event(EventType::MOUSE_MOVE);
@@ -987,6 +999,16 @@ void CanvasWindow::on_key_event(int key, [[maybe_unused]] int scancode, int acti
     }
 }
 
+void CanvasWindow::on_char_event(unsigned int codepoint) {
+    // Text after keyboard layout and IME composition; KEY_PRESS carries the
+    // physical key for shortcuts and editing keys
+    InputEvent event = create_input_event(EventType::TEXT_INPUT);
+    event.codepoint = codepoint;
+    if (event_router_) {
+        event_router_->route_event(event);
+    }
+}
+
 // RegionManager implementation
 
 RegionManager::RegionManager(CanvasWindow* window)
@@ -303,6 +303,7 @@ void EventRouter::log_event(const InputEvent& event, [[maybe_unused]] const std:
         case EventType::TRACKPAD_ROTATE: type_name = "TRACKPAD_ROTATE"; break;
         case EventType::SMART_MOUSE_GESTURE: type_name = "SMART_MOUSE_GESTURE"; break;
         case EventType::MODIFIER_CHANGE: type_name = "MODIFIER_CHANGE"; break;
+        case EventType::TEXT_INPUT: type_name = "TEXT_INPUT"; break;
     }
     
     [[maybe_unused]] const char* result_name = "UNKNOWN";
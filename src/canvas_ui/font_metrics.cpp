@@ -5,6 +5,7 @@
  */
 
 #include "canvas_ui/font_metrics.h"
+#include "canvas_ui/utf8.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <iostream>
@@ -56,18 +57,19 @@ bool FontMetrics::initialize(FT_Face face) {
 void FontMetrics::load_glyph_metrics() {
     if (!face_) return;
     
-    // Load common ASCII characters and their advance widths
-    for (uint32_t codepoint = 32; codepoint < 127; ++codepoint) {
+    // Latin-1 glyph ids and advance widths go in flat tables
+    for (uint32_t codepoint = 0; codepoint < LATIN_CODEPOINTS; ++codepoint) {
         FT_UInt glyph_index = FT_Get_Char_Index(face_, codepoint);
-        if (glyph_index) {
+        latin_glyph_ids_[codepoint] = glyph_index;
+        latin_advances_[codepoint] = -1.0f;
+        if (glyph_index && codepoint >= 32) {
             if (!FT_Load_Glyph(face_, glyph_index, FT_LOAD_NO_SCALE)) {
-                glyph_advances_[codepoint] = face_->glyph->metrics.horiAdvance;
+                latin_advances_[codepoint] = static_cast<float>(face_->glyph->metrics.horiAdvance);
             }
         }
     }
     
-    // Also load common Unicode ranges if needed
-    // TODO: Add more Unicode ranges as needed
+    // Everything else is loaded by find_advance() on first use
 }
 
 void FontMetrics::build_kerning_table() {
@@ -116,14 +118,24 @@ std::vector<ShapedGlyph> FontMetrics::shape_text(const std::string& text, float
     std::vector<ShapedGlyph> shaped;
     if (!face_) return shaped;
     
+    std::vector<uint32_t> codepoints;
+    codepoints.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ) {
+        codepoints.push_back(decode_utf8(text, i));
+    }
+    shape_codepoints(codepoints.data(), codepoints.size(), font_size_px, shaped);
+    return shaped;
+}
+
+void FontMetrics::shape_codepoints(const uint32_t* codepoints, size_t count, float font_size_px,
+                                   std::vector<ShapedGlyph>& out) const {
+    if (!face_) return;
+    
     float scale = font_size_px / metrics_.units_per_em;
     uint32_t prev_glyph = 0;
-    [[maybe_unused]] float x_pos = 0;
     
-    for (size_t i = 0; i < text.length(); ++i) {
-        // Simple UTF-8 to codepoint (handles ASCII for now)
-        // TODO: Proper UTF-8 decoding for international text
-        uint32_t codepoint = static_cast<unsigned char>(text[i]);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t codepoint = codepoints[i];
         uint32_t glyph_id = codepoint_to_glyph(codepoint);
         
         ShapedGlyph glyph;
@@ -137,26 +149,22 @@ std::vector<ShapedGlyph> FontMetrics::shape_text(const std::string& text, float
         if (prev_glyph != 0) {
             float kern = get_kerning(prev_glyph, glyph_id);
             if (kern != 0) {
-                x_pos += kern * scale;
                 glyph.x_offset = kern * scale;
             }
         }
         
         // Get advance width
-        auto it = glyph_advances_.find(codepoint);
-        if (it != glyph_advances_.end()) {
-            glyph.x_advance = it->second * scale;
+        float advance_units;
+        if (find_advance(codepoint, advance_units)) {
+            glyph.x_advance = advance_units * scale;
         } else {
             // Fallback for unknown glyphs
             glyph.x_advance = font_size_px * 0.5f;
         }
         
-        shaped.push_back(glyph);
-        x_pos += glyph.x_advance;
+        out.push_back(glyph);
         prev_glyph = glyph_id;
     }
-    
-    return shaped;
 }
 
 float FontMetrics::get_char_advance(uint32_t codepoint, float font_size_px, 
@@ -165,9 +173,9 @@ float FontMetrics::get_char_advance(uint32_t codepoint, float font_size_px,
     float advance = 0;
     
     // Get base advance
-    auto it = glyph_advances_.find(codepoint);
-    if (it != glyph_advances_.end()) {
-        advance = it->second * scale;
+    float advance_units;
+    if (find_advance(codepoint, advance_units)) {
+        advance = advance_units * scale;
     } else {
         advance = font_size_px * 0.5f;  // Fallback
     }
@@ -189,8 +197,29 @@ float FontMetrics::get_kerning(uint32_t left_glyph, uint32_t right_glyph) const
     return (it != kerning_table_.end()) ? it->second : 0;
 }
 
+bool FontMetrics::find_advance(uint32_t codepoint, float& advance) const {
+    if (codepoint < LATIN_CODEPOINTS) {
+        advance = latin_advances_[codepoint];
+        return advance >= 0.0f;
+    }
+    auto it = glyph_advances_.find(codepoint);
+    if (it == glyph_advances_.end()) {
+        float loaded = -1.0f;
+        FT_UInt glyph_index = face_ ? FT_Get_Char_Index(face_, codepoint) : 0;
+        if (glyph_index && !FT_Load_Glyph(face_, glyph_index, FT_LOAD_NO_SCALE)) {
+            loaded = static_cast<float>(face_->glyph->metrics.horiAdvance);
+        }
+        it = glyph_advances_.emplace(codepoint, loaded).first;
+    }
+    advance = it->second;
+    return advance >= 0.0f;
+}
+
 uint32_t FontMetrics::codepoint_to_glyph(uint32_t codepoint) const {
     if (!face_) return 0;
+    if (codepoint < LATIN_CODEPOINTS) {
+        return latin_glyph_ids_[codepoint];
+    }
     return FT_Get_Char_Index(face_, codepoint);
 }
 
@@ -215,38 +244,4 @@ float FontMetrics::get_x_height(float font_size_px) const {
     return metrics_.to_pixels(metrics_.x_height, font_size_px);
 }
 
-// TextMeasurementCache implementation
-
-TextMeasurement TextMeasurementCache::measure(const CacheKey& key,
-                                             const std::function<TextMeasurement()>& compute) {
-    // Check cache
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        return it->second;
-    }
-    
-    // Compute and cache
-    TextMeasurement result = compute();
-    
-    // Evict if cache is too large
-    if (cache_.size() >= max_cache_size_) {
-        evict_oldest();
-    }
-    
-    cache_[key] = result;
-    return result;
-}
-
-void TextMeasurementCache::clear() {
-    cache_.clear();
-}
-
-void TextMeasurementCache::evict_oldest() {
-    // Simple eviction: remove first element (not truly LRU)
-    // For production, implement proper LRU with timestamp or access order
-    if (!cache_.empty()) {
-        cache_.erase(cache_.begin());
-    }
-}
-
 } // namespace voxel_canvas
\ No newline at end of file
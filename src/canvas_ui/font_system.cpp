@@ -12,14 +12,22 @@
 #include "canvas_ui/font_system.h"
 #include "canvas_ui/canvas_renderer.h"
 #include "canvas_ui/font_metrics.h"
+#include "canvas_ui/mapped_file.h"
+#include "canvas_ui/msdf_generator.h"
+#include "canvas_ui/shader_cache.h"
+#include "canvas_ui/utf8.h"
 #include "glad/gl.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MULTIPLE_MASTERS_H
 
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 
 namespace voxel_canvas {
 
@@ -28,9 +36,10 @@ FontSystem* g_font_system = nullptr;
 
 // FontFace implementation
 
-FontFace::FontFace(const std::string& path, int size)
+FontFace::FontFace(const std::string& path, int size, float weight)
     : font_path_(path)
-    , default_size_(size) {
+    , default_size_(size)
+    , weight_(weight) {
     // Extract font name from path
     size_t last_slash = path.find_last_of("/\\");
     size_t last_dot = path.find_last_of(".");
@@ -56,15 +65,26 @@ bool FontFace::load() {
         return false;
     }
     
-    // Load font face
-    FT_Error error = FT_New_Face(ft, font_path_.c_str(), 0, &face_);
-    if (error) {
-        std::cerr << "Failed to load font: " << font_path_ << " (error: " << error << ")" << std::endl;
+    // Faces of one file share its mapping instead of each reading the file
+    file_ = g_font_system->map_font_file(font_path_);
+    if (!file_) {
+        std::cerr << "Failed to load font: " << font_path_ << std::endl;
+        return false;
+    }
+    
+    face_ = create_face(ft, *file_, weight_);
+    if (!face_) {
+        file_.reset();
         return false;
     }
     
-    // Set default size
-    FT_Set_Pixel_Sizes(face_, 0, static_cast<FT_UInt>(default_size_));
+    // Size-independent metric factors; every size is a multiply away
+    if (face_->units_per_EM) {
+        float units_per_em = static_cast<float>(face_->units_per_EM);
+        ascender_per_px_ = static_cast<float>(face_->ascender) / units_per_em;
+        descender_per_px_ = static_cast<float>(face_->descender) / units_per_em;
+        line_height_per_px_ = static_cast<float>(face_->height) / units_per_em;
+    }
     
     // Initialize font metrics for accurate measurement
     metrics_ = std::make_unique<FontMetrics>();
@@ -81,155 +101,165 @@ void FontFace::unload() {
         FT_Done_Face(face_);
         face_ = nullptr;
     }
+    file_.reset();
     
-    // Clear all cached glyphs
-    for (auto& [size, cache] : size_caches_) {
-        for (auto& [codepoint, glyph] : cache.glyphs) {
-            if (glyph.texture_id && !glyph.in_atlas) {
-                glDeleteTextures(1, &glyph.texture_id);
-            }
+    // Clear all cached glyphs; their atlas space is reclaimed on repack
+    if (g_font_system) {
+        g_font_system->release_atlas_glyphs(this);
+    }
+    for (unsigned int codepoint = 0; codepoint < LATIN_GLYPHS; ++codepoint) {
+        if (latin_loaded_[codepoint]) {
+            release_glyph(latin_glyphs_[codepoint]);
+            latin_loaded_[codepoint] = false;
         }
     }
-    size_caches_.clear();
+    for (auto& [codepoint, glyph] : glyphs_) {
+        release_glyph(glyph);
+    }
+    glyphs_.clear();
+    reset_metrics();
 }
 
-GlyphInfo* FontFace::get_glyph(unsigned int codepoint, int size) {
-    // Check if we have this size cached
-    auto size_it = size_caches_.find(size);
-    if (size_it == size_caches_.end()) {
-        // Create new size cache
-        SizeCache cache;
-        cache.pixel_size = size;
-        
-        // Set font size and get metrics
-        FT_Set_Pixel_Sizes(face_, 0, static_cast<FT_UInt>(size));
-        cache.line_height = face_->size->metrics.height >> 6;
-        cache.ascender = face_->size->metrics.ascender >> 6;
-        cache.descender = face_->size->metrics.descender >> 6;
-        
-        size_caches_[size] = cache;
-        size_it = size_caches_.find(size);
+void FontFace::reset_metrics() {
+    ascender_per_px_ = 0.8f;
+    descender_per_px_ = 0.2f;
+    line_height_per_px_ = 1.2f;
+}
+
+void FontFace::release_glyph(GlyphInfo& glyph) {
+    // Atlas pages own the texels
+    glyph = GlyphInfo();
+}
+
+void FontFace::evict_glyph(unsigned int codepoint) {
+    if (codepoint < LATIN_GLYPHS) {
+        release_glyph(latin_glyphs_[codepoint]);
+        latin_loaded_[codepoint] = false;
+        return;
+    }
+    glyphs_.erase(codepoint);
+}
+
+GlyphInfo* FontFace::find_glyph(unsigned int codepoint) {
+    if (codepoint < LATIN_GLYPHS) {
+        return latin_loaded_[codepoint] ? &latin_glyphs_[codepoint] : nullptr;
+    }
+    auto glyph_it = glyphs_.find(codepoint);
+    return glyph_it != glyphs_.end() ? &glyph_it->second : nullptr;
+}
+
+GlyphInfo* FontFace::get_glyph_slow(unsigned int codepoint) {
+    if (GlyphInfo* existing = find_glyph(codepoint)) {
+        return existing;
     }
     
-    // Check if glyph is cached
-    auto& cache = size_it->second;
-    auto glyph_it = cache.glyphs.find(codepoint);
-    if (glyph_it != cache.glyphs.end()) {
-        return &glyph_it->second;
+    // Workers generate the distance field off the render thread; until it
+    // lands the glyph draws as a placeholder
+    if (face_ && g_font_system && g_font_system->request_glyph(this, codepoint)) {
+        GlyphInfo pending;
+        pending.pending = true;
+        if (codepoint < LATIN_GLYPHS) {
+            latin_glyphs_[codepoint] = pending;
+            latin_loaded_[codepoint] = true;
+            return &latin_glyphs_[codepoint];
+        }
+        return &(glyphs_[codepoint] = pending);
     }
     
-    // Load the glyph
-    return load_glyph(codepoint, size);
+    // Generate the distance field once; it serves every size and DPI
+    GlyphInfo glyph;
+    if (!load_glyph(codepoint, glyph)) {
+        return nullptr;
+    }
+    if (codepoint < LATIN_GLYPHS) {
+        latin_glyphs_[codepoint] = glyph;
+        latin_loaded_[codepoint] = true;
+        return &latin_glyphs_[codepoint];
+    }
+    return &(glyphs_[codepoint] = glyph);
 }
 
-GlyphInfo* FontFace::load_glyph(unsigned int codepoint, int size) {
+bool FontFace::load_glyph(unsigned int codepoint, GlyphInfo& glyph) {
     if (!face_) {
-        return nullptr;
+        return false;
     }
     
-    // Set size
-    FT_Set_Pixel_Sizes(face_, 0, static_cast<FT_UInt>(size));
-    
-    // Load glyph
-    if (FT_Load_Char(face_, codepoint, FT_LOAD_RENDER)) {
+    // Unhinted outline at the reference size
+    if (FT_Load_Char(face_, codepoint, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP)) {
         std::cerr << "Failed to load glyph for codepoint: " << codepoint << std::endl;
-        return nullptr;
+        return false;
     }
     
     FT_GlyphSlot g = face_->glyph;
     
-    // Create glyph info
-    GlyphInfo glyph;
-    glyph.size = Point2D(g->bitmap.width, g->bitmap.rows);
-    glyph.bearing = Point2D(g->bitmap_left, g->bitmap_top);
-    glyph.advance = g->advance.x >> 6; // Convert from 26.6 fixed point
-    
-    // Try to add to atlas if glyph fits
-    if (g->bitmap.width > 0 && g->bitmap.rows > 0) {
-        // Check if we should use atlas (for smaller glyphs)
-        bool use_atlas = g_font_system && g_font_system->try_add_to_atlas(glyph, g->bitmap.buffer, 
-                                                                         static_cast<int>(g->bitmap.width), static_cast<int>(g->bitmap.rows));
+    // Create glyph info; linear advance is 16.16 and matches FontMetrics
+    glyph = GlyphInfo();
+    glyph.advance = static_cast<float>(g->linearHoriAdvance) / 65536.0f;
+    
+    MsdfBitmap field;
+    if (g->format == FT_GLYPH_FORMAT_OUTLINE &&
+        MsdfGenerator::generate(g->outline, DISTANCE_RANGE, field)) {
+        glyph.size = Point2D(static_cast<float>(field.width), static_cast<float>(field.height));
+        glyph.bearing = Point2D(static_cast<float>(field.left), static_cast<float>(field.top));
         
-        if (!use_atlas) {
-            // Create individual texture for large glyphs
-            glGenTextures(1, &glyph.texture_id);
-            glBindTexture(GL_TEXTURE_2D, glyph.texture_id);
-            
-            // Set texture parameters
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);  
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            
-            // Clear texture first to avoid garbage data
-            if (g->bitmap.buffer == nullptr) {
-                // If no bitmap data, create cleared texture
-                std::vector<unsigned char> cleared(g->bitmap.width * g->bitmap.rows, 0);
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RED,
-                            static_cast<GLsizei>(g->bitmap.width), static_cast<GLsizei>(g->bitmap.rows), 
-                            0, GL_RED, GL_UNSIGNED_BYTE,
-                            cleared.data());
-            } else {
-                // Upload glyph bitmap
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RED,
-                            static_cast<GLsizei>(g->bitmap.width), static_cast<GLsizei>(g->bitmap.rows), 
-                            0, GL_RED, GL_UNSIGNED_BYTE,
-                            g->bitmap.buffer);
-            }
-            
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glyph.in_atlas = false;
+        // Shared atlas only; a glyph that cannot be placed draws nothing
+        if (g_font_system) {
+            g_font_system->add_to_atlas(this, codepoint, glyph, field);
         }
     }
     
-    // Store in cache
-    size_caches_[size].glyphs[codepoint] = glyph;
-    return &size_caches_[size].glyphs[codepoint];
+    return true;
 }
 
-float FontFace::get_line_height(int size) const {
-    auto it = size_caches_.find(size);
-    if (it != size_caches_.end()) {
-        return it->second.line_height;
+FT_Face FontFace::create_face(FT_Library library, const MappedFile& file, float weight) {
+    FT_Face face = nullptr;
+    FT_Error error = FT_New_Memory_Face(library, file.data(), static_cast<FT_Long>(file.size()), 0, &face);
+    if (error) {
+        std::cerr << "Failed to load font: " << file.get_path() << " (error: " << error << ")" << std::endl;
+        return nullptr;
     }
     
-    // Calculate from face metrics
-    if (face_) {
-        FT_Set_Pixel_Sizes(const_cast<FT_Face>(face_), 0, static_cast<FT_UInt>(size));
-        return face_->size->metrics.height >> 6;
+    // Variations apply to outlines, advances and metrics read from the face
+    if (weight > 0.0f) {
+        apply_weight(library, face, weight, file.get_path());
     }
     
-    return size * 1.2f; // Fallback
+    // Outlines are always loaded at the reference size; other sizes scale the field
+    FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(REFERENCE_SIZE));
+    return face;
 }
 
-float FontFace::get_ascender(int size) const {
-    auto it = size_caches_.find(size);
-    if (it != size_caches_.end()) {
-        return it->second.ascender;
+void FontFace::apply_weight(FT_Library library, FT_Face face, float weight, const std::string& path) {
+    if (!FT_HAS_MULTIPLE_MASTERS(face)) {
+        return;
     }
     
-    if (face_) {
-        FT_Set_Pixel_Sizes(const_cast<FT_Face>(face_), 0, static_cast<FT_UInt>(size));
-        return face_->size->metrics.ascender >> 6;
+    FT_MM_Var* variations = nullptr;
+    if (FT_Get_MM_Var(face, &variations) || !variations) {
+        return;
     }
     
-    return size * 0.8f; // Fallback
-}
-
-float FontFace::get_descender(int size) const {
-    auto it = size_caches_.find(size);
-    if (it != size_caches_.end()) {
-        return it->second.descender;
+    // Every axis at its default except weight, clamped to the axis range
+    const FT_ULong weight_tag = FT_MAKE_TAG('w', 'g', 'h', 't');
+    std::vector<FT_Fixed> coordinates(variations->num_axis);
+    bool has_weight = false;
+    for (FT_UInt i = 0; i < variations->num_axis; ++i) {
+        const FT_Var_Axis& axis = variations->axis[i];
+        coordinates[i] = axis.def;
+        if (axis.tag == weight_tag) {
+            FT_Fixed value = static_cast<FT_Fixed>(std::lround(weight * 65536.0f));
+            coordinates[i] = std::clamp(value, axis.minimum, axis.maximum);
+            has_weight = true;
+        }
     }
     
-    if (face_) {
-        FT_Set_Pixel_Sizes(const_cast<FT_Face>(face_), 0, static_cast<FT_UInt>(size));
-        return face_->size->metrics.descender >> 6;
+    if (!has_weight) {
+        std::cerr << "Font has no weight axis: " << path << std::endl;
+    } else if (FT_Set_Var_Design_Coordinates(face, variations->num_axis, coordinates.data())) {
+        std::cerr << "Failed to set font weight " << weight << ": " << path << std::endl;
     }
     
-    return size * 0.2f; // Fallback
+    FT_Done_MM_Var(library, variations);
 }
 
 TextMeasurement FontFace::measure_text(const std::string& text, float font_size_px) const {
@@ -274,8 +304,11 @@ bool FontSystem::initialize() {
     // Setup VAO/VBO for batch rendering
     setup_render_buffers();
     
-    // Create texture atlas
-    create_texture_atlas();
+    // Create glyph atlas pages
+    create_glyph_atlas();
+    
+    // Glyph workers; without them glyphs rasterize on the render thread
+    glyph_rasterizer_.start();
     
     // Reserve space for batch vertices
     vertex_batch_.reserve(MAX_BATCH_SIZE * 6); // 6 vertices per glyph (2 triangles)
@@ -292,8 +325,22 @@ void FontSystem::shutdown() {
         return;
     }
     
-    // Clear all fonts
+    // Workers hold font handles; stop them before the fonts go
+    glyph_rasterizer_.stop();
+    completed_glyphs_.clear();
+    if (upload_pbo_) {
+        glDeleteBuffers(1, &upload_pbo_);
+        upload_pbo_ = 0;
+    }
+    
+    // Clear all fonts (runs are keyed by font handle)
+    run_cache_.clear();
+    prewarm_queue_.clear();
+    fallback_fonts_.clear();
+    fallback_cache_.clear();
+    fonts_by_id_.clear();
     fonts_.clear();
+    font_files_.clear();
     
     // Destroy VAO/VBO
     if (text_vao_) {
@@ -307,14 +354,13 @@ void FontSystem::shutdown() {
     
     // Destroy shader
     if (text_shader_program_) {
+        ShaderCache::get_instance().release_program(text_shader_program_);
         glDeleteProgram(text_shader_program_);
         text_shader_program_ = 0;
     }
     
-    // Destroy atlas texture if it exists
-    if (atlas_ && atlas_->texture_id) {
-        glDeleteTextures(1, &atlas_->texture_id);
-    }
+    // Destroy atlas pages
+    glyph_atlas_.shutdown();
     
     // Shutdown FreeType
     if (ft_library_) {
@@ -326,99 +372,436 @@ void FontSystem::shutdown() {
     initialized_ = false;
 }
 
-bool FontSystem::load_font(const std::string& name, const std::string& path, int default_size) {
+bool FontSystem::load_font(const std::string& name, const std::string& path, int default_size,
+                           float weight) {
     // Check if already loaded
     if (fonts_.find(name) != fonts_.end()) {
         return true;
     }
     
     // Create and load font face
-    auto font = std::make_unique<FontFace>(path, default_size);
+    auto font = std::make_unique<FontFace>(path, default_size, weight);
     if (!font->load()) {
         return false;
     }
     
     fonts_[name] = std::move(font);
+    fonts_by_id_.clear();  // A name may resolve differently now ("default")
     return true;
 }
 
+std::shared_ptr<MappedFile> FontSystem::map_font_file(const std::string& path) {
+    auto it = font_files_.find(path);
+    if (it != font_files_.end()) {
+        if (std::shared_ptr<MappedFile> file = it->second.lock()) {
+            return file;
+        }
+    }
+    
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        return nullptr;
+    }
+    font_files_[path] = file;
+    return file;
+}
+
 FontFace* FontSystem::get_font(const std::string& name) {
     auto it = fonts_.find(name);
     if (it != fonts_.end()) {
         return it->second.get();
     }
+    
+    // Styles without a font family ask for "default", which draws as Inter
+    if (name == "default") {
+        it = fonts_.find("Inter");
+        if (it != fonts_.end()) {
+            return it->second.get();
+        }
+    }
     return nullptr;
 }
 
-// UTF-8 decoding helper
-static unsigned int decode_utf8(const std::string& text, size_t& index) {
-    unsigned char c = static_cast<unsigned char>(text[index]);
-    unsigned int codepoint = 0;
-    
-    if ((c & 0x80) == 0) {
-        // ASCII (1 byte)
-        codepoint = c;
-        index += 1;
-    } else if ((c & 0xE0) == 0xC0) {
-        // 2-byte sequence
-        if (index + 1 < text.length()) {
-            codepoint = static_cast<unsigned int>(((c & 0x1F) << 6) | (text[index + 1] & 0x3F));
-            index += 2;
-        } else {
-            index += 1; // Invalid sequence
-        }
-    } else if ((c & 0xF0) == 0xE0) {
-        // 3-byte sequence
-        if (index + 2 < text.length()) {
-            codepoint = static_cast<unsigned int>(((c & 0x0F) << 12) | 
-                       ((text[index + 1] & 0x3F) << 6) | 
-                       (text[index + 2] & 0x3F));
-            index += 3;
-        } else {
-            index += 1; // Invalid sequence
-        }
-    } else if ((c & 0xF8) == 0xF0) {
-        // 4-byte sequence
-        if (index + 3 < text.length()) {
-            codepoint = static_cast<unsigned int>(((c & 0x07) << 18) | 
-                       ((text[index + 1] & 0x3F) << 12) | 
-                       ((text[index + 2] & 0x3F) << 6) | 
-                       (text[index + 3] & 0x3F));
-            index += 4;
-        } else {
-            index += 1; // Invalid sequence
-        }
-    } else {
-        // Invalid UTF-8 start byte
-        index += 1;
+FontFace* FontSystem::get_font(FontId id) {
+    if (!id.is_valid()) {
+        return nullptr;
+    }
+    if (id.get_index() >= fonts_by_id_.size()) {
+        fonts_by_id_.resize(FontId::get_count(), nullptr);
     }
     
-    return codepoint;
+    // Unknown names are looked up again each call; they are rare mistakes
+    FontFace*& font = fonts_by_id_[id.get_index()];
+    if (!font) {
+        font = get_font(id.get_name());
+    }
+    return font;
 }
 
 Point2D FontSystem::measure_text(const std::string& text, const std::string& font_name, int size) {
     // Use accurate measurement if available
-    TextMeasurement measurement = measure_text_accurate(text, font_name, static_cast<float>(size));
+    const TextMeasurement& measurement = measure_text_accurate(text, font_name, static_cast<float>(size));
     return Point2D(measurement.width, measurement.height);
 }
 
-TextMeasurement FontSystem::measure_text_accurate(const std::string& text, const std::string& font_name, float font_size_px) {
+const TextMeasurement& FontSystem::measure_text_accurate(const std::string& text, const std::string& font_name, float font_size_px) {
     FontFace* font = get_font(font_name);
     if (!font) {
-        TextMeasurement empty;
-        empty.width = 0;
-        empty.height = 0;
-        empty.ascender = 0;
-        empty.descender = 0;
-        empty.line_gap = 0;
+        static const TextMeasurement empty{};
+        return empty;
+    }
+    
+    return get_shaped_run(font, text, font_size_px).measurement;
+}
+
+const TextMeasurement& FontSystem::measure_text_accurate(const std::string& text, FontId font_id, float font_size_px) {
+    FontFace* font = get_font(font_id);
+    if (!font) {
+        static const TextMeasurement empty{};
         return empty;
     }
     
-    // Use cache for performance
-    TextMeasurementCache::CacheKey key{text, font_name, font_size_px};
-    return measurement_cache_.measure(key, [&]() {
-        return font->measure_text(text, font_size_px);
+    return get_shaped_run(font, text, font_size_px).measurement;
+}
+
+const ShapedRun& FontSystem::get_shaped_run(FontFace* font, std::string_view text, float font_size_px,
+                                            bool with_quads) {
+    uint64_t hash = ShapedRunCache::hash_key(font, text, font_size_px);
+    ShapedRun* run = run_cache_.find(hash, font, text, font_size_px);
+    if (!run) {
+        run = &run_cache_.insert(hash, font, text, font_size_px);
+        shape_run(font, text, font_size_px, *run);
+    }
+    
+    if (with_quads) {
+        prepare_run_quads(font, font_size_px, *run);
+    }
+    return *run;
+}
+
+void FontSystem::shape_owned_run(FontFace* font, std::string_view text, float font_size_px, ShapedRun& run) {
+    run = ShapedRun();
+    shape_run(font, text, font_size_px, run);
+}
+
+void FontSystem::prepare_run_quads(FontFace* font, float font_size_px, ShapedRun& run) {
+    // Placeholder quads are rebuilt once the glyphs they stand in for land,
+    // and any quads once a page they may sample has been repacked
+    if (!run.has_quads || run.quads_generation < atlas_evicted_generation_ ||
+        (run.has_placeholders && run.quads_generation != glyph_generation_)) {
+        build_run_quads(font, font_size_px, run);
+    }
+    glyph_atlas_.touch_pages(run.atlas_pages);
+}
+
+void FontSystem::begin_scale_prewarm(float from_scale, float to_scale) {
+    prewarm_queue_.clear();
+    if (from_scale <= 0.0f || to_scale <= 0.0f || from_scale == to_scale) {
+        return;
+    }
+    
+    // Cached keys only hold const handles; map them back to the owned faces
+    std::unordered_map<const FontFace*, FontFace*> faces;
+    for (auto& [name, face] : fonts_) {
+        faces.emplace(face.get(), face.get());
+    }
+    
+    // Themes size text as base * scale with bases on a quarter pixel, so
+    // recover the base and scale it the same way to hit the exact key the
+    // relayout will ask for
+    run_cache_.for_each_key([&](const FontFace* font, std::string_view text, float size, bool has_quads) {
+        auto face = faces.find(font);
+        if (face == faces.end()) {
+            return;
+        }
+        float base_size = std::round(size / from_scale * 4.0f) / 4.0f;
+        prewarm_queue_.push_back(PrewarmRun{face->second, std::string(text), base_size * to_scale, has_quads});
     });
+    
+    // Room for both scales' runs while the window may still move back
+    if (!retained_run_capacity_) {
+        retained_run_capacity_ = run_cache_.get_max_size();
+        run_cache_.set_max_size(retained_run_capacity_ * 2);
+    }
+}
+
+bool FontSystem::prewarm_runs(std::chrono::steady_clock::time_point deadline) {
+    // Most recently used first, so the visible text is ready soonest
+    while (!prewarm_queue_.empty()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        const PrewarmRun& pending = prewarm_queue_.front();
+        get_shaped_run(pending.font, pending.text, pending.size, pending.with_quads);
+        prewarm_queue_.pop_front();
+    }
+    return true;
+}
+
+void FontSystem::end_scale_retention() {
+    prewarm_queue_.clear();
+    if (retained_run_capacity_) {
+        run_cache_.set_max_size(retained_run_capacity_);  // Drops the least recently used scale's runs
+        retained_run_capacity_ = 0;
+    }
+}
+
+void FontSystem::shape_run(FontFace* font, std::string_view text, float font_size_px, ShapedRun& run) {
+    // Line metrics always come from the requested font
+    run.measurement = font->measure_text(std::string(), font_size_px);
+    
+    shape_codepoints_.clear();
+    shape_offsets_.clear();
+    shape_fonts_.clear();
+    for (size_t i = 0; i < text.size(); ) {
+        shape_offsets_.push_back(static_cast<uint32_t>(i));
+        uint32_t codepoint = decode_utf8(text, i);
+        shape_codepoints_.push_back(codepoint);
+        shape_fonts_.push_back(resolve_font(font, codepoint));
+    }
+    
+    // Shape each stretch of one face together, so kerning stays within a face
+    auto& glyphs = run.measurement.glyphs;
+    size_t count = shape_codepoints_.size();
+    glyphs.reserve(count);
+    for (size_t start = 0; start < count; ) {
+        FontFace* face = shape_fonts_[start];
+        size_t end = start + 1;
+        while (end < count && shape_fonts_[end] == face) {
+            end++;
+        }
+        
+        if (const FontMetrics* metrics = face->get_metrics()) {
+            metrics->shape_codepoints(shape_codepoints_.data() + start, end - start, font_size_px, glyphs);
+        } else {
+            // Same approximation as FontFace::measure_text without metrics
+            for (size_t i = start; i < end; ++i) {
+                glyphs.push_back(ShapedGlyph{0, shape_codepoints_[i], font_size_px * 0.6f, 0.0f, 0.0f, 0.0f});
+            }
+        }
+        start = end;
+    }
+    
+    if (std::any_of(shape_fonts_.begin(), shape_fonts_.end(), [font](FontFace* face) { return face != font; })) {
+        run.glyph_fonts = shape_fonts_;
+    }
+    
+    // Prefix sums of the shaped advances; caret stops sit between codepoints
+    run.prefix_advances.reserve(count + 1);
+    run.byte_offsets.reserve(count + 1);
+    float pen_x = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        run.prefix_advances.push_back(pen_x);
+        run.byte_offsets.push_back(shape_offsets_[i]);
+        pen_x += glyphs[i].x_advance;
+    }
+    run.prefix_advances.push_back(pen_x);
+    run.byte_offsets.push_back(static_cast<uint32_t>(text.size()));
+    run.measurement.width = pen_x;
+}
+
+FontFace* FontSystem::resolve_font(FontFace* font, uint32_t codepoint) {
+    // Latin-1 the font has is a flat table lookup
+    if (codepoint < 256 && font->has_glyph(codepoint)) {
+        return font;
+    }
+    
+    auto it = fallback_cache_.find(FallbackKey{font, codepoint});
+    if (it != fallback_cache_.end()) {
+        return it->second;
+    }
+    
+    FontFace* resolved = font;
+    if (!font->has_glyph(codepoint)) {
+        for (FontFace* fallback : fallback_fonts_) {
+            if (fallback != font && fallback->has_glyph(codepoint)) {
+                resolved = fallback;
+                break;
+            }
+        }
+    }
+    fallback_cache_.emplace(FallbackKey{font, codepoint}, resolved);
+    return resolved;
+}
+
+bool FontSystem::add_fallback_font(const std::string& name) {
+    auto it = fonts_.find(name);
+    if (it == fonts_.end()) {
+        std::cerr << "Fallback font not loaded: " << name << std::endl;
+        return false;
+    }
+    if (std::find(fallback_fonts_.begin(), fallback_fonts_.end(), it->second.get()) == fallback_fonts_.end()) {
+        fallback_fonts_.push_back(it->second.get());
+        
+        // Resolutions and runs shaped without this face are stale
+        fallback_cache_.clear();
+        run_cache_.clear();
+    }
+    return true;
+}
+
+void FontSystem::clear_fallback_fonts() {
+    fallback_fonts_.clear();
+    fallback_cache_.clear();
+    run_cache_.clear();
+}
+
+void FontSystem::build_run_quads(FontFace* font, float font_size_px, ShapedRun& run) {
+    run.quads.clear();
+    run.has_placeholders = false;
+    run.atlas_pages = 0;
+    run.quads_generation = glyph_generation_;  // A repack while building leaves it stale
+    float scale = FontFace::get_glyph_scale(font_size_px);
+    const auto& glyphs = run.measurement.glyphs;
+    size_t count = std::min(glyphs.size(), run.glyph_count());
+    
+    // Glyphs of every face in the fallback chain share the atlas pages, so a
+    // mixed-script run batches like a single-face one; pen positions come
+    // from the prefix table
+    for (size_t i = 0; i < count; ++i) {
+        FontFace* face = run.glyph_fonts.empty() ? font : run.glyph_fonts[i];
+        GlyphInfo* glyph = face->get_glyph(glyphs[i].codepoint);
+        if (glyph && glyph->pending) {
+            // Faint half-em block inside the glyph's advance
+            float advance = run.prefix_advances[i + 1] - run.prefix_advances[i];
+            if (advance > 0.0f) {
+                GlyphQuad quad;
+                quad.x0 = run.prefix_advances[i] + advance * 0.15f;
+                quad.x1 = run.prefix_advances[i + 1] - advance * 0.15f;
+                quad.y0 = -font_size_px * 0.5f;
+                quad.y1 = 0.0f;
+                quad.uv_rect = placeholder_uv_;
+                quad.texture_id = glyph_atlas_.get_texture(0);
+                quad.glyph_index = static_cast<uint32_t>(i);
+                run.quads.push_back(quad);
+                run.atlas_pages |= 1u;
+            }
+            run.has_placeholders = true;
+            continue;
+        }
+        if (!glyph || !glyph->texture_id) {
+            continue;
+        }
+        
+        GlyphQuad quad;
+        quad.x0 = run.prefix_advances[i] + glyph->bearing.x * scale;
+        quad.y0 = -glyph->bearing.y * scale;
+        quad.x1 = quad.x0 + glyph->size.x * scale;
+        quad.y1 = quad.y0 + glyph->size.y * scale;
+        quad.uv_rect = glyph->uv_rect;
+        quad.texture_id = glyph->texture_id;
+        quad.glyph_index = static_cast<uint32_t>(i);
+        run.quads.push_back(quad);
+        
+        // Keep the page current so glyphs placed later in this run can't repack it
+        run.atlas_pages |= 1u << glyph->atlas_page;
+        glyph_atlas_.touch(glyph->atlas_page);
+    }
+    run.has_quads = true;
+}
+
+// ShapedRun implementation
+
+size_t ShapedRun::fit_glyphs(float max_width) const {
+    if (prefix_advances.empty()) {
+        return 0;
+    }
+    // First stop past max_width; every glyph before it ends inside
+    auto it = std::upper_bound(prefix_advances.begin() + 1, prefix_advances.end(), max_width);
+    return static_cast<size_t>(it - prefix_advances.begin()) - 1;
+}
+
+size_t ShapedRun::hit_test(float x) const {
+    if (prefix_advances.empty()) {
+        return 0;
+    }
+    auto it = std::upper_bound(prefix_advances.begin(), prefix_advances.end(), x);
+    if (it == prefix_advances.begin()) {
+        return 0;
+    }
+    if (it == prefix_advances.end()) {
+        return glyph_count();
+    }
+    size_t after = static_cast<size_t>(it - prefix_advances.begin());
+    // Nearer of the two stops around x
+    return (x - prefix_advances[after - 1] < prefix_advances[after] - x) ? after - 1 : after;
+}
+
+float ShapedRun::caret_x(size_t byte_offset) const {
+    if (prefix_advances.empty()) {
+        return 0.0f;
+    }
+    auto it = std::lower_bound(byte_offsets.begin(), byte_offsets.end(), byte_offset);
+    if (it == byte_offsets.end()) {
+        return prefix_advances.back();
+    }
+    return prefix_advances[static_cast<size_t>(it - byte_offsets.begin())];
+}
+
+// ShapedRunCache implementation
+
+uint64_t ShapedRunCache::hash_key(const FontFace* font, std::string_view text, float size) {
+    // FNV-1a over the text, then the font handle and size
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    mix(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(font)));
+    uint32_t size_bits;
+    std::memcpy(&size_bits, &size, sizeof(size_bits));
+    mix(size_bits);
+    return hash;
+}
+
+ShapedRun* ShapedRunCache::find(uint64_t hash, const FontFace* font, std::string_view text, float size) {
+    auto it = index_.find(KeyView{hash, font, size, text});
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    
+    // Move to front (list splice keeps the node, so the key view stays valid)
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->run;
+}
+
+ShapedRun& ShapedRunCache::insert(uint64_t hash, const FontFace* font, std::string_view text, float size) {
+    while (!entries_.empty() && entries_.size() >= max_size_) {
+        evict_oldest();
+    }
+    
+    entries_.emplace_front();
+    Entry& entry = entries_.front();
+    entry.text.assign(text.data(), text.size());
+    entry.font = font;
+    entry.size = size;
+    entry.hash = hash;
+    index_.emplace(KeyView{hash, font, size, entry.text}, entries_.begin());
+    return entry.run;
+}
+
+void ShapedRunCache::evict_oldest() {
+    const Entry& oldest = entries_.back();
+    index_.erase(KeyView{oldest.hash, oldest.font, oldest.size, oldest.text});
+    entries_.pop_back();
+}
+
+void ShapedRunCache::clear() {
+    index_.clear();
+    entries_.clear();
+}
+
+void ShapedRunCache::set_max_size(size_t max_size) {
+    max_size_ = std::max<size_t>(max_size, 1);
+    while (entries_.size() > max_size_) {
+        evict_oldest();
+    }
 }
 
 // Viewport immediate mode text rendering - for 3D overlays like navigation widget
@@ -448,7 +831,8 @@ void FontSystem::render_text(CanvasRenderer* renderer, const std::string& text,
     
     float x = position.x;
     float y = position.y;
-    float baseline_y = y + font->get_ascender(size);
+    float baseline_y = std::round(y + font->get_ascender(size));
+    float scale = FontFace::get_glyph_scale(static_cast<float>(size));
     
     // Group glyphs by texture for efficient batching
     struct TextureBatch {
@@ -459,14 +843,16 @@ void FontSystem::render_text(CanvasRenderer* renderer, const std::string& text,
     
     // Collect all glyphs and group by texture
     for (size_t i = 0; i < text.length(); ) {
-        unsigned int codepoint = decode_utf8(text, i);
+        uint32_t codepoint = decode_utf8(text, i);
         
-        GlyphInfo* glyph = font->get_glyph(codepoint, size);
+        GlyphInfo* glyph = resolve_font(font, codepoint)->get_glyph(codepoint);
         if (glyph && glyph->texture_id) {
+            glyph_atlas_.touch(glyph->atlas_page);
+            
             // Calculate glyph position
             Point2D glyph_pos(
-                x + glyph->bearing.x,
-                baseline_y - glyph->bearing.y
+                x + glyph->bearing.x * scale,
+                baseline_y - glyph->bearing.y * scale
             );
             
             // Find or create batch for this texture
@@ -488,7 +874,7 @@ void FontSystem::render_text(CanvasRenderer* renderer, const std::string& text,
         }
         
         if (glyph) {
-            x += glyph->advance;
+            x += glyph->advance * scale;
         }
     }
     
@@ -498,7 +884,7 @@ void FontSystem::render_text(CanvasRenderer* renderer, const std::string& text,
         
         // Add all glyphs for this texture to the vertex batch
         for (const auto& [glyph, pos] : batch.glyphs) {
-            add_glyph_to_batch(*glyph, pos);
+            add_glyph_to_batch(*glyph, pos, scale);
         }
         
         // Flush this texture's batch
@@ -519,21 +905,54 @@ bool FontSystem::load_default_fonts() {
     std::string font_path = "assets/fonts/InterVariable.ttf";
     
     // Load as default font with different names for different use cases
-    if (!load_font("Inter", font_path, 14)) {
+    if (!load_font("Inter", font_path, 14, 400.0f)) {
         std::cerr << "Failed to load Inter Variable font at: " << font_path << std::endl;
         return false;
     }
     
-    // For now, use same variable font for different weights
-    // Later we can implement font variation axes for weight control
-    if (!load_font("Inter-Medium", font_path, 16)) {
+    // Weight instances of the same variable font; the file is mapped once
+    if (!load_font("Inter-Medium", font_path, 16, 500.0f)) {
         std::cerr << "Failed to load Inter for medium weight" << std::endl;
     }
     
-    if (!load_font("Inter-Bold", font_path, 14)) {
+    if (!load_font("Inter-Bold", font_path, 14, 700.0f)) {
         std::cerr << "Failed to load Inter for bold weight" << std::endl;
     }
     
+    // Fallback chain for scripts Inter does not cover. Files are mapped, so
+    // large CJK collections only page in the glyphs actually drawn.
+    static const char* const fallback_paths[] = {
+#if defined(VOXELUX_WINDOWS)
+        "C:/Windows/Fonts/segoeui.ttf",
+        "C:/Windows/Fonts/msyh.ttc",
+        "C:/Windows/Fonts/YuGothM.ttc",
+        "C:/Windows/Fonts/malgun.ttf",
+        "C:/Windows/Fonts/seguisym.ttf",
+#elif defined(VOXELUX_MACOS)
+        "/System/Library/Fonts/PingFang.ttc",
+        "/System/Library/Fonts/Hiragino Sans GB.ttc",
+        "/System/Library/Fonts/AppleSDGothicNeo.ttc",
+        "/System/Library/Fonts/Apple Symbols.ttf",
+#else
+        "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+        "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+        "/usr/share/fonts/google-noto-cjk/NotoSansCJK-Regular.ttc",
+        "/usr/share/fonts/truetype/noto/NotoSans-Regular.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+#endif
+    };
+    int fallback_index = 0;
+    for (const char* path : fallback_paths) {
+        std::error_code error;
+        if (!std::filesystem::exists(path, error)) {
+            continue;
+        }
+        std::string name = "Fallback-" + std::to_string(fallback_index++);
+        if (load_font(name, path, 14)) {
+            add_fallback_font(name);
+        }
+    }
+    
     return true;
 }
 
@@ -559,66 +978,55 @@ out vec4 FragColor;
 
 uniform sampler2D text;
 uniform vec4 textColor;
+uniform float distanceRange;  // Field range in texels
+
+float median(float r, float g, float b) {
+    return max(min(r, g), min(max(r, g), b));
+}
 
 void main() {
-    float alpha = texture(text, TexCoords).r;
-    // More aggressive alpha cutoff to prevent ghost pixels
-    if (alpha < 0.1) {
-        discard;  // Don't render pixels with low alpha
+    // Multi-channel distance field: the median channel is the signed distance
+    vec3 msd = texture(text, TexCoords).rgb;
+    float sd = median(msd.r, msd.g, msd.b) - 0.5;
+    
+    // Field range in screen pixels at the current scale
+    vec2 unit_range = vec2(distanceRange) / vec2(textureSize(text, 0));
+    vec2 screen_tex_size = vec2(1.0) / fwidth(TexCoords);
+    float screen_px_range = max(0.5 * dot(unit_range, screen_tex_size), 1.0);
+    
+    float alpha = clamp(screen_px_range * sd + 0.5, 0.0, 1.0);
+    if (alpha <= 0.0) {
+        discard;
     }
-    // Apply gamma correction for better text rendering
-    alpha = pow(alpha, 1.0 / 2.2);
     FragColor = vec4(textColor.rgb, textColor.a * alpha);
 }
 )";
     
-    // Compile vertex shader
-    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_shader_src, nullptr);
-    glCompileShader(vertex_shader);
-    
-    // Check vertex shader compilation
-    GLint success;
-    GLchar info_log[512];
-    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex_shader, 512, nullptr, info_log);
-        std::cerr << "Text vertex shader compilation failed: " << info_log << std::endl;
-    }
-    
-    // Compile fragment shader
-    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_shader_src, nullptr);
-    glCompileShader(fragment_shader);
-    
-    // Check fragment shader compilation
-    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment_shader, 512, nullptr, info_log);
-        std::cerr << "Text fragment shader compilation failed: " << info_log << std::endl;
+    // Immediate-mode text is only used for debug overlays, so link it off the startup path
+    text_shader_program_ = ShaderCache::get_instance().load_program("font_text",
+                                                                    vertex_shader_src,
+                                                                    fragment_shader_src,
+                                                                    nullptr,
+                                                                    true);
+    text_shader_ready_ = false;
+}
+
+bool FontSystem::ensure_text_shader_ready() {
+    if (text_shader_ready_) {
+        return true;
     }
-    
-    // Link program
-    text_shader_program_ = glCreateProgram();
-    glAttachShader(text_shader_program_, vertex_shader);
-    glAttachShader(text_shader_program_, fragment_shader);
-    glLinkProgram(text_shader_program_);
-    
-    // Check program linking
-    glGetProgramiv(text_shader_program_, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(text_shader_program_, 512, nullptr, info_log);
-        std::cerr << "Text shader program linking failed: " << info_log << std::endl;
+    if (!ShaderCache::get_instance().finish_program(text_shader_program_)) {
+        text_shader_program_ = 0;
+        return false;
     }
     
     // Get uniform locations
     projection_uniform_ = static_cast<unsigned int>(glGetUniformLocation(text_shader_program_, "projection"));
     text_color_uniform_ = static_cast<unsigned int>(glGetUniformLocation(text_shader_program_, "textColor"));
     texture_uniform_ = static_cast<unsigned int>(glGetUniformLocation(text_shader_program_, "text"));
-    
-    // Clean up
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
+    distance_range_uniform_ = static_cast<unsigned int>(glGetUniformLocation(text_shader_program_, "distanceRange"));
+    text_shader_ready_ = true;
+    return true;
 }
 
 void FontSystem::setup_render_buffers() {
@@ -640,11 +1048,11 @@ void FontSystem::setup_render_buffers() {
     glBindVertexArray(0);
 }
 
-void FontSystem::add_glyph_to_batch(const GlyphInfo& glyph, const Point2D& position) {
+void FontSystem::add_glyph_to_batch(const GlyphInfo& glyph, const Point2D& position, float scale) {
     float x = position.x;
     float y = position.y;
-    float w = glyph.size.x;
-    float h = glyph.size.y;
+    float w = glyph.size.x * scale;
+    float h = glyph.size.y * scale;
     
     // Calculate texture coordinates
     float u0 = 0.0f, v0 = 0.0f;
@@ -671,7 +1079,8 @@ void FontSystem::add_glyph_to_batch(const GlyphInfo& glyph, const Point2D& posit
 }
 
 void FontSystem::flush_batch(CanvasRenderer* renderer, unsigned int texture_id, const ColorRGBA& color) {
-    if (vertex_batch_.empty()) {
+    if (vertex_batch_.empty() || !ensure_text_shader_ready()) {
+        vertex_batch_.clear();
         return;
     }
     
@@ -707,6 +1116,7 @@ void FontSystem::flush_batch(CanvasRenderer* renderer, unsigned int texture_id,
     
     glUniform4f(static_cast<GLint>(text_color_uniform_), color.r, color.g, color.b, color.a);
     glUniform1i(static_cast<GLint>(texture_uniform_), 0);
+    glUniform1f(static_cast<GLint>(distance_range_uniform_), FontFace::DISTANCE_RANGE);
     
     // Bind texture
     glActiveTexture(GL_TEXTURE0);
@@ -730,103 +1140,169 @@ void FontSystem::flush_batch(CanvasRenderer* renderer, unsigned int texture_id,
 }
 
 void FontSystem::render_glyph(CanvasRenderer* renderer, const GlyphInfo& glyph, 
-                             const Point2D& position, const ColorRGBA& color) {
+                             const Point2D& position, float scale, const ColorRGBA& color) {
     if (!glyph.texture_id || glyph.size.x == 0 || glyph.size.y == 0) {
         return; // Skip empty glyphs (like spaces)
     }
     
     // Add to batch
-    add_glyph_to_batch(glyph, position);
+    add_glyph_to_batch(glyph, position, scale);
     
     // For now, flush immediately (later we can batch multiple glyphs)
     flush_batch(renderer, glyph.texture_id, color);
 }
 
-void FontSystem::create_texture_atlas() {
-    // Create texture atlas for glyph packing
-    atlas_ = std::make_unique<TextureAtlas>();
-    
-    // Create the atlas texture
-    glGenTextures(1, &atlas_->texture_id);
-    glBindTexture(GL_TEXTURE_2D, atlas_->texture_id);
-    
-    // Set texture parameters for crisp text rendering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // Allocate empty texture (single channel for glyphs)
-    std::vector<unsigned char> empty_data(static_cast<size_t>(atlas_->width * atlas_->height), 0);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 
-                atlas_->width, atlas_->height, 
-                0, GL_RED, GL_UNSIGNED_BYTE, 
-                empty_data.data());
+void FontSystem::create_glyph_atlas() {
+    if (!glyph_atlas_.initialize(GLYPH_ATLAS_PAGE_SIZE, GLYPH_ATLAS_MAX_PAGES, AtlasFormat::RGB8,
+                                 TextureOwner::GlyphAtlas)) {
+        std::cerr << "Failed to create glyph atlas" << std::endl;
+        return;
+    }
     
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Repacked pages drop their glyphs; quads built earlier may sample them
+    glyph_atlas_.set_eviction_callback([this](void* owner, uint32_t codepoint) {
+        if (owner) {
+            static_cast<FontFace*>(owner)->evict_glyph(codepoint);
+        }
+        atlas_evicted_generation_ = ++glyph_generation_;
+    });
     
-    // Reset packing position
-    atlas_->current_x = 1; // Leave 1 pixel border
-    atlas_->current_y = 1;
-    atlas_->row_height = 0;
+    // Placeholder: 4x4 texels at the outline value (half coverage); sampling
+    // the inner 2x2 keeps bilinear filtering off the neighbours. Its page is
+    // pinned so the texels are never repacked away.
+    const int placeholder_size = 4;
+    AtlasSlot slot;
+    if (glyph_atlas_.allocate(nullptr, 0, placeholder_size, placeholder_size, slot)) {
+        std::vector<unsigned char> texels(placeholder_size * placeholder_size * 3, 128);
+        glyph_atlas_.upload(slot, texels.data());
+        glyph_atlas_.pin_page(slot.page);
+        
+        float size = static_cast<float>(GLYPH_ATLAS_PAGE_SIZE);
+        placeholder_uv_ = Rect2D((static_cast<float>(slot.x) + 1.5f) / size, (static_cast<float>(slot.y) + 1.5f) / size,
+                                 1.0f / size, 1.0f / size);
+    }
+}
+
+void FontSystem::set_atlas_slot(GlyphInfo& glyph, const AtlasSlot& slot) {
+    glyph.uv_rect = slot.uv;
+    glyph.in_atlas = true;
+    glyph.texture_id = slot.texture_id;
+    glyph.atlas_page = slot.page;
 }
 
-bool FontSystem::try_add_to_atlas(GlyphInfo& glyph, const unsigned char* bitmap_data, 
-                                  int width, int height) {
-    if (!atlas_ || !atlas_->texture_id) {
+bool FontSystem::add_to_atlas(FontFace* font, unsigned int codepoint, GlyphInfo& glyph, const MsdfBitmap& field) {
+    AtlasSlot slot;
+    if (!glyph_atlas_.allocate(font, codepoint, field.width, field.height, slot)) {
         return false;
     }
-    
-    // Don't use atlas for very large glyphs
-    const int MAX_GLYPH_SIZE = 128;
-    if (width > MAX_GLYPH_SIZE || height > MAX_GLYPH_SIZE) {
+    glyph_atlas_.upload(slot, field.pixels.data());
+    set_atlas_slot(glyph, slot);
+    return true;
+}
+
+void FontSystem::release_atlas_glyphs(const FontFace* font) {
+    glyph_atlas_.release_owner(font);
+}
+
+bool FontSystem::request_glyph(FontFace* font, unsigned int codepoint) {
+    if (!glyph_rasterizer_.is_running() || !font || !font->get_file()) {
         return false;
     }
+    glyph_rasterizer_.request(font, font->get_file(), font->get_weight(), codepoint);
+    return true;
+}
+
+void FontSystem::begin_frame() {
+    glyph_atlas_.begin_frame();
+    process_glyph_uploads();
+}
+
+void FontSystem::process_glyph_uploads() {
+    completed_glyphs_.clear();
+    glyph_rasterizer_.take_completed(completed_glyphs_);
+    if (completed_glyphs_.empty()) {
+        return;
+    }
     
-    // Add padding between glyphs to prevent bleeding
-    const int padding = 2;
-    int padded_width = width + padding;
-    int padded_height = height + padding;
+    struct AtlasUpload {
+        const MsdfBitmap* field;
+        AtlasSlot slot;
+        size_t offset;  // Into the pixel buffer
+    };
+    std::vector<AtlasUpload> uploads;
+    size_t total_bytes = 0;
     
-    // Check if we need to move to next row
-    if (atlas_->current_x + padded_width > atlas_->width) {
-        atlas_->current_x = 1;
-        atlas_->current_y += atlas_->row_height + padding;
-        atlas_->row_height = 0;
+    for (const RasterizedGlyph& result : completed_glyphs_) {
+        GlyphInfo* glyph = result.font->find_glyph(result.codepoint);
+        if (!glyph || !glyph->pending) {
+            continue;
+        }
+        glyph->pending = false;
+        glyph->advance = result.advance;
+        
+        if (!result.loaded) {
+            std::cerr << "Failed to load glyph for codepoint: " << result.codepoint << std::endl;
+            continue;
+        }
+        
+        const MsdfBitmap& field = result.field;
+        if (field.width == 0 || field.height == 0) {
+            continue;  // No outline (e.g. space)
+        }
+        glyph->size = Point2D(static_cast<float>(field.width), static_cast<float>(field.height));
+        glyph->bearing = Point2D(static_cast<float>(field.left), static_cast<float>(field.top));
+        
+        // Packed before the pixel buffer is bound: a repack clears its page
+        AtlasSlot slot;
+        if (glyph_atlas_.allocate(result.font, result.codepoint, field.width, field.height, slot)) {
+            set_atlas_slot(*glyph, slot);
+            uploads.push_back({&field, slot, total_bytes});
+            total_bytes += field.pixels.size();
+        }
     }
     
-    // Check if we have space in the atlas
-    if (atlas_->current_y + padded_height > atlas_->height) {
-        // Atlas is full - could implement atlas resizing or multiple atlases here
-        std::cerr << "Texture atlas full, using individual texture for glyph" << std::endl;
-        return false;
+    if (!uploads.empty()) {
+        // One transfer: stage every field in a pixel buffer (orphaning last
+        // frame's storage), then source the sub-image copies from it
+        if (!upload_pbo_) {
+            glGenBuffers(1, &upload_pbo_);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(total_bytes), nullptr, GL_STREAM_DRAW);
+        auto* staging = static_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(total_bytes),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        
+        if (staging) {
+            for (const AtlasUpload& upload : uploads) {
+                std::memcpy(staging + upload.offset, upload.field->pixels.data(), upload.field->pixels.size());
+            }
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        unsigned int bound_texture = 0;
+        for (const AtlasUpload& upload : uploads) {
+            if (upload.slot.texture_id != bound_texture) {
+                bound_texture = upload.slot.texture_id;
+                glBindTexture(GL_TEXTURE_2D, bound_texture);
+            }
+            
+            // Offsets into the bound buffer, or client memory if mapping failed
+            const void* source = staging
+                ? reinterpret_cast<const void*>(static_cast<uintptr_t>(upload.offset))
+                : static_cast<const void*>(upload.field->pixels.data());
+            glTexSubImage2D(GL_TEXTURE_2D, 0, upload.slot.x, upload.slot.y,
+                           upload.slot.width, upload.slot.height,
+                           GL_RGB, GL_UNSIGNED_BYTE, source);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     }
     
-    // Upload glyph to atlas
-    glBindTexture(GL_TEXTURE_2D, atlas_->texture_id);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 
-                   atlas_->current_x, atlas_->current_y,
-                   width, height,
-                   GL_RED, GL_UNSIGNED_BYTE,
-                   bitmap_data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    // Set glyph UV coordinates (normalized)
-    glyph.uv_rect.x = static_cast<float>(atlas_->current_x) / atlas_->width;
-    glyph.uv_rect.y = static_cast<float>(atlas_->current_y) / atlas_->height;
-    glyph.uv_rect.width = static_cast<float>(width) / atlas_->width;
-    glyph.uv_rect.height = static_cast<float>(height) / atlas_->height;
-    
-    // Mark as in atlas and set texture ID
-    glyph.in_atlas = true;
-    glyph.texture_id = atlas_->texture_id;
-    
-    // Update packing position
-    atlas_->current_x += padded_width;
-    atlas_->row_height = std::max(atlas_->row_height, padded_height);
-    
-    return true;
+    glyph_generation_++;
 }
 
 } // namespace voxel_canvas
\ No newline at end of file
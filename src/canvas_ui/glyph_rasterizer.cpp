@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Glyph Rasterizer implementation
+ */
+
+#include "canvas_ui/glyph_rasterizer.h"
+#include "canvas_ui/font_system.h"
+#include "canvas_ui/mapped_file.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace voxel_canvas {
+
+GlyphRasterizer::~GlyphRasterizer() {
+    stop();
+}
+
+bool GlyphRasterizer::start(unsigned int worker_count) {
+    if (is_running()) {
+        return true;
+    }
+
+    if (worker_count == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, 4u);
+    }
+
+    stopping_ = false;
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&GlyphRasterizer::worker_main, this);
+    }
+    return true;
+}
+
+void GlyphRasterizer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    work_available_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    completed_.clear();
+    in_flight_ = 0;
+}
+
+void GlyphRasterizer::request(FontFace* font, std::shared_ptr<MappedFile> file, float weight,
+                              unsigned int codepoint) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(Job{font, std::move(file), weight, codepoint});
+        in_flight_++;
+    }
+    work_available_.notify_one();
+}
+
+void GlyphRasterizer::take_completed(std::vector<RasterizedGlyph>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (RasterizedGlyph& glyph : completed_) {
+        out.push_back(std::move(glyph));
+    }
+    completed_.clear();
+}
+
+size_t GlyphRasterizer::get_pending_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+void GlyphRasterizer::worker_main() {
+    FT_Library library = nullptr;
+    if (FT_Init_FreeType(&library)) {
+        std::cerr << "Glyph worker failed to initialize FreeType" << std::endl;
+        library = nullptr;
+    }
+
+    // Faces opened by this worker; fonts outlive the pool
+    std::unordered_map<const FontFace*, FT_Face> faces;
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        RasterizedGlyph result;
+        result.font = job.font;
+        result.codepoint = job.codepoint;
+
+        FT_Face face = nullptr;
+        auto it = faces.find(job.font);
+        if (it != faces.end()) {
+            face = it->second;
+        } else if (library && job.file) {
+            face = FontFace::create_face(library, *job.file, job.weight);
+            faces[job.font] = face;  // Cache failures too
+        }
+
+        // Same load flags and reference size as the synchronous path
+        if (face && !FT_Load_Char(face, job.codepoint, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP)) {
+            FT_GlyphSlot slot = face->glyph;
+            result.loaded = true;
+            result.advance = static_cast<float>(slot->linearHoriAdvance) / 65536.0f;
+            if (slot->format == FT_GLYPH_FORMAT_OUTLINE) {
+                MsdfGenerator::generate(slot->outline, FontFace::DISTANCE_RANGE, result.field);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.push_back(std::move(result));
+        in_flight_--;
+    }
+
+    for (auto& [font, face] : faces) {
+        if (face) {
+            FT_Done_Face(face);
+        }
+    }
+    if (library) {
+        FT_Done_FreeType(library);
+    }
+}
+
+} // namespace voxel_canvas
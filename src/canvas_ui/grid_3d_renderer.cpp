@@ -6,10 +6,10 @@
 
 #include "canvas_ui/grid_3d_renderer.h"
 #include "canvas_ui/camera_3d.h"
+#include "canvas_ui/shader_cache.h"
+#include "canvas_ui/grid_shaders.h"
 #include "glad/gl.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cmath>
 
 #ifndef M_PI
@@ -57,107 +57,11 @@ void Grid3DRenderer::shutdown() {
 }
 
 bool Grid3DRenderer::load_shaders() {
-    
-    // Load vertex shader - try multiple possible paths
-    std::vector<std::string> vertex_paths = {
-        "../../shaders/grid/grid.vert",     // From build/bin/
-        "../shaders/grid/grid.vert",        // From build/
-        "shaders/grid/grid.vert",           // From project root
-        "./shaders/grid/grid.vert"          // Current directory
-    };
-    
-    std::ifstream vertex_file;
-    std::string used_path;
-    
-    for (const auto& path : vertex_paths) {
-        vertex_file.open(path);
-        if (vertex_file.is_open()) {
-            used_path = path;
-            break;
-        }
-    }
-    
-    if (!vertex_file.is_open()) {
-        std::cerr << "ERROR: Failed to open vertex shader file at any of these paths:" << std::endl;
-        for (const auto& path : vertex_paths) {
-            std::cerr << "  - " << path << std::endl;
-        }
-        return false;
-    }
-    
-    std::stringstream vertex_stream;
-    vertex_stream << vertex_file.rdbuf();
-    std::string vertex_code = vertex_stream.str();
-    vertex_file.close();
-    
-    // Load fragment shader - try multiple possible paths
-    std::vector<std::string> fragment_paths = {
-        "../../shaders/grid/grid.frag",     // From build/bin/
-        "../shaders/grid/grid.frag",        // From build/
-        "shaders/grid/grid.frag",           // From project root
-        "./shaders/grid/grid.frag"          // Current directory
-    };
-    
-    std::ifstream fragment_file;
-    
-    for (const auto& path : fragment_paths) {
-        fragment_file.open(path);
-        if (fragment_file.is_open()) {
-            break;
-        }
-    }
-    
-    if (!fragment_file.is_open()) {
-        std::cerr << "ERROR: Failed to open fragment shader file at any of these paths:" << std::endl;
-        for (const auto& path : fragment_paths) {
-            std::cerr << "  - " << path << std::endl;
-        }
-        return false;
-    }
-    
-    std::stringstream fragment_stream;
-    fragment_stream << fragment_file.rdbuf();
-    std::string fragment_code = fragment_stream.str();
-    fragment_file.close();
-    
-    // Compile vertex shader
-    vertex_shader_ = glCreateShader(GL_VERTEX_SHADER);
-    const char* vertex_src = vertex_code.c_str();
-    glShaderSource(vertex_shader_, 1, &vertex_src, nullptr);
-    glCompileShader(vertex_shader_);
-    
-    GLint success;
-    GLchar info_log[512];
-    glGetShaderiv(vertex_shader_, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex_shader_, 512, nullptr, info_log);
-        std::cerr << "Vertex shader compilation failed: " << info_log << std::endl;
-        return false;
-    }
-    
-    // Compile fragment shader
-    fragment_shader_ = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fragment_src = fragment_code.c_str();
-    glShaderSource(fragment_shader_, 1, &fragment_src, nullptr);
-    glCompileShader(fragment_shader_);
-    
-    glGetShaderiv(fragment_shader_, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment_shader_, 512, nullptr, info_log);
-        std::cerr << "Fragment shader compilation failed: " << info_log << std::endl;
-        return false;
-    }
-    
-    // Create shader program
-    shader_program_ = glCreateProgram();
-    glAttachShader(shader_program_, vertex_shader_);
-    glAttachShader(shader_program_, fragment_shader_);
-    glLinkProgram(shader_program_);
-    
-    glGetProgramiv(shader_program_, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shader_program_, 512, nullptr, info_log);
-        std::cerr << "Shader program linking failed: " << info_log << std::endl;
+    // Sources are embedded at build time from shaders/grid/ (see src/canvas_ui/CMakeLists.txt)
+    shader_program_ = ShaderCache::get_instance().load_program("grid_3d",
+                                                               embedded_shaders::GRID_VERTEX_SHADER,
+                                                               embedded_shaders::GRID_FRAGMENT_SHADER);
+    if (!shader_program_) {
         return false;
     }
     
@@ -452,14 +356,6 @@ void Grid3DRenderer::cleanup_opengl_resources() {
         glDeleteProgram(shader_program_);
         shader_program_ = 0;
     }
-    if (vertex_shader_ != 0) {
-        glDeleteShader(vertex_shader_);
-        vertex_shader_ = 0;
-    }
-    if (fragment_shader_ != 0) {
-        glDeleteShader(fragment_shader_);
-        fragment_shader_ = 0;
-    }
 }
 
 } // namespace voxel_canvas
\ No newline at end of file
@@ -1,136 +1,185 @@
 /*
  * Copyright (C) 2024 Voxelux
- * 
+ *
  * Icon Atlas Implementation for efficient batch rendering
  */
 
 #include "canvas_ui/icon_system.h"
 #include <glad/gl.h>
-#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace voxel_canvas {
 
-IconAtlas::IconAtlas(int width, int height)
-    : atlas_width_(width)
-    , atlas_height_(height) {
-    
-    // Create OpenGL texture for atlas
-    glGenTextures(1, &texture_id_);
-    glBindTexture(GL_TEXTURE_2D, texture_id_);
-    
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Allocate texture memory (RGBA)
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas_width_, atlas_height_, 
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    
-    glBindTexture(GL_TEXTURE_2D, 0);
+IconAtlas::IconAtlas(int page_size, int max_pages)
+    : page_size_(page_size)
+    , max_pages_(max_pages) {
+
+    pages_.set_eviction_callback([this]([[maybe_unused]] void* owner, uint32_t id) {
+        evict(id);
+    });
 }
 
 IconAtlas::~IconAtlas() {
-    if (texture_id_ != 0) {
-        glDeleteTextures(1, &texture_id_);
+    if (upload_pbo_) {
+        glDeleteBuffers(1, &upload_pbo_);
+    }
+}
+
+bool IconAtlas::ensure_pages() {
+    // Created on first use, when a GL context is current
+    if (pages_.is_initialized()) {
+        return true;
     }
+    return pages_.initialize(page_size_, max_pages_, AtlasFormat::RGBA8, TextureOwner::IconAtlas);
 }
 
-bool IconAtlas::add_icon(const std::string& key, const uint8_t* pixels, int width, int height) {
+bool IconAtlas::add_icon(Key key, const uint8_t* pixels, int width, int height) {
     // Check if icon already exists
     if (entries_.find(key) != entries_.end()) {
         return true; // Already in atlas
     }
-    
-    // Simple row-based packing algorithm
-    // For production, you'd use rectpack2D here
-    
-    // Check if we need to move to next row
-    if (next_x_ + width > atlas_width_) {
-        next_x_ = 0;
-        next_y_ += row_height_ + 2; // 2 pixel padding
-        row_height_ = 0;
+
+    AtlasSlot slot;
+    if (!pixels || !place_icon(key, width, height, slot)) {
+        return false;
+    }
+    pages_.upload(slot, pixels);
+    return true;
+}
+
+void IconAtlas::add_icons(const std::vector<IconUpload>& uploads) {
+    struct StagedUpload {
+        const IconUpload* icon;
+        AtlasSlot slot;
+        size_t offset;  // Into the pixel buffer
+    };
+    std::vector<StagedUpload> staged;
+    size_t total_bytes = 0;
+
+    // Packed before the pixel buffer is bound: a repack clears its page
+    for (const IconUpload& upload : uploads) {
+        AtlasSlot slot;
+        if (upload.pixels && entries_.find(upload.key) == entries_.end() &&
+            place_icon(upload.key, upload.width, upload.height, slot)) {
+            staged.push_back({&upload, slot, total_bytes});
+            total_bytes += static_cast<size_t>(upload.width) * static_cast<size_t>(upload.height) * 4;
+        }
+    }
+    if (staged.empty()) {
+        return;
+    }
+
+    // One transfer: stage every icon in a pixel buffer (orphaning last
+    // frame's storage), then source the sub-image copies from it
+    if (!upload_pbo_) {
+        glGenBuffers(1, &upload_pbo_);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(total_bytes), nullptr, GL_STREAM_DRAW);
+    auto* staging = static_cast<unsigned char*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(total_bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    if (staging) {
+        for (const StagedUpload& upload : staged) {
+            size_t bytes = static_cast<size_t>(upload.slot.width) * static_cast<size_t>(upload.slot.height) * 4;
+            std::memcpy(staging + upload.offset, upload.icon->pixels, bytes);
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     }
-    
-    // Check if we have space in atlas
-    if (next_y_ + height > atlas_height_) {
-        // Atlas is full, need to evict or resize
-        // For now, clear and start over
-        clear();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    unsigned int bound_texture = 0;
+    for (const StagedUpload& upload : staged) {
+        if (upload.slot.texture_id != bound_texture) {
+            bound_texture = upload.slot.texture_id;
+            glBindTexture(GL_TEXTURE_2D, bound_texture);
+        }
+
+        // Offsets into the bound buffer, or client memory if mapping failed
+        const void* source = staging
+            ? reinterpret_cast<const void*>(static_cast<uintptr_t>(upload.offset))
+            : static_cast<const void*>(upload.icon->pixels);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, upload.slot.x, upload.slot.y,
+                        upload.slot.width, upload.slot.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, source);
     }
-    
-    // Upload texture data to specific region
-    glBindTexture(GL_TEXTURE_2D, texture_id_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, next_x_, next_y_, width, height,
-                    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     glBindTexture(GL_TEXTURE_2D, 0);
-    
-    // Calculate UV coordinates
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool IconAtlas::place_icon(Key key, int width, int height, AtlasSlot& slot) {
+    if (!ensure_pages()) {
+        return false;
+    }
+
+    uint32_t id = next_id_++;
+    if (!pages_.allocate(this, id, width, height, slot)) {
+        std::cerr << "Failed to place " << width << "x" << height << " icon in atlas" << std::endl;
+        return false;
+    }
+
     AtlasEntry entry;
-    entry.texture_coords.x = static_cast<float>(next_x_) / atlas_width_;
-    entry.texture_coords.y = static_cast<float>(next_y_) / atlas_height_;
-    entry.texture_coords.width = static_cast<float>(width) / atlas_width_;
-    entry.texture_coords.height = static_cast<float>(height) / atlas_height_;
+    entry.texture_coords = slot.uv;
     entry.width = static_cast<float>(width);
     entry.height = static_cast<float>(height);
-    entry.last_used = 0; // Will be updated on use
-    
+    entry.texture_id = slot.texture_id;
+    entry.page = slot.page;
+    entry.id = id;
+
     entries_[key] = entry;
-    
-    // Update packing position
-    next_x_ += width + 2; // 2 pixel padding
-    row_height_ = std::max(row_height_, height);
-    
+    keys_[id] = key;
     return true;
 }
 
-const IconAtlas::AtlasEntry* IconAtlas::get_entry(const std::string& key) const {
+const IconAtlas::AtlasEntry* IconAtlas::get_entry(Key key) const {
     auto it = entries_.find(key);
     return (it != entries_.end()) ? &it->second : nullptr;
 }
 
+const IconAtlas::AtlasEntry* IconAtlas::use_entry(Key key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    pages_.touch(it->second.page);
+    return &it->second;
+}
+
+void IconAtlas::remove_icon(IconId icon) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if ((it->first >> 32) == icon.get_index()) {
+            keys_.erase(it->second.id);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void IconAtlas::begin_frame() {
+    pages_.begin_frame();
+}
+
 void IconAtlas::clear() {
     entries_.clear();
-    next_x_ = 0;
-    next_y_ = 0;
-    row_height_ = 0;
-    
-    // Clear texture to transparent
-    std::vector<uint8_t> clear_data(static_cast<size_t>(atlas_width_ * atlas_height_ * 4), 0);
-    glBindTexture(GL_TEXTURE_2D, texture_id_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, atlas_width_, atlas_height_,
-                    GL_RGBA, GL_UNSIGNED_BYTE, clear_data.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
+    keys_.clear();
+
+    // Pages are recreated lazily by the next add_icon
+    pages_.shutdown();
 }
 
-void IconAtlas::evict_lru(size_t target_count) {
-    if (entries_.size() <= target_count) {
+void IconAtlas::evict(uint32_t id) {
+    // Ids of removed icons are still listed on their page; ignore them
+    auto it = keys_.find(id);
+    if (it == keys_.end()) {
         return;
     }
-    
-    // Collect entries with their last used time
-    std::vector<std::pair<std::string, uint32_t>> usage;
-    for (const auto& [key, entry] : entries_) {
-        usage.push_back({key, entry.last_used});
-    }
-    
-    // Sort by last used time
-    std::sort(usage.begin(), usage.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second < b.second;
-              });
-    
-    // Remove oldest entries
-    size_t to_remove = entries_.size() - target_count;
-    for (size_t i = 0; i < to_remove && i < usage.size(); ++i) {
-        entries_.erase(usage[i].first);
-    }
-    
-    // After eviction, we should reorganize the atlas
-    // For now, we'll just mark it as needing reorganization
-    // In production, you'd repack all remaining icons
+    entries_.erase(it->second);
+    keys_.erase(it);
 }
 
-} // namespace voxel_canvas
\ No newline at end of file
+} // namespace voxel_canvas
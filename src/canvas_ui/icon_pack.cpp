@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Icon Pack implementation
+ */
+
+#include "canvas_ui/icon_pack.h"
+#include <cstdlib>
+#include <iostream>
+
+namespace voxel_canvas {
+
+bool IconPack::open(const std::string& path) {
+    header_ = nullptr;
+    icons_ = nullptr;
+    images_ = nullptr;
+
+    if (!file_.open(path)) {
+        return false;
+    }
+
+    // Mappings are page aligned and every record is uint32, so the tables
+    // can be read in place
+    const uint8_t* base = file_.data();
+    if (!in_bounds(0, sizeof(icon_pack::Header))) {
+        std::cerr << "Icon pack is truncated: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+    const auto* header = reinterpret_cast<const icon_pack::Header*>(base);
+    if (header->magic != icon_pack::MAGIC || header->version != icon_pack::VERSION) {
+        std::cerr << "Icon pack has an unsupported format: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+
+    uint64_t icons_offset = sizeof(icon_pack::Header);
+    uint64_t icons_bytes = uint64_t{header->icon_count} * sizeof(icon_pack::IconRecord);
+    uint64_t images_offset = icons_offset + icons_bytes;
+    uint64_t images_bytes = uint64_t{header->image_count} * sizeof(icon_pack::ImageRecord);
+    if (!in_bounds(icons_offset, icons_bytes) || !in_bounds(images_offset, images_bytes)) {
+        std::cerr << "Icon pack tables are truncated: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+    const auto* icons = reinterpret_cast<const icon_pack::IconRecord*>(base + icons_offset);
+    const auto* images = reinterpret_cast<const icon_pack::ImageRecord*>(base + images_offset);
+
+    // Validate every range once so lookups can stay unchecked
+    for (uint32_t i = 0; i < header->icon_count; ++i) {
+        const icon_pack::IconRecord& icon = icons[i];
+        bool valid = in_bounds(icon.name_offset, icon.name_length) &&
+                     in_bounds(icon.svg_offset, icon.svg_length) &&
+                     uint64_t{icon.first_image} + icon.image_count <= header->image_count;
+        for (uint32_t j = 0; valid && j < icon.image_count; ++j) {
+            const icon_pack::ImageRecord& image = images[icon.first_image + j];
+            valid = in_bounds(image.pixel_offset, uint64_t{image.size} * image.size * 4);
+        }
+        if (!valid) {
+            std::cerr << "Icon pack entry " << i << " is out of range: " << path << std::endl;
+            file_.close();
+            return false;
+        }
+    }
+
+    header_ = header;
+    icons_ = icons;
+    images_ = images;
+    return true;
+}
+
+std::string_view IconPack::get_name(size_t icon) const {
+    const icon_pack::IconRecord& record = icons_[icon];
+    return std::string_view(reinterpret_cast<const char*>(file_.data() + record.name_offset), record.name_length);
+}
+
+std::string_view IconPack::get_svg(size_t icon) const {
+    const icon_pack::IconRecord& record = icons_[icon];
+    return std::string_view(reinterpret_cast<const char*>(file_.data() + record.svg_offset), record.svg_length);
+}
+
+const uint8_t* IconPack::find_image(size_t icon, int size) const {
+    const icon_pack::IconRecord& record = icons_[icon];
+    for (uint32_t i = 0; i < record.image_count; ++i) {
+        const icon_pack::ImageRecord& image = images_[record.first_image + i];
+        if (static_cast<int>(image.size) == size) {
+            return file_.data() + image.pixel_offset;
+        }
+    }
+    return nullptr;
+}
+
+int IconPack::find_nearest_size(size_t icon, int size) const {
+    const icon_pack::IconRecord& record = icons_[icon];
+    int best = 0;
+    for (uint32_t i = 0; i < record.image_count; ++i) {
+        int candidate = static_cast<int>(images_[record.first_image + i].size);
+        int distance = std::abs(candidate - size);
+        int best_distance = std::abs(best - size);
+        if (best == 0 || distance < best_distance || (distance == best_distance && candidate > best)) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+} // namespace voxel_canvas
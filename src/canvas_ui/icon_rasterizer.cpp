@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Icon Rasterizer implementation
+ */
+
+#include "canvas_ui/icon_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// NanoSVG declarations; the implementation is compiled in icon_system.cpp
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wdouble-promotion"
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wimplicit-float-conversion"
+#pragma GCC diagnostic ignored "-Wfloat-conversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "../../lib/third_party/nanosvg.h"
+#include "../../lib/third_party/nanosvgrast.h"
+#pragma GCC diagnostic pop
+
+namespace voxel_canvas {
+
+namespace {
+
+constexpr double FIELD_INF = 1e20;
+
+// Squared Euclidean distance transform of one row or column in place
+// (Felzenszwalb & Huttenlocher lower envelope of parabolas)
+void transform_line(float* grid, size_t stride, int count, std::vector<double>& f,
+                    std::vector<int>& v, std::vector<double>& z) {
+    for (int i = 0; i < count; ++i) {
+        f[static_cast<size_t>(i)] = grid[static_cast<size_t>(i) * stride];
+    }
+    auto intersect = [&f](int q, int p) {
+        double fq = f[static_cast<size_t>(q)] + static_cast<double>(q) * q;
+        double fp = f[static_cast<size_t>(p)] + static_cast<double>(p) * p;
+        return (fq - fp) / (2.0 * (q - p));
+    };
+
+    size_t k = 0;
+    v[0] = 0;
+    z[0] = -FIELD_INF;
+    z[1] = FIELD_INF;
+    for (int q = 1; q < count; ++q) {
+        double s = intersect(q, v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = intersect(q, v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FIELD_INF;
+    }
+
+    k = 0;
+    for (int q = 0; q < count; ++q) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        double dx = q - v[k];
+        grid[static_cast<size_t>(q) * stride] = static_cast<float>(dx * dx + f[static_cast<size_t>(v[k])]);
+    }
+}
+
+// Squared distance from every cell to the nearest zero cell
+void transform_grid(std::vector<float>& grid, int size) {
+    size_t length = static_cast<size_t>(size);
+    std::vector<double> f(length);
+    std::vector<int> v(length);
+    std::vector<double> z(length + 1);
+    for (size_t x = 0; x < length; ++x) {
+        transform_line(grid.data() + x, length, size, f, v, z);
+    }
+    for (size_t y = 0; y < length; ++y) {
+        transform_line(grid.data() + y * length, 1, size, f, v, z);
+    }
+}
+
+// Whether filling the shape paints anything. Open strokes like "M5 12h14"
+// keep SVG's default black fill, but their control polygons enclose nothing.
+bool has_fill_area(const NSVGshape* shape) {
+    for (const NSVGpath* path = shape->paths; path; path = path->next) {
+        float area = 0.0f;
+        for (int i = 0; i < path->npts; ++i) {
+            const float* p0 = &path->pts[i * 2];
+            const float* p1 = &path->pts[((i + 1) % path->npts) * 2];
+            area += p0[0] * p1[1] - p1[0] * p0[1];
+        }
+        if (std::abs(area) > 1e-3f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+bool rasterize_svg_icon(NSVGrasterizer* rasterizer, NSVGimage* image, int size, std::vector<uint8_t>& pixels) {
+    if (!rasterizer || !image || size <= 0) {
+        return false;
+    }
+
+    // Calculate scale for pixel-perfect rendering
+    // Use exact target size, no rounding to avoid size drift
+    float scale = static_cast<float>(size) / std::max(image->width, image->height);
+
+    // Allocate buffer for rasterization (initialize to transparent)
+    pixels.assign(static_cast<size_t>(size) * static_cast<size_t>(size) * 4, 0);
+    nsvgRasterize(rasterizer, image, 0, 0, scale, pixels.data(), size, size, size * 4);
+
+    if (std::none_of(pixels.begin(), pixels.end(), [](uint8_t value) { return value != 0; })) {
+        std::cerr << "Warning: SVG rasterized to empty image (all pixels transparent)" << std::endl;
+        std::cerr << "Creating debug checkerboard pattern" << std::endl;
+        // Create a checkerboard pattern so we can see something
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                size_t idx = (static_cast<size_t>(y) * static_cast<size_t>(size) + static_cast<size_t>(x)) * 4;
+                bool checker = ((x / 4) + (y / 4)) % 2;
+                uint8_t color = checker ? 255 : 128;
+                pixels[idx] = color;      // R
+                pixels[idx + 1] = color;  // G
+                pixels[idx + 2] = color;  // B
+                pixels[idx + 3] = 255;    // A
+            }
+        }
+    }
+    return true;
+}
+
+bool is_monochrome_svg(const NSVGimage* image) {
+    if (!image) {
+        return false;
+    }
+
+    unsigned int colour = 0;
+    bool found = false;
+    for (const NSVGshape* shape = image->shapes; shape; shape = shape->next) {
+        if (!(shape->flags & NSVG_FLAGS_VISIBLE)) {
+            continue;
+        }
+        if (shape->opacity < 1.0f) {
+            return false;
+        }
+        bool fills = has_fill_area(shape);
+        for (const NSVGpaint* paint : {&shape->fill, &shape->stroke}) {
+            if (paint->type == NSVG_PAINT_NONE || (paint == &shape->fill && !fills)) {
+                continue;
+            }
+            // Gradients and translucent paints don't survive a coverage mask
+            if (paint->type != NSVG_PAINT_COLOR || (paint->color >> 24) != 0xFF) {
+                return false;
+            }
+            if (found && paint->color != colour) {
+                return false;
+            }
+            colour = paint->color;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool rasterize_svg_icon_field(NSVGrasterizer* rasterizer, NSVGimage* image, std::vector<uint8_t>& pixels) {
+    // Coverage at a multiple of the field resolution; the distance transform
+    // runs there and is sampled back down at texel centres
+    constexpr int SAMPLES = ICON_FIELD_SIZE * ICON_FIELD_SUPERSAMPLE;
+    std::vector<uint8_t> coverage;
+    if (!rasterize_svg_icon(rasterizer, image, SAMPLES, coverage)) {
+        return false;
+    }
+
+    size_t sample_count = static_cast<size_t>(SAMPLES) * static_cast<size_t>(SAMPLES);
+    std::vector<float> to_inside(sample_count);
+    std::vector<float> to_outside(sample_count);
+    for (size_t i = 0; i < sample_count; ++i) {
+        bool inside = coverage[i * 4 + 3] >= 128;
+        to_inside[i] = inside ? 0.0f : static_cast<float>(FIELD_INF);
+        to_outside[i] = inside ? static_cast<float>(FIELD_INF) : 0.0f;
+    }
+    transform_grid(to_inside, SAMPLES);
+    transform_grid(to_outside, SAMPLES);
+
+    // Signed distance in samples, with the edge halfway between the last
+    // inside and first outside sample
+    auto signed_distance = [&](size_t x, size_t y) {
+        size_t i = y * static_cast<size_t>(SAMPLES) + x;
+        return to_outside[i] > 0.0f ? std::sqrt(to_outside[i]) - 0.5f : 0.5f - std::sqrt(to_inside[i]);
+    };
+
+    pixels.assign(static_cast<size_t>(ICON_FIELD_SIZE) * static_cast<size_t>(ICON_FIELD_SIZE) * 4, 255);
+    constexpr size_t HALF = ICON_FIELD_SUPERSAMPLE / 2;
+    for (size_t y = 0; y < static_cast<size_t>(ICON_FIELD_SIZE); ++y) {
+        for (size_t x = 0; x < static_cast<size_t>(ICON_FIELD_SIZE); ++x) {
+            // Texel centres fall between four samples
+            size_t sx = x * ICON_FIELD_SUPERSAMPLE + HALF;
+            size_t sy = y * ICON_FIELD_SUPERSAMPLE + HALF;
+            float distance = (signed_distance(sx - 1, sy - 1) + signed_distance(sx, sy - 1) +
+                              signed_distance(sx - 1, sy) + signed_distance(sx, sy)) * 0.25f;
+            float texels = distance / static_cast<float>(ICON_FIELD_SUPERSAMPLE);
+            float value = std::clamp(0.5f + texels / ICON_FIELD_RANGE, 0.0f, 1.0f);
+            uint8_t encoded = static_cast<uint8_t>(std::lround(value * 255.0f));
+
+            size_t idx = (y * static_cast<size_t>(ICON_FIELD_SIZE) + x) * 4;
+            pixels[idx] = encoded;
+            pixels[idx + 1] = encoded;
+            pixels[idx + 2] = encoded;
+        }
+    }
+    return true;
+}
+
+IconRasterizer::~IconRasterizer() {
+    stop();
+}
+
+bool IconRasterizer::start(unsigned int worker_count) {
+    if (is_running()) {
+        return true;
+    }
+
+    if (worker_count == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, 2u);
+    }
+
+    stopping_ = false;
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&IconRasterizer::worker_main, this);
+    }
+    return true;
+}
+
+void IconRasterizer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    work_available_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    completed_.clear();
+    in_flight_ = 0;
+}
+
+void IconRasterizer::request(IconId icon, uint64_t serial, std::shared_ptr<NSVGimage> image, int size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(Job{icon, serial, std::move(image), size, false});
+        in_flight_++;
+    }
+    work_available_.notify_one();
+}
+
+void IconRasterizer::request_field(IconId icon, uint64_t serial, std::shared_ptr<NSVGimage> image) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(Job{icon, serial, std::move(image), ICON_FIELD_SIZE, true});
+        in_flight_++;
+    }
+    work_available_.notify_one();
+}
+
+size_t IconRasterizer::take_completed(std::vector<RasterizedIcon>& out, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t taken = 0;
+    while (!completed_.empty() && taken < max_bytes) {
+        taken += completed_.front().pixels.size();
+        out.push_back(std::move(completed_.front()));
+        completed_.pop_front();
+    }
+    return taken;
+}
+
+size_t IconRasterizer::get_pending_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_ + completed_.size();
+}
+
+void IconRasterizer::worker_main() {
+    NSVGrasterizer* rasterizer = nsvgCreateRasterizer();
+    if (!rasterizer) {
+        std::cerr << "Icon worker failed to create SVG rasterizer" << std::endl;
+    }
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        RasterizedIcon result;
+        result.icon = job.icon;
+        result.serial = job.serial;
+        result.size = job.size;
+        result.distance_field = job.distance_field;
+        bool rasterized = job.distance_field
+            ? rasterize_svg_icon_field(rasterizer, job.image.get(), result.pixels)
+            : rasterize_svg_icon(rasterizer, job.image.get(), job.size, result.pixels);
+        if (!rasterized) {
+            result.pixels.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.push_back(std::move(result));
+        in_flight_--;
+    }
+
+    if (rasterizer) {
+        nsvgDeleteRasterizer(rasterizer);
+    }
+}
+
+} // namespace voxel_canvas
@@ -7,11 +7,12 @@
 #include "canvas_ui/icon_system.h"
 #include "canvas_ui/canvas_renderer.h"
 #include "canvas_ui/canvas_window.h"
-#include <glad/gl.h>
+#include "canvas_ui/icon_pack.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 
 // For PNG loading, we'll use stb_image (header-only library)
@@ -39,37 +40,22 @@
 #include "../../lib/third_party/nanosvgrast.h"
 #pragma GCC diagnostic pop
 
-// For texture atlas packing
-// rectpack2D - MIT License, Copyright (c) 2016 Patryk Nadrowski
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-#include "../../lib/third_party/rectpack2D/finders_interface.h"
-#pragma GCC diagnostic pop
-
 namespace voxel_canvas {
 
 // IconAsset implementation
 
+namespace {
+uint64_t next_icon_serial = 1;  // Icons are created on the render thread
+}
+
 IconAsset::IconAsset(const std::string& name)
-    : name_(name) {
+    : name_(name)
+    , id_(IconId::intern(name))
+    , serial_(next_icon_serial++) {
 }
 
 IconAsset::~IconAsset() {
-    if (texture_id_ != 0) {
-        glDeleteTextures(1, &texture_id_);
-    }
-    
-    // Clean up all cached size textures
-    for (auto& [size, cache] : size_cache_) {
-        if (cache.texture_id != 0) {
-            glDeleteTextures(1, &cache.texture_id);
-        }
-    }
-    
-    // Clean up NanoSVG resources
-    if (svg_image_) {
-        nsvgDelete(svg_image_);
-    }
+    // Clean up NanoSVG resources (workers hold their own image references)
     if (svg_rasterizer_) {
         nsvgDeleteRasterizer(svg_rasterizer_);
     }
@@ -119,7 +105,7 @@ bool IconAsset::load_from_svg(const std::string& svg_path) {
     svg_data_[svg_str.size()] = '\0';
     
     // Parse SVG with NanoSVG
-    svg_image_ = nsvgParse(reinterpret_cast<char*>(svg_data_.data()), "px", 96.0f);
+    svg_image_.reset(nsvgParse(reinterpret_cast<char*>(svg_data_.data()), "px", 96.0f), nsvgDelete);
     
     if (!svg_image_) {
         std::cerr << "Failed to parse SVG: " << svg_path << std::endl;
@@ -143,15 +129,12 @@ bool IconAsset::load_from_png(const std::string& png_path) {
         return false;
     }
     
-    bool success = create_texture(data, width, height, 4);
+    pixels_.assign(data, data + static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
     stbi_image_free(data);
     
-    if (success) {
-        width_ = static_cast<float>(width);
-        height_ = static_cast<float>(height);
-    }
-    
-    return success;
+    width_ = static_cast<float>(width);
+    height_ = static_cast<float>(height);
+    return true;
 }
 
 bool IconAsset::load_from_memory(const uint8_t* data, size_t size, bool is_svg) {
@@ -160,7 +143,7 @@ bool IconAsset::load_from_memory(const uint8_t* data, size_t size, bool is_svg)
         svg_data_[size] = '\0'; // Null terminate for NanoSVG
         
         // Parse SVG with NanoSVG
-        svg_image_ = nsvgParse(reinterpret_cast<char*>(svg_data_.data()), "px", 96.0f);
+        svg_image_.reset(nsvgParse(reinterpret_cast<char*>(svg_data_.data()), "px", 96.0f), nsvgDelete);
         
         if (!svg_image_) {
             return false;
@@ -178,236 +161,303 @@ bool IconAsset::load_from_memory(const uint8_t* data, size_t size, bool is_svg)
             return false;
         }
         
-        bool success = create_texture(img_data, width, height, 4);
+        pixels_.assign(img_data, img_data + static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
         stbi_image_free(img_data);
         
-        if (success) {
-            width_ = static_cast<float>(width);
-            height_ = static_cast<float>(height);
-        }
-        
-        return success;
+        width_ = static_cast<float>(width);
+        height_ = static_cast<float>(height);
+        return true;
     }
 }
 
-bool IconAsset::rasterize_svg(int target_size) {
-    if (!svg_image_) {
+bool IconAsset::load_from_pack(std::shared_ptr<const IconPack> pack, size_t index) {
+    if (!pack || index >= pack->get_icon_count()) {
         return false;
     }
-    
-    // Create rasterizer if needed
-    if (!svg_rasterizer_) {
-        svg_rasterizer_ = nsvgCreateRasterizer();
-        if (!svg_rasterizer_) {
-            std::cerr << "Failed to create SVG rasterizer" << std::endl;
-            return false;
-        }
+    pack_ = std::move(pack);
+    pack_index_ = index;
+    is_svg_ = true;
+    return true;
+}
+
+bool IconAsset::parse_packed_svg() {
+    if (svg_image_) {
+        return true;
+    }
+    if (!pack_) {
+        return false;
     }
     
-    // Calculate scale for pixel-perfect rendering
-    // Use exact target size, no rounding to avoid size drift
-    float scale = target_size / std::max(svg_image_->width, svg_image_->height);
-    int width = target_size;  // Force exact size
-    int height = target_size; // Force square for consistency
-    
-    // Allocate buffer for rasterization (initialize to transparent)
-    std::vector<uint8_t> pixels(static_cast<size_t>(width * height * 4), 0);
+    // NanoSVG parses in place, so it gets a terminated copy
+    std::string_view svg = pack_->get_svg(pack_index_);
+    svg_data_.assign(svg.begin(), svg.end());
+    svg_data_.push_back('\0');
+    svg_image_.reset(nsvgParse(reinterpret_cast<char*>(svg_data_.data()), "px", 96.0f), nsvgDelete);
+    if (!svg_image_) {
+        std::cerr << "Failed to parse packed SVG: " << name_ << std::endl;
+        pack_.reset();  // Don't retry every frame
+        return false;
+    }
     
-    // Rasterize SVG
-    nsvgRasterize(svg_rasterizer_, svg_image_, 0, 0, scale,
-                  pixels.data(), width, height, width * 4);
+    original_width_ = svg_image_->width;
+    original_height_ = svg_image_->height;
+    return true;
+}
+
+IconAtlas::Key IconAsset::get_atlas_key(int size) const {
+    // Bitmaps have one entry at their native size; SVGs one per raster size
+    return IconAtlas::make_key(id_, is_svg_ ? static_cast<uint32_t>(size) : 0);
+}
+
+const IconAtlas::AtlasEntry* IconAsset::get_atlas_entry(int size) {
+    IconSystem& system = IconSystem::get_instance();
+    IconAtlas& atlas = system.get_atlas();
+    IconAtlas::Key key = get_atlas_key(size);
+    if (const IconAtlas::AtlasEntry* entry = atlas.use_entry(key)) {
+        return entry;
+    }
     
-    // Debug: Check if we got any non-zero pixels
-    int non_zero_count = 0;
-    int max_alpha = 0;
-    for (size_t i = 0; i < pixels.size(); i += 4) {
-        if (pixels[i] > 0 || pixels[i+1] > 0 || pixels[i+2] > 0 || pixels[i+3] > 0) {
-            non_zero_count++;
-            max_alpha = std::max(max_alpha, static_cast<int>(pixels[i+3]));
+    // Not in the atlas yet, or its page was repacked since
+    if (!is_svg_) {
+        int width = static_cast<int>(width_);
+        int height = static_cast<int>(height_);
+        if (!system.spend_frame_budget(pixels_.size()) || !atlas.add_icon(key, pixels_.data(), width, height)) {
+            return nullptr;
         }
+        return atlas.use_entry(key);
     }
     
-    // SVG rasterized: width x height with non_zero_count pixels
-    std::cout << "SVG rasterized: " << name_ << " size=" << width << "x" << height 
-              << " non_zero_pixels=" << non_zero_count 
-              << " max_alpha=" << max_alpha << std::endl;
-    
-    if (non_zero_count == 0) {
-        std::cerr << "Warning: SVG rasterized to empty image (all pixels transparent)" << std::endl;
-        std::cerr << "Creating debug checkerboard pattern" << std::endl;
-        // Create a checkerboard pattern so we can see something
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int idx = (y * width + x) * 4;
-                bool checker = ((x / 4) + (y / 4)) % 2;
-                uint8_t color = checker ? 255 : 128;
-                pixels[static_cast<size_t>(idx)] = color;     // R
-                pixels[static_cast<size_t>(idx + 1)] = color; // G
-                pixels[static_cast<size_t>(idx + 2)] = color; // B
-                pixels[static_cast<size_t>(idx + 3)] = 255;   // A
-            }
+    if (pack_ && pack_->find_image(pack_index_, size)) {
+        if (add_packed_size(size)) {
+            return atlas.use_entry(key);
         }
+    } else {
+        request_size(size);
     }
+    return find_nearest_entry(size);
+}
+
+const IconAtlas::AtlasEntry* IconAsset::find_nearest_entry(int size) {
+    IconAtlas& atlas = IconSystem::get_instance().get_atlas();
     
-    // Create texture from rasterized data
-    bool success = create_texture(pixels.data(), width, height, 4);
-    if (success) {
-        width_ = static_cast<float>(width);
-        height_ = static_cast<float>(height);
-        last_rendered_size_ = target_size;
+    int best = 0;
+    for (auto it = atlas_sizes_.begin(); it != atlas_sizes_.end();) {
+        if (!atlas.get_entry(get_atlas_key(*it))) {
+            it = atlas_sizes_.erase(it);  // Evicted with its page
+            continue;
+        }
+        // Prefer downscaling a larger raster on ties
+        int distance = std::abs(*it - size);
+        int best_distance = std::abs(best - size);
+        if (best == 0 || distance < best_distance || (distance == best_distance && *it > best)) {
+            best = *it;
+        }
+        ++it;
     }
     
-    return success;
+    // Nothing rasterized yet: the nearest packed size is an upload away
+    if (best == 0 && pack_) {
+        int packed = pack_->find_nearest_size(pack_index_, size);
+        if (packed > 0 && add_packed_size(packed)) {
+            best = packed;
+        }
+    }
+    return best > 0 ? atlas.use_entry(get_atlas_key(best)) : nullptr;
 }
 
-bool IconAsset::create_texture(const uint8_t* pixels, int width, int height, int channels) {
-    if (texture_id_ != 0) {
-        glDeleteTextures(1, &texture_id_);
-    }
-    
-    // Creating texture with specified dimensions and channels
-    std::cout << "Creating icon texture: " << width << "x" << height << " channels=" << channels << std::endl;
-    
-    glGenTextures(1, &texture_id_);
-    std::cout << "Generated texture ID: " << texture_id_ << std::endl;
-    glBindTexture(GL_TEXTURE_2D, texture_id_);
-    
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Upload texture data
-    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
-    
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "OpenGL error creating texture: " << error << std::endl;
-    } else {
-        // Texture created successfully
+bool IconAsset::add_packed_size(int size) {
+    // Packed sizes upload straight from the mapping
+    IconSystem& system = IconSystem::get_instance();
+    const uint8_t* packed = pack_->find_image(pack_index_, size);
+    size_t bytes = static_cast<size_t>(size) * static_cast<size_t>(size) * 4;
+    if (!packed || !system.spend_frame_budget(bytes) ||
+        !system.get_atlas().add_icon(get_atlas_key(size), packed, size, size)) {
+        return false;
     }
-    
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    return error == GL_NO_ERROR;
+    remember_size(size);
+    return true;
 }
 
-void IconAsset::render(CanvasRenderer* renderer, const Point2D& position, float scaled_size, const ColorRGBA& tint) {
-    // Size is pre-scaled from ScaledTheme - no additional scaling needed
-    
-    // For SVG icons, use multi-size cache for optimal quality
-    if (is_svg_) {
-        // Size is already scaled, use directly for rasterization
-        int raster_size = static_cast<int>(scaled_size);
-        
-        // Get or create texture for this size
-        GLuint tex_id = get_texture_for_size(raster_size);
-        if (tex_id == 0) return;  // Failed to get texture
-        
-        // Use the size-specific texture
-        texture_id_ = tex_id;
-        width_ = height_ = static_cast<float>(raster_size);
+void IconAsset::request_size(int size) {
+    // One request in flight per icon: while a dock zoom sweeps through
+    // sizes, only the size drawn when the last one lands is queued next
+    if (pending_size_ != 0 || !parse_packed_svg()) {
+        return;
     }
     
-    if (!is_loaded()) return;
-    
-    // Pixel-perfect alignment: round position to nearest pixel
-    float x = std::round(position.x);
-    float y = std::round(position.y);
-    
-    // Size is already scaled, render directly
-    float physical_size = std::round(scaled_size);
+    IconSystem& system = IconSystem::get_instance();
+    IconRasterizer& rasterizer = system.get_rasterizer();
+    if (rasterizer.is_running()) {
+        rasterizer.request(id_, serial_, svg_image_, size);
+        pending_size_ = size;
+        return;
+    }
     
-    // Render the icon texture at the pre-scaled size
-    renderer->draw_texture(texture_id_, Rect2D(x, y, physical_size, physical_size), tint);
+    // No workers: rasterize here, still within the frame budget
+    size_t bytes = static_cast<size_t>(size) * static_cast<size_t>(size) * 4;
+    if (!system.spend_frame_budget(bytes)) {
+        return;
+    }
+    if (!svg_rasterizer_) {
+        svg_rasterizer_ = nsvgCreateRasterizer();
+    }
+    std::vector<uint8_t> pixels;
+    if (rasterize_svg_icon(svg_rasterizer_, svg_image_.get(), size, pixels) &&
+        system.get_atlas().add_icon(get_atlas_key(size), pixels.data(), size, size)) {
+        remember_size(size);
+    }
 }
 
+void IconAsset::finish_rasterization(const RasterizedIcon& result, bool placed) {
+    if (result.distance_field) {
+        // Kept even if the atlas was full: the next draw only uploads it
+        field_pending_ = false;
+        field_pixels_ = result.pixels;
+        return;
+    }
+    if (result.size == pending_size_) {
+        pending_size_ = 0;
+    }
+    if (placed) {
+        remember_size(result.size);
+    }
+}
 
+bool IconAsset::prewarm_size(int size) {
+    // A distance field already serves every size
+    if (!is_svg_ || size <= 0 || uses_distance_field()) {
+        return true;
+    }
+    IconSystem& system = IconSystem::get_instance();
+    if (system.get_atlas().get_entry(get_atlas_key(size))) {
+        return true;
+    }
+    if (pack_ && pack_->find_image(pack_index_, size)) {
+        return add_packed_size(size);
+    }
+    if (!parse_packed_svg()) {
+        return true;
+    }
+    
+    // Not as pending_size_: draws at the current scale keep requesting theirs
+    IconRasterizer& rasterizer = system.get_rasterizer();
+    if (rasterizer.is_running()) {
+        rasterizer.request(id_, serial_, svg_image_, size);
+        return true;
+    }
+    if (pending_size_ == 0) {
+        request_size(size);  // Synchronous and budgeted without workers
+    }
+    return true;
+}
 
-void IconAsset::prerender_at_size([[maybe_unused]] CanvasRenderer* renderer, float size) {
-    // Pre-render SVG at specific size for faster display
-    // NOTE: Size should be pre-scaled from ScaledTheme
-    if (is_svg_) {
-        // Size is already scaled, use directly
-        int raster_size = static_cast<int>(size);
-        
-        // Pre-cache this size
-        get_texture_for_size(raster_size);
+bool IconAsset::uses_distance_field() {
+    if (!is_svg_ || !IconSystem::get_instance().uses_distance_field_icons()) {
+        return false;
     }
+    if (!monochrome_checked_) {
+        monochrome_checked_ = true;
+        monochrome_ = parse_packed_svg() && is_monochrome_svg(svg_image_.get());
+    }
+    return monochrome_;
 }
 
-GLuint IconAsset::get_texture_for_size(int size) {
-    // Check if we already have this size cached
-    auto it = size_cache_.find(size);
-    if (it != size_cache_.end()) {
-        // Update last used time
-        it->second.last_used = std::chrono::steady_clock::now();
-        return it->second.texture_id;
+const IconAtlas::AtlasEntry* IconAsset::get_field_entry() {
+    IconSystem& system = IconSystem::get_instance();
+    IconAtlas& atlas = system.get_atlas();
+    IconAtlas::Key key = get_field_key();
+    if (const IconAtlas::AtlasEntry* entry = atlas.use_entry(key)) {
+        return entry;
     }
     
-    // Need to rasterize at this size
-    if (rasterize_svg(size)) {
-        // Clean up old caches if we have too many
-        if (size_cache_.size() >= MAX_CACHED_SIZES) {
-            cleanup_old_caches();
-        }
-        
-        // Add to cache
-        SizeCache cache;
-        cache.texture_id = texture_id_;
-        cache.size = size;
-        cache.last_used = std::chrono::steady_clock::now();
-        size_cache_[size] = cache;
-        
-        return texture_id_;
+    // Generated once; after an eviction the kept field is only uploaded
+    if (field_pixels_.empty()) {
+        request_field();
     }
-    
-    return 0;  // Failed to rasterize
+    if (field_pixels_.empty() || !system.spend_frame_budget(field_pixels_.size()) ||
+        !atlas.add_icon(key, field_pixels_.data(), ICON_FIELD_SIZE, ICON_FIELD_SIZE)) {
+        return nullptr;
+    }
+    width_ = height_ = static_cast<float>(ICON_FIELD_SIZE);
+    return atlas.use_entry(key);
 }
 
-void IconAsset::cleanup_old_caches() {
-    if (size_cache_.size() < MAX_CACHED_SIZES) return;
-    
-    // Find the least recently used entry
-    auto oldest = size_cache_.begin();
-    auto oldest_time = oldest->second.last_used;
+void IconAsset::request_field() {
+    if (field_pending_) {
+        return;
+    }
     
-    for (auto it = size_cache_.begin(); it != size_cache_.end(); ++it) {
-        if (it->second.last_used < oldest_time) {
-            oldest = it;
-            oldest_time = it->second.last_used;
-        }
+    IconSystem& system = IconSystem::get_instance();
+    IconRasterizer& rasterizer = system.get_rasterizer();
+    if (rasterizer.is_running()) {
+        rasterizer.request_field(id_, serial_, svg_image_);
+        field_pending_ = true;
+        return;
     }
     
-    // Delete the oldest texture
-    if (oldest != size_cache_.end()) {
-        if (oldest->second.texture_id != 0) {
-            glDeleteTextures(1, &oldest->second.texture_id);
-        }
-        size_cache_.erase(oldest);
+    // No workers: generate here, charged at its supersampled coverage
+    size_t samples = static_cast<size_t>(ICON_FIELD_SIZE) * ICON_FIELD_SUPERSAMPLE;
+    if (!system.spend_frame_budget(samples * samples * 4)) {
+        return;
+    }
+    if (!svg_rasterizer_) {
+        svg_rasterizer_ = nsvgCreateRasterizer();
+    }
+    if (!rasterize_svg_icon_field(svg_rasterizer_, svg_image_.get(), field_pixels_)) {
+        field_pixels_.clear();
     }
 }
 
-void IconAsset::clear_cache() {
-    // Delete all cached textures
-    for (auto& [size, cache] : size_cache_) {
-        if (cache.texture_id != 0) {
-            glDeleteTextures(1, &cache.texture_id);
-        }
+void IconAsset::remember_size(int size) {
+    if (std::find(atlas_sizes_.begin(), atlas_sizes_.end(), size) == atlas_sizes_.end()) {
+        atlas_sizes_.push_back(size);
     }
-    size_cache_.clear();
+    width_ = height_ = static_cast<float>(size);
+}
+
+void IconAsset::render(CanvasRenderer* renderer, const Point2D& position, float scaled_size, const ColorRGBA& tint) {
+    // Size is pre-scaled from ScaledTheme - no additional scaling needed
+    if (!is_loaded()) return;
     
-    // Reset the current texture as well
-    if (texture_id_ != 0 && !is_svg_) {
-        // Don't delete non-SVG textures as they're the original loaded image
-    } else if (texture_id_ != 0) {
-        glDeleteTextures(1, &texture_id_);
-        texture_id_ = 0;
+    // SVGs are rasterized at exactly the drawn size for crisp edges; the
+    // entry may be a nearby size standing in until that lands
+    int raster_size = static_cast<int>(scaled_size);
+    if (raster_size <= 0) return;
+    
+    // A distance field serves every size; while it is generated, any raster
+    // already at hand stands in
+    bool distance_field = uses_distance_field();
+    const IconAtlas::AtlasEntry* entry = nullptr;
+    if (distance_field) {
+        entry = get_field_entry();
+        if (!entry) {
+            distance_field = false;
+            entry = find_nearest_entry(raster_size);
+        }
+    } else {
+        entry = get_atlas_entry(raster_size);
     }
+    if (!entry) return;
+    
+    // Pixel-perfect alignment: round position to nearest pixel
+    float x = std::round(position.x);
+    float y = std::round(position.y);
+    
+    // Size is already scaled, render directly
+    float physical_size = std::round(scaled_size);
     
-    last_rendered_size_ = 0;
+    // Every icon on the same atlas page lands in the same batch
+    renderer->draw_texture_region(entry->texture_id, Rect2D(x, y, physical_size, physical_size),
+                                  entry->texture_coords, tint, distance_field);
+}
+
+void IconAsset::prerender_at_size([[maybe_unused]] CanvasRenderer* renderer, float size) {
+    // Pre-render SVG at specific size for faster display
+    // NOTE: Size should be pre-scaled from ScaledTheme
+    int raster_size = static_cast<int>(size);
+    if (is_loaded() && raster_size > 0) {
+        get_atlas_entry(raster_size);
+    }
 }
 
 // IconSystem implementation
@@ -419,50 +469,6 @@ IconSystem::~IconSystem() {
     shutdown();
 }
 
-std::string IconSystem::make_cache_key(const std::string& icon_name, int size) const {
-    return icon_name + "_" + std::to_string(size);
-}
-
-void IconSystem::evict_old_cache_entries() {
-    // Calculate total cache size
-    size_t total_size = 0;
-    for (const auto& [key, cached] : size_cache_) {
-        // Estimate: 4 bytes per pixel
-        total_size += static_cast<size_t>(cached.width * cached.height * 4);
-    }
-    
-    size_t max_size_bytes = MAX_CACHE_SIZE_MB * 1024 * 1024;
-    
-    if (total_size > max_size_bytes) {
-        // Find oldest entries
-        std::vector<std::pair<std::string, std::chrono::steady_clock::time_point>> entries;
-        for (const auto& [key, cached] : size_cache_) {
-            entries.push_back({key, cached.last_used});
-        }
-        
-        // Sort by last used time
-        std::sort(entries.begin(), entries.end(),
-                  [](const auto& a, const auto& b) {
-                      return a.second < b.second;
-                  });
-        
-        // Remove oldest entries until we're under the limit
-        size_t removed_size = 0;
-        for (const auto& [key, _] : entries) {
-            if (total_size - removed_size <= max_size_bytes * 0.75f) {
-                break; // Keep 25% free space
-            }
-            
-            auto it = size_cache_.find(key);
-            if (it != size_cache_.end()) {
-                glDeleteTextures(1, &it->second.texture_id);
-                removed_size += static_cast<size_t>(it->second.width * it->second.height * 4);
-                size_cache_.erase(it);
-            }
-        }
-    }
-}
-
 bool IconSystem::initialize(const std::string& icon_directory) {
     if (initialized_) {
         return true;
@@ -470,6 +476,9 @@ bool IconSystem::initialize(const std::string& icon_directory) {
     
     icon_directory_ = icon_directory;
     
+    // SVG workers; without them icons rasterize on the render thread
+    rasterizer_.start();
+    
     // Load default icons
     load_default_icons();
     
@@ -478,7 +487,13 @@ bool IconSystem::initialize(const std::string& icon_directory) {
 }
 
 void IconSystem::shutdown() {
+    // Workers share parsed SVGs with the icons; stop them first
+    rasterizer_.stop();
+    completed_icons_.clear();
+    prewarm_queue_.clear();
+    icons_by_id_.clear();
     icons_.clear();
+    atlas_.clear();
     initialized_ = false;
 }
 
@@ -492,7 +507,23 @@ bool IconSystem::load_icon(const std::string& name, const std::string& filepath)
     }
     
     std::cout << "Successfully loaded icon: " << name << std::endl;
-    icons_[name] = std::move(icon);
+    add_icon(std::move(icon));
+    return true;
+}
+
+bool IconSystem::load_icon_pack(const std::string& path) {
+    auto pack = std::make_shared<IconPack>();
+    if (!pack->open(path)) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < pack->get_icon_count(); ++i) {
+        std::string name(pack->get_name(i));
+        auto icon = std::make_unique<IconAsset>(name);
+        if (icon->load_from_pack(pack, i)) {
+            add_icon(std::move(icon));
+        }
+    }
     return true;
 }
 
@@ -532,6 +563,16 @@ const IconAsset* IconSystem::get_icon(const std::string& name) const {
     return (it != icons_.end()) ? it->second.get() : nullptr;
 }
 
+void IconSystem::add_icon(std::unique_ptr<IconAsset> icon) {
+    IconId id = icon->get_id();
+    atlas_.remove_icon(id);  // Entries of an icon this one replaces
+    if (id.get_index() >= icons_by_id_.size()) {
+        icons_by_id_.resize(IconId::get_count(), nullptr);
+    }
+    icons_by_id_[id.get_index()] = icon.get();
+    icons_[icon->get_name()] = std::move(icon);
+}
+
 bool IconSystem::has_icon(const std::string& name) const {
     return icons_.find(name) != icons_.end();
 }
@@ -540,6 +581,28 @@ void IconSystem::load_default_icons() {
     // Load built-in icons
     load_builtin_icons();
     
+    // Startup cost of either path, for comparing pack and directory loads
+    auto start = std::chrono::steady_clock::now();
+    size_t builtin_count = icons_.size();
+    auto report = [&](const std::string& source) {
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "Loaded " << icons_.size() - builtin_count << " icons from " << source << " in "
+                  << elapsed.count() << " ms" << std::endl;
+    };
+    
+    // A prebuilt pack is mapped, not parsed: prefer one shipped with the
+    // icons, then the one this build generated
+    std::vector<std::string> packs = {icon_directory_ + "icons.pack"};
+#ifdef VOXELUX_ICON_PACK_PATH
+    packs.push_back(VOXELUX_ICON_PACK_PATH);
+#endif
+    for (const std::string& pack : packs) {
+        if (std::filesystem::exists(pack) && load_icon_pack(pack)) {
+            report(pack);
+            return;
+        }
+    }
+    
     // Try to load icons from the assets directory
     std::string icons_dir = icon_directory_;
     
@@ -552,6 +615,7 @@ void IconSystem::load_default_icons() {
         
         // Load file icons
         load_icon_set("file", icons_dir + "file/");
+        report(icons_dir);
     }
 }
 
@@ -559,45 +623,111 @@ void IconSystem::render_icon(CanvasRenderer* renderer, const std::string& icon_n
                              const Point2D& position, float scaled_size, const ColorRGBA& tint) {
     IconAsset* icon = get_icon(icon_name);
     if (icon) {
-        // Check if we have a cached version at this size
-        std::string cache_key = make_cache_key(icon_name, static_cast<int>(scaled_size));
-        auto cache_it = size_cache_.find(cache_key);
-        
-        if (cache_it != size_cache_.end()) {
-            // Update last used time
-            cache_it->second.last_used = std::chrono::steady_clock::now();
-        }
-        
         icon->render(renderer, position, scaled_size, tint);
-        
-        // Periodically evict old cache entries
-        static int render_count = 0;
-        if (++render_count % 100 == 0) {
-            evict_old_cache_entries();
+    }
+}
+
+void IconSystem::render_icon(CanvasRenderer* renderer, IconId icon_id,
+                             const Point2D& position, float scaled_size, const ColorRGBA& tint) {
+    IconAsset* icon = get_icon(icon_id);
+    if (icon) {
+        icon->render(renderer, position, scaled_size, tint);
+    }
+}
+
+void IconSystem::begin_frame() {
+    atlas_.begin_frame();
+    frame_budget_ = ICON_FRAME_BUDGET_BYTES;
+    process_rasterized_icons();
+}
+
+bool IconSystem::spend_frame_budget(size_t bytes) {
+    // A fresh frame always admits one icon, however large
+    if (bytes > frame_budget_ && frame_budget_ < ICON_FRAME_BUDGET_BYTES) {
+        return false;
+    }
+    frame_budget_ -= std::min(bytes, frame_budget_);
+    return true;
+}
+
+void IconSystem::process_rasterized_icons() {
+    completed_icons_.clear();
+    size_t taken = rasterizer_.take_completed(completed_icons_, frame_budget_);
+    frame_budget_ -= std::min(taken, frame_budget_);
+    if (completed_icons_.empty()) {
+        return;
+    }
+    
+    std::vector<IconAtlas::IconUpload> uploads;
+    std::vector<std::pair<IconAsset*, const RasterizedIcon*>> owners;
+    for (const RasterizedIcon& result : completed_icons_) {
+        IconAsset* icon = get_icon(result.icon);
+        if (!icon || icon->get_serial() != result.serial) {
+            continue;  // Reloaded or removed while queued
+        }
+        // Empty, or made for the other mode before the option was switched
+        if (result.pixels.empty() || result.distance_field != icon->uses_distance_field()) {
+            icon->finish_rasterization(result, false);
+            continue;
         }
+        IconAtlas::Key key = result.distance_field ? icon->get_field_key() : icon->get_atlas_key(result.size);
+        uploads.push_back({key, result.pixels.data(), result.size, result.size});
+        owners.emplace_back(icon, &result);
+    }
+    
+    // Placed together so the texels go up in one staged transfer
+    atlas_.add_icons(uploads);
+    for (size_t i = 0; i < uploads.size(); ++i) {
+        owners[i].first->finish_rasterization(*owners[i].second, atlas_.get_entry(uploads[i].key) != nullptr);
     }
 }
 
+void IconSystem::begin_scale_prewarm(float from_scale, float to_scale) {
+    prewarm_queue_.clear();
+    if (from_scale <= 0.0f || to_scale <= 0.0f || from_scale == to_scale) {
+        return;
+    }
+    // Icon sizes are whole-pixel bases times the scale, truncated to a
+    // raster size like IconAsset::render() does
+    for (const auto& [name, icon] : icons_) {
+        for (int size : icon->get_atlas_sizes()) {
+            float base_size = std::round(static_cast<float>(size) / from_scale);
+            prewarm_queue_.emplace_back(icon->get_id(), static_cast<int>(base_size * to_scale));
+        }
+    }
+}
+
+bool IconSystem::prewarm_icons() {
+    while (!prewarm_queue_.empty()) {
+        auto [id, size] = prewarm_queue_.front();
+        IconAsset* icon = get_icon(id);
+        if (icon && !icon->prewarm_size(size)) {
+            return false;  // Budget spent; the rest next frame
+        }
+        prewarm_queue_.pop_front();
+    }
+    return rasterizer_.get_pending_count() == 0;
+}
+
 IconSystem& IconSystem::get_instance() {
     static IconSystem instance;
     return instance;
 }
 
-void IconSystem::clear_all_caches() {
-    // Clear cache for all icons
-    for (auto& [name, icon] : icons_) {
-        if (icon) {
-            icon->clear_cache();
-        }
+void IconSystem::set_distance_field_icons(bool enabled) {
+    if (enabled == distance_field_icons_) {
+        return;
     }
+    distance_field_icons_ = enabled;
     
-    // Also clear the system-level size cache
-    for (auto& [key, cached] : size_cache_) {
-        if (cached.texture_id != 0) {
-            glDeleteTextures(1, &cached.texture_id);
-        }
-    }
-    size_cache_.clear();
+    // Entries of the other mode would only linger until their page is
+    // repacked; fields kept by the icons upload again on their next draw
+    atlas_.clear();
+}
+
+void IconSystem::clear_all_caches() {
+    // Every size is rasterized again on its next draw
+    atlas_.clear();
 }
 
 void IconSystem::load_builtin_icons() {
@@ -631,7 +761,7 @@ void IconSystem::load_builtin_icons() {
         }
         
         icon->load_from_memory(pixels.data(), pixels.size(), false);
-        icons_[icon_name] = std::move(icon);
+        add_icon(std::move(icon));
     }
 }
 
@@ -651,6 +781,7 @@ bool IconSystem::is_png_file(const std::string& filepath) const {
 
 IconButton::IconButton(const std::string& icon_name, const Rect2D& bounds, float scaled_icon_size)
     : icon_name_(icon_name)
+    , icon_id_(IconId::intern(icon_name))
     , bounds_(bounds)
     , scaled_icon_size_(scaled_icon_size)
     , icon_tint_(1.0f, 1.0f, 1.0f, 1.0f) {
@@ -689,7 +820,7 @@ void IconButton::render(CanvasRenderer* renderer) {
             tint.a *= 0.5f;
         }
         
-        IconSystem::get_instance().render_icon(renderer, icon_name_, icon_pos, scaled_icon_size_, tint);
+        IconSystem::get_instance().render_icon(renderer, icon_id_, icon_pos, scaled_icon_size_, tint);
     }
     
     // Draw border for selected state
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Image Loader implementation
+ */
+
+#include "canvas_ui/image_loader.h"
+#include "canvas_ui/texture_residency.h"
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Declarations only; the implementation is compiled in icon_system.cpp
+#include "stb_image.h"
+
+namespace voxel_canvas {
+
+ImageLoader& ImageLoader::get_instance() {
+    static ImageLoader instance;
+    return instance;
+}
+
+ImageLoader::~ImageLoader() {
+    // Textures die with the context; only the workers need stopping here
+    stop_workers();
+}
+
+void ImageLoader::shutdown() {
+    stop_workers();
+
+    TextureResidency& residency = TextureResidency::get_instance();
+    for (auto& [path, image] : images_) {
+        if (image.texture_id) {
+            residency.release(image.texture_id);
+            glDeleteTextures(1, &image.texture_id);
+        }
+    }
+    images_.clear();
+    upload_queue_.clear();
+
+    if (upload_pbo_) {
+        glDeleteBuffers(1, &upload_pbo_);
+        upload_pbo_ = 0;
+    }
+}
+
+unsigned int ImageLoader::get_texture(const std::string& path, int* width, int* height, State* state) {
+    auto it = images_.find(path);
+    if (it == images_.end()) {
+        images_.emplace(path, Image{});
+        queue_decode(path);
+        if (state) {
+            *state = State::Decoding;
+        }
+        return 0;
+    }
+
+    const Image& image = it->second;
+    if (width) {
+        *width = image.width;
+    }
+    if (height) {
+        *height = image.height;
+    }
+    if (state) {
+        *state = image.state;
+    }
+    if (image.state != State::Ready) {
+        return 0;
+    }
+    TextureResidency::get_instance().touch(image.texture_id);
+    return image.texture_id;
+}
+
+void ImageLoader::begin_frame() {
+    std::deque<Decoded> decoded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded.swap(completed_);
+    }
+
+    for (Decoded& result : decoded) {
+        auto it = images_.find(result.path);
+        if (it == images_.end()) {
+            continue;
+        }
+        Image& image = it->second;
+        if (result.pixels.empty()) {
+            std::cerr << "Failed to load image: " << result.path << std::endl;
+            image.state = State::Failed;
+            continue;
+        }
+        image.state = State::Uploading;
+        image.width = result.width;
+        image.height = result.height;
+        image.uploaded_rows = 0;
+        image.pixels = std::move(result.pixels);
+        upload_queue_.push_back(std::move(result.path));
+    }
+
+    if (!upload_queue_.empty()) {
+        upload_pending();
+    }
+}
+
+size_t ImageLoader::get_pending_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_ + completed_.size() + upload_queue_.size();
+}
+
+void ImageLoader::upload_pending() {
+    struct Band {
+        Image* image;
+        int y;
+        int rows;
+        size_t offset;  // Into the pixel buffer
+    };
+    std::vector<Band> bands;
+    size_t total_bytes = 0;
+
+    // Oldest image first, in whole rows; a row wider than the budget still
+    // goes alone so every image makes progress
+    for (const std::string& path : upload_queue_) {
+        Image& image = images_[path];
+        if (!image.texture_id && !create_texture(path, image)) {
+            image.state = State::Failed;
+            image.pixels = {};
+            continue;
+        }
+
+        size_t row_bytes = static_cast<size_t>(image.width) * 4;
+        size_t available = upload_budget_ > total_bytes ? upload_budget_ - total_bytes : 0;
+        int rows = static_cast<int>(std::min<size_t>(available / row_bytes,
+                                                     static_cast<size_t>(image.height - image.uploaded_rows)));
+        if (rows == 0) {
+            if (total_bytes > 0) {
+                break;
+            }
+            rows = 1;
+        }
+        bands.push_back(Band{&image, image.uploaded_rows, rows, total_bytes});
+        total_bytes += static_cast<size_t>(rows) * row_bytes;
+        if (total_bytes >= upload_budget_) {
+            break;
+        }
+    }
+
+    if (!bands.empty()) {
+        // One transfer: stage every band in a pixel buffer (orphaning last
+        // frame's storage), then source the sub-image copies from it
+        if (!upload_pbo_) {
+            glGenBuffers(1, &upload_pbo_);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(total_bytes), nullptr, GL_STREAM_DRAW);
+        auto* staging = static_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(total_bytes),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+        auto band_pixels = [](const Band& band) {
+            return band.image->pixels.data() + static_cast<size_t>(band.y) * static_cast<size_t>(band.image->width) * 4;
+        };
+        if (staging) {
+            for (const Band& band : bands) {
+                size_t bytes = static_cast<size_t>(band.rows) * static_cast<size_t>(band.image->width) * 4;
+                std::memcpy(staging + band.offset, band_pixels(band), bytes);
+            }
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (const Band& band : bands) {
+            Image& image = *band.image;
+            glBindTexture(GL_TEXTURE_2D, image.texture_id);
+
+            // Offsets into the bound buffer, or client memory if mapping failed
+            const void* source = staging
+                ? reinterpret_cast<const void*>(static_cast<uintptr_t>(band.offset))
+                : static_cast<const void*>(band_pixels(band));
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, band.y, image.width, band.rows,
+                            GL_RGBA, GL_UNSIGNED_BYTE, source);
+
+            image.uploaded_rows += band.rows;
+            if (image.uploaded_rows >= image.height) {
+                glGenerateMipmap(GL_TEXTURE_2D);
+                image.pixels = {};
+                image.state = State::Ready;
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Textures still filling are not drawn yet but must not look idle
+    TextureResidency& residency = TextureResidency::get_instance();
+    upload_queue_.erase(std::remove_if(upload_queue_.begin(), upload_queue_.end(),
+                                       [this, &residency](const std::string& path) {
+                                           const Image& image = images_[path];
+                                           if (image.state != State::Uploading) {
+                                               return true;
+                                           }
+                                           residency.touch(image.texture_id);
+                                           return false;
+                                       }),
+                        upload_queue_.end());
+}
+
+bool ImageLoader::create_texture(const std::string& path, Image& image) {
+    glGenTextures(1, &image.texture_id);
+    if (!image.texture_id) {
+        std::cerr << "Failed to create texture for image: " << path << std::endl;
+        return false;
+    }
+
+    // Level 0 storage only; glGenerateMipmap allocates the rest when the
+    // last band has been uploaded
+    glBindTexture(GL_TEXTURE_2D, image.texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    TextureResidency::get_instance().track(
+        image.texture_id, TextureResidency::get_texture_bytes(image.width, image.height, 4, true),
+        TextureOwner::Image, [this, path]() { unload(path); });
+    return true;
+}
+
+void ImageLoader::unload(const std::string& path) {
+    auto it = images_.find(path);
+    if (it == images_.end()) {
+        return;
+    }
+    if (it->second.texture_id) {
+        TextureResidency::get_instance().release(it->second.texture_id);
+        glDeleteTextures(1, &it->second.texture_id);
+    }
+    // Forgotten entirely, so the next get_texture() reads the file again
+    upload_queue_.erase(std::remove(upload_queue_.begin(), upload_queue_.end(), path), upload_queue_.end());
+    images_.erase(it);
+}
+
+void ImageLoader::start_workers() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    unsigned int worker_count = std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, 2u);
+
+    stopping_ = false;
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&ImageLoader::worker_main, this);
+    }
+}
+
+void ImageLoader::stop_workers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    work_available_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    completed_.clear();
+    in_flight_ = 0;
+}
+
+void ImageLoader::queue_decode(const std::string& path) {
+    if (workers_.empty()) {
+        start_workers();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(path);
+        in_flight_++;
+    }
+    work_available_.notify_one();
+}
+
+void ImageLoader::worker_main() {
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            path = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        Decoded result;
+        int channels = 0;
+        unsigned char* data = stbi_load(path.c_str(), &result.width, &result.height, &channels, 4);  // Force RGBA
+        if (data && result.width > 0 && result.height > 0) {
+            result.pixels.assign(data, data + static_cast<size_t>(result.width) * static_cast<size_t>(result.height) * 4);
+        }
+        if (data) {
+            stbi_image_free(data);
+        }
+        result.path = std::move(path);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.push_back(std::move(result));
+        in_flight_--;
+    }
+}
+
+} // namespace voxel_canvas
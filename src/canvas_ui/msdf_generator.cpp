@@ -0,0 +1,899 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * MSDF Generator implementation
+ *
+ * Follows Chlumsky's multi-channel distance field construction: contours are
+ * split into edge groups at corners, each group gets two of the three
+ * channels, and every channel stores the pseudo-distance to the nearest edge
+ * carrying it. Overlapping contours (common in variable fonts) are resolved
+ * per contour by winding before the channels are combined.
+ */
+
+#include "canvas_ui/msdf_generator.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#include <algorithm>
+#include <cmath>
+
+namespace voxel_canvas {
+
+namespace {
+
+constexpr double FAR_DISTANCE = 1e240;
+constexpr int CUBIC_SEARCH_STARTS = 4;
+constexpr int CUBIC_SEARCH_STEPS = 4;
+constexpr int SCANLINE_CURVE_SEGMENTS = 16;
+constexpr double CLASH_THRESHOLD = 1.001;  // In texels of distance change per texel
+
+// Turns sharper than ~3 radians between adjacent edges count as corners
+const double CORNER_CROSS_THRESHOLD = std::sin(3.0);
+
+enum EdgeColor : uint8_t {
+    BLACK = 0, RED = 1, GREEN = 2, YELLOW = 3, BLUE = 4, MAGENTA = 5, CYAN = 6, WHITE = 7
+};
+
+struct Vector2 {
+    double x = 0.0, y = 0.0;
+
+    Vector2() = default;
+    Vector2(double px, double py) : x(px), y(py) {}
+
+    Vector2 operator+(const Vector2& o) const { return Vector2(x + o.x, y + o.y); }
+    Vector2 operator-(const Vector2& o) const { return Vector2(x - o.x, y - o.y); }
+    Vector2 operator*(double s) const { return Vector2(x * s, y * s); }
+    bool operator==(const Vector2& o) const { return x == o.x && y == o.y; }
+    bool is_zero() const { return x == 0.0 && y == 0.0; }
+};
+
+double dot(const Vector2& a, const Vector2& b) { return a.x * b.x + a.y * b.y; }
+double cross(const Vector2& a, const Vector2& b) { return a.x * b.y - a.y * b.x; }
+double length(const Vector2& v) { return std::sqrt(dot(v, v)); }
+double non_zero_sign(double value) { return value > 0.0 ? 1.0 : -1.0; }
+Vector2 mix(const Vector2& a, const Vector2& b, double t) { return a + (b - a) * t; }
+
+Vector2 normalize(const Vector2& v) {
+    double len = length(v);
+    return len > 0.0 ? v * (1.0 / len) : Vector2(0.0, 0.0);
+}
+
+double median(double a, double b, double c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+int solve_quadratic(double roots[2], double a, double b, double c) {
+    if (a == 0.0 || std::fabs(b) > 1e12 * std::fabs(a)) {
+        if (b == 0.0) {
+            return 0;
+        }
+        roots[0] = -c / b;
+        return 1;
+    }
+    double discriminant = b * b - 4.0 * a * c;
+    if (discriminant > 0.0) {
+        discriminant = std::sqrt(discriminant);
+        roots[0] = (-b + discriminant) / (2.0 * a);
+        roots[1] = (-b - discriminant) / (2.0 * a);
+        return 2;
+    }
+    if (discriminant == 0.0) {
+        roots[0] = -b / (2.0 * a);
+        return 1;
+    }
+    return 0;
+}
+
+// x^3 + a x^2 + b x + c = 0
+int solve_cubic_normed(double roots[3], double a, double b, double c) {
+    double a2 = a * a;
+    double q = (a2 - 3.0 * b) / 9.0;
+    double r = (a * (2.0 * a2 - 9.0 * b) + 27.0 * c) / 54.0;
+    double r2 = r * r;
+    double q3 = q * q * q;
+    a /= 3.0;
+    if (r2 < q3) {
+        double t = std::clamp(r / std::sqrt(q3), -1.0, 1.0);
+        t = std::acos(t);
+        q = -2.0 * std::sqrt(q);
+        const double two_pi = 6.28318530717958647692;
+        roots[0] = q * std::cos(t / 3.0) - a;
+        roots[1] = q * std::cos((t + two_pi) / 3.0) - a;
+        roots[2] = q * std::cos((t - two_pi) / 3.0) - a;
+        return 3;
+    }
+    double u = (r < 0.0 ? 1.0 : -1.0) * std::cbrt(std::fabs(r) + std::sqrt(r2 - q3));
+    double v = u == 0.0 ? 0.0 : q / u;
+    roots[0] = (u + v) - a;
+    if (u == v || std::fabs(u - v) < 1e-12 * std::fabs(u + v)) {
+        roots[1] = -0.5 * (u + v) - a;
+        return 2;
+    }
+    return 1;
+}
+
+int solve_cubic(double roots[3], double a, double b, double c, double d) {
+    if (a != 0.0) {
+        double bn = b / a;
+        // Beyond this ratio treating the cubic term as zero is more accurate
+        if (std::fabs(bn) < 1e6) {
+            return solve_cubic_normed(roots, bn, c / a, d / a);
+        }
+    }
+    return solve_quadratic(roots, b, c, d);
+}
+
+/**
+ * Distance with a tie-breaker: when two edges are equally close (at a shared
+ * endpoint) the one the sample point is more orthogonal to wins.
+ */
+struct SignedDistance {
+    double distance = -FAR_DISTANCE;
+    double dot = 1.0;
+
+    SignedDistance() = default;
+    SignedDistance(double d, double o) : distance(d), dot(o) {}
+
+    bool operator<(const SignedDistance& o) const {
+        double a = std::fabs(distance);
+        double b = std::fabs(o.distance);
+        return a < b || (a == b && dot < o.dot);
+    }
+};
+
+/**
+ * Line (degree 1), quadratic (2) or cubic (3) Bezier segment. Distances are
+ * positive to the right of the direction of travel, which is inside for
+ * TrueType-oriented contours.
+ */
+struct Edge {
+    int degree = 1;
+    Vector2 p[4];
+    uint8_t color = WHITE;
+
+    Vector2 point(double t) const {
+        switch (degree) {
+            case 1:
+                return mix(p[0], p[1], t);
+            case 2:
+                return mix(mix(p[0], p[1], t), mix(p[1], p[2], t), t);
+            default: {
+                Vector2 p12 = mix(p[1], p[2], t);
+                return mix(mix(mix(p[0], p[1], t), p12, t), mix(p12, mix(p[2], p[3], t), t), t);
+            }
+        }
+    }
+
+    Vector2 direction(double t) const {
+        switch (degree) {
+            case 1:
+                return p[1] - p[0];
+            case 2: {
+                Vector2 tangent = mix(p[1] - p[0], p[2] - p[1], t);
+                return tangent.is_zero() ? p[2] - p[0] : tangent;
+            }
+            default: {
+                Vector2 tangent = mix(mix(p[1] - p[0], p[2] - p[1], t), mix(p[2] - p[1], p[3] - p[2], t), t);
+                if (tangent.is_zero()) {
+                    if (t == 0.0) return p[2] - p[0];
+                    if (t == 1.0) return p[3] - p[1];
+                }
+                return tangent;
+            }
+        }
+    }
+
+    Vector2 end_point() const { return p[degree]; }
+
+    // De Casteljau subdivision at t
+    void split(double t, Edge& first, Edge& second) const {
+        first.degree = second.degree = degree;
+        first.color = second.color = color;
+        switch (degree) {
+            case 1: {
+                Vector2 m = point(t);
+                first.p[0] = p[0]; first.p[1] = m;
+                second.p[0] = m; second.p[1] = p[1];
+                break;
+            }
+            case 2: {
+                Vector2 a = mix(p[0], p[1], t);
+                Vector2 b = mix(p[1], p[2], t);
+                Vector2 m = mix(a, b, t);
+                first.p[0] = p[0]; first.p[1] = a; first.p[2] = m;
+                second.p[0] = m; second.p[1] = b; second.p[2] = p[2];
+                break;
+            }
+            default: {
+                Vector2 a = mix(p[0], p[1], t);
+                Vector2 b = mix(p[1], p[2], t);
+                Vector2 c = mix(p[2], p[3], t);
+                Vector2 ab = mix(a, b, t);
+                Vector2 bc = mix(b, c, t);
+                Vector2 m = mix(ab, bc, t);
+                first.p[0] = p[0]; first.p[1] = a; first.p[2] = ab; first.p[3] = m;
+                second.p[0] = m; second.p[1] = bc; second.p[2] = c; second.p[3] = p[3];
+                break;
+            }
+        }
+    }
+
+    void split_in_thirds(Edge& first, Edge& second, Edge& third) const {
+        Edge rest;
+        split(1.0 / 3.0, first, rest);
+        rest.split(0.5, second, third);
+    }
+
+    void reverse() {
+        std::reverse(p, p + degree + 1);
+    }
+
+    // Control polygon bounds; the curve lies inside its convex hull
+    void bounds(double& left, double& bottom, double& right, double& top) const {
+        left = right = p[0].x;
+        bottom = top = p[0].y;
+        for (int i = 1; i <= degree; ++i) {
+            left = std::min(left, p[i].x);
+            right = std::max(right, p[i].x);
+            bottom = std::min(bottom, p[i].y);
+            top = std::max(top, p[i].y);
+        }
+    }
+
+    SignedDistance signed_distance(const Vector2& origin, double& param) const {
+        switch (degree) {
+            case 1: return line_distance(origin, param);
+            case 2: return quadratic_distance(origin, param);
+            default: return cubic_distance(origin, param);
+        }
+    }
+
+    // Past an endpoint, measure to the extended tangent instead so corners
+    // from different channels intersect cleanly
+    void to_pseudo_distance(SignedDistance& distance, const Vector2& origin, double param) const {
+        if (param < 0.0) {
+            Vector2 dir = normalize(direction(0.0));
+            Vector2 aq = origin - point(0.0);
+            if (dot(aq, dir) < 0.0) {
+                double pseudo = cross(aq, dir);
+                if (std::fabs(pseudo) <= std::fabs(distance.distance)) {
+                    distance = SignedDistance(pseudo, 0.0);
+                }
+            }
+        } else if (param > 1.0) {
+            Vector2 dir = normalize(direction(1.0));
+            Vector2 bq = origin - point(1.0);
+            if (dot(bq, dir) > 0.0) {
+                double pseudo = cross(bq, dir);
+                if (std::fabs(pseudo) <= std::fabs(distance.distance)) {
+                    distance = SignedDistance(pseudo, 0.0);
+                }
+            }
+        }
+    }
+
+private:
+    SignedDistance line_distance(const Vector2& origin, double& param) const {
+        Vector2 aq = origin - p[0];
+        Vector2 ab = p[1] - p[0];
+        param = dot(aq, ab) / dot(ab, ab);
+        Vector2 eq = (param > 0.5 ? p[1] : p[0]) - origin;
+        double endpoint_distance = length(eq);
+        if (param > 0.0 && param < 1.0) {
+            double ortho_distance = cross(aq, ab) / length(ab);
+            if (std::fabs(ortho_distance) < endpoint_distance) {
+                return SignedDistance(ortho_distance, 0.0);
+            }
+        }
+        return SignedDistance(non_zero_sign(cross(aq, ab)) * endpoint_distance,
+                              std::fabs(dot(normalize(ab), normalize(eq))));
+    }
+
+    SignedDistance endpoint_result(const Vector2& origin, double min_distance, double param) const {
+        if (param >= 0.0 && param <= 1.0) {
+            return SignedDistance(min_distance, 0.0);
+        }
+        if (param < 0.5) {
+            return SignedDistance(min_distance, std::fabs(dot(normalize(direction(0.0)), normalize(p[0] - origin))));
+        }
+        return SignedDistance(min_distance, std::fabs(dot(normalize(direction(1.0)), normalize(end_point() - origin))));
+    }
+
+    // Nearest point solves a cubic in t (derivative of squared distance)
+    SignedDistance quadratic_distance(const Vector2& origin, double& param) const {
+        Vector2 qa = p[0] - origin;
+        Vector2 ab = p[1] - p[0];
+        Vector2 br = p[2] - p[1] - ab;
+        double a = dot(br, br);
+        double b = 3.0 * dot(ab, br);
+        double c = 2.0 * dot(ab, ab) + dot(qa, br);
+        double d = dot(qa, ab);
+        double roots[3];
+        int count = solve_cubic(roots, a, b, c, d);
+
+        Vector2 start_dir = direction(0.0);
+        double min_distance = non_zero_sign(cross(start_dir, qa)) * length(qa);
+        param = -dot(qa, start_dir) / dot(start_dir, start_dir);
+        {
+            Vector2 end_dir = direction(1.0);
+            double distance = length(p[2] - origin);
+            if (distance < std::fabs(min_distance)) {
+                min_distance = non_zero_sign(cross(end_dir, p[2] - origin)) * distance;
+                param = dot(origin - p[1], end_dir) / dot(end_dir, end_dir);
+            }
+        }
+        for (int i = 0; i < count; ++i) {
+            double t = roots[i];
+            if (t > 0.0 && t < 1.0) {
+                Vector2 qe = qa + ab * (2.0 * t) + br * (t * t);
+                double distance = length(qe);
+                if (distance <= std::fabs(min_distance)) {
+                    min_distance = non_zero_sign(cross(ab + br * t, qe)) * distance;
+                    param = t;
+                }
+            }
+        }
+        return endpoint_result(origin, min_distance, param);
+    }
+
+    // No closed form worth the cost: Newton iterations from a few starts
+    SignedDistance cubic_distance(const Vector2& origin, double& param) const {
+        Vector2 qa = p[0] - origin;
+        Vector2 ab = p[1] - p[0];
+        Vector2 br = p[2] - p[1] - ab;
+        Vector2 as = (p[3] - p[2]) - (p[2] - p[1]) - br;
+
+        Vector2 start_dir = direction(0.0);
+        double min_distance = non_zero_sign(cross(start_dir, qa)) * length(qa);
+        param = -dot(qa, start_dir) / dot(start_dir, start_dir);
+        {
+            Vector2 end_dir = direction(1.0);
+            double distance = length(p[3] - origin);
+            if (distance < std::fabs(min_distance)) {
+                min_distance = non_zero_sign(cross(end_dir, p[3] - origin)) * distance;
+                param = dot(end_dir - (p[3] - origin), end_dir) / dot(end_dir, end_dir);
+            }
+        }
+        for (int i = 0; i <= CUBIC_SEARCH_STARTS; ++i) {
+            double t = static_cast<double>(i) / CUBIC_SEARCH_STARTS;
+            Vector2 qe = qa + ab * (3.0 * t) + br * (3.0 * t * t) + as * (t * t * t);
+            for (int step = 0; step < CUBIC_SEARCH_STEPS; ++step) {
+                Vector2 d1 = ab * 3.0 + br * (6.0 * t) + as * (3.0 * t * t);
+                Vector2 d2 = br * 6.0 + as * (6.0 * t);
+                double denominator = dot(d1, d1) + dot(qe, d2);
+                if (denominator == 0.0) {
+                    break;
+                }
+                t -= dot(qe, d1) / denominator;
+                if (t <= 0.0 || t >= 1.0) {
+                    break;
+                }
+                qe = qa + ab * (3.0 * t) + br * (3.0 * t * t) + as * (t * t * t);
+                double distance = length(qe);
+                if (distance < std::fabs(min_distance)) {
+                    min_distance = non_zero_sign(cross(direction(t), qe)) * distance;
+                    param = t;
+                }
+            }
+        }
+        return endpoint_result(origin, min_distance, param);
+    }
+};
+
+using Contour = std::vector<Edge>;
+
+// FT_Outline_Decompose callbacks
+
+struct OutlineContext {
+    std::vector<Contour> contours;
+    Vector2 position;
+};
+
+Vector2 to_vector(const FT_Vector* v) {
+    return Vector2(static_cast<double>(v->x) / 64.0, static_cast<double>(v->y) / 64.0);
+}
+
+int outline_move_to(const FT_Vector* to, void* user) {
+    auto* context = static_cast<OutlineContext*>(user);
+    context->contours.emplace_back();
+    context->position = to_vector(to);
+    return 0;
+}
+
+int outline_line_to(const FT_Vector* to, void* user) {
+    auto* context = static_cast<OutlineContext*>(user);
+    Vector2 end = to_vector(to);
+    if (!(end == context->position) && !context->contours.empty()) {
+        Edge edge;
+        edge.degree = 1;
+        edge.p[0] = context->position;
+        edge.p[1] = end;
+        context->contours.back().push_back(edge);
+    }
+    context->position = end;
+    return 0;
+}
+
+int outline_conic_to(const FT_Vector* control, const FT_Vector* to, void* user) {
+    auto* context = static_cast<OutlineContext*>(user);
+    Vector2 end = to_vector(to);
+    if (!context->contours.empty()) {
+        Edge edge;
+        edge.degree = 2;
+        edge.p[0] = context->position;
+        edge.p[1] = to_vector(control);
+        edge.p[2] = end;
+        context->contours.back().push_back(edge);
+    }
+    context->position = end;
+    return 0;
+}
+
+int outline_cubic_to(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user) {
+    auto* context = static_cast<OutlineContext*>(user);
+    Vector2 end = to_vector(to);
+    if (!context->contours.empty()) {
+        Edge edge;
+        edge.degree = 3;
+        edge.p[0] = context->position;
+        edge.p[1] = to_vector(control1);
+        edge.p[2] = to_vector(control2);
+        edge.p[3] = end;
+        context->contours.back().push_back(edge);
+    }
+    context->position = end;
+    return 0;
+}
+
+// Edge colouring
+
+bool is_corner(const Vector2& a, const Vector2& b) {
+    return dot(a, b) <= 0.0 || std::fabs(cross(a, b)) > CORNER_CROSS_THRESHOLD;
+}
+
+// Pick the next colour so adjacent edge groups always share exactly one channel
+void switch_color(uint8_t& color, uint64_t& seed, uint8_t banned = BLACK) {
+    uint8_t combined = static_cast<uint8_t>(color & banned);
+    if (combined == RED || combined == GREEN || combined == BLUE) {
+        color = static_cast<uint8_t>(combined ^ WHITE);
+        return;
+    }
+    if (color == BLACK || color == WHITE) {
+        static const uint8_t start[3] = { CYAN, MAGENTA, YELLOW };
+        color = start[seed % 3];
+        seed /= 3;
+        return;
+    }
+    int shifted = color << (1 + (seed & 1));
+    color = static_cast<uint8_t>((shifted | shifted >> 3) & WHITE);
+    seed >>= 1;
+}
+
+void color_edges(std::vector<Contour>& contours) {
+    uint64_t seed = 0;
+    for (Contour& edges : contours) {
+        std::vector<size_t> corners;
+        Vector2 previous = normalize(edges.back().direction(1.0));
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (is_corner(previous, normalize(edges[i].direction(0.0)))) {
+                corners.push_back(i);
+            }
+            previous = normalize(edges[i].direction(1.0));
+        }
+
+        if (corners.empty()) {
+            // Smooth contour: all channels agree
+            for (Edge& edge : edges) {
+                edge.color = WHITE;
+            }
+        } else if (corners.size() == 1) {
+            // Teardrop: spread three colours around the single corner
+            uint8_t colors[3] = { WHITE, WHITE, WHITE };
+            switch_color(colors[0], seed);
+            colors[2] = colors[0];
+            switch_color(colors[2], seed);
+            size_t corner = corners[0];
+            size_t count = edges.size();
+            if (count >= 3) {
+                for (size_t i = 0; i < count; ++i) {
+                    double position = 3.0 + 2.875 * static_cast<double>(i) / static_cast<double>(count - 1) - 1.4375 + 0.5;
+                    edges[(corner + i) % count].color = colors[static_cast<int>(position) - 2];
+                }
+            } else {
+                // Too few edges to carry three colours: split them in thirds
+                std::vector<Edge> parts(count * 3);
+                edges[0].split_in_thirds(parts[3 * corner], parts[1 + 3 * corner], parts[2 + 3 * corner]);
+                if (count == 2) {
+                    edges[1].split_in_thirds(parts[3 - 3 * corner], parts[4 - 3 * corner], parts[5 - 3 * corner]);
+                    parts[0].color = parts[1].color = colors[0];
+                    parts[2].color = parts[3].color = colors[1];
+                    parts[4].color = parts[5].color = colors[2];
+                } else {
+                    parts[0].color = colors[0];
+                    parts[1].color = colors[1];
+                    parts[2].color = colors[2];
+                }
+                edges = std::move(parts);
+            }
+        } else {
+            // Switch colour at every corner; the last group must differ from the first
+            size_t corner_count = corners.size();
+            size_t spline = 0;
+            size_t start = corners[0];
+            size_t count = edges.size();
+            uint8_t color = WHITE;
+            switch_color(color, seed);
+            uint8_t initial_color = color;
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = (start + i) % count;
+                if (spline + 1 < corner_count && corners[spline + 1] == index) {
+                    ++spline;
+                    switch_color(color, seed, spline == corner_count - 1 ? initial_color : static_cast<uint8_t>(BLACK));
+                }
+                edges[index].color = color;
+            }
+        }
+    }
+}
+
+// +1 for clockwise (filled, TrueType orientation), -1 for holes
+int contour_winding(const Contour& edges) {
+    auto shoelace = [](const Vector2& a, const Vector2& b) {
+        return (b.x - a.x) * (a.y + b.y);
+    };
+    double total = 0.0;
+    if (edges.size() == 1) {
+        Vector2 a = edges[0].point(0.0), b = edges[0].point(1.0 / 3.0), c = edges[0].point(2.0 / 3.0);
+        total = shoelace(a, b) + shoelace(b, c) + shoelace(c, a);
+    } else if (edges.size() == 2) {
+        Vector2 a = edges[0].point(0.0), b = edges[0].point(0.5), c = edges[1].point(0.0), d = edges[1].point(0.5);
+        total = shoelace(a, b) + shoelace(b, c) + shoelace(c, d) + shoelace(d, a);
+    } else {
+        Vector2 previous = edges.back().point(0.0);
+        for (const Edge& edge : edges) {
+            Vector2 current = edge.point(0.0);
+            total += shoelace(previous, current);
+            previous = current;
+        }
+    }
+    return total > 0.0 ? 1 : (total < 0.0 ? -1 : 0);
+}
+
+// Per-pixel distance selection
+
+struct MultiDistance {
+    double r = -FAR_DISTANCE, g = -FAR_DISTANCE, b = -FAR_DISTANCE;
+
+    double median_value() const { return median(r, g, b); }
+};
+
+struct EdgeSelection {
+    struct Channel {
+        SignedDistance distance;
+        const Edge* edge = nullptr;
+        double param = 0.0;
+    };
+    Channel channels[3];
+
+    double worst_distance() const {
+        return std::max({ std::fabs(channels[0].distance.distance),
+                          std::fabs(channels[1].distance.distance),
+                          std::fabs(channels[2].distance.distance) });
+    }
+
+    void add(const Edge& edge, const SignedDistance& distance, double param) {
+        for (int c = 0; c < 3; ++c) {
+            if ((edge.color & (1 << c)) && distance < channels[c].distance) {
+                channels[c].distance = distance;
+                channels[c].edge = &edge;
+                channels[c].param = param;
+            }
+        }
+    }
+
+    void merge(const EdgeSelection& other) {
+        for (int c = 0; c < 3; ++c) {
+            if (other.channels[c].distance < channels[c].distance) {
+                channels[c] = other.channels[c];
+            }
+        }
+    }
+
+    MultiDistance resolve(const Vector2& origin) const {
+        double values[3];
+        for (int c = 0; c < 3; ++c) {
+            SignedDistance distance = channels[c].distance;
+            if (channels[c].edge) {
+                channels[c].edge->to_pseudo_distance(distance, origin, channels[c].param);
+            }
+            values[c] = distance.distance;
+        }
+        MultiDistance result;
+        result.r = values[0];
+        result.g = values[1];
+        result.b = values[2];
+        return result;
+    }
+};
+
+struct EdgeBounds {
+    double left, bottom, right, top;
+
+    double distance_to(const Vector2& p) const {
+        double dx = std::max({ left - p.x, 0.0, p.x - right });
+        double dy = std::max({ bottom - p.y, 0.0, p.y - top });
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+/**
+ * Combines per-contour results so a contour that lies inside another filled
+ * contour cannot punch its edges through the union (overlapping outlines).
+ */
+MultiDistance combine_contours(const std::vector<MultiDistance>& contour_distances,
+                               const std::vector<int>& windings,
+                               const MultiDistance& shape_distance,
+                               const MultiDistance& inner_distance,
+                               const MultiDistance& outer_distance) {
+    double inner_scalar = inner_distance.median_value();
+    double outer_scalar = outer_distance.median_value();
+    MultiDistance distance;
+    int winding = 0;
+
+    if (inner_scalar >= 0.0 && std::fabs(inner_scalar) <= std::fabs(outer_scalar)) {
+        distance = inner_distance;
+        winding = 1;
+        for (size_t i = 0; i < contour_distances.size(); ++i) {
+            if (windings[i] > 0) {
+                double scalar = contour_distances[i].median_value();
+                if (std::fabs(scalar) < std::fabs(outer_scalar) && scalar > distance.median_value()) {
+                    distance = contour_distances[i];
+                }
+            }
+        }
+    } else if (outer_scalar <= 0.0 && std::fabs(outer_scalar) < std::fabs(inner_scalar)) {
+        distance = outer_distance;
+        winding = -1;
+        for (size_t i = 0; i < contour_distances.size(); ++i) {
+            if (windings[i] < 0) {
+                double scalar = contour_distances[i].median_value();
+                if (std::fabs(scalar) < std::fabs(inner_scalar) && scalar < distance.median_value()) {
+                    distance = contour_distances[i];
+                }
+            }
+        }
+    } else {
+        return shape_distance;
+    }
+
+    for (size_t i = 0; i < contour_distances.size(); ++i) {
+        if (windings[i] != winding) {
+            double scalar = contour_distances[i].median_value();
+            double current = distance.median_value();
+            if (scalar * current >= 0.0 && std::fabs(scalar) < std::fabs(current)) {
+                distance = contour_distances[i];
+            }
+        }
+    }
+    if (distance.median_value() == shape_distance.median_value()) {
+        distance = shape_distance;
+    }
+    return distance;
+}
+
+// Two neighbouring texels clash when a channel jumps by more than the field can
+// change over one texel; only the texel farther from the edge is flagged
+bool detect_clash(const double* a, const double* b, double threshold) {
+    double a0 = a[0], a1 = a[1], a2 = a[2];
+    double b0 = b[0], b1 = b[1], b2 = b[2];
+    if (std::fabs(b0 - a0) < std::fabs(b1 - a1)) {
+        std::swap(a0, a1);
+        std::swap(b0, b1);
+    }
+    if (std::fabs(b1 - a1) < std::fabs(b2 - a2)) {
+        std::swap(a1, a2);
+        std::swap(b1, b2);
+        if (std::fabs(b0 - a0) < std::fabs(b1 - a1)) {
+            std::swap(a0, a1);
+            std::swap(b0, b1);
+        }
+    }
+    return std::fabs(b1 - a1) >= threshold &&
+           !(b0 == b1 && b0 == b2) &&
+           std::fabs(a2 - 0.5) >= std::fabs(b2 - 0.5);
+}
+
+} // namespace
+
+bool MsdfGenerator::generate(const FT_Outline& outline, float pixel_range, MsdfBitmap& bitmap) {
+    bitmap.clear();
+    if (outline.n_contours <= 0 || outline.n_points <= 0 || pixel_range <= 0.0f) {
+        return false;
+    }
+
+    FT_Outline* ft_outline = const_cast<FT_Outline*>(&outline);
+
+    OutlineContext context;
+    FT_Outline_Funcs funcs = {};
+    funcs.move_to = outline_move_to;
+    funcs.line_to = outline_line_to;
+    funcs.conic_to = outline_conic_to;
+    funcs.cubic_to = outline_cubic_to;
+    if (FT_Outline_Decompose(ft_outline, &funcs, &context)) {
+        return false;
+    }
+
+    std::vector<Contour>& contours = context.contours;
+    contours.erase(std::remove_if(contours.begin(), contours.end(),
+                                  [](const Contour& c) { return c.empty(); }),
+                   contours.end());
+    if (contours.empty()) {
+        return false;
+    }
+
+    // Distances are positive to the right of each edge; PostScript outlines
+    // wind the other way, so bring them to TrueType orientation first
+    if (FT_Outline_Get_Orientation(ft_outline) == FT_ORIENTATION_POSTSCRIPT) {
+        for (Contour& edges : contours) {
+            std::reverse(edges.begin(), edges.end());
+            for (Edge& edge : edges) {
+                edge.reverse();
+            }
+        }
+    }
+
+    color_edges(contours);
+
+    std::vector<int> windings;
+    std::vector<std::vector<EdgeBounds>> bounds(contours.size());
+    windings.reserve(contours.size());
+    for (size_t i = 0; i < contours.size(); ++i) {
+        windings.push_back(contour_winding(contours[i]));
+        for (const Edge& edge : contours[i]) {
+            EdgeBounds box{};
+            edge.bounds(box.left, box.bottom, box.right, box.top);
+            bounds[i].push_back(box);
+        }
+    }
+
+    // Glyph box plus enough border for the field to fall to zero
+    FT_BBox box;
+    FT_Outline_Get_CBox(ft_outline, &box);
+    int padding = static_cast<int>(std::ceil(pixel_range * 0.5f)) + 1;
+    bitmap.left = static_cast<int>(std::floor(static_cast<double>(box.xMin) / 64.0)) - padding;
+    bitmap.top = static_cast<int>(std::ceil(static_cast<double>(box.yMax) / 64.0)) + padding;
+    int right = static_cast<int>(std::ceil(static_cast<double>(box.xMax) / 64.0)) + padding;
+    int bottom = static_cast<int>(std::floor(static_cast<double>(box.yMin) / 64.0)) - padding;
+    bitmap.width = right - bitmap.left;
+    bitmap.height = bitmap.top - bottom;
+
+    const size_t texel_count = static_cast<size_t>(bitmap.width) * static_cast<size_t>(bitmap.height);
+    std::vector<double> field(texel_count * 3);
+    std::vector<MultiDistance> contour_distances(contours.size());
+    std::vector<EdgeSelection> contour_selections(contours.size());
+    const double range = static_cast<double>(pixel_range);
+
+    for (int row = 0; row < bitmap.height; ++row) {
+        for (int col = 0; col < bitmap.width; ++col) {
+            Vector2 origin(bitmap.left + col + 0.5, bitmap.top - row - 0.5);
+
+            EdgeSelection shape_selection;
+            EdgeSelection inner_selection;
+            EdgeSelection outer_selection;
+            for (size_t c = 0; c < contours.size(); ++c) {
+                EdgeSelection& selection = contour_selections[c];
+                selection = EdgeSelection();
+                const Contour& edges = contours[c];
+                for (size_t e = 0; e < edges.size(); ++e) {
+                    // Skip edges whose hull is farther than every channel's best
+                    if (bounds[c][e].distance_to(origin) > selection.worst_distance()) {
+                        continue;
+                    }
+                    double param = 0.0;
+                    SignedDistance distance = edges[e].signed_distance(origin, param);
+                    selection.add(edges[e], distance, param);
+                }
+                shape_selection.merge(selection);
+                contour_distances[c] = selection.resolve(origin);
+                double scalar = contour_distances[c].median_value();
+                if (windings[c] > 0 && scalar >= 0.0) {
+                    inner_selection.merge(selection);
+                }
+                if (windings[c] < 0 && scalar <= 0.0) {
+                    outer_selection.merge(selection);
+                }
+            }
+
+            MultiDistance distance = combine_contours(contour_distances, windings,
+                                                      shape_selection.resolve(origin),
+                                                      inner_selection.resolve(origin),
+                                                      outer_selection.resolve(origin));
+            double* texel = &field[(static_cast<size_t>(row) * static_cast<size_t>(bitmap.width) + static_cast<size_t>(col)) * 3];
+            texel[0] = distance.r / range + 0.5;
+            texel[1] = distance.g / range + 0.5;
+            texel[2] = distance.b / range + 0.5;
+        }
+    }
+
+    // Sign fix-up against a non-zero scanline fill of the flattened outline, for
+    // self-intersecting contours the per-edge signs cannot resolve
+    struct Segment { Vector2 a, b; };
+    std::vector<Segment> segments;
+    for (const Contour& edges : contours) {
+        for (const Edge& edge : edges) {
+            int steps = edge.degree == 1 ? 1 : SCANLINE_CURVE_SEGMENTS;
+            Vector2 previous = edge.point(0.0);
+            for (int s = 1; s <= steps; ++s) {
+                Vector2 current = edge.point(static_cast<double>(s) / steps);
+                segments.push_back({ previous, current });
+                previous = current;
+            }
+        }
+    }
+
+    struct Crossing { double x; int direction; };
+    std::vector<Crossing> crossings;
+    for (int row = 0; row < bitmap.height; ++row) {
+        double y = bitmap.top - row - 0.5;
+        crossings.clear();
+        for (const Segment& segment : segments) {
+            if ((segment.a.y > y) != (segment.b.y > y)) {
+                double x = segment.a.x + (y - segment.a.y) * (segment.b.x - segment.a.x) / (segment.b.y - segment.a.y);
+                crossings.push_back({ x, segment.b.y > segment.a.y ? 1 : -1 });
+            }
+        }
+        std::sort(crossings.begin(), crossings.end(),
+                  [](const Crossing& a, const Crossing& b) { return a.x < b.x; });
+
+        size_t next = 0;
+        int winding = 0;
+        for (int col = 0; col < bitmap.width; ++col) {
+            double x = bitmap.left + col + 0.5;
+            while (next < crossings.size() && crossings[next].x < x) {
+                winding += crossings[next].direction;
+                ++next;
+            }
+            double* texel = &field[(static_cast<size_t>(row) * static_cast<size_t>(bitmap.width) + static_cast<size_t>(col)) * 3];
+            bool inside = winding != 0;
+            double sd = median(texel[0], texel[1], texel[2]);
+            if (sd != 0.5 && (sd > 0.5) != inside) {
+                texel[0] = 1.0 - texel[0];
+                texel[1] = 1.0 - texel[1];
+                texel[2] = 1.0 - texel[2];
+            }
+        }
+    }
+
+    // Clash correction: equalize texels whose channels disagree with a neighbour
+    const double threshold = CLASH_THRESHOLD / range;
+    std::vector<size_t> clashes;
+    for (int row = 0; row < bitmap.height; ++row) {
+        for (int col = 0; col < bitmap.width; ++col) {
+            size_t index = static_cast<size_t>(row) * static_cast<size_t>(bitmap.width) + static_cast<size_t>(col);
+            const double* texel = &field[index * 3];
+            bool clash =
+                (col > 0 && detect_clash(texel, texel - 3, threshold)) ||
+                (col < bitmap.width - 1 && detect_clash(texel, texel + 3, threshold)) ||
+                (row > 0 && detect_clash(texel, texel - static_cast<size_t>(bitmap.width) * 3, threshold)) ||
+                (row < bitmap.height - 1 && detect_clash(texel, texel + static_cast<size_t>(bitmap.width) * 3, threshold));
+            if (clash) {
+                clashes.push_back(index);
+            }
+        }
+    }
+    for (size_t index : clashes) {
+        double* texel = &field[index * 3];
+        double m = median(texel[0], texel[1], texel[2]);
+        texel[0] = texel[1] = texel[2] = m;
+    }
+
+    bitmap.pixels.resize(texel_count * 3);
+    for (size_t i = 0; i < field.size(); ++i) {
+        bitmap.pixels[i] = static_cast<uint8_t>(std::clamp(field[i], 0.0, 1.0) * 255.0 + 0.5);
+    }
+    return true;
+}
+
+} // namespace voxel_canvas
@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Paged Atlas implementation
+ */
+
+#include "canvas_ui/paged_atlas.h"
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+// rectpack2D - MIT License, Copyright (c) 2016 Patryk Nadrowski
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#include "../../lib/third_party/rectpack2D/finders_interface.h"
+#pragma GCC diagnostic pop
+
+namespace voxel_canvas {
+
+struct PagedAtlas::PagePacker {
+    explicit PagePacker(int size) : spaces(rectpack2D::rect_wh(size, size)) {}
+
+    rectpack2D::empty_spaces<false> spaces;
+};
+
+namespace {
+
+GLenum pixel_format(AtlasFormat format) {
+    return format == AtlasFormat::RGBA8 ? GL_RGBA : GL_RGB;
+}
+
+size_t texel_bytes(AtlasFormat format) {
+    return format == AtlasFormat::RGBA8 ? 4 : 3;
+}
+
+} // anonymous namespace
+
+PagedAtlas::PagedAtlas() = default;
+
+PagedAtlas::~PagedAtlas() {
+    shutdown();
+}
+
+bool PagedAtlas::initialize(int page_size, int max_pages, AtlasFormat format, TextureOwner owner, int padding) {
+    shutdown();
+    if (page_size <= 0 || max_pages <= 0) {
+        std::cerr << "Invalid atlas page configuration" << std::endl;
+        return false;
+    }
+
+    page_size_ = page_size;
+    max_pages_ = std::min(max_pages, MAX_PAGE_SLOTS);
+    format_ = format;
+    owner_ = owner;
+    padding_ = std::max(padding, 0);
+    frame_ = 1;
+
+    // First page up front so callers can place shared texels on it
+    if (add_page() < 0) {
+        page_size_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void PagedAtlas::shutdown() {
+    for (Page& page : pages_) {
+        if (page.texture_id) {
+            TextureResidency::get_instance().release(page.texture_id);
+            glDeleteTextures(1, &page.texture_id);
+        }
+    }
+    pages_.clear();
+    page_size_ = 0;
+    eviction_count_ = 0;
+}
+
+void PagedAtlas::begin_frame() {
+    // Pages drawn in the frame that just ended stay resident longest
+    TextureResidency& residency = TextureResidency::get_instance();
+    for (const Page& page : pages_) {
+        if (page.texture_id && page.last_used_frame == frame_) {
+            residency.touch(page.texture_id);
+        }
+    }
+    frame_++;
+
+    // Overflow pages go back once nothing drew from them last frame
+    int live = get_page_count();
+    while (live > max_pages_) {
+        Page* oldest = nullptr;
+        for (Page& page : pages_) {
+            if (page.texture_id && !page.pinned && page.last_used_frame + 1 < frame_ &&
+                (!oldest || page.last_used_frame < oldest->last_used_frame)) {
+                oldest = &page;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        release_page(*oldest);
+        live--;
+    }
+}
+
+bool PagedAtlas::allocate(void* owner, uint32_t id, int width, int height, AtlasSlot& slot) {
+    if (!is_initialized() || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (width + padding_ > page_size_ || height + padding_ > page_size_) {
+        std::cerr << "Atlas rect " << width << "x" << height << " exceeds the "
+                  << page_size_ << "px page size" << std::endl;
+        return false;
+    }
+
+    Page* target = nullptr;
+    for (Page& page : pages_) {
+        if (page.texture_id && try_insert(page, width, height, slot)) {
+            target = &page;
+            break;
+        }
+    }
+
+    if (!target && get_page_count() < max_pages_) {
+        int index = add_page();
+        if (index >= 0 && try_insert(pages_[static_cast<size_t>(index)], width, height, slot)) {
+            target = &pages_[static_cast<size_t>(index)];
+        }
+    }
+
+    if (!target) {
+        // Repack the least recently used page that nothing drew from this frame
+        Page* victim = nullptr;
+        for (Page& page : pages_) {
+            if (page.texture_id && !page.pinned && page.last_used_frame < frame_ &&
+                (!victim || page.last_used_frame < victim->last_used_frame)) {
+                victim = &page;
+            }
+        }
+
+        // Every page is on screen: grow past the budget rather than corrupt
+        // texels already batched this frame, and only when out of page slots
+        // repack one anyway
+        bool fresh = false;
+        if (!victim) {
+            int index = add_page();
+            if (index >= 0) {
+                victim = &pages_[static_cast<size_t>(index)];
+                fresh = true;
+            }
+        }
+        if (!victim) {
+            for (Page& page : pages_) {
+                if (page.texture_id && !page.pinned &&
+                    (!victim || page.last_used_frame < victim->last_used_frame)) {
+                    victim = &page;
+                }
+            }
+        }
+        if (!victim) {
+            std::cerr << "Atlas has no page available for a " << width << "x" << height << " rect" << std::endl;
+            return false;
+        }
+
+        if (!fresh) {
+            evict_page(*victim);
+        }
+        if (!try_insert(*victim, width, height, slot)) {
+            return false;
+        }
+        target = victim;
+    }
+
+    target->entries.push_back(Entry{owner, id});
+    target->last_used_frame = frame_;
+    slot.page = static_cast<int>(target - pages_.data());
+    slot.texture_id = target->texture_id;
+    return true;
+}
+
+bool PagedAtlas::try_insert(Page& page, int width, int height, AtlasSlot& slot) {
+    auto rect = page.packer->spaces.insert(rectpack2D::rect_wh(width + padding_, height + padding_));
+    if (!rect) {
+        return false;
+    }
+
+    float size = static_cast<float>(page_size_);
+    slot.x = rect->x;
+    slot.y = rect->y;
+    slot.width = width;
+    slot.height = height;
+    slot.uv = Rect2D(static_cast<float>(rect->x) / size, static_cast<float>(rect->y) / size,
+                     static_cast<float>(width) / size, static_cast<float>(height) / size);
+    return true;
+}
+
+void PagedAtlas::upload(const AtlasSlot& slot, const void* pixels) const {
+    if (!slot.texture_id || !pixels) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, slot.texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, slot.x, slot.y, slot.width, slot.height,
+                   pixel_format(format_), GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PagedAtlas::release_owner(const void* owner) {
+    for (Page& page : pages_) {
+        page.entries.erase(std::remove_if(page.entries.begin(), page.entries.end(),
+                                          [owner](const Entry& entry) { return entry.owner == owner; }),
+                           page.entries.end());
+    }
+}
+
+void PagedAtlas::touch_pages(uint32_t page_mask) {
+    while (page_mask) {
+        touch(std::countr_zero(page_mask));
+        page_mask &= page_mask - 1;
+    }
+}
+
+void PagedAtlas::pin_page(int page) {
+    if (page >= 0 && page < static_cast<int>(pages_.size())) {
+        Page& pinned = pages_[static_cast<size_t>(page)];
+        pinned.pinned = true;
+        TextureResidency::get_instance().pin(pinned.texture_id);
+    }
+}
+
+unsigned int PagedAtlas::get_texture(int page) const {
+    if (page < 0 || page >= static_cast<int>(pages_.size())) {
+        return 0;
+    }
+    return pages_[static_cast<size_t>(page)].texture_id;
+}
+
+int PagedAtlas::get_page_count() const {
+    return static_cast<int>(std::count_if(pages_.begin(), pages_.end(),
+                                          [](const Page& page) { return page.texture_id != 0; }));
+}
+
+int PagedAtlas::add_page() {
+    // Reuse a released slot so page indices stay stable
+    size_t index = 0;
+    while (index < pages_.size() && pages_[index].texture_id) {
+        index++;
+    }
+    if (index >= static_cast<size_t>(MAX_PAGE_SLOTS)) {
+        return -1;
+    }
+    if (index == pages_.size()) {
+        pages_.emplace_back();
+    }
+
+    Page& page = pages_[index];
+    glGenTextures(1, &page.texture_id);
+    if (!page.texture_id) {
+        std::cerr << "Failed to create atlas page texture" << std::endl;
+        return -1;
+    }
+    glBindTexture(GL_TEXTURE_2D, page.texture_id);
+
+    // Linear filtering; the padding keeps neighbours out of the footprint
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Zeroed storage: padding must read as empty when filtered
+    std::vector<unsigned char> empty_data(static_cast<size_t>(page_size_) * static_cast<size_t>(page_size_) *
+                                          texel_bytes(format_), 0);
+    GLint internal_format = format_ == AtlasFormat::RGBA8 ? GL_RGBA8 : GL_RGB8;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, page_size_, page_size_, 0,
+                pixel_format(format_), GL_UNSIGNED_BYTE, empty_data.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Over the global budget an idle page goes back like an overflow page
+    TextureResidency::get_instance().track(
+        page.texture_id,
+        TextureResidency::get_texture_bytes(page_size_, page_size_, static_cast<int>(texel_bytes(format_))),
+        owner_, [this, index]() { release_page(pages_[index]); });
+
+    page.packer = std::make_unique<PagePacker>(page_size_);
+    page.entries.clear();
+    page.last_used_frame = frame_;
+    page.pinned = false;
+    return static_cast<int>(index);
+}
+
+void PagedAtlas::clear_page(Page& page) {
+    std::vector<unsigned char> empty_data(static_cast<size_t>(page_size_) * static_cast<size_t>(page_size_) *
+                                          texel_bytes(format_), 0);
+    glBindTexture(GL_TEXTURE_2D, page.texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, page_size_, page_size_,
+                   pixel_format(format_), GL_UNSIGNED_BYTE, empty_data.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PagedAtlas::evict_page(Page& page) {
+    // Owners forget their slots first, then the page is packed from scratch
+    std::vector<Entry> evicted;
+    evicted.swap(page.entries);
+    if (on_evict_) {
+        for (const Entry& entry : evicted) {
+            on_evict_(entry.owner, entry.id);
+        }
+    }
+
+    page.packer->spaces.reset(rectpack2D::rect_wh(page_size_, page_size_));
+    clear_page(page);
+    eviction_count_++;
+}
+
+void PagedAtlas::release_page(Page& page) {
+    evict_page(page);
+    TextureResidency::get_instance().release(page.texture_id);
+    glDeleteTextures(1, &page.texture_id);
+    page.texture_id = 0;
+    page.packer.reset();
+}
+
+} // namespace voxel_canvas
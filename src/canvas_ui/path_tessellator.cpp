@@ -0,0 +1,708 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * Path Tessellator implementation
+ */
+
+#include "canvas_ui/path_tessellator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voxel_canvas {
+
+namespace {
+
+constexpr float PI = 3.14159265358979323846f;
+constexpr float EPSILON = 1e-6f;
+constexpr int MAX_CURVE_SEGMENTS = 256;
+
+float cross(const Point2D& a, const Point2D& b) { return a.x * b.y - a.y * b.x; }
+float dot(const Point2D& a, const Point2D& b) { return a.x * b.x + a.y * b.y; }
+float length(const Point2D& v) { return std::sqrt(dot(v, v)); }
+
+Point2D normalized(const Point2D& v) {
+    float len = length(v);
+    return len > EPSILON ? v / len : Point2D(0, 0);
+}
+
+// Left-hand normal of a unit direction
+Point2D perpendicular(const Point2D& d) { return Point2D(-d.y, d.x); }
+
+bool nearly_equal(const Point2D& a, const Point2D& b) {
+    return std::fabs(a.x - b.x) < EPSILON && std::fabs(a.y - b.y) < EPSILON;
+}
+
+float signed_area(const std::vector<Point2D>& points) {
+    float area = 0.0f;
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+        area += cross(points[j], points[i]);
+    }
+    return area * 0.5f;
+}
+
+bool point_in_polygon(const Point2D& p, const std::vector<Point2D>& polygon) {
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Point2D& a = polygon[i];
+        const Point2D& b = polygon[j];
+        if ((a.y > p.y) != (b.y > p.y) &&
+            p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool point_in_triangle(const Point2D& p, const Point2D& a, const Point2D& b, const Point2D& c) {
+    // Inclusive of edges so bridge seams never let a triangle swallow a vertex
+    return cross(b - a, p - a) >= 0.0f &&
+           cross(c - b, p - b) >= 0.0f &&
+           cross(a - c, p - c) >= 0.0f;
+}
+
+void add_triangle(PathMesh& mesh, const Point2D& a, const Point2D& b, const Point2D& c) {
+    uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.vertices.push_back(a);
+    mesh.vertices.push_back(b);
+    mesh.vertices.push_back(c);
+    mesh.indices.push_back(base);
+    mesh.indices.push_back(base + 1);
+    mesh.indices.push_back(base + 2);
+}
+
+void add_quad(PathMesh& mesh, const Point2D& a, const Point2D& b, const Point2D& c, const Point2D& d) {
+    uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.vertices.push_back(a);
+    mesh.vertices.push_back(b);
+    mesh.vertices.push_back(c);
+    mesh.vertices.push_back(d);
+    for (uint32_t i : {0u, 1u, 2u, 0u, 2u, 3u}) {
+        mesh.indices.push_back(base + i);
+    }
+}
+
+// Angular step that keeps a round join/cap within tolerance of the true arc
+float arc_step(float radius, float tolerance) {
+    if (radius <= tolerance) {
+        return PI * 0.5f;
+    }
+    return std::max(2.0f * std::acos(1.0f - tolerance / radius), PI / 64.0f);
+}
+
+void add_arc_fan(PathMesh& mesh, const Point2D& center, float radius, float start_angle,
+                 float sweep, float tolerance) {
+    int steps = std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / arc_step(radius, tolerance))));
+    uint32_t center_index = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.vertices.push_back(center);
+    for (int i = 0; i <= steps; ++i) {
+        float angle = start_angle + sweep * static_cast<float>(i) / static_cast<float>(steps);
+        mesh.vertices.push_back(Point2D(center.x + std::cos(angle) * radius,
+                                        center.y + std::sin(angle) * radius));
+        if (i > 0) {
+            uint32_t current = static_cast<uint32_t>(mesh.vertices.size() - 1);
+            mesh.indices.push_back(center_index);
+            mesh.indices.push_back(current - 1);
+            mesh.indices.push_back(current);
+        }
+    }
+}
+
+void add_join(PathMesh& mesh, const Point2D& p, const Point2D& d0, const Point2D& d1,
+              float half_width, const StrokeStyle& style, float tolerance) {
+    float turn = cross(d0, d1);
+    if (std::fabs(turn) < EPSILON && dot(d0, d1) > 0.0f) {
+        return;  // Collinear, segment quads already meet
+    }
+
+    // The outer side of the turn is where the segment quads leave a gap
+    float side = turn > 0.0f ? -1.0f : 1.0f;
+    Point2D n0 = perpendicular(d0) * side;
+    Point2D n1 = perpendicular(d1) * side;
+    Point2D outer0 = p + n0 * half_width;
+    Point2D outer1 = p + n1 * half_width;
+
+    switch (style.join) {
+        case LineJoin::Miter: {
+            Point2D bisector = n0 + n1;
+            float bisector_len = length(bisector);
+            if (bisector_len > EPSILON && 2.0f / bisector_len <= style.miter_limit) {
+                Point2D miter = p + bisector * (2.0f * half_width / (bisector_len * bisector_len));
+                add_quad(mesh, p, outer0, miter, outer1);
+                return;
+            }
+            add_triangle(mesh, p, outer0, outer1);  // Over the limit: bevel
+            return;
+        }
+        case LineJoin::Round: {
+            float start = std::atan2(n0.y, n0.x);
+            float sweep = std::atan2(n1.y, n1.x) - start;
+            if (sweep > PI) sweep -= 2.0f * PI;
+            if (sweep < -PI) sweep += 2.0f * PI;
+            add_arc_fan(mesh, p, half_width, start, sweep, tolerance);
+            return;
+        }
+        case LineJoin::Bevel:
+            add_triangle(mesh, p, outer0, outer1);
+            return;
+    }
+}
+
+void add_cap(PathMesh& mesh, const Point2D& p, const Point2D& d, bool is_start,
+             float half_width, LineCap cap, float tolerance) {
+    Point2D n = perpendicular(d) * half_width;
+    switch (cap) {
+        case LineCap::Butt:
+            return;
+        case LineCap::Square: {
+            Point2D extend = d * (is_start ? -half_width : half_width);
+            add_quad(mesh, p + n, p + n + extend, p - n + extend, p - n);
+            return;
+        }
+        case LineCap::Round:
+            // Sweep from the left normal around the back (start) or front (end) of the line
+            add_arc_fan(mesh, p, half_width, std::atan2(n.y, n.x), is_start ? PI : -PI, tolerance);
+            return;
+    }
+}
+
+// Turn direction of a -> b -> c; positive where a counter-clockwise polygon is convex
+float turn(const Point2D& a, const Point2D& b, const Point2D& c) { return cross(b - a, c - b); }
+
+// Whether a diagonal from polygon[i] to p starts into the polygon's interior
+bool locally_inside(const std::vector<Point2D>& polygon, size_t i, const Point2D& p) {
+    size_t count = polygon.size();
+    const Point2D& prev = polygon[(i + count - 1) % count];
+    const Point2D& a = polygon[i];
+    const Point2D& next = polygon[(i + 1) % count];
+    if (turn(prev, a, next) > 0.0f) {
+        return turn(a, p, next) <= 0.0f && turn(a, prev, p) <= 0.0f;
+    }
+    return turn(a, p, prev) > 0.0f || turn(a, next, p) > 0.0f;
+}
+
+// Bridges leave duplicated vertices behind; of two copies of one point, whether
+// the wedge at polygon[j] lies inside the wedge at polygon[i]
+bool sector_contains_sector(const std::vector<Point2D>& polygon, size_t i, size_t j) {
+    size_t count = polygon.size();
+    return turn(polygon[(i + count - 1) % count], polygon[i], polygon[(j + count - 1) % count]) > 0.0f &&
+           turn(polygon[(j + 1) % count], polygon[i], polygon[(i + 1) % count]) > 0.0f;
+}
+
+// Proper crossing only; segments that share an end point or merely touch do not count
+bool segments_cross(const Point2D& p1, const Point2D& q1, const Point2D& p2, const Point2D& q2) {
+    if (nearly_equal(p1, p2) || nearly_equal(p1, q2) || nearly_equal(q1, p2) || nearly_equal(q1, q2)) {
+        return false;
+    }
+    float o1 = cross(q1 - p1, p2 - p1);
+    float o2 = cross(q1 - p1, q2 - p1);
+    float o3 = cross(q2 - p2, p1 - p2);
+    float o4 = cross(q2 - p2, q1 - p2);
+    return ((o1 > 0.0f && o2 < 0.0f) || (o1 < 0.0f && o2 > 0.0f)) &&
+           ((o3 > 0.0f && o4 < 0.0f) || (o3 < 0.0f && o4 > 0.0f));
+}
+
+bool crosses_contour(const Point2D& a, const Point2D& b, const std::vector<Point2D>& contour) {
+    for (size_t i = 0, j = contour.size() - 1; i < contour.size(); j = i++) {
+        if (segments_cross(a, b, contour[j], contour[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t leftmost_index(const std::vector<Point2D>& points) {
+    size_t index = 0;
+    for (size_t i = 1; i < points.size(); ++i) {
+        if (points[i].x < points[index].x ||
+            (points[i].x == points[index].x && points[i].y < points[index].y)) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+// Earcut's bridge search: cast a ray from the hole's leftmost point h to -x and
+// take the nearest edge that faces it. Its left end point is the bridge unless a
+// reflex vertex inside triangle (h, hit, end point) blocks the view; then the
+// visible vertex with the smallest angle to the ray wins, ties going to the
+// rightmost. Returns outer.size() when no edge faces the hole.
+size_t find_bridge(const std::vector<Point2D>& outer, const Point2D& h) {
+    size_t count = outer.size();
+    size_t bridge = count;
+    float hit_x = -INFINITY;
+    for (size_t i = 0; i < count; ++i) {
+        const Point2D& a = outer[i];
+        const Point2D& b = outer[(i + 1) % count];
+        // Only edges running down face +x on a counter-clockwise contour
+        if (h.y > a.y || h.y < b.y || a.y == b.y) {
+            continue;
+        }
+        float x = a.x + (h.y - a.y) * (b.x - a.x) / (b.y - a.y);
+        if (x <= h.x && x > hit_x) {
+            hit_x = x;
+            bridge = a.x < b.x ? i : (i + 1) % count;
+            if (x == h.x) {
+                return bridge;  // The hole touches this edge
+            }
+        }
+    }
+    if (bridge == count) {
+        return count;
+    }
+
+    const Point2D hit(hit_x, h.y);
+    const Point2D end = outer[bridge];
+    float best_tan = INFINITY;
+    for (size_t i = 0; i < count; ++i) {
+        const Point2D& p = outer[i];
+        if (p.x > h.x || p.x < end.x || p.x == h.x) {
+            continue;
+        }
+        if (!point_in_triangle(p, h, hit, end) && !point_in_triangle(p, h, end, hit)) {
+            continue;
+        }
+        float tan = std::fabs(h.y - p.y) / (h.x - p.x);
+        const Point2D& best = outer[bridge];
+        if (locally_inside(outer, i, h) &&
+            (tan < best_tan || (tan == best_tan && (p.x > best.x ||
+                                                   (p.x == best.x && sector_contains_sector(outer, bridge, i)))))) {
+            bridge = i;
+            best_tan = tan;
+        }
+    }
+    return bridge;
+}
+
+// Splice a clockwise hole into the counter-clockwise polygon built so far
+// (outer contour plus the holes already bridged), through a seam from the
+// hole's leftmost vertex to a vertex it can see
+void bridge_hole(std::vector<Point2D>& outer, const std::vector<Point2D>& hole) {
+    size_t hole_index = leftmost_index(hole);
+    const Point2D h = hole[hole_index];
+
+    size_t bridge = find_bridge(outer, h);
+    if (bridge == outer.size()) {
+        return;  // Hole not inside the outer contour, leave it unfilled
+    }
+
+    // A seam that crosses an edge would make the ear clipper overlap triangles;
+    // fall back to the nearest vertex with a clear, inward seam
+    if (!locally_inside(outer, bridge, h) || crosses_contour(outer[bridge], h, outer) ||
+        crosses_contour(outer[bridge], h, hole)) {
+        bridge = outer.size();
+        float best_distance = INFINITY;
+        for (size_t i = 0; i < outer.size(); ++i) {
+            Point2D d = outer[i] - h;
+            float distance = dot(d, d);
+            if (distance < best_distance && locally_inside(outer, i, h) &&
+                !crosses_contour(outer[i], h, outer) && !crosses_contour(outer[i], h, hole)) {
+                best_distance = distance;
+                bridge = i;
+            }
+        }
+        if (bridge == outer.size()) {
+            return;
+        }
+    }
+
+    std::vector<Point2D> merged;
+    merged.reserve(outer.size() + hole.size() + 2);
+    merged.insert(merged.end(), outer.begin(), outer.begin() + static_cast<std::ptrdiff_t>(bridge) + 1);
+    for (size_t i = 0; i <= hole.size(); ++i) {
+        merged.push_back(hole[(hole_index + i) % hole.size()]);
+    }
+    merged.insert(merged.end(), outer.begin() + static_cast<std::ptrdiff_t>(bridge), outer.end());
+    outer = std::move(merged);
+}
+
+// Ear clipping of a simple CCW polygon (possibly with bridge seams)
+void ear_clip(const std::vector<Point2D>& polygon, PathMesh& mesh) {
+    if (polygon.size() < 3) {
+        return;
+    }
+
+    uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.vertices.insert(mesh.vertices.end(), polygon.begin(), polygon.end());
+
+    std::vector<uint32_t> remaining(polygon.size());
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        remaining[i] = static_cast<uint32_t>(i);
+    }
+
+    size_t guard = 0;
+    size_t i = 0;
+    while (remaining.size() > 3) {
+        size_t count = remaining.size();
+        uint32_t ia = remaining[(i + count - 1) % count];
+        uint32_t ib = remaining[i % count];
+        uint32_t ic = remaining[(i + 1) % count];
+        const Point2D& a = polygon[ia];
+        const Point2D& b = polygon[ib];
+        const Point2D& c = polygon[ic];
+
+        bool is_ear = cross(b - a, c - b) > 0.0f;
+        for (size_t k = 0; is_ear && k < count; ++k) {
+            const Point2D& p = polygon[remaining[k]];
+            if (nearly_equal(p, a) || nearly_equal(p, b) || nearly_equal(p, c)) {
+                continue;
+            }
+            if (point_in_triangle(p, a, b, c)) {
+                is_ear = false;
+            }
+        }
+
+        // Self-intersecting input can leave no valid ear; clip anyway rather than spin
+        if (is_ear || guard >= count) {
+            mesh.indices.push_back(base + ia);
+            mesh.indices.push_back(base + ib);
+            mesh.indices.push_back(base + ic);
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i % count));
+            guard = 0;
+            i = i % remaining.size();
+        } else {
+            ++guard;
+            i = (i + 1) % count;
+        }
+    }
+
+    mesh.indices.push_back(base + remaining[0]);
+    mesh.indices.push_back(base + remaining[1]);
+    mesh.indices.push_back(base + remaining[2]);
+}
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Byte-wise like hash_commands, so equal hashes and equal commands agree
+bool same_commands(const std::vector<PathCommand>& a, const std::vector<PathCommand>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        float values_a[6] = {a[i].x, a[i].y, a[i].cp1x, a[i].cp1y, a[i].cp2x, a[i].cp2y};
+        float values_b[6] = {b[i].x, b[i].y, b[i].cp1x, b[i].cp1y, b[i].cp2x, b[i].cp2y};
+        if (a[i].type != b[i].type || std::memcmp(values_a, values_b, sizeof(values_a)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool same_stroke(const StrokeStyle& a, const StrokeStyle& b) {
+    return std::memcmp(&a.width, &b.width, sizeof(a.width)) == 0 &&
+           std::memcmp(&a.miter_limit, &b.miter_limit, sizeof(a.miter_limit)) == 0 &&
+           a.join == b.join && a.cap == b.cap;
+}
+
+} // namespace
+
+// PathTessellator implementation
+
+void PathTessellator::flatten(const std::vector<PathCommand>& commands, float tolerance,
+                              std::vector<PathContour>& contours) {
+    contours.clear();
+    tolerance = std::max(tolerance, 0.01f);
+
+    PathContour current;
+    Point2D pen;
+    Point2D start;
+
+    auto emit = [&](const Point2D& p) {
+        if (current.points.empty() || !nearly_equal(current.points.back(), p)) {
+            current.points.push_back(p);
+        }
+    };
+    auto finish = [&](bool closed) {
+        if (closed && current.points.size() > 1 && nearly_equal(current.points.front(), current.points.back())) {
+            current.points.pop_back();
+        }
+        current.closed = closed;
+        if (!current.points.empty()) {
+            contours.push_back(std::move(current));
+        }
+        current = PathContour();
+    };
+
+    for (const auto& cmd : commands) {
+        switch (cmd.type) {
+            case PathCommand::MoveTo:
+                finish(false);
+                pen = start = Point2D(cmd.x, cmd.y);
+                emit(pen);
+                break;
+
+            case PathCommand::LineTo:
+                if (current.points.empty()) emit(pen);
+                pen = Point2D(cmd.x, cmd.y);
+                emit(pen);
+                break;
+
+            case PathCommand::CurveTo: {
+                if (current.points.empty()) emit(pen);
+                Point2D p0 = pen;
+                Point2D p1(cmd.cp1x, cmd.cp1y);
+                Point2D p2(cmd.cp2x, cmd.cp2y);
+                Point2D p3(cmd.x, cmd.y);
+
+                // Wang's formula: segments needed so the chord error stays below tolerance
+                float dd = std::max(length(p0 - p1 * 2.0f + p2), length(p1 - p2 * 2.0f + p3));
+                int segments = static_cast<int>(std::ceil(std::sqrt(0.75f * dd / tolerance)));
+                segments = std::clamp(segments, 1, MAX_CURVE_SEGMENTS);
+
+                for (int i = 1; i <= segments; ++i) {
+                    float t = static_cast<float>(i) / static_cast<float>(segments);
+                    float mt = 1.0f - t;
+                    float a = mt * mt * mt;
+                    float b = 3.0f * mt * mt * t;
+                    float c = 3.0f * mt * t * t;
+                    float d = t * t * t;
+                    emit(Point2D(a * p0.x + b * p1.x + c * p2.x + d * p3.x,
+                                 a * p0.y + b * p1.y + c * p2.y + d * p3.y));
+                }
+                pen = p3;
+                break;
+            }
+
+            case PathCommand::Close:
+                finish(true);
+                pen = start;
+                break;
+        }
+    }
+    finish(false);
+}
+
+void PathTessellator::fill(const std::vector<PathContour>& contours, PathMesh& mesh) {
+    std::vector<std::vector<Point2D>> polygons;
+    for (const auto& contour : contours) {
+        if (contour.points.size() >= 3 && std::fabs(signed_area(contour.points)) > EPSILON) {
+            polygons.push_back(contour.points);
+        }
+    }
+    if (polygons.empty()) {
+        return;
+    }
+
+    // Even-odd nesting depth decides whether a contour is a shell or a hole
+    std::vector<int> depth(polygons.size(), 0);
+    std::vector<int> parent(polygons.size(), -1);
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        float parent_area = INFINITY;
+        for (size_t j = 0; j < polygons.size(); ++j) {
+            if (i != j && point_in_polygon(polygons[i][0], polygons[j])) {
+                depth[i]++;
+                float area = std::fabs(signed_area(polygons[j]));
+                if (area < parent_area) {
+                    parent_area = area;
+                    parent[i] = static_cast<int>(j);
+                }
+            }
+        }
+    }
+
+    // Shells wind counter-clockwise, holes clockwise
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        bool is_hole = (depth[i] % 2) == 1;
+        float area = signed_area(polygons[i]);
+        if ((area < 0.0f) != is_hole) {
+            std::reverse(polygons[i].begin(), polygons[i].end());
+        }
+    }
+
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        if (depth[i] % 2 == 1) {
+            continue;
+        }
+
+        std::vector<size_t> holes;
+        for (size_t j = 0; j < polygons.size(); ++j) {
+            if (depth[j] % 2 == 1 && parent[j] == static_cast<int>(i)) {
+                holes.push_back(j);
+            }
+        }
+
+        // Bridge holes left to right: each seam runs left, into the outer contour
+        // or a hole already spliced in, never across a hole still to come
+        std::sort(holes.begin(), holes.end(), [&](size_t a, size_t b) {
+            const Point2D& pa = polygons[a][leftmost_index(polygons[a])];
+            const Point2D& pb = polygons[b][leftmost_index(polygons[b])];
+            return pa.x < pb.x || (pa.x == pb.x && pa.y < pb.y);
+        });
+
+        std::vector<Point2D> outer = polygons[i];
+        for (size_t hole : holes) {
+            bridge_hole(outer, polygons[hole]);
+        }
+        ear_clip(outer, mesh);
+    }
+}
+
+void PathTessellator::stroke(const std::vector<PathContour>& contours, const StrokeStyle& style,
+                             float tolerance, PathMesh& mesh) {
+    float half_width = style.width * 0.5f;
+    if (half_width <= 0.0f) {
+        return;
+    }
+    tolerance = std::max(tolerance, 0.01f);
+
+    for (const auto& contour : contours) {
+        const auto& points = contour.points;
+        size_t count = points.size();
+
+        if (count == 1) {
+            // Zero-length subpath: only round and square caps produce ink
+            if (style.cap == LineCap::Round) {
+                add_arc_fan(mesh, points[0], half_width, 0.0f, 2.0f * PI, tolerance);
+            } else if (style.cap == LineCap::Square) {
+                Point2D p = points[0];
+                add_quad(mesh, Point2D(p.x - half_width, p.y - half_width), Point2D(p.x + half_width, p.y - half_width),
+                         Point2D(p.x + half_width, p.y + half_width), Point2D(p.x - half_width, p.y + half_width));
+            }
+            continue;
+        }
+
+        bool closed = contour.closed && count > 2;
+        size_t segment_count = closed ? count : count - 1;
+
+        std::vector<Point2D> directions(segment_count);
+        for (size_t i = 0; i < segment_count; ++i) {
+            directions[i] = normalized(points[(i + 1) % count] - points[i]);
+        }
+
+        for (size_t i = 0; i < segment_count; ++i) {
+            const Point2D& a = points[i];
+            const Point2D& b = points[(i + 1) % count];
+            Point2D n = perpendicular(directions[i]) * half_width;
+            add_quad(mesh, a + n, b + n, b - n, a - n);
+        }
+
+        // Joins at interior vertices (every vertex for closed contours)
+        size_t first_join = closed ? 0 : 1;
+        size_t last_join = closed ? count : count - 1;
+        for (size_t i = first_join; i < last_join; ++i) {
+            const Point2D& d0 = directions[(i + segment_count - 1) % segment_count];
+            const Point2D& d1 = directions[i % segment_count];
+            add_join(mesh, points[i], d0, d1, half_width, style, tolerance);
+        }
+
+        if (!closed) {
+            add_cap(mesh, points.front(), directions.front(), true, half_width, style.cap, tolerance);
+            add_cap(mesh, points.back(), directions.back(), false, half_width, style.cap, tolerance);
+        }
+    }
+}
+
+uint64_t PathTessellator::hash_commands(const std::vector<PathCommand>& commands) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& cmd : commands) {
+        int type = static_cast<int>(cmd.type);
+        float values[6] = {cmd.x, cmd.y, cmd.cp1x, cmd.cp1y, cmd.cp2x, cmd.cp2y};
+        hash = hash_bytes(hash, &type, sizeof(type));
+        hash = hash_bytes(hash, values, sizeof(values));
+    }
+    return hash;
+}
+
+// PathTessellationCache implementation
+
+const PathMesh& PathTessellationCache::get_fill(const std::vector<PathCommand>& commands, float scale) {
+    float bucket = bucket_scale(scale);
+    uint64_t key = PathTessellator::hash_commands(commands);
+    key = hash_bytes(key, &bucket, sizeof(bucket));
+
+    if (Entry* entry = find(key, commands, bucket, nullptr)) {
+        return entry->mesh;
+    }
+
+    Entry& entry = insert(key, commands, bucket, nullptr);
+    std::vector<PathContour> contours;
+    PathTessellator::flatten(commands, BASE_TOLERANCE / bucket, contours);
+    PathTessellator::fill(contours, entry.mesh);
+    return entry.mesh;
+}
+
+const PathMesh& PathTessellationCache::get_stroke(const std::vector<PathCommand>& commands,
+                                                  const StrokeStyle& style, float scale) {
+    float bucket = bucket_scale(scale);
+    uint64_t key = PathTessellator::hash_commands(commands);
+    int join = static_cast<int>(style.join);
+    int cap = static_cast<int>(style.cap);
+    key = hash_bytes(key, &bucket, sizeof(bucket));
+    key = hash_bytes(key, &style.width, sizeof(style.width));
+    key = hash_bytes(key, &style.miter_limit, sizeof(style.miter_limit));
+    key = hash_bytes(key, &join, sizeof(join));
+    key = hash_bytes(key, &cap, sizeof(cap));
+    key ^= 0x9e3779b97f4a7c15ull;  // Keep strokes apart from fills of the same path
+
+    if (Entry* entry = find(key, commands, bucket, &style)) {
+        return entry->mesh;
+    }
+
+    Entry& entry = insert(key, commands, bucket, &style);
+    std::vector<PathContour> contours;
+    float tolerance = BASE_TOLERANCE / bucket;
+    PathTessellator::flatten(commands, tolerance, contours);
+    PathTessellator::stroke(contours, style, tolerance, entry.mesh);
+    return entry.mesh;
+}
+
+void PathTessellationCache::begin_frame() {
+    frame_++;
+    if (entries_.size() <= MAX_ENTRIES / 2) {
+        return;
+    }
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        bool idle = frame_ - it->second.last_used_frame > MAX_IDLE_FRAMES;
+        bool over_budget = entries_.size() > MAX_ENTRIES && it->second.last_used_frame + 1 < frame_;
+        if (idle || over_budget) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+PathTessellationCache::Entry* PathTessellationCache::find(uint64_t key, const std::vector<PathCommand>& commands,
+                                                          float bucket, const StrokeStyle* style) {
+    // Meshes sharing the hash are only a hit if their inputs match
+    auto range = entries_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        Entry& entry = it->second;
+        if (entry.bucket == bucket && entry.is_stroke == (style != nullptr) &&
+            (!style || same_stroke(entry.style, *style)) && same_commands(entry.commands, commands)) {
+            hits_++;
+            entry.last_used_frame = frame_;
+            return &entry;
+        }
+    }
+    misses_++;
+    return nullptr;
+}
+
+PathTessellationCache::Entry& PathTessellationCache::insert(uint64_t key, const std::vector<PathCommand>& commands,
+                                                           float bucket, const StrokeStyle* style) {
+    Entry& entry = entries_.emplace(key, Entry())->second;
+    entry.commands = commands;
+    entry.bucket = bucket;
+    entry.is_stroke = style != nullptr;
+    if (style) {
+        entry.style = *style;
+    }
+    entry.last_used_frame = frame_;
+    return entry;
+}
+
+float PathTessellationCache::bucket_scale(float scale) {
+    scale = std::max(scale, 1.0f / 64.0f);
+    // Round up to the next quarter octave so the cached mesh is never too coarse
+    return std::exp2(std::ceil(std::log2(scale) * 4.0f) / 4.0f);
+}
+
+} // namespace voxel_canvas
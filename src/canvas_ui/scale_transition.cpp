@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Scale Transition implementation
+ */
+
+#include "canvas_ui/scale_transition.h"
+#include "canvas_ui/canvas_renderer.h"
+#include "canvas_ui/font_system.h"
+#include "canvas_ui/icon_system.h"
+
+#include <chrono>
+
+namespace voxel_canvas {
+
+void ScaleTransition::begin(CanvasRenderer* renderer, float new_scale) {
+    if (new_scale <= 0.0f || new_scale == target_scale_) {
+        return;
+    }
+    target_scale_ = new_scale;
+
+    // Moved back before the switch: the layout is already at this scale
+    if (new_scale == scale_) {
+        cancel_prewarm();
+        renderer->set_presentation_scale(1.0f);
+        return;
+    }
+
+    prewarming_ = true;
+    prewarm_frames_ = 0;
+    renderer->set_presentation_scale(target_scale_ / scale_);
+    if (g_font_system) {
+        g_font_system->begin_scale_prewarm(scale_, target_scale_);
+    }
+    IconSystem::get_instance().begin_scale_prewarm(scale_, target_scale_);
+}
+
+bool ScaleTransition::update(CanvasRenderer* renderer) {
+    if (!prewarming_) {
+        if (retain_frames_ > 0 && --retain_frames_ == 0 && g_font_system) {
+            g_font_system->end_scale_retention();
+        }
+        return false;
+    }
+
+    // Icons only queue work for the workers; shaping runs here, sliced
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double, std::milli>(PREWARM_SLICE_MS));
+    bool runs_ready = !g_font_system || g_font_system->prewarm_runs(deadline);
+    bool icons_ready = IconSystem::get_instance().prewarm_icons();
+
+    if ((runs_ready && icons_ready) || ++prewarm_frames_ >= MAX_PREWARM_FRAMES) {
+        finish(renderer);
+        return true;
+    }
+    return false;
+}
+
+void ScaleTransition::finish(CanvasRenderer* renderer) {
+    // Whatever is still queued is left to the first draws at the new scale
+    cancel_prewarm();
+    scale_ = target_scale_;
+    renderer->set_presentation_scale(1.0f);
+    retain_frames_ = RETAIN_FRAMES;
+}
+
+void ScaleTransition::cancel_prewarm() {
+    prewarming_ = false;
+    if (g_font_system) {
+        g_font_system->cancel_scale_prewarm();
+    }
+    IconSystem::get_instance().cancel_scale_prewarm();
+}
+
+} // namespace voxel_canvas
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * Shader Program Cache implementation
+ */
+
+#include "canvas_ui/shader_cache.h"
+#include "glad/gl.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace voxel_canvas {
+
+namespace {
+
+// Header written in front of every stored binary
+constexpr uint32_t CACHE_MAGIC = 0x42535856;  // "VXSB"
+constexpr uint32_t CACHE_VERSION = 1;
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+std::string gl_string(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ShaderCache& ShaderCache::get_instance() {
+    static ShaderCache instance;
+    return instance;
+}
+
+void ShaderCache::initialize() {
+    if (initialized_) {
+        return;
+    }
+    initialized_ = true;
+
+    driver_key_ = gl_string(GL_VENDOR) + "|" + gl_string(GL_RENDERER) + "|" + gl_string(GL_VERSION);
+
+    // Program binaries are core in 4.1; some 3.3 drivers expose them through the ARB extension.
+    // Drivers that report zero formats (e.g. Apple) cannot round-trip binaries at all.
+    if ((GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary) &&
+        glGetProgramBinary && glProgramBinary) {
+        GLint format_count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        binary_supported_ = format_count > 0;
+    }
+
+    if (binary_supported_) {
+        cache_directory_ = resolve_cache_directory();
+        if (!cache_directory_.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(cache_directory_, ec);
+            if (ec) {
+                std::cerr << "Shader cache disabled, cannot create " << cache_directory_
+                          << ": " << ec.message() << std::endl;
+                cache_directory_.clear();
+            }
+        }
+    }
+
+    if (GLAD_GL_KHR_parallel_shader_compile && glMaxShaderCompilerThreadsKHR) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);  // Let the driver pick its thread count
+        parallel_compile_ = true;
+    } else if (GLAD_GL_ARB_parallel_shader_compile && glMaxShaderCompilerThreadsARB) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        parallel_compile_ = true;
+    }
+}
+
+GLuint ShaderCache::load_program(const std::string& name,
+                                 const char* vertex_source,
+                                 const char* fragment_source,
+                                 const char* geometry_source,
+                                 bool deferred) {
+    initialize();
+    auto start = std::chrono::steady_clock::now();
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = hash_bytes(hash, driver_key_.data(), driver_key_.size());
+    for (const char* source : {vertex_source, geometry_source, fragment_source}) {
+        // Stage separator keeps "ab"+"c" and "a"+"bc" from colliding
+        hash = hash_bytes(hash, "\x1f", 1);
+        if (source) {
+            hash = hash_bytes(hash, source, std::char_traits<char>::length(source));
+        }
+    }
+
+    std::string cache_path = is_binary_cache_enabled() ? make_cache_path(name, hash) : std::string();
+
+    if (!cache_path.empty()) {
+        GLuint program = load_binary(cache_path);
+        if (program) {
+            failed_.erase(program);  // The name of a deleted failure may be handed out again
+            stats_.cache_hits++;
+            stats_.total_ms += elapsed_ms(start);
+            return program;
+        }
+    }
+
+    PendingProgram pending;
+    pending.name = name;
+    pending.cache_path = cache_path;
+
+    // Issue every compile before querying any status so the driver can overlap them
+    pending.shaders.push_back(compile_stage(vertex_source, GL_VERTEX_SHADER));
+    if (geometry_source) {
+        pending.shaders.push_back(compile_stage(geometry_source, GL_GEOMETRY_SHADER));
+    }
+    pending.shaders.push_back(compile_stage(fragment_source, GL_FRAGMENT_SHADER));
+
+    GLuint program = glCreateProgram();
+    failed_.erase(program);
+    for (GLuint shader : pending.shaders) {
+        glAttachShader(program, shader);
+    }
+    if (!cache_path.empty()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    stats_.cache_misses++;
+
+    if (deferred) {
+        stats_.deferred++;
+        pending_.emplace(program, std::move(pending));
+        stats_.total_ms += elapsed_ms(start);
+        return program;
+    }
+
+    bool linked = complete_link(program, pending);
+    stats_.total_ms += elapsed_ms(start);
+    return linked ? program : 0;
+}
+
+bool ShaderCache::finish_program(GLuint program) {
+    auto it = pending_.find(program);
+    if (it == pending_.end()) {
+        // poll() may have finished it already; a failure deleted the id
+        return program != 0 && failed_.count(program) == 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PendingProgram pending = std::move(it->second);
+    pending_.erase(it);
+    bool linked = complete_link(program, pending);
+    if (!linked) {
+        failed_.insert(program);
+    }
+    stats_.total_ms += elapsed_ms(start);
+    return linked;
+}
+
+void ShaderCache::poll() {
+    if (pending_.empty()) {
+        return;
+    }
+
+    if (!parallel_compile_) {
+        // Without completion queries a status check blocks, so finish one per frame
+        finish_program(pending_.begin()->first);
+        return;
+    }
+
+    std::vector<GLuint> ready;
+    for (const auto& [program, pending] : pending_) {
+        GLint complete = GL_FALSE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (complete) {
+            ready.push_back(program);
+        }
+    }
+    for (GLuint program : ready) {
+        finish_program(program);
+    }
+}
+
+void ShaderCache::release_program(GLuint program) {
+    failed_.erase(program);
+    auto it = pending_.find(program);
+    if (it == pending_.end()) {
+        return;
+    }
+    for (GLuint shader : it->second.shaders) {
+        glDeleteShader(shader);
+    }
+    pending_.erase(it);
+}
+
+void ShaderCache::log_startup_summary(const char* stage) const {
+    std::cout << "Shader startup (" << stage << "): " << stats_.total_ms << " ms, "
+              << stats_.cache_hits << " from cache, " << stats_.cache_misses << " compiled"
+              << " (" << stats_.deferred << " deferred)"
+              << (stats_.cache_misses == 0 && stats_.cache_hits > 0 ? " [warm]" : " [cold]")
+              << std::endl;
+}
+
+GLuint ShaderCache::load_binary(const std::string& path) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    uint32_t header[4] = {0, 0, 0, 0};  // magic, version, format, length
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || header[0] != CACHE_MAGIC || header[1] != CACHE_VERSION || header[3] == 0) {
+        return 0;
+    }
+
+    std::vector<char> binary(header[3]);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file) {
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, static_cast<GLenum>(header[2]), binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Drivers reject binaries after an update; fall back to compiling from source
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        std::remove(path.c_str());
+        return 0;
+    }
+    return program;
+}
+
+void ShaderCache::store_binary(GLuint program, const std::string& path) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+
+    // Write to a temporary file and rename so a crash never leaves a torn binary
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        uint32_t header[4] = {CACHE_MAGIC, CACHE_VERSION, format, static_cast<uint32_t>(written)};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) {
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+bool ShaderCache::complete_link(GLuint program, PendingProgram& pending) {
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        // Report the failing stage first, the link log is often empty in that case
+        for (GLuint shader : pending.shaders) {
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+            if (!compiled) {
+                GLchar info_log[512];
+                glGetShaderInfoLog(shader, 512, nullptr, info_log);
+                std::cerr << "Shader compilation failed (" << pending.name << "): " << info_log << std::endl;
+            }
+        }
+        GLchar info_log[512];
+        glGetProgramInfoLog(program, 512, nullptr, info_log);
+        std::cerr << "Shader linking failed (" << pending.name << "): " << info_log << std::endl;
+        stats_.failures++;
+    } else if (!pending.cache_path.empty()) {
+        store_binary(program, pending.cache_path);
+    }
+
+    for (GLuint shader : pending.shaders) {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    pending.shaders.clear();
+
+    if (!success) {
+        glDeleteProgram(program);
+        return false;
+    }
+    return true;
+}
+
+std::string ShaderCache::make_cache_path(const std::string& name, uint64_t hash) const {
+    char hash_hex[17];
+    std::snprintf(hash_hex, sizeof(hash_hex), "%016llx", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(cache_directory_) / (name + "-" + hash_hex + ".bin")).string();
+}
+
+GLuint ShaderCache::compile_stage(const char* source, unsigned int type) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+uint64_t ShaderCache::hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+std::string ShaderCache::resolve_cache_directory() {
+    if (const char* override_dir = std::getenv("VOXELUX_SHADER_CACHE")) {
+        return override_dir;
+    }
+
+#if defined(VOXELUX_WINDOWS)
+    if (const char* local_app_data = std::getenv("LOCALAPPDATA")) {
+        return (std::filesystem::path(local_app_data) / "Voxelux" / "ShaderCache").string();
+    }
+#elif defined(VOXELUX_MACOS)
+    if (const char* home = std::getenv("HOME")) {
+        return (std::filesystem::path(home) / "Library" / "Caches" / "Voxelux" / "Shaders").string();
+    }
+#else
+    if (const char* xdg_cache = std::getenv("XDG_CACHE_HOME")) {
+        return (std::filesystem::path(xdg_cache) / "voxelux" / "shaders").string();
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return (std::filesystem::path(home) / ".cache" / "voxelux" / "shaders").string();
+    }
+#endif
+    return std::string();
+}
+
+} // namespace voxel_canvas
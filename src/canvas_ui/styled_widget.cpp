@@ -554,16 +554,32 @@ void StyledWidget::render(CanvasRenderer* renderer) {
         perform_layout();
     }
     
+    // The outermost render call registers the occluders of its whole tree
+    // first, so subtrees hidden behind later opaque widgets are skipped whole
+    bool occlusion_root = renderer->begin_occlusion_scope();
+    if (occlusion_root) {
+        Rect2D viewport(0, 0, std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        ScaledTheme theme = renderer->get_scaled_theme();
+        collect_occluders(renderer, theme, viewport, false, renderer->get_global_opacity());
+    }
+    
+    if (occlusion_cullable_ && occlusion_frame_ == renderer->get_frame_id()) {
+        CanvasRenderer::OcclusionFlags flags;
+        flags.allows_occlusion = true;
+        if (renderer->should_cull_widget(paint_extent_, flags, paint_order_, subtree_last_order_)) {
+            if (occlusion_root) {
+                renderer->end_occlusion_scope();
+            }
+            return;
+        }
+    }
+    
     // Apply opacity
     float saved_opacity = renderer->get_global_opacity();
     renderer->set_global_opacity(saved_opacity * computed_style_.opacity);
     
     // Apply transform if present
-    bool has_transform = (computed_style_.transform.translate_x != 0 ||
-                         computed_style_.transform.translate_y != 0 ||
-                         computed_style_.transform.scale_x != 1 ||
-                         computed_style_.transform.scale_y != 1 ||
-                         computed_style_.transform.rotate != 0);
+    bool has_transform = has_style_transform();
     
     if (has_transform) {
         renderer->push_transform();
@@ -609,6 +625,110 @@ void StyledWidget::render(CanvasRenderer* renderer) {
     
     // Restore opacity
     renderer->set_global_opacity(saved_opacity);
+    
+    if (occlusion_root) {
+        renderer->end_occlusion_scope();
+    }
+}
+
+bool StyledWidget::has_style_transform() const {
+    return computed_style_.transform.translate_x != 0 ||
+           computed_style_.transform.translate_y != 0 ||
+           computed_style_.transform.scale_x != 1 ||
+           computed_style_.transform.scale_y != 1 ||
+           computed_style_.transform.rotate != 0;
+}
+
+void StyledWidget::collect_occluders(CanvasRenderer* renderer, const ScaledTheme& theme, const Rect2D& clip,
+                                     bool transformed, float opacity) {
+    // Mirrors render(): same visibility rules and child order
+    paint_order_ = renderer->next_paint_order();
+    subtree_last_order_ = paint_order_;
+    occlusion_frame_ = renderer->get_frame_id();
+    occlusion_cullable_ = false;
+    paint_extent_ = Rect2D();
+    
+    if (!visible_ || computed_style_.visibility == WidgetStyle::Visibility::Hidden ||
+        computed_style_.visibility == WidgetStyle::Visibility::Collapse) {
+        return;
+    }
+    
+    if (needs_style_computation_) {
+        compute_style(theme);
+    }
+    if (needs_layout_) {
+        perform_layout();
+    }
+    
+    // Transformed subtrees paint somewhere other than their bounds
+    transformed = transformed || has_style_transform();
+    opacity *= computed_style_.opacity;
+    
+    auto extend = [](Rect2D& extent, const Rect2D& rect) {
+        if (rect.width <= 0 || rect.height <= 0) return;
+        if (extent.width <= 0 || extent.height <= 0) {
+            extent = rect;
+            return;
+        }
+        float right = std::max(extent.right(), rect.right());
+        float bottom = std::max(extent.bottom(), rect.bottom());
+        extent.x = std::min(extent.x, rect.x);
+        extent.y = std::min(extent.y, rect.y);
+        extent.width = right - extent.x;
+        extent.height = bottom - extent.y;
+    };
+    
+    // Painted extent: bounds grown by the outline and the box shadow
+    Rect2D extent = bounds_;
+    if (computed_style_.outline.style != WidgetStyle::OutlineStyle::None && 
+        computed_style_.outline.width.value > 0) {
+        float grow = computed_style_.outline.width.resolve(theme) +
+                     std::abs(computed_style_.outline.offset.resolve(theme));
+        extent = Rect2D(extent.x - grow, extent.y - grow, extent.width + grow * 2, extent.height + grow * 2);
+    }
+    paint_extent_ = extent;
+    
+    const auto& shadow = computed_style_.box_shadow;
+    if (shadow.blur_radius > 0 || shadow.spread != 0) {
+        float grow = std::max(0.0f, shadow.spread + shadow.blur_radius * 2.0f);
+        extend(paint_extent_, Rect2D(bounds_.x + shadow.offset_x - grow, bounds_.y + shadow.offset_y - grow,
+                                     bounds_.width + grow * 2, bounds_.height + grow * 2));
+    }
+    
+    // An opaque, square background hides everything painted before it. The
+    // anti-aliased border edge is excluded from the occluding rect.
+    float corner_radius = std::max({computed_style_.border_radius_tl, computed_style_.border_radius_tr,
+                                    computed_style_.border_radius_br, computed_style_.border_radius_bl});
+    if (!transformed && opacity >= 1.0f && corner_radius <= 0.0f &&
+        computed_style_.background_color.a >= 1.0f) {
+        float border_width = std::max({computed_style_.border_width_top, computed_style_.border_width_right,
+                                       computed_style_.border_width_bottom, computed_style_.border_width_left});
+        float inset = border_width > 0.001f ? border_width + 1.0f : 0.0f;
+        Rect2D fill = get_padding_bounds();
+        fill = Rect2D(fill.x + inset, fill.y + inset, fill.width - inset * 2, fill.height - inset * 2);
+        
+        CanvasRenderer::OcclusionFlags flags;
+        flags.is_opaque = true;
+        renderer->add_occluder(fill.intersection(clip), flags, paint_order_);
+    }
+    
+    // Children are painted after this widget and may overflow it (instance
+    // draws are not scissored), so their extent is not clipped
+    bool needs_clip = (computed_style_.overflow_x == WidgetStyle::Overflow::Hidden ||
+                      computed_style_.overflow_y == WidgetStyle::Overflow::Hidden ||
+                      computed_style_.overflow_x == WidgetStyle::Overflow::Scroll ||
+                      computed_style_.overflow_y == WidgetStyle::Overflow::Scroll);
+    Rect2D child_clip = needs_clip ? clip.intersection(get_content_bounds()) : clip;
+    
+    for (auto& child : children_) {
+        if (child->is_visible()) {
+            child->collect_occluders(renderer, theme, child_clip, transformed, opacity);
+            extend(paint_extent_, child->paint_extent_);
+        }
+    }
+    
+    subtree_last_order_ = renderer->get_paint_order();
+    occlusion_cullable_ = !transformed;
 }
 
 void StyledWidget::render_background(CanvasRenderer* renderer) {
@@ -678,7 +798,7 @@ void StyledWidget::render_background(CanvasRenderer* renderer) {
     // 2. Background images (if any)
     if (!computed_style_.background_images.empty()) {
         for (const auto& bg_image : computed_style_.background_images) {
-            if (bg_image.texture_id != 0) {
+            if (bg_image.is_set()) {
                 // Calculate image position and size based on properties
                 CanvasRenderer::ObjectFit fit = CanvasRenderer::ObjectFit::Fill;
                 switch (bg_image.size) {
@@ -697,29 +817,35 @@ void StyledWidget::render_background(CanvasRenderer* renderer) {
                 }
                 
                 // TODO: Handle repeat, position, and attachment properties
-                renderer->draw_image(bg_image.texture_id, bg_bounds, fit);
+                if (bg_image.texture_id != 0) {
+                    renderer->draw_image(bg_image.texture_id, bg_bounds, fit);
+                } else {
+                    renderer->draw_image(bg_image.url, bg_bounds, fit);
+                }
             }
         }
     } else if (computed_style_.background_image.is_set()) {
-        // Single background image
+        // Single background image; a url is loaded in the background
+        CanvasRenderer::ObjectFit fit = CanvasRenderer::ObjectFit::Fill;
+        switch (computed_style_.background_image.size) {
+            case WidgetStyle::BackgroundImage::Cover:
+                fit = CanvasRenderer::ObjectFit::Cover;
+                break;
+            case WidgetStyle::BackgroundImage::Contain:
+                fit = CanvasRenderer::ObjectFit::Contain;
+                break;
+            case WidgetStyle::BackgroundImage::Auto:
+                fit = CanvasRenderer::ObjectFit::None;
+                break;
+            default:
+                fit = CanvasRenderer::ObjectFit::Fill;
+                break;
+        }
+        
         if (computed_style_.background_image.texture_id != 0) {
-            CanvasRenderer::ObjectFit fit = CanvasRenderer::ObjectFit::Fill;
-            switch (computed_style_.background_image.size) {
-                case WidgetStyle::BackgroundImage::Cover:
-                    fit = CanvasRenderer::ObjectFit::Cover;
-                    break;
-                case WidgetStyle::BackgroundImage::Contain:
-                    fit = CanvasRenderer::ObjectFit::Contain;
-                    break;
-                case WidgetStyle::BackgroundImage::Auto:
-                    fit = CanvasRenderer::ObjectFit::None;
-                    break;
-                default:
-                    fit = CanvasRenderer::ObjectFit::Fill;
-                    break;
-            }
-            
             renderer->draw_image(computed_style_.background_image.texture_id, bg_bounds, fit);
+        } else {
+            renderer->draw_image(computed_style_.background_image.url, bg_bounds, fit);
         }
     }
     
@@ -1143,7 +1269,9 @@ bool StyledWidget::handle_event(const InputEvent& event) {
         }
     }
     
-    return in_bounds;  // Consume event if in bounds
+    // Consume event if in bounds; keys belong to the focused widget, not
+    // the one under the pointer
+    return in_bounds && !event.is_keyboard_event();
 }
 
 void StyledWidget::perform_layout() {
@@ -1456,9 +1584,7 @@ void StyledWidget::layout_inline() {
                         // For text widgets, get the font metrics
                         if (item_style.font_size_pixels > 0 && g_font_system) {
                             // Get font ascender (height above baseline)
-                            FontFace* font = g_font_system->get_font(
-                                item_style.font_family.empty() ? "default" : item_style.font_family
-                            );
+                            FontFace* font = g_font_system->get_font(item_style.font_id);
                             float ascender = font ? font->get_ascender(static_cast<int>(item_style.font_size_pixels)) : 0;
                             
                             // Position so text baseline aligns with line baseline
@@ -2077,9 +2203,7 @@ void StyledWidget::position_flex_line(const FlexLine& line, const Rect2D& conten
                 if (is_row) {
                     float baseline_y = cross_pos + line_cross_size * 0.8f;
                     if (item_style.font_size_pixels > 0 && g_font_system) {
-                        FontFace* font = g_font_system->get_font(
-                            item_style.font_family.empty() ? "default" : item_style.font_family
-                        );
+                        FontFace* font = g_font_system->get_font(item_style.font_id);
                         float ascender = font ? font->get_ascender(static_cast<int>(item_style.font_size_pixels)) : 0;
                         item_cross_pos = baseline_y - ascender;
                     } else {
@@ -2315,9 +2439,7 @@ void StyledWidget::position_flex_items(const std::vector<FlexItem>& items) {
                     
                     // Get item's baseline offset
                     if (item_style.font_size_pixels > 0 && g_font_system) {
-                        FontFace* font = g_font_system->get_font(
-                            item_style.font_family.empty() ? "default" : item_style.font_family
-                        );
+                        FontFace* font = g_font_system->get_font(item_style.font_id);
                         float ascender = font ? font->get_ascender(static_cast<int>(item_style.font_size_pixels)) : 0;
                         cross_pos = baseline_y - ascender;
                     } else {
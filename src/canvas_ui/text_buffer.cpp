@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Text Buffer implementation
+ */
+
+#include "canvas_ui/text_buffer.h"
+#include <algorithm>
+
+namespace voxel_canvas {
+
+namespace {
+
+void index_newlines(std::string_view text, size_t base, std::vector<size_t>& out) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            out.push_back(base + i);
+        }
+    }
+}
+
+} // anonymous namespace
+
+TextBuffer::TextBuffer() {
+    set_text(std::string_view());
+}
+
+TextBuffer::TextBuffer(std::string_view text) {
+    set_text(text);
+}
+
+void TextBuffer::set_text(std::string_view text) {
+    original_.assign(text);
+    added_.clear();
+    original_newlines_.clear();
+    added_newlines_.clear();
+    index_newlines(original_, 0, original_newlines_);
+
+    nodes_.clear();
+    nodes_.emplace_back();  // Null node: zero length, no children
+    free_nodes_.clear();
+    piece_count_ = 0;
+    root_ = 0;
+
+    if (!original_.empty()) {
+        Piece piece;
+        piece.added = false;
+        piece.start = 0;
+        piece.length = original_.size();
+        piece.newlines = original_newlines_.size();
+        root_ = new_node(piece);
+    }
+
+    version_++;
+    mark_dirty(0, true);
+}
+
+// Editing
+
+void TextBuffer::insert(size_t offset, std::string_view text) {
+    if (text.empty()) {
+        return;
+    }
+    offset = std::min(offset, size());
+    size_t first_line = line_of_offset(offset);
+
+    Piece piece;
+    piece.added = true;
+    piece.start = added_.size();
+    piece.length = text.size();
+    size_t indexed = added_newlines_.size();
+    index_newlines(text, piece.start, added_newlines_);
+    piece.newlines = added_newlines_.size() - indexed;
+    added_.append(text);
+
+    uint32_t left;
+    uint32_t right;
+    split(root_, offset, left, right);
+
+    // Typing appends to the add buffer right after the previous insert;
+    // grow that piece instead of adding one per keystroke
+    uint32_t last = left;
+    std::vector<uint32_t> path;
+    while (last) {
+        path.push_back(last);
+        if (!nodes_[last].right) {
+            break;
+        }
+        last = nodes_[last].right;
+    }
+    if (last && nodes_[last].piece.added &&
+        nodes_[last].piece.start + nodes_[last].piece.length == piece.start) {
+        nodes_[last].piece.length += piece.length;
+        nodes_[last].piece.newlines += piece.newlines;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            update(*it);
+        }
+        root_ = merge(left, right);
+    } else {
+        root_ = merge(merge(left, new_node(piece)), right);
+    }
+
+    version_++;
+    mark_dirty(first_line, piece.newlines > 0);
+}
+
+void TextBuffer::erase(size_t offset, size_t length) {
+    size_t total = size();
+    if (offset >= total || length == 0) {
+        return;
+    }
+    length = std::min(length, total - offset);
+    size_t first_line = line_of_offset(offset);
+
+    uint32_t left;
+    uint32_t rest;
+    uint32_t middle;
+    uint32_t right;
+    split(root_, offset, left, rest);
+    split(rest, length, middle, right);
+    bool shifted = nodes_[middle].newlines > 0;
+    free_subtree(middle);
+    root_ = merge(left, right);
+
+    version_++;
+    mark_dirty(first_line, shifted);
+}
+
+void TextBuffer::mark_dirty(size_t first_line, bool shifted) {
+    dirty_first_ = std::min(dirty_first_, first_line);
+    if (shifted) {
+        dirty_last_ = npos;
+    } else if (dirty_last_ != npos) {
+        dirty_last_ = std::max(dirty_last_, first_line);
+    }
+}
+
+bool TextBuffer::take_dirty_lines(size_t& first, size_t& last) {
+    if (dirty_first_ == npos) {
+        return false;
+    }
+    first = dirty_first_;
+    last = dirty_last_;
+    dirty_first_ = npos;
+    dirty_last_ = 0;
+    return true;
+}
+
+// Queries
+
+size_t TextBuffer::size() const {
+    return nodes_[root_].length;
+}
+
+size_t TextBuffer::get_line_count() const {
+    return nodes_[root_].newlines + 1;
+}
+
+size_t TextBuffer::count_newlines(bool added, size_t start, size_t end) const {
+    const std::vector<size_t>& newlines = added ? added_newlines_ : original_newlines_;
+    auto first = std::lower_bound(newlines.begin(), newlines.end(), start);
+    auto last = std::lower_bound(first, newlines.end(), end);
+    return static_cast<size_t>(last - first);
+}
+
+size_t TextBuffer::line_start(size_t line) const {
+    if (line == 0) {
+        return 0;
+    }
+
+    // Offset just past the line-th newline
+    size_t remaining = line;
+    size_t base = 0;
+    uint32_t node = root_;
+    while (node) {
+        const Node& current = nodes_[node];
+        const Node& left = nodes_[current.left];
+        if (remaining <= left.newlines) {
+            node = current.left;
+            continue;
+        }
+        remaining -= left.newlines;
+        base += left.length;
+
+        const Piece& piece = current.piece;
+        if (remaining <= piece.newlines) {
+            const std::vector<size_t>& newlines = newlines_of(piece);
+            auto first = std::lower_bound(newlines.begin(), newlines.end(), piece.start);
+            size_t position = *(first + static_cast<std::ptrdiff_t>(remaining - 1));
+            return base + (position - piece.start) + 1;
+        }
+        remaining -= piece.newlines;
+        base += piece.length;
+        node = current.right;
+    }
+    return size();
+}
+
+size_t TextBuffer::line_end(size_t line) const {
+    if (line + 1 >= get_line_count()) {
+        return size();
+    }
+    return line_start(line + 1) - 1;
+}
+
+size_t TextBuffer::line_of_offset(size_t offset) const {
+    size_t count = 0;
+    uint32_t node = root_;
+    while (node) {
+        const Node& current = nodes_[node];
+        const Node& left = nodes_[current.left];
+        if (offset < left.length) {
+            node = current.left;
+            continue;
+        }
+        count += left.newlines;
+        offset -= left.length;
+
+        const Piece& piece = current.piece;
+        if (offset <= piece.length) {
+            return count + count_newlines(piece.added, piece.start, piece.start + offset);
+        }
+        count += piece.newlines;
+        offset -= piece.length;
+        node = current.right;
+    }
+    return count;
+}
+
+void TextBuffer::get_text(size_t offset, size_t length, std::string& out) const {
+    out.clear();
+    size_t total = size();
+    if (offset >= total) {
+        return;
+    }
+    length = std::min(length, total - offset);
+    out.reserve(length);
+    collect(root_, offset, length, out);
+}
+
+std::string TextBuffer::get_line(size_t line) const {
+    std::string text;
+    size_t start = line_start(line);
+    get_text(start, line_end(line) - std::min(start, line_end(line)), text);
+    return text;
+}
+
+std::string TextBuffer::to_string() const {
+    std::string text;
+    get_text(0, size(), text);
+    return text;
+}
+
+void TextBuffer::collect(uint32_t node, size_t offset, size_t length, std::string& out) const {
+    if (!node || length == 0) {
+        return;
+    }
+    const Node& current = nodes_[node];
+    size_t left_length = nodes_[current.left].length;
+    size_t piece_end = left_length + current.piece.length;
+    size_t end = offset + length;
+
+    if (offset < left_length) {
+        collect(current.left, offset, std::min(end, left_length) - offset, out);
+    }
+
+    size_t start = std::max(offset, left_length);
+    size_t stop = std::min(end, piece_end);
+    if (start < stop) {
+        out.append(buffer_of(current.piece), current.piece.start + (start - left_length), stop - start);
+    }
+
+    if (end > piece_end) {
+        size_t right_offset = std::max(offset, piece_end) - piece_end;
+        collect(current.right, right_offset, end - std::max(offset, piece_end), out);
+    }
+}
+
+// Treap
+
+uint32_t TextBuffer::next_priority() {
+    // xorshift32
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 17;
+    random_state_ ^= random_state_ << 5;
+    return random_state_;
+}
+
+uint32_t TextBuffer::new_node(const Piece& piece) {
+    uint32_t index;
+    if (!free_nodes_.empty()) {
+        index = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[index];
+    node.left = 0;
+    node.right = 0;
+    node.priority = next_priority();
+    node.piece = piece;
+    update(index);
+    piece_count_++;
+    return index;
+}
+
+void TextBuffer::free_subtree(uint32_t node) {
+    std::vector<uint32_t> stack;
+    if (node) {
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        if (nodes_[index].left) {
+            stack.push_back(nodes_[index].left);
+        }
+        if (nodes_[index].right) {
+            stack.push_back(nodes_[index].right);
+        }
+        free_nodes_.push_back(index);
+        piece_count_--;
+    }
+}
+
+void TextBuffer::update(uint32_t node) {
+    Node& current = nodes_[node];
+    current.length = nodes_[current.left].length + current.piece.length + nodes_[current.right].length;
+    current.newlines = nodes_[current.left].newlines + current.piece.newlines + nodes_[current.right].newlines;
+}
+
+void TextBuffer::split(uint32_t node, size_t offset, uint32_t& left, uint32_t& right) {
+    if (!node) {
+        left = right = 0;
+        return;
+    }
+
+    // Indices only: new_node() below may reallocate nodes_
+    size_t left_length = nodes_[nodes_[node].left].length;
+    size_t piece_length = nodes_[node].piece.length;
+    uint32_t lower;
+    uint32_t upper;
+
+    if (offset <= left_length) {
+        split(nodes_[node].left, offset, lower, upper);
+        nodes_[node].left = upper;
+        update(node);
+        left = lower;
+        right = node;
+    } else if (offset >= left_length + piece_length) {
+        split(nodes_[node].right, offset - left_length - piece_length, lower, upper);
+        nodes_[node].right = lower;
+        update(node);
+        left = node;
+        right = upper;
+    } else {
+        // Offset falls inside this piece: cut it in two
+        size_t cut = offset - left_length;
+        Piece head = nodes_[node].piece;
+        Piece tail = head;
+        head.length = cut;
+        head.newlines = count_newlines(head.added, head.start, head.start + cut);
+        tail.start += cut;
+        tail.length -= cut;
+        tail.newlines -= head.newlines;
+
+        uint32_t tail_node = new_node(tail);
+        uint32_t old_right = nodes_[node].right;
+        nodes_[node].piece = head;
+        nodes_[node].right = 0;
+        update(node);
+        left = node;
+        right = merge(tail_node, old_right);
+    }
+}
+
+uint32_t TextBuffer::merge(uint32_t left, uint32_t right) {
+    if (!left) {
+        return right;
+    }
+    if (!right) {
+        return left;
+    }
+    if (nodes_[left].priority > nodes_[right].priority) {
+        uint32_t merged = merge(nodes_[left].right, right);
+        nodes_[left].right = merged;
+        update(left);
+        return left;
+    }
+    uint32_t merged = merge(left, nodes_[right].left);
+    nodes_[right].left = merged;
+    update(right);
+    return right;
+}
+
+} // namespace voxel_canvas
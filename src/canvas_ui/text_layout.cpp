@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Text Layout implementation
+ */
+
+#include "canvas_ui/text_layout.h"
+#include "canvas_ui/font_system.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace voxel_canvas {
+
+namespace {
+
+constexpr float WIDTH_INFINITY = std::numeric_limits<float>::infinity();
+
+// Ranges open to infinity also hold for an unbounded width
+bool range_contains(float min, float max, float width) {
+    return min <= width && (width < max || max == WIDTH_INFINITY);
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f';
+}
+
+// CJK ideographs, kana and Hangul break between characters without spaces
+bool is_ideographic(uint32_t codepoint) {
+    return (codepoint >= 0x2E80 && codepoint <= 0x9FFF) ||
+           (codepoint >= 0xAC00 && codepoint <= 0xD7AF) ||
+           (codepoint >= 0xF900 && codepoint <= 0xFAFF) ||
+           (codepoint >= 0xFF00 && codepoint <= 0xFFEF) ||
+           (codepoint >= 0x20000 && codepoint <= 0x3FFFF);
+}
+
+} // anonymous namespace
+
+// Configuration
+
+void TextLayout::set_font(FontFace* font, float font_size_px) {
+    if (font == font_ && font_size_px == font_size_) {
+        return;
+    }
+    font_ = font;
+    font_size_ = font_size_px;
+
+    int size = static_cast<int>(font_size_px);
+    line_height_ = font_ ? std::round(font_->get_line_height(size)) : 0.0f;
+    ascender_ = font_ ? font_->get_ascender(size) : 0.0f;
+    invalidate_shaping();
+}
+
+void TextLayout::set_white_space(WidgetStyle::WhiteSpace white_space) {
+    if (white_space == white_space_) {
+        return;
+    }
+    white_space_ = white_space;
+
+    // Paragraph boundaries and collapsing depend on the mode; re-split
+    std::string text = std::move(source_);
+    clear();
+    set_text(text);
+}
+
+void TextLayout::set_word_break(WidgetStyle::WordBreak word_break) {
+    if (word_break == word_break_) {
+        return;
+    }
+    word_break_ = word_break;
+    invalidate_shaping();
+}
+
+void TextLayout::set_width(float max_width) {
+    // Paragraphs check their valid range lazily; nothing to do here
+    max_width_ = std::max(0.0f, max_width);
+}
+
+bool TextLayout::wraps() const {
+    return white_space_ == WidgetStyle::WhiteSpace::Normal ||
+           white_space_ == WidgetStyle::WhiteSpace::PreWrap ||
+           white_space_ == WidgetStyle::WhiteSpace::PreLine;
+}
+
+void TextLayout::invalidate_shaping() {
+    // Keep line counts as estimates so scroll extents don't jump
+    for (Paragraph& paragraph : paragraphs_) {
+        paragraph.shaped = false;
+        paragraph.valid = {0.0f, -1.0f};
+    }
+}
+
+// Text
+
+void TextLayout::split_paragraphs(std::string_view text, std::vector<std::string>& out) const {
+    out.clear();
+    bool preserve_newlines = white_space_ != WidgetStyle::WhiteSpace::Normal &&
+                             white_space_ != WidgetStyle::WhiteSpace::NoWrap;
+    if (!preserve_newlines) {
+        out.emplace_back();
+        process_paragraph(text, out.back());
+        return;
+    }
+
+    size_t start = 0;
+    while (true) {
+        size_t newline = text.find('\n', start);
+        out.emplace_back();
+        process_paragraph(text.substr(start, newline == std::string_view::npos ? std::string_view::npos
+                                                                              : newline - start),
+                          out.back());
+        if (newline == std::string_view::npos) {
+            break;
+        }
+        start = newline + 1;
+    }
+}
+
+void TextLayout::process_paragraph(std::string_view raw, std::string& out) const {
+    out.clear();
+    out.reserve(raw.size());
+
+    bool collapse = white_space_ == WidgetStyle::WhiteSpace::Normal ||
+                    white_space_ == WidgetStyle::WhiteSpace::NoWrap ||
+                    white_space_ == WidgetStyle::WhiteSpace::PreLine;
+    if (collapse) {
+        // Runs of white space become one space; none at either end
+        bool pending_space = false;
+        for (char c : raw) {
+            if (is_space(c)) {
+                pending_space = !out.empty();
+                continue;
+            }
+            if (pending_space) {
+                out.push_back(' ');
+                pending_space = false;
+            }
+            out.push_back(c);
+        }
+        return;
+    }
+
+    for (char c : raw) {
+        if (c == '\t') {
+            out.append(static_cast<size_t>(TAB_WIDTH), ' ');
+        } else if (c != '\r') {
+            out.push_back(c);
+        }
+    }
+}
+
+void TextLayout::set_text(std::string_view text) {
+    if (text == source_ && !paragraphs_.empty()) {
+        return;
+    }
+    source_.assign(text);
+
+    std::vector<std::string> texts;
+    split_paragraphs(text, texts);
+
+    // Keep paragraphs matching at either end; only the edited middle is re-shaped
+    size_t old_count = paragraphs_.size();
+    size_t prefix = 0;
+    while (prefix < old_count && prefix < texts.size() && paragraphs_[prefix].text == texts[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < old_count - prefix && suffix < texts.size() - prefix &&
+           paragraphs_[old_count - 1 - suffix].text == texts[texts.size() - 1 - suffix]) {
+        suffix++;
+    }
+
+    size_t old_middle = old_count - prefix - suffix;
+    size_t new_middle = texts.size() - prefix - suffix;
+    auto middle = paragraphs_.begin() + static_cast<std::ptrdiff_t>(prefix);
+    paragraphs_.erase(middle, middle + static_cast<std::ptrdiff_t>(old_middle));
+    std::vector<Paragraph> inserted(new_middle);
+    for (size_t i = 0; i < new_middle; ++i) {
+        inserted[i].text = std::move(texts[prefix + i]);
+    }
+    paragraphs_.insert(paragraphs_.begin() + static_cast<std::ptrdiff_t>(prefix),
+                       std::make_move_iterator(inserted.begin()),
+                       std::make_move_iterator(inserted.end()));
+
+    if (old_middle == new_middle) {
+        // Same shape of document; update the edited counts in place
+        for (size_t i = prefix; i < prefix + new_middle; ++i) {
+            add_line_count(i, 1 - static_cast<int>(line_counts_[i]));
+        }
+    } else {
+        auto counts = line_counts_.begin() + static_cast<std::ptrdiff_t>(prefix);
+        line_counts_.erase(counts, counts + static_cast<std::ptrdiff_t>(old_middle));
+        line_counts_.insert(line_counts_.begin() + static_cast<std::ptrdiff_t>(prefix), new_middle, 1u);
+        rebuild_line_tree();
+    }
+}
+
+void TextLayout::append_text(std::string_view text) {
+    bool preserve_newlines = white_space_ != WidgetStyle::WhiteSpace::Normal &&
+                             white_space_ != WidgetStyle::WhiteSpace::NoWrap;
+    bool collapse = white_space_ == WidgetStyle::WhiteSpace::PreLine;
+    if (!preserve_newlines || collapse || paragraphs_.empty()) {
+        // Collapsing can join across the seam; take the general path
+        std::string combined = source_;
+        combined.append(text);
+        set_text(combined);
+        return;
+    }
+
+    source_.append(text);
+
+    // Pre / PreWrap process each character independently: extend the last
+    // paragraph with the first piece, open new paragraphs for the rest
+    size_t start;
+    size_t newline = text.find('\n');
+    std::string piece;
+    process_paragraph(text.substr(0, newline), piece);
+    if (!piece.empty()) {
+        size_t last = paragraphs_.size() - 1;
+        paragraphs_[last].text += piece;
+        paragraphs_[last].shaped = false;
+        paragraphs_[last].valid = {0.0f, -1.0f};
+    }
+
+    while (newline != std::string_view::npos) {
+        start = newline + 1;
+        newline = text.find('\n', start);
+        Paragraph paragraph;
+        process_paragraph(text.substr(start, newline == std::string_view::npos ? std::string_view::npos
+                                                                              : newline - start),
+                          paragraph.text);
+        paragraphs_.push_back(std::move(paragraph));
+        push_line_count(1);
+    }
+}
+
+void TextLayout::clear() {
+    source_.clear();
+    paragraphs_.clear();
+    line_counts_.clear();
+    line_tree_.clear();
+}
+
+// Shaping and breaking
+
+void TextLayout::ensure_shaped(Paragraph& paragraph) {
+    if (paragraph.shaped) {
+        return;
+    }
+    paragraph.shaped = true;
+    paragraph.valid = {0.0f, -1.0f};
+    paragraph.lines.clear();
+    paragraph.line_ranges.clear();
+    paragraph.breaks.clear();
+
+    // Glyphs are codepoints of the UTF-8 text
+    if (font_ && g_font_system) {
+        g_font_system->shape_owned_run(font_, paragraph.text, font_size_, paragraph.run);
+    } else {
+        paragraph.run = ShapedRun();
+    }
+    std::vector<float>& prefix = paragraph.run.prefix_advances;
+    if (prefix.empty()) {
+        prefix.push_back(0.0f);
+    }
+
+    const std::vector<ShapedGlyph>& codepoints = paragraph.run.measurement.glyphs;
+    uint32_t glyphs = static_cast<uint32_t>(std::min(prefix.size() - 1, codepoints.size()));
+    auto trim = [&codepoints](uint32_t end) {
+        while (end > 0 && codepoints[end - 1].codepoint == ' ') {
+            end--;
+        }
+        return end;
+    };
+
+    // Break opportunities: before any non-space after a space or hyphen, on
+    // either side of an ideograph, or before every non-space glyph for break-all
+    if (wraps()) {
+        bool break_all = word_break_ == WidgetStyle::WordBreak::BreakAll;
+        for (uint32_t i = 1; i < glyphs; ++i) {
+            uint32_t current = codepoints[i].codepoint;
+            if (current == ' ') {
+                continue;
+            }
+            uint32_t before = codepoints[i - 1].codepoint;
+            if (break_all || before == ' ' || before == '-' ||
+                is_ideographic(current) || is_ideographic(before)) {
+                paragraph.breaks.push_back({i, trim(i)});
+            }
+        }
+    }
+    paragraph.breaks.push_back({glyphs, trim(glyphs)});
+    paragraph.natural_width = prefix[paragraph.breaks.back().content_end];
+}
+
+float TextLayout::span_width(const Paragraph& paragraph, uint32_t start, uint32_t end) const {
+    const std::vector<float>& prefix = paragraph.run.prefix_advances;
+    return end > start ? prefix[end] - prefix[start] : 0.0f;
+}
+
+void TextLayout::break_line(const Paragraph& paragraph, uint32_t start, TextLine& line,
+                            ValidRange& range) const {
+    const std::vector<Break>& breaks = paragraph.breaks;
+    auto width_at = [&](size_t k) { return span_width(paragraph, start, breaks[k].content_end); };
+
+    // Candidates end lines after start; their widths grow with k
+    size_t first = static_cast<size_t>(
+        std::upper_bound(breaks.begin(), breaks.end(), start,
+                         [](uint32_t glyph, const Break& b) { return glyph < b.start; }) -
+        breaks.begin());
+
+    if (!wraps()) {
+        line = {start, breaks.back().start, width_at(breaks.size() - 1)};
+        range = {0.0f, WIDTH_INFINITY};
+        return;
+    }
+
+    // Last candidate that fits
+    size_t lo = first;
+    size_t hi = breaks.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (width_at(mid) <= max_width_) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo > first) {
+        size_t k = lo - 1;
+        line = {start, breaks[k].start, width_at(k)};
+        range = {line.width, k + 1 < breaks.size() ? width_at(k + 1) : WIDTH_INFINITY};
+        return;
+    }
+
+    // Even the first word overflows
+    float first_width = width_at(first);
+    if (word_break_ != WidgetStyle::WordBreak::BreakWord) {
+        line = {start, breaks[first].start, first_width};
+        range = {0.0f, first_width};
+        return;
+    }
+
+    // break-word: split the word at the last glyph that fits, at least one
+    uint32_t word_end = breaks[first].content_end;
+    const std::vector<float>& prefix = paragraph.run.prefix_advances;
+    auto glyph_end = std::upper_bound(prefix.begin() + start + 1, prefix.begin() + word_end + 1,
+                                      prefix[start] + max_width_);
+    uint32_t end = std::max(start + 1,
+                            static_cast<uint32_t>(glyph_end - prefix.begin()) - 1);
+    line = {start, end, span_width(paragraph, start, end)};
+    float next = end < word_end ? span_width(paragraph, start, end + 1) : first_width;
+    range = {end > start + 1 || line.width <= max_width_ ? line.width : 0.0f, next};
+}
+
+void TextLayout::ensure_layout(size_t index) {
+    Paragraph& paragraph = paragraphs_[index];
+    ensure_shaped(paragraph);
+    if (range_contains(paragraph.valid.min, paragraph.valid.max, max_width_)) {
+        return;
+    }
+
+    // Lines before the first one whose range excludes the width are unchanged
+    size_t keep = 0;
+    while (keep < paragraph.lines.size() &&
+           range_contains(paragraph.line_ranges[keep].min, paragraph.line_ranges[keep].max, max_width_)) {
+        keep++;
+    }
+    paragraph.lines.resize(keep);
+    paragraph.line_ranges.resize(keep);
+
+    uint32_t glyphs = paragraph.breaks.back().start;
+    uint32_t start = keep > 0 ? paragraph.lines.back().glyph_end : 0;
+    while (start < glyphs || paragraph.lines.empty()) {
+        TextLine line;
+        ValidRange range;
+        break_line(paragraph, start, line, range);
+        paragraph.lines.push_back(line);
+        paragraph.line_ranges.push_back(range);
+        start = line.glyph_end;
+    }
+
+    paragraph.valid = {0.0f, WIDTH_INFINITY};
+    for (const ValidRange& range : paragraph.line_ranges) {
+        paragraph.valid.min = std::max(paragraph.valid.min, range.min);
+        paragraph.valid.max = std::min(paragraph.valid.max, range.max);
+    }
+
+    int delta = static_cast<int>(paragraph.lines.size()) - static_cast<int>(line_counts_[index]);
+    if (delta != 0) {
+        add_line_count(index, delta);
+    }
+}
+
+void TextLayout::layout_all() {
+    for (size_t i = 0; i < paragraphs_.size(); ++i) {
+        ensure_layout(i);
+    }
+}
+
+float TextLayout::get_natural_width() {
+    float width = 0.0f;
+    for (Paragraph& paragraph : paragraphs_) {
+        ensure_shaped(paragraph);
+        width = std::max(width, paragraph.natural_width);
+    }
+    return width;
+}
+
+// Line index
+
+size_t TextLayout::get_line_count() const {
+    return lines_before(paragraphs_.size());
+}
+
+bool TextLayout::get_line(size_t line_index, size_t& paragraph_index, TextLine& line) {
+    if (line_index >= get_line_count()) {
+        return false;
+    }
+    paragraph_index = find_paragraph(line_index);
+    ensure_layout(paragraph_index);
+
+    // Re-flowing may have changed this paragraph's count
+    size_t local = line_index - lines_before(paragraph_index);
+    const Paragraph& paragraph = paragraphs_[paragraph_index];
+    line = paragraph.lines[std::min(local, paragraph.lines.size() - 1)];
+    return true;
+}
+
+void TextLayout::draw(CanvasRenderer* renderer, const Point2D& origin, const ColorRGBA& color,
+                      TextAlign align, float box_width, float clip_top, float clip_bottom) {
+    if (!renderer || !font_ || !g_font_system || paragraphs_.empty() || line_height_ <= 0.0f) {
+        return;
+    }
+
+    size_t first_line = clip_top > 0.0f ? static_cast<size_t>(clip_top / line_height_) : 0;
+    if (first_line >= get_line_count()) {
+        return;
+    }
+
+    for (size_t p = find_paragraph(first_line); p < paragraphs_.size(); ++p) {
+        ensure_layout(p);
+        float y = static_cast<float>(lines_before(p)) * line_height_;
+        if (y >= clip_bottom) {
+            break;
+        }
+
+        Paragraph& paragraph = paragraphs_[p];
+        if (paragraph.breaks.back().start == 0) {
+            continue;  // Blank line
+        }
+
+        g_font_system->prepare_run_quads(font_, font_size_, paragraph.run);
+        for (const TextLine& line : paragraph.lines) {
+            if (y + line_height_ > clip_top && y < clip_bottom) {
+                float x = origin.x;
+                if (align == TextAlign::CENTER) {
+                    x += std::round((box_width - line.width) / 2);
+                } else if (align == TextAlign::RIGHT) {
+                    x += box_width - line.width;
+                }
+                renderer->draw_text_run(paragraph.run, Point2D(x, origin.y + y), ascender_, color,
+                                        line.glyph_begin, line.glyph_end);
+            }
+            y += line_height_;
+        }
+    }
+}
+
+// Fenwick tree
+
+void TextLayout::rebuild_line_tree() {
+    size_t count = line_counts_.size();
+    line_tree_.assign(count + 1, 0);
+    for (size_t i = 1; i <= count; ++i) {
+        line_tree_[i] += line_counts_[i - 1];
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= count) {
+            line_tree_[parent] += line_tree_[i];
+        }
+    }
+}
+
+void TextLayout::push_line_count(uint32_t count) {
+    line_counts_.push_back(count);
+    if (line_tree_.empty()) {
+        line_tree_.push_back(0);
+    }
+
+    // New node i covers (i - lowbit(i), i]; sum its children
+    size_t i = line_counts_.size();
+    uint32_t sum = count;
+    size_t low = i & (~i + 1);
+    for (size_t child = i - 1; child > i - low; child -= child & (~child + 1)) {
+        sum += line_tree_[child];
+    }
+    line_tree_.push_back(sum);
+}
+
+void TextLayout::add_line_count(size_t index, int delta) {
+    line_counts_[index] = static_cast<uint32_t>(static_cast<int>(line_counts_[index]) + delta);
+    for (size_t i = index + 1; i < line_tree_.size(); i += i & (~i + 1)) {
+        line_tree_[i] = static_cast<uint32_t>(static_cast<int>(line_tree_[i]) + delta);
+    }
+}
+
+size_t TextLayout::lines_before(size_t paragraph_index) const {
+    size_t sum = 0;
+    for (size_t i = std::min(paragraph_index, line_counts_.size()); i > 0; i -= i & (~i + 1)) {
+        sum += line_tree_[i];
+    }
+    return sum;
+}
+
+size_t TextLayout::find_paragraph(size_t line_index) const {
+    // Largest prefix whose line total is <= line_index
+    size_t position = 0;
+    size_t step = 1;
+    while (step * 2 < line_tree_.size()) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        size_t next = position + step;
+        if (next < line_tree_.size() && line_tree_[next] <= line_index) {
+            position = next;
+            line_index -= line_tree_[next];
+        }
+    }
+    return std::min(position, paragraphs_.empty() ? 0 : paragraphs_.size() - 1);
+}
+
+} // namespace voxel_canvas
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Texture Residency implementation
+ */
+
+#include "canvas_ui/texture_residency.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace voxel_canvas {
+
+const char* get_texture_owner_name(TextureOwner owner) {
+    switch (owner) {
+        case TextureOwner::Renderer: return "renderer";
+        case TextureOwner::GlyphAtlas: return "glyph atlas";
+        case TextureOwner::IconAtlas: return "icon atlas";
+        case TextureOwner::ShadowCache: return "shadow cache";
+        case TextureOwner::RenderTarget: return "render targets";
+        case TextureOwner::Image: return "images";
+        case TextureOwner::Count: break;
+    }
+    return "unknown";
+}
+
+TextureResidency& TextureResidency::get_instance() {
+    static TextureResidency instance;
+    return instance;
+}
+
+size_t TextureResidency::get_texture_bytes(int width, int height, int bytes_per_texel, bool mipmapped) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    size_t texel = bytes_per_texel == 3 ? 4 : static_cast<size_t>(std::max(bytes_per_texel, 1));
+    size_t bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * texel;
+    // A full mip chain adds a third
+    return mipmapped ? bytes + bytes / 3 : bytes;
+}
+
+void TextureResidency::track(unsigned int texture, size_t bytes, TextureOwner owner, EvictCallback evict) {
+    if (!texture) {
+        return;
+    }
+    release(texture);  // Re-specified storage replaces the old size
+
+    textures_.emplace(texture, Entry{bytes, owner, frame_, std::move(evict)});
+    OwnerUsage& usage = owners_[static_cast<size_t>(owner)];
+    usage.bytes += bytes;
+    usage.count++;
+    total_bytes_ += bytes;
+    peak_bytes_ = std::max(peak_bytes_, total_bytes_);
+}
+
+void TextureResidency::release(unsigned int texture) {
+    auto it = textures_.find(texture);
+    if (it == textures_.end()) {
+        return;
+    }
+    OwnerUsage& usage = owners_[static_cast<size_t>(it->second.owner)];
+    usage.bytes -= it->second.bytes;
+    usage.count--;
+    total_bytes_ -= it->second.bytes;
+    textures_.erase(it);
+}
+
+void TextureResidency::touch(unsigned int texture) {
+    auto it = textures_.find(texture);
+    if (it != textures_.end()) {
+        it->second.last_used_frame = frame_;
+    }
+}
+
+void TextureResidency::pin(unsigned int texture) {
+    auto it = textures_.find(texture);
+    if (it != textures_.end()) {
+        it->second.evict = nullptr;
+    }
+}
+
+void TextureResidency::begin_frame() {
+    if (total_bytes_ > budget_bytes_) {
+        evict_to_budget();
+    }
+    frame_++;
+}
+
+void TextureResidency::evict_to_budget() {
+    // Callbacks release() their texture, so pick the victims before calling any
+    struct Candidate {
+        unsigned int texture;
+        uint64_t last_used_frame;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& [texture, entry] : textures_) {
+        if (entry.evict && entry.last_used_frame < frame_) {
+            candidates.push_back(Candidate{texture, entry.last_used_frame});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.last_used_frame < b.last_used_frame;
+    });
+
+    for (const Candidate& candidate : candidates) {
+        if (total_bytes_ <= budget_bytes_) {
+            break;
+        }
+        auto it = textures_.find(candidate.texture);
+        if (it == textures_.end() || !it->second.evict) {
+            continue;  // Already dropped by an earlier callback
+        }
+        EvictCallback evict = std::move(it->second.evict);
+        evict();
+        release(candidate.texture);  // In case the owner did not
+        eviction_count_++;
+    }
+}
+
+void TextureResidency::print_usage() const {
+    std::cout << "GPU textures: " << textures_.size() << " using " << total_bytes_ / 1024 << " KB of "
+              << budget_bytes_ / 1024 << " KB (peak " << peak_bytes_ / 1024 << " KB)" << std::endl;
+    for (size_t i = 0; i < owners_.size(); ++i) {
+        if (owners_[i].count) {
+            std::cout << "  " << get_texture_owner_name(static_cast<TextureOwner>(i)) << ": "
+                      << owners_[i].count << " textures, " << owners_[i].bytes / 1024 << " KB" << std::endl;
+        }
+    }
+}
+
+} // namespace voxel_canvas
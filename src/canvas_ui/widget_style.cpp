@@ -71,25 +71,55 @@ float SizeValue::resolve(float parent_size, float content_size, const ScaledThem
 
 // ColorValue implementation
 
+namespace {
+
+using ThemeColorGetter = ColorRGBA (*)(const ScaledTheme&);
+
+// Map theme reference to actual color; unknown names fall back to gray_3
+ThemeColorGetter find_theme_color(const std::string& name) {
+    if (name == "gray_1") return [](const ScaledTheme& theme) { return theme.gray_1(); };
+    else if (name == "gray_2") return [](const ScaledTheme& theme) { return theme.gray_2(); };
+    else if (name == "gray_4") return [](const ScaledTheme& theme) { return theme.gray_4(); };
+    else if (name == "gray_5") return [](const ScaledTheme& theme) { return theme.gray_5(); };
+    else if (name == "accent_primary") return [](const ScaledTheme& theme) { return theme.accent_primary(); };
+    else if (name == "accent_secondary") return [](const ScaledTheme& theme) { return theme.accent_secondary(); };
+    else if (name == "accent_warning") return [](const ScaledTheme& theme) { return theme.accent_warning(); };
+    else if (name == "accent_hover") return [](const ScaledTheme& theme) { return theme.accent_hover(); };
+    else if (name == "accent_pressed") return [](const ScaledTheme& theme) { return theme.accent_pressed(); };
+    else if (name == "transparent") return [](const ScaledTheme&) { return ColorRGBA(0, 0, 0, 0); };
+    else if (name == "white") return [](const ScaledTheme&) { return ColorRGBA(1, 1, 1, 1); };
+    else if (name == "black") return [](const ScaledTheme&) { return ColorRGBA(0, 0, 0, 1); };
+    return [](const ScaledTheme& theme) { return theme.gray_3(); };
+}
+
+// Getter per ThemeTokenId index, matched by name the first time a token resolves
+ThemeColorGetter get_theme_color(ThemeTokenId token) {
+    static std::vector<ThemeColorGetter> getters;
+    if (!token.is_valid()) {
+        token = ColorValue::default_theme_token();
+    }
+    uint32_t index = token.get_index();
+    if (index >= getters.size()) {
+        getters.resize(ThemeTokenId::get_count(), nullptr);
+    }
+    if (!getters[index]) {
+        getters[index] = find_theme_color(token.get_name());
+    }
+    return getters[index];
+}
+
+} // anonymous namespace
+
+ThemeTokenId ColorValue::default_theme_token() {
+    static const ThemeTokenId token = ThemeTokenId::intern("gray_3");
+    return token;
+}
+
 ColorRGBA ColorValue::resolve(const ScaledTheme& theme) const {
     if (type == Direct) {
         return color;
     } else if (type == ThemeColor) {
-        // Map theme reference to actual color
-        if (theme_ref == "gray_1") return theme.gray_1();
-        else if (theme_ref == "gray_2") return theme.gray_2();
-        else if (theme_ref == "gray_3") return theme.gray_3();
-        else if (theme_ref == "gray_4") return theme.gray_4();
-        else if (theme_ref == "gray_5") return theme.gray_5();
-        else if (theme_ref == "accent_primary") return theme.accent_primary();
-        else if (theme_ref == "accent_secondary") return theme.accent_secondary();
-        else if (theme_ref == "accent_warning") return theme.accent_warning();
-        else if (theme_ref == "accent_hover") return theme.accent_hover();
-        else if (theme_ref == "accent_pressed") return theme.accent_pressed();
-        else if (theme_ref == "transparent") return ColorRGBA(0, 0, 0, 0);
-        else if (theme_ref == "white") return ColorRGBA(1, 1, 1, 1);
-        else if (theme_ref == "black") return ColorRGBA(0, 0, 0, 1);
-        else return theme.gray_3();  // Default fallback
+        return get_theme_color(theme_token)(theme);
     }
     return ColorRGBA(0, 0, 0, 0);  // Transparent for inherit
 }
@@ -436,6 +466,7 @@ WidgetStyle::ComputedStyle WidgetStyle::compute(const ScaledTheme& theme,
     computed.line_height = line_height;
     computed.font_weight = font_weight;
     computed.font_family = font_family;
+    computed.font_id = FontId::intern(font_family.empty() ? "default" : font_family);
     computed.opacity = opacity;
     computed.overflow_x = overflow_x;
     computed.overflow_y = overflow_y;
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Build-time icon packer: rasterizes the SVG icon sets at the theme sizes
+ * and writes them, with their sources, into one icon pack file.
+ *
+ * Usage: voxelux_pack_icons <output> <set>=<directory> [<set>=<directory> ...]
+ */
+
+#include "canvas_ui/icon_pack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// NanoSVG - zlib License (no attribution required)
+// Disable warnings for third-party headers
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wdouble-promotion"
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wimplicit-float-conversion"
+#pragma GCC diagnostic ignored "-Wfloat-conversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#define NANOSVG_IMPLEMENTATION
+#include "../../lib/third_party/nanosvg.h"
+#define NANOSVGRAST_IMPLEMENTATION
+#include "../../lib/third_party/nanosvgrast.h"
+#pragma GCC diagnostic pop
+
+namespace {
+
+using namespace voxel_canvas;
+
+struct PackedIcon {
+    std::string name;
+    std::string svg;
+    std::vector<std::pair<int, std::vector<uint8_t>>> images;
+};
+
+bool read_svg(const std::filesystem::path& path, std::string& svg) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open SVG file: " << path.string() << std::endl;
+        return false;
+    }
+    svg.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    // Same substitution as IconAsset::load_from_svg: tinted at draw time
+    size_t pos = 0;
+    while ((pos = svg.find("currentColor", pos)) != std::string::npos) {
+        svg.replace(pos, 12, "#FFFFFF");
+        pos += 7;
+    }
+    return true;
+}
+
+// Mirrors IconAsset::rasterize_svg so packed and runtime pixels match
+bool rasterize(NSVGrasterizer* rasterizer, const std::string& svg, int size, std::vector<uint8_t>& pixels) {
+    std::vector<char> source(svg.begin(), svg.end());
+    source.push_back('\0');  // nsvgParse edits its input in place
+    NSVGimage* image = nsvgParse(source.data(), "px", 96.0f);
+    if (!image) {
+        return false;
+    }
+
+    float scale = static_cast<float>(size) / std::max(image->width, image->height);
+    pixels.assign(static_cast<size_t>(size) * static_cast<size_t>(size) * 4, 0);
+    nsvgRasterize(rasterizer, image, 0, 0, scale, pixels.data(), size, size, size * 4);
+    nsvgDelete(image);
+
+    // Empty results are left to the runtime, which draws its debug pattern
+    return std::any_of(pixels.begin(), pixels.end(), [](uint8_t value) { return value != 0; });
+}
+
+std::vector<int> pack_sizes() {
+    std::set<int> sizes;
+    for (int base : icon_pack::BASE_SIZES) {
+        for (float scale : icon_pack::SCALES) {
+            sizes.insert(static_cast<int>(static_cast<float>(base) * scale));
+        }
+    }
+    return std::vector<int>(sizes.begin(), sizes.end());
+}
+
+void append(std::vector<uint8_t>& out, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+uint32_t offset_of(const std::vector<uint8_t>& out) {
+    return static_cast<uint32_t>(out.size());
+}
+
+// Records are written in host order; every supported target is little-endian
+bool write_pack(const std::string& output, const std::vector<PackedIcon>& icons) {
+    uint32_t image_count = 0;
+    for (const PackedIcon& icon : icons) {
+        image_count += static_cast<uint32_t>(icon.images.size());
+    }
+
+    icon_pack::Header header{icon_pack::MAGIC, icon_pack::VERSION, static_cast<uint32_t>(icons.size()), image_count};
+    std::vector<icon_pack::IconRecord> icon_records(icons.size());
+    std::vector<icon_pack::ImageRecord> image_records;
+    image_records.reserve(image_count);
+
+    size_t tables = sizeof(header) + icon_records.size() * sizeof(icon_pack::IconRecord) +
+                    image_count * sizeof(icon_pack::ImageRecord);
+    std::vector<uint8_t> blob(tables, 0);
+
+    for (size_t i = 0; i < icons.size(); ++i) {
+        const PackedIcon& icon = icons[i];
+        icon_pack::IconRecord& record = icon_records[i];
+        record.name_offset = offset_of(blob);
+        record.name_length = static_cast<uint32_t>(icon.name.size());
+        append(blob, icon.name.data(), icon.name.size());
+        record.svg_offset = offset_of(blob);
+        record.svg_length = static_cast<uint32_t>(icon.svg.size());
+        append(blob, icon.svg.data(), icon.svg.size());
+        record.first_image = static_cast<uint32_t>(image_records.size());
+        record.image_count = static_cast<uint32_t>(icon.images.size());
+
+        for (const auto& [size, pixels] : icon.images) {
+            blob.resize((blob.size() + 3) & ~size_t{3}, 0);
+            image_records.push_back(icon_pack::ImageRecord{static_cast<uint32_t>(size), offset_of(blob)});
+            append(blob, pixels.data(), pixels.size());
+        }
+    }
+
+    if (blob.size() > UINT32_MAX) {
+        std::cerr << "Icon pack exceeds 4 GB" << std::endl;
+        return false;
+    }
+
+    uint8_t* cursor = blob.data();
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    std::memcpy(cursor, icon_records.data(), icon_records.size() * sizeof(icon_pack::IconRecord));
+    cursor += icon_records.size() * sizeof(icon_pack::IconRecord);
+    std::memcpy(cursor, image_records.data(), image_records.size() * sizeof(icon_pack::ImageRecord));
+
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create icon pack: " << output << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    return static_cast<bool>(file);
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+
+    if (argc < 3) {
+        std::cerr << "Usage: voxelux_pack_icons <output> <set>=<directory> ..." << std::endl;
+        return 1;
+    }
+
+    NSVGrasterizer* rasterizer = nsvgCreateRasterizer();
+    if (!rasterizer) {
+        std::cerr << "Failed to create SVG rasterizer" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> sizes = pack_sizes();
+    std::vector<PackedIcon> icons;
+    bool ok = true;
+
+    for (int arg = 2; arg < argc; ++arg) {
+        std::string spec = argv[arg];
+        size_t split = spec.find('=');
+        if (split == std::string::npos) {
+            std::cerr << "Expected <set>=<directory>, got: " << spec << std::endl;
+            ok = false;
+            break;
+        }
+        std::string set_name = spec.substr(0, split);
+        fs::path directory = spec.substr(split + 1);
+        if (!fs::exists(directory)) {
+            continue;  // Same as IconSystem::load_icon_set: optional sets
+        }
+
+        // Sorted so the pack is byte-identical between builds
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".svg") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        for (const fs::path& path : files) {
+            PackedIcon icon;
+            icon.name = set_name + "_" + path.stem().string();
+            if (!read_svg(path, icon.svg)) {
+                ok = false;
+                continue;
+            }
+            for (int size : sizes) {
+                std::vector<uint8_t> pixels;
+                if (rasterize(rasterizer, icon.svg, size, pixels)) {
+                    icon.images.emplace_back(size, std::move(pixels));
+                }
+            }
+            icons.push_back(std::move(icon));
+        }
+    }
+
+    nsvgDeleteRasterizer(rasterizer);
+
+    if (!ok || !write_pack(argv[1], icons)) {
+        return 1;
+    }
+    std::cout << "Packed " << icons.size() << " icons at " << sizes.size() << " sizes into " << argv[1] << std::endl;
+    return 0;
+}
@@ -16,6 +16,7 @@
 #include "canvas_ui/event_router.h"
 #include "canvas_ui/canvas_region.h"
 #include "canvas_ui/voxelux_layout.h"
+#include "canvas_ui/scale_transition.h"
 
 #include <iostream>
 #include <memory>
@@ -59,19 +60,24 @@ public:
         
         // Setup resize callback for smooth window resizing
         window_->set_resize_callback([this](int width, int height) {
-            // Update layout dimensions immediately
-            layout_->on_window_resize(width, height);
-            
             // During resize drag, the OS blocks the main loop on macOS/Windows
             // We must render immediately here for smooth resizing
             auto* renderer{window_->get_renderer()};
-            if (renderer) {
+            if (!renderer) {
+                layout_->on_window_resize(width, height);
+            } else {
                 // Critical: Update OpenGL viewport immediately for correct rendering
                 glViewport(0, 0, width, height);
                 
                 // Update renderer's viewport tracking
                 renderer->set_viewport(0, 0, width, height);
                 
+                // Update layout dimensions; smaller while a scale change
+                // draws the old-scale layout stretched
+                float stretch{renderer->get_presentation_scale()};
+                layout_->on_window_resize(static_cast<int>(static_cast<float>(width) / stretch),
+                                          static_cast<int>(static_cast<float>(height) / stretch));
+                
                 // Refresh layout with new dimensions
                 layout_->refresh_layout(renderer);
                 
@@ -107,6 +113,9 @@ public:
         Point2D last_size{window_->get_framebuffer_size()};
         float last_scale{window_->get_content_scale()};
         
+        // DPI changes switch the layout only once caches are warm for the new scale
+        ScaleTransition scale_transition{last_scale};
+        
         // Main render loop with continuous updates
         while (!window_->should_close()) {
             auto frame_start{std::chrono::high_resolution_clock::now()};
@@ -121,20 +130,6 @@ public:
             bool size_changed{current_size.x != last_size.x || current_size.y != last_size.y};
             bool scale_changed{current_scale != last_scale};
             
-            // Handle size changes immediately for smooth resizing
-            if (size_changed) {
-                layout_->on_window_resize(static_cast<int>(current_size.x), 
-                                        static_cast<int>(current_size.y));
-                last_size = current_size;
-            }
-            
-            // Handle DPI scale changes
-            if (scale_changed) {
-                layout_->set_content_scale(current_scale);
-                last_scale = current_scale;
-                std::cout << "Content scale changed to: " << current_scale << "x" << std::endl;
-            }
-            
             // Update viewport if window system requires it
             if (window_->needs_viewport_update()) {
                 window_->update_viewport_from_render_thread();
@@ -145,9 +140,27 @@ public:
             if (!renderer) {
                 continue;
             }
+            last_size = current_size;
+            last_scale = current_scale;
+            
+            // Handle DPI scale changes: keep drawing the old-scale layout,
+            // stretched, while the new scale's text and icons are prepared
+            if (scale_changed) {
+                scale_transition.begin(renderer, current_scale);
+                std::cout << "Content scale changing to: " << current_scale << "x" << std::endl;
+            }
+            bool scale_switched{scale_transition.update(renderer)};
+            if (scale_switched) {
+                layout_->set_content_scale(scale_transition.get_scale());
+                std::cout << "Content scale changed to: " << scale_transition.get_scale() << "x" << std::endl;
+            }
             
-            // Refresh layout when size or scale changed
-            if (size_changed || scale_changed) {
+            // Refresh layout when size or scale changed, in the units the
+            // renderer currently presents
+            if (size_changed || scale_changed || scale_switched) {
+                float stretch{renderer->get_presentation_scale()};
+                layout_->on_window_resize(static_cast<int>(current_size.x / stretch),
+                                          static_cast<int>(current_size.y / stretch));
                 layout_->refresh_layout(renderer);
             }
             
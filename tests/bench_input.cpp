@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Typing benchmark - keystroke latency of the Input widget on a 1 MB buffer
+ */
+
+#include "canvas_ui/styled_widgets_form.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace voxel_canvas;
+
+namespace {
+
+constexpr size_t DOCUMENT_BYTES = 1 << 20;
+constexpr int KEYSTROKES = 20000;
+constexpr int COPYING_KEYSTROKES = 2000;  // The copying listener is O(n) per key
+
+struct Timing {
+    double total_us = 0.0;
+    double worst_us = 0.0;
+    int count = 0;
+
+    void add(double us) {
+        total_us += us;
+        worst_us = std::max(worst_us, us);
+        count++;
+    }
+    double mean_us() const { return count > 0 ? total_us / count : 0.0; }
+};
+
+InputEvent make_event(EventType type) {
+    InputEvent event{};
+    event.type = type;
+    return event;
+}
+
+// Lines of 79 characters with some multi-byte text mixed in
+std::string make_document() {
+    const std::string line = "The quick brown fox jumps over the lazy dog, \xC3\xA9t\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC "
+                             "\xF0\x9F\x98\x80 0123456789\n";
+    std::string text;
+    text.reserve(DOCUMENT_BYTES + line.size());
+    while (text.size() < DOCUMENT_BYTES) {
+        text += line;
+    }
+    return text;
+}
+
+// Keystrokes through the same TEXT_INPUT / KEY_PRESS path CanvasWindow feeds
+Timing type_keys(StyledWidget& input, int count, bool backspace) {
+    const uint32_t keys[] = {'h', 'e', 'l', 'l', 'o', ' ', 0xE9, 0x65E5, 0x1F600, '\n'};
+    InputEvent text = make_event(EventType::TEXT_INPUT);
+    InputEvent erase = make_event(EventType::KEY_PRESS);
+    erase.key_code = 259;  // GLFW_KEY_BACKSPACE
+    Timing timing;
+    for (int i = 0; i < count; ++i) {
+        text.codepoint = keys[static_cast<size_t>(i) % (sizeof(keys) / sizeof(keys[0]))];
+        auto start = std::chrono::steady_clock::now();
+        input.handle_event(backspace ? erase : text);
+        timing.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return timing;
+}
+
+void report(const char* label, const Timing& timing) {
+    std::printf("%-34s %8d keys %10.2f us mean %10.2f us worst\n", label, timing.count, timing.mean_us(),
+                timing.worst_us);
+}
+
+} // namespace
+
+int main() {
+    std::string document = make_document();
+    std::printf("Document: %zu bytes\n", document.size());
+
+    Input input;
+    input.set_focused(true);
+    size_t edited_bytes = 0;
+    input.set_on_change([&edited_bytes](const Input::Edit& edit) {
+        edited_bytes += edit.inserted.size() + edit.erased;
+    });
+
+    input.set_value(document);
+    report("typing at the end", type_keys(input, KEYSTROKES, false));
+    report("backspace at the end", type_keys(input, KEYSTROKES, true));
+
+    input.set_value(document);
+    input.set_caret(document.size() / 2);
+    report("typing in the middle", type_keys(input, KEYSTROKES, false));
+    report("backspace in the middle", type_keys(input, KEYSTROKES, true));
+
+    // Whole codepoints only: every byte typed above was erased again
+    bool intact = input.get_value() == document;
+    std::printf("Buffer restored after backspacing: %s (%zu bytes seen by the listener)\n",
+                intact ? "yes" : "NO", edited_bytes);
+
+    // The previous contract: the listener received the whole value per key
+    input.set_value(document);
+    input.set_on_change([&input, &edited_bytes](const Input::Edit&) {
+        edited_bytes += input.get_value().size();
+    });
+    report("typing, listener copies the value", type_keys(input, COPYING_KEYSTROKES, false));
+
+    return intact ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Segment throughput benchmark - instanced AA segments vs the geometry
+ * shader polyline path they replaced
+ */
+
+#include "canvas_ui/canvas_window.h"
+#include "canvas_ui/canvas_renderer.h"
+#include "canvas_ui/shader_cache.h"
+#include "glad/gl.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace voxel_canvas;
+
+namespace {
+
+// The removed PolylineShader: lines expanded into quads in a geometry
+// shader, one vertex upload and one draw per call
+const char* legacy_vertex_shader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+out VS_OUT { vec4 color; } vs_out;
+uniform mat4 u_projection;
+void main() {
+    gl_Position = u_projection * vec4(position.xy, 0.0, 1.0);
+    vs_out.color = color;
+}
+)";
+
+const char* legacy_geometry_shader = R"(
+#version 330 core
+layout(lines) in;
+layout(triangle_strip, max_vertices = 4) out;
+in VS_OUT { vec4 color; } gs_in[];
+out vec4 frag_color;
+out float v_line_coord;
+uniform vec2 u_viewport_size;
+uniform float u_line_width;
+void main() {
+    vec4 p0 = gl_in[0].gl_Position;
+    vec4 p1 = gl_in[1].gl_Position;
+    vec2 screen0 = (p0.xy / p0.w) * u_viewport_size * 0.5;
+    vec2 screen1 = (p1.xy / p1.w) * u_viewport_size * 0.5;
+    vec2 line_dir = normalize(screen1 - screen0);
+    vec2 offset = vec2(-line_dir.y, line_dir.x) * u_line_width / u_viewport_size;
+    gl_Position = p0; gl_Position.xy -= offset * p0.w; frag_color = gs_in[0].color; v_line_coord = -1.0; EmitVertex();
+    gl_Position = p0; gl_Position.xy += offset * p0.w; frag_color = gs_in[0].color; v_line_coord = 1.0; EmitVertex();
+    gl_Position = p1; gl_Position.xy -= offset * p1.w; frag_color = gs_in[1].color; v_line_coord = -1.0; EmitVertex();
+    gl_Position = p1; gl_Position.xy += offset * p1.w; frag_color = gs_in[1].color; v_line_coord = 1.0; EmitVertex();
+    EndPrimitive();
+}
+)";
+
+const char* legacy_fragment_shader = R"(
+#version 330 core
+in vec4 frag_color;
+in float v_line_coord;
+out vec4 out_color;
+void main() {
+    out_color = frag_color;
+    out_color.a *= 1.0 - smoothstep(0.5, 1.0, abs(v_line_coord));
+}
+)";
+
+struct LineVertex {
+    float x, y, z;
+    float r, g, b, a;
+};
+
+constexpr int POINTS_PER_CURVE = 100;
+constexpr int FRAMES = 60;
+
+// Sine curves across the window; segments = curves * (POINTS_PER_CURVE - 1)
+std::vector<std::vector<Point2D>> make_curves(int curve_count, float width, float height) {
+    std::vector<std::vector<Point2D>> curves(static_cast<size_t>(curve_count));
+    for (int c = 0; c < curve_count; ++c) {
+        float base = height * static_cast<float>(c + 1) / static_cast<float>(curve_count + 1);
+        for (int i = 0; i < POINTS_PER_CURVE; ++i) {
+            float x = width * static_cast<float>(i) / (POINTS_PER_CURVE - 1);
+            curves[static_cast<size_t>(c)].emplace_back(x, base + 20.0f * std::sin(x * 0.02f + static_cast<float>(c)));
+        }
+    }
+    return curves;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    CanvasWindow window(1280, 800, "Segment benchmark");
+    if (!window.initialize()) {
+        std::fprintf(stderr, "Failed to create a GL context\n");
+        return 1;
+    }
+    CanvasRenderer* renderer = window.get_renderer();
+    Point2D size = window.get_framebuffer_size();
+    float projection[16];
+    renderer->get_projection_matrix(projection);
+
+    GLuint legacy_program = ShaderCache::get_instance().load_program(
+        "bench_legacy_polyline", legacy_vertex_shader, legacy_fragment_shader, legacy_geometry_shader);
+    GLuint legacy_vao = 0;
+    GLuint legacy_vbo = 0;
+    glGenVertexArrays(1, &legacy_vao);
+    glGenBuffers(1, &legacy_vbo);
+    glBindVertexArray(legacy_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, legacy_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), reinterpret_cast<void*>(0));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(LineVertex), reinterpret_cast<void*>(3 * sizeof(float)));
+    glBindVertexArray(0);
+
+    const ColorRGBA color(0.9f, 0.6f, 0.2f, 0.8f);
+    std::printf("%10s %14s %14s %8s\n", "segments", "legacy ms", "instanced ms", "speedup");
+
+    for (int curve_count : {10, 100, 500}) {
+        auto curves = make_curves(curve_count, size.x, size.y);
+
+        // Legacy: one polyline per curve, uploaded and drawn on its own
+        double legacy_ms = 0.0;
+        if (legacy_program) {
+            std::vector<LineVertex> vertices;
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < FRAMES; ++frame) {
+                glUseProgram(legacy_program);
+                glUniformMatrix4fv(glGetUniformLocation(legacy_program, "u_projection"), 1, GL_FALSE, projection);
+                glUniform2f(glGetUniformLocation(legacy_program, "u_viewport_size"), size.x, size.y);
+                glUniform1f(glGetUniformLocation(legacy_program, "u_line_width"), 2.0f);
+                glBindVertexArray(legacy_vao);
+                glBindBuffer(GL_ARRAY_BUFFER, legacy_vbo);
+                for (const auto& curve : curves) {
+                    vertices.clear();
+                    for (size_t i = 1; i < curve.size(); ++i) {
+                        vertices.push_back({curve[i - 1].x, curve[i - 1].y, 0.0f, color.r, color.g, color.b, color.a});
+                        vertices.push_back({curve[i].x, curve[i].y, 0.0f, color.r, color.g, color.b, color.a});
+                    }
+                    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(LineVertex)),
+                                 vertices.data(), GL_DYNAMIC_DRAW);
+                    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+                }
+                glBindVertexArray(0);
+                glFinish();
+            }
+            legacy_ms = elapsed_ms(start) / FRAMES;
+        }
+
+        // Instanced: every curve queued, one draw when the frame ends
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            renderer->begin_frame();
+            for (const auto& curve : curves) {
+                renderer->draw_polyline(curve, color, 2.0f);
+            }
+            renderer->end_frame();
+            glFinish();
+        }
+        double instanced_ms = elapsed_ms(start) / FRAMES;
+
+        int segments = curve_count * (POINTS_PER_CURVE - 1);
+        std::printf("%10d %14.3f %14.3f %7.1fx\n", segments, legacy_ms, instanced_ms,
+                    instanced_ms > 0.0 ? legacy_ms / instanced_ms : 0.0);
+    }
+
+    glDeleteBuffers(1, &legacy_vbo);
+    glDeleteVertexArrays(1, &legacy_vao);
+    if (legacy_program) {
+        glDeleteProgram(legacy_program);
+    }
+    window.shutdown();
+    return 0;
+}
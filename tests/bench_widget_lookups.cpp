@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Widget lookup benchmark - per-widget theme colour, font and icon lookups
+ * through interned handles vs by name
+ */
+
+#include "canvas_ui/canvas_window.h"
+#include "canvas_ui/canvas_renderer.h"
+#include "canvas_ui/font_system.h"
+#include "canvas_ui/icon_system.h"
+#include "canvas_ui/scaled_theme.h"
+#include "canvas_ui/widget_style.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace voxel_canvas;
+
+namespace {
+
+constexpr int WIDGETS = 1000;
+constexpr int FRAMES = 200;
+constexpr int WARMUP_FRAMES = 60;  // Icon rasters land in the atlas before timing starts
+
+// The removed ColorValue::resolve: the token name against up to 13 literals
+ColorRGBA resolve_by_name(const std::string& theme_ref, const ScaledTheme& theme) {
+    if (theme_ref == "gray_1") return theme.gray_1();
+    else if (theme_ref == "gray_2") return theme.gray_2();
+    else if (theme_ref == "gray_3") return theme.gray_3();
+    else if (theme_ref == "gray_4") return theme.gray_4();
+    else if (theme_ref == "gray_5") return theme.gray_5();
+    else if (theme_ref == "accent_primary") return theme.accent_primary();
+    else if (theme_ref == "accent_secondary") return theme.accent_secondary();
+    else if (theme_ref == "accent_warning") return theme.accent_warning();
+    else if (theme_ref == "accent_hover") return theme.accent_hover();
+    else if (theme_ref == "accent_pressed") return theme.accent_pressed();
+    else if (theme_ref == "transparent") return ColorRGBA(0, 0, 0, 0);
+    else if (theme_ref == "white") return ColorRGBA(1, 1, 1, 1);
+    else if (theme_ref == "black") return ColorRGBA(0, 0, 0, 1);
+    else return theme.gray_3();
+}
+
+// What one widget looks up per paint, both as names and as handles
+struct WidgetResources {
+    std::string colors[3];
+    std::string font;
+    std::string icon;
+
+    ColorValue color_values[3];
+    FontId font_id;
+    IconId icon_id;
+};
+
+struct Timing {
+    double colors_ms = 0.0;
+    double font_ms = 0.0;
+    double icon_ms = 0.0;
+    double widget_ms = 0.0;
+};
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double ns_per(double total_ms, int calls_per_widget) {
+    return total_ms * 1.0e6 / (static_cast<double>(FRAMES) * WIDGETS * calls_per_widget);
+}
+
+} // namespace
+
+int main() {
+    CanvasWindow window(1280, 800, "Widget lookup benchmark");
+    if (!window.initialize()) {
+        std::fprintf(stderr, "Failed to create a GL context\n");
+        return 1;
+    }
+    CanvasRenderer* renderer = window.get_renderer();
+    IconSystem& icons = IconSystem::get_instance();
+    if (!g_font_system || icons.get_all_icons().empty()) {
+        std::fprintf(stderr, "Fonts or icons failed to load\n");
+        return 1;
+    }
+
+    std::vector<std::string> icon_names;
+    for (const auto& [name, icon] : icons.get_all_icons()) {
+        icon_names.push_back(name);
+    }
+    const char* tokens[] = {"gray_1", "gray_4", "accent_primary", "accent_pressed", "white", "black"};
+    const size_t token_count = sizeof(tokens) / sizeof(tokens[0]);
+
+    // Handles are interned once, as widgets do when they are built
+    std::vector<WidgetResources> widgets(WIDGETS);
+    for (size_t i = 0; i < widgets.size(); ++i) {
+        WidgetResources& widget = widgets[i];
+        for (size_t c = 0; c < 3; ++c) {
+            widget.colors[c] = tokens[(i + c * 2) % token_count];
+            widget.color_values[c] = ColorValue(widget.colors[c]);
+        }
+        widget.font = "Inter";
+        widget.font_id = FontId::intern(widget.font);
+        widget.icon = icon_names[i % icon_names.size()];
+        widget.icon_id = IconId::intern(widget.icon);
+    }
+
+    const float icon_size = 16.0f;
+    auto icon_position = [](size_t i) {
+        return Point2D(static_cast<float>(i % 40) * 20.0f, static_cast<float>(i / 40) * 20.0f);
+    };
+    for (int frame = 0; frame < WARMUP_FRAMES; ++frame) {
+        renderer->begin_frame();
+        for (size_t i = 0; i < widgets.size(); ++i) {
+            icons.render_icon(renderer, widgets[i].icon_id, icon_position(i), icon_size);
+        }
+        renderer->end_frame();
+    }
+
+    // Each pass is timed inside the frame; drawing the queued icons is not
+    float sink = 0.0f;
+    auto resolve_color = [](const WidgetResources& widget, size_t c, const ScaledTheme& theme, bool by_name) {
+        return by_name ? resolve_by_name(widget.colors[c], theme) : widget.color_values[c].resolve(theme);
+    };
+    auto get_font = [](const WidgetResources& widget, bool by_name) {
+        return by_name ? g_font_system->get_font(widget.font) : g_font_system->get_font(widget.font_id);
+    };
+    auto run = [&](bool by_name) {
+        Timing timing;
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            renderer->begin_frame();
+            ScaledTheme theme = renderer->get_scaled_theme();
+
+            auto start = std::chrono::steady_clock::now();
+            for (const WidgetResources& widget : widgets) {
+                for (size_t c = 0; c < 3; ++c) {
+                    sink += resolve_color(widget, c, theme, by_name).r;
+                }
+            }
+            timing.colors_ms += elapsed_ms(start);
+
+            start = std::chrono::steady_clock::now();
+            for (const WidgetResources& widget : widgets) {
+                sink += get_font(widget, by_name) ? 1.0f : 0.0f;
+            }
+            timing.font_ms += elapsed_ms(start);
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < widgets.size(); ++i) {
+                if (by_name) {
+                    icons.render_icon(renderer, widgets[i].icon, icon_position(i), icon_size);
+                } else {
+                    icons.render_icon(renderer, widgets[i].icon_id, icon_position(i), icon_size);
+                }
+            }
+            timing.icon_ms += elapsed_ms(start);
+
+            // A whole widget: three colours, its font and its icon
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < widgets.size(); ++i) {
+                const WidgetResources& widget = widgets[i];
+                for (size_t c = 0; c < 3; ++c) {
+                    sink += resolve_color(widget, c, theme, by_name).r;
+                }
+                sink += get_font(widget, by_name) ? 1.0f : 0.0f;
+                if (by_name) {
+                    icons.render_icon(renderer, widget.icon, icon_position(i), icon_size);
+                } else {
+                    icons.render_icon(renderer, widget.icon_id, icon_position(i), icon_size);
+                }
+            }
+            timing.widget_ms += elapsed_ms(start);
+
+            renderer->end_frame();
+        }
+        return timing;
+    };
+
+    Timing names = run(true);
+    Timing handles = run(false);
+
+    // The name path still hashes the name, but no longer builds the
+    // "name@size" atlas key the previous icon draws did
+    std::printf("%d widgets, %zu icons, %d frames\n", WIDGETS, icon_names.size(), FRAMES);
+    std::printf("%-24s %12s %12s %8s\n", "ns per call", "by name", "by handle", "speedup");
+    auto row = [](const char* label, double by_name, double by_handle) {
+        std::printf("%-24s %12.1f %12.1f %7.1fx\n", label, by_name, by_handle,
+                    by_handle > 0.0 ? by_name / by_handle : 0.0);
+    };
+    row("theme colour resolve", ns_per(names.colors_ms, 3), ns_per(handles.colors_ms, 3));
+    row("get_font", ns_per(names.font_ms, 1), ns_per(handles.font_ms, 1));
+    row("render_icon", ns_per(names.icon_ms, 1), ns_per(handles.icon_ms, 1));
+    row("per widget", ns_per(names.widget_ms, 1), ns_per(handles.widget_ms, 1));
+    std::printf("(checksum %.1f)\n", static_cast<double>(sink));
+
+    window.shutdown();
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Path fill test - triangulated area of shapes with several holes
+ */
+
+#include "canvas_ui/path_tessellator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace voxel_canvas;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+PathContour rect(float x, float y, float width, float height, bool clockwise = false) {
+    PathContour contour;
+    contour.closed = true;
+    contour.points = {Point2D(x, y), Point2D(x + width, y), Point2D(x + width, y + height), Point2D(x, y + height)};
+    if (clockwise) {
+        std::swap(contour.points[1], contour.points[3]);
+    }
+    return contour;
+}
+
+bool even_odd_inside(const Point2D& p, const std::vector<PathContour>& contours) {
+    bool inside = false;
+    for (const auto& contour : contours) {
+        const auto& points = contour.points;
+        for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+            if ((points[i].y > p.y) != (points[j].y > p.y) &&
+                p.x < (points[j].x - points[i].x) * (p.y - points[i].y) / (points[j].y - points[i].y) + points[i].x) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+// Overlapping or inverted triangles show up as excess covered area, and
+// triangles over a hole or outside the shape as a centroid outside the fill
+void check_fill(const char* name, const std::vector<PathContour>& contours, float expected_area) {
+    PathMesh mesh;
+    PathTessellator::fill(contours, mesh);
+
+    double area = 0.0;
+    bool centroids_inside = true;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const Point2D& a = mesh.vertices[mesh.indices[i]];
+        const Point2D& b = mesh.vertices[mesh.indices[i + 1]];
+        const Point2D& c = mesh.vertices[mesh.indices[i + 2]];
+        double doubled = static_cast<double>((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+        area += std::fabs(doubled) * 0.5;
+        if (std::fabs(doubled) > 1e-3 && !even_odd_inside((a + b + c) / 3.0f, contours)) {
+            centroids_inside = false;
+        }
+    }
+
+    bool area_ok = std::fabs(area - static_cast<double>(expected_area)) < 0.01;
+    if (!area_ok || !centroids_inside) {
+        std::fprintf(stderr, "FAIL: %s: area %.2f, expected %.2f%s\n", name, area,
+                     static_cast<double>(expected_area), centroids_inside ? "" : ", triangles outside the fill");
+        ++failures;
+    }
+}
+
+void test_holes() {
+    check_fill("one hole", {rect(0, 0, 100, 100), rect(10, 10, 20, 20)}, 9600.0f);
+    check_fill("two holes side by side", {rect(0, 0, 100, 100), rect(10, 10, 20, 20), rect(60, 10, 20, 20)}, 9200.0f);
+    check_fill("two holes stacked", {rect(0, 0, 100, 100), rect(10, 10, 20, 20), rect(15, 60, 20, 20)}, 9200.0f);
+    check_fill("holes given in either winding",
+               {rect(0, 0, 100, 100, true), rect(10, 10, 20, 20), rect(60, 10, 20, 20, true)}, 9200.0f);
+
+    // Rows and columns of holes share edge coordinates with each other
+    std::vector<PathContour> grid = {rect(0, 0, 100, 100)};
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            grid.push_back(rect(10.0f + 30.0f * static_cast<float>(column), 10.0f + 30.0f * static_cast<float>(row),
+                                20.0f, 20.0f));
+        }
+    }
+    check_fill("3x3 grid of holes", grid, 10000.0f - 9.0f * 400.0f);
+
+    // Staggered holes whose seams would cross if bridged in the wrong order
+    check_fill("staggered holes",
+               {rect(0, 0, 120, 100), rect(10, 40, 15, 15), rect(35, 10, 15, 60), rect(60, 45, 15, 40),
+                rect(85, 5, 20, 20), rect(90, 60, 20, 30)},
+               12000.0f - 225.0f - 900.0f - 600.0f - 400.0f - 600.0f);
+}
+
+void test_concave_and_nested() {
+    // U shape: the seam from the right arm's hole must not cut across the gap
+    PathContour u_shape;
+    u_shape.closed = true;
+    u_shape.points = {Point2D(0, 0), Point2D(100, 0), Point2D(100, 100), Point2D(70, 100),
+                      Point2D(70, 30), Point2D(30, 30), Point2D(30, 100), Point2D(0, 100)};
+    check_fill("holes in both arms of a U",
+               {u_shape, rect(10, 50, 10, 30), rect(80, 50, 10, 30), rect(40, 10, 20, 10)},
+               10000.0f - 40.0f * 70.0f - 300.0f - 300.0f - 200.0f);
+
+    // Islands inside holes are filled again, with holes of their own
+    check_fill("island inside a hole",
+               {rect(0, 0, 100, 100), rect(10, 10, 80, 80), rect(20, 20, 60, 60), rect(30, 30, 10, 10),
+                rect(60, 30, 10, 10), rect(45, 60, 10, 10)},
+               10000.0f - 6400.0f + 3600.0f - 300.0f);
+}
+
+void test_flattened_path() {
+    // The same two-hole icon through the command path the renderer records
+    std::vector<PathCommand> commands;
+    auto add_rect = [&commands](float x, float y, float width, float height) {
+        commands.push_back({PathCommand::MoveTo, x, y});
+        commands.push_back({PathCommand::LineTo, x + width, y});
+        commands.push_back({PathCommand::LineTo, x + width, y + height});
+        commands.push_back({PathCommand::LineTo, x, y + height});
+        commands.push_back({PathCommand::Close});
+    };
+    add_rect(0, 0, 100, 100);
+    add_rect(10, 10, 20, 20);
+    add_rect(60, 10, 20, 20);
+
+    std::vector<PathContour> contours;
+    PathTessellator::flatten(commands, 0.25f, contours);
+    expect(contours.size() == 3, "three closed contours");
+    check_fill("flattened two-hole path", contours, 9200.0f);
+}
+
+} // namespace
+
+int main() {
+    test_holes();
+    test_concave_and_nested();
+    test_flattened_path();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d path fill check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("Path fill: all checks passed\n");
+    return 0;
+}
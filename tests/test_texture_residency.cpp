@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Texture residency test - usage accounting, budget eviction and leak check
+ * (no GL context; texture names are only keys here)
+ */
+
+#include "canvas_ui/texture_residency.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace voxel_canvas;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+constexpr size_t MB = size_t{1024} * 1024;
+
+void test_texture_bytes() {
+    expect(TextureResidency::get_texture_bytes(256, 256) == 256 * 256 * 4, "RGBA8 size");
+    expect(TextureResidency::get_texture_bytes(256, 256, 3) == 256 * 256 * 4, "RGB8 is padded to four bytes");
+    expect(TextureResidency::get_texture_bytes(512, 512, 1) == 512 * 512, "R8 size");
+    expect(TextureResidency::get_texture_bytes(300, 300, 4, true) == 300 * 300 * 4 + 300 * 300 * 4 / 3,
+           "mip chain adds a third");
+    expect(TextureResidency::get_texture_bytes(0, 64) == 0, "empty texture has no size");
+}
+
+// Panels open and close; whatever they allocated must be handed back
+void test_panels_return_to_baseline() {
+    TextureResidency& residency = TextureResidency::get_instance();
+    const size_t baseline = residency.get_usage();
+    const size_t baseline_count = residency.get_texture_count();
+
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        std::vector<unsigned int> panel;
+        unsigned int name = 1000;
+        for (TextureOwner owner : {TextureOwner::GlyphAtlas, TextureOwner::IconAtlas, TextureOwner::ShadowCache,
+                                   TextureOwner::RenderTarget, TextureOwner::Image}) {
+            for (int i = 0; i < 4; ++i) {
+                residency.track(name, TextureResidency::get_texture_bytes(128, 64), owner, [] {});
+                panel.push_back(name++);
+            }
+        }
+        expect(residency.get_usage() == baseline + 20 * 128 * 64 * 4, "open panels are counted");
+        expect(residency.get_texture_count() == baseline_count + 20, "open panel textures are counted");
+
+        for (unsigned int texture : panel) {
+            residency.release(texture);
+        }
+        residency.release(1000);  // Twice, and unknown names, are ignored
+        residency.release(424242);
+        residency.begin_frame();
+
+        expect(residency.get_usage() == baseline, "usage returns to baseline after the panels close");
+        expect(residency.get_texture_count() == baseline_count, "texture count returns to baseline");
+        for (size_t owner = 0; owner < static_cast<size_t>(TextureOwner::Count); ++owner) {
+            expect(residency.get_usage(static_cast<TextureOwner>(owner)) == 0 &&
+                   residency.get_texture_count(static_cast<TextureOwner>(owner)) == 0,
+                   "per-owner counters return to zero");
+        }
+    }
+}
+
+void test_owner_accounting() {
+    TextureResidency& residency = TextureResidency::get_instance();
+    residency.track(2000, 3 * MB, TextureOwner::GlyphAtlas);
+    residency.track(2001, 1 * MB, TextureOwner::GlyphAtlas);
+    residency.track(2002, 2 * MB, TextureOwner::Image);
+
+    expect(residency.get_usage(TextureOwner::GlyphAtlas) == 4 * MB, "glyph atlas bytes");
+    expect(residency.get_texture_count(TextureOwner::GlyphAtlas) == 2, "glyph atlas count");
+    expect(residency.get_usage(TextureOwner::Image) == 2 * MB && residency.get_texture_count(TextureOwner::Image) == 1,
+           "image bytes and count");
+    expect(residency.get_usage(TextureOwner::IconAtlas) == 0, "other owners untouched");
+    expect(residency.get_usage() == 6 * MB, "total is the sum of the owners");
+
+    // Re-specified storage replaces the old size, even under another owner
+    residency.track(2001, 5 * MB, TextureOwner::RenderTarget);
+    expect(residency.get_usage(TextureOwner::GlyphAtlas) == 3 * MB &&
+           residency.get_texture_count(TextureOwner::GlyphAtlas) == 1, "retracked texture leaves its old owner");
+    expect(residency.get_usage(TextureOwner::RenderTarget) == 5 * MB, "retracked texture counts for its new owner");
+    expect(residency.get_usage() == 10 * MB && residency.get_texture_count() == 3, "retracking does not double count");
+    expect(residency.get_peak_usage() >= 10 * MB, "peak usage follows the total");
+
+    for (unsigned int texture : {2000u, 2001u, 2002u}) {
+        residency.release(texture);
+    }
+    expect(residency.get_usage() == 0 && residency.get_texture_count() == 0, "owner accounting released");
+}
+
+void test_lru_eviction() {
+    TextureResidency& residency = TextureResidency::get_instance();
+    residency.set_budget(TextureResidency::DEFAULT_BUDGET_BYTES);
+    const uint64_t evictions_before = residency.get_eviction_count();
+
+    std::vector<unsigned int> evicted;
+    auto evict_releasing = [&residency, &evicted](unsigned int texture) {
+        return [&residency, &evicted, texture] {
+            evicted.push_back(texture);
+            residency.release(texture);  // What atlas and shadow owners do
+        };
+    };
+    residency.track(3000, MB, TextureOwner::IconAtlas, evict_releasing(3000));
+    residency.track(3001, MB, TextureOwner::IconAtlas, evict_releasing(3001));
+    // This owner leaves release() to the residency
+    residency.track(3002, MB, TextureOwner::ShadowCache, [&evicted] { evicted.push_back(3002); });
+    residency.track(3003, MB, TextureOwner::IconAtlas, evict_releasing(3003));
+    residency.track(3004, MB, TextureOwner::IconAtlas, evict_releasing(3004));
+    residency.pin(3004);  // Oldest of all, but pinned
+    residency.track(3005, MB, TextureOwner::Renderer);  // No callback: never evicted
+
+    // Drawn in the order 3001, 3003, 3000 in later frames; 3002 not since it was created
+    residency.begin_frame();
+    residency.touch(3001);
+    residency.begin_frame();
+    residency.touch(3003);
+    residency.begin_frame();
+    residency.touch(3000);
+    residency.begin_frame();
+    expect(evicted.empty(), "nothing evicted under the budget");
+
+    // Six resident, three must go: least recently drawn first
+    residency.set_budget(3 * MB);
+    residency.begin_frame();
+    expect(evicted == std::vector<unsigned int>({3002, 3001, 3003}), "evicted in LRU order until usage fits");
+    expect(residency.get_usage() == 3 * MB && residency.get_texture_count() == 3, "usage fits the budget");
+    expect(residency.get_eviction_count() == evictions_before + 3, "evictions are counted");
+
+    // A texture drawn in the current frame survives even over the budget
+    residency.set_budget(0);
+    residency.touch(3000);
+    residency.begin_frame();
+    expect(evicted.size() == 3, "texture drawn this frame is not evicted");
+    residency.begin_frame();
+    expect(evicted.size() == 4 && evicted.back() == 3000, "evicted once it was not drawn");
+
+    // Pinned and callback-less textures stay, so usage stays over the budget
+    for (int frame = 0; frame < 3; ++frame) {
+        residency.begin_frame();
+    }
+    expect(evicted.size() == 4, "pinned textures are never evicted");
+    expect(residency.get_usage() == 2 * MB && residency.get_texture_count(TextureOwner::IconAtlas) == 1 &&
+           residency.get_texture_count(TextureOwner::Renderer) == 1, "pinned and unevictable textures stay resident");
+
+    residency.release(3004);
+    residency.release(3005);
+    residency.set_budget(TextureResidency::DEFAULT_BUDGET_BYTES);
+    expect(residency.get_usage() == 0 && residency.get_texture_count() == 0, "eviction test leaves nothing behind");
+}
+
+} // namespace
+
+int main() {
+    test_texture_bytes();
+    test_panels_return_to_baseline();
+    test_owner_accounting();
+    test_lru_eviction();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d texture residency check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("Texture residency: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2024 Voxelux
+ *
+ * This software and its source code are proprietary and confidential.
+ * All rights reserved. No part of this software may be reproduced,
+ * distributed, or transmitted in any form or by any means without
+ * prior written permission from Voxelux.
+ *
+ * Vertex packing test - pack/unpack round trips for the compact vertex and
+ * instance formats
+ */
+
+#include "canvas_ui/canvas_renderer.h"
+#include "canvas_ui/vertex_packing.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+using namespace voxel_canvas;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+bool near(float a, float b, float tolerance) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+// Half float keeps 11 significant bits
+bool near_half(float original, float unpacked) {
+    return near(original, unpacked, std::fabs(original) * (1.0f / 2048.0f));
+}
+
+bool colors_near(const ColorRGBA& a, const ColorRGBA& b) {
+    const float tolerance = 0.501f / 255.0f;  // Half a step, plus float rounding
+    return near(a.r, b.r, tolerance) && near(a.g, b.g, tolerance) &&
+           near(a.b, b.b, tolerance) && near(a.a, b.a, tolerance);
+}
+
+void test_unorm() {
+    for (int i = 0; i <= 255; ++i) {
+        expect(pack_unorm8(unpack_unorm8(static_cast<uint8_t>(i))) == i, "unorm8 round trip is exact");
+    }
+    expect(pack_unorm8(-1.0f) == 0 && pack_unorm8(2.0f) == 255, "unorm8 clamps");
+    expect(pack_unorm16(0.5f) == 32768, "unorm16 rounds to nearest");
+    expect(near(unpack_unorm16(pack_unorm16(0.123456f)), 0.123456f, 0.5f / 65535.0f), "unorm16 round trip");
+}
+
+void test_half() {
+    const float values[] = {0.0f, 1.0f, -1.0f, 0.5f, 3.14159f, 12.0f, 255.75f, 1024.0f, 65504.0f, 6.1035156e-5f};
+    for (float value : values) {
+        expect(half_to_float(float_to_half(value)) == value ||
+               near_half(value, half_to_float(float_to_half(value))), "half round trip");
+    }
+    expect(half_to_float(float_to_half(2049.0f)) == 2048.0f, "half rounds ties to even");
+    expect(half_to_float(float_to_half(5.9604645e-8f)) == 5.9604645e-8f, "smallest subnormal survives");
+    expect(std::isinf(half_to_float(float_to_half(1.0e6f))), "out of range saturates to infinity");
+    expect(std::isnan(half_to_float(float_to_half(std::numeric_limits<float>::quiet_NaN()))), "NaN stays NaN");
+    expect(std::signbit(half_to_float(float_to_half(-0.0f))), "negative zero keeps its sign");
+}
+
+void test_ui_vertex() {
+    UIVertex vertex(1919.25f, -37.5f, 0.25f, 1.0f, 0.1f, 0.2f, 0.3f, 0.4f);
+    expect(vertex.x == 1919.25f && vertex.y == -37.5f, "vertex position is exact");
+    expect(near(unpack_unorm16(vertex.u), 0.25f, 0.5f / 65535.0f) && unpack_unorm16(vertex.v) == 1.0f,
+           "vertex texture coordinates");
+    ColorRGBA color(unpack_unorm8(vertex.r), unpack_unorm8(vertex.g), unpack_unorm8(vertex.b), unpack_unorm8(vertex.a));
+    expect(colors_near(color, ColorRGBA(0.1f, 0.2f, 0.3f, 0.4f)), "vertex RGBA8 color");
+}
+
+void test_widget_instance() {
+    Rect2D rect(12.5f, 840.0f, 320.0f, 28.0f);
+    ColorRGBA fill(0.2f, 0.4f, 0.6f, 1.0f);
+    ColorRGBA border(1.0f, 0.0f, 0.5f, 0.75f);
+    ColorRGBA outline(0.05f, 0.9f, 0.33f, 0.5f);
+    WidgetInstanceData instance = pack_widget_instance(rect, fill, 6.5f, 1.5f, border, 2.0f, -1.25f, outline);
+
+    expect(instance.transform[0] == rect.x && instance.transform[1] == rect.y &&
+           instance.transform[2] == rect.width && instance.transform[3] == rect.height, "instance rect is exact");
+    expect(colors_near(unpack_rgba8(instance.color), fill), "instance fill color");
+    expect(colors_near(unpack_rgba8(instance.border_color), border), "instance border color");
+    expect(colors_near(unpack_rgba8(instance.outline_color), outline), "instance outline color keeps all channels");
+    for (uint16_t radius : instance.radii) {
+        expect(half_to_float(radius) == 6.5f, "instance corner radius");
+    }
+    expect(half_to_float(instance.widths[0]) == 1.5f, "instance border width");
+    expect(half_to_float(instance.widths[1]) == 2.0f, "instance outline width");
+    expect(half_to_float(instance.widths[2]) == -1.25f, "instance outline offset keeps its sign");
+    expect(half_to_float(instance.uv_rect[0]) == 0.0f && half_to_float(instance.uv_rect[3]) == 1.0f,
+           "instance uv rect spans the texture");
+    expect(instance.flags == 0 && instance.depth == 0, "plain instance has no gradient and no depth yet");
+
+    WidgetInstanceData clamped = pack_widget_instance(rect, fill, -4.0f, -1.0f, border, -2.0f, 0.0f, outline);
+    expect(clamped.radii[0] == 0 && clamped.widths[0] == 0 && clamped.widths[1] == 0,
+           "negative radius and widths clamp to zero");
+}
+
+void test_flags() {
+    for (unsigned kind = 0; kind <= 3; ++kind) {
+        for (unsigned row : {0u, 1u, 255u, 4095u}) {
+            uint16_t flags = pack_instance_flags(kind, row);
+            expect(instance_gradient_kind(flags) == kind && instance_lut_row(flags) == row, "flags round trip");
+        }
+    }
+    expect(instance_gradient_kind(pack_instance_flags(17u, 0u)) == 1u, "gradient kind stays in its 4 bits");
+}
+
+} // namespace
+
+int main() {
+    test_unorm();
+    test_half();
+    test_ui_vertex();
+    test_widget_instance();
+    test_flags();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d vertex packing check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("Vertex packing: all checks passed\n");
+    return 0;
+}